@@ -305,6 +305,7 @@ gAllTests = [ TestCase('TestBuffer', [], True)
              ,TestCase('TestTextUtils', [], True)
              ,TestCase('TestNetwork', [], True)
              ,TestCase('TestTime', [], True)
+             ,TestCase('TestHttp', [], True)
              #,TestCase('TestTimer', [])
              ,TestCase('TestTimerMock', [], True)
              #,TestCase('TestHttpReader', [], True)
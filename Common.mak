@@ -43,6 +43,7 @@ objects_core = \
 	$(objdir)CpiDeviceDv.$(objext) \
 	$(objdir)CpiDeviceLpec.$(objext) \
 	$(objdir)CpiDeviceUpnp.$(objext) \
+	$(objdir)CpiDeviceCacheUpnp.$(objext) \
 	$(objdir)CpiService.$(objext) \
 	$(objdir)CpiStack.$(objext) \
 	$(objdir)CpiSubscription.$(objext) \
@@ -95,6 +96,7 @@ objects_core = \
 	$(objdir)Md5.$(objext) \
 	$(objdir)NetworkAdapterList.$(objext) \
 	$(objdir)DnsChangeNotifier.$(objext) \
+	$(objdir)Metrics.$(objext) \
 	$(objdir)Network.$(objext) \
 	$(objdir)Parser.$(objext) \
 	$(objdir)Printer.$(objext) \
@@ -113,6 +115,8 @@ objects_core = \
 	$(objdir)Thread.$(objext) \
 	$(objdir)Time.$(objext) \
 	$(objdir)Timer.$(objext) \
+	$(objdir)WorkerPool.$(objext) \
+	$(objdir)BufferPool.$(objext) \
 	$(objdir)TIpAddressUtils.$(objext) \
 	$(objdir)Uri.$(objext) \
 	$(objdir)XmlParser.$(objext) \
@@ -130,7 +134,9 @@ objects_core = \
 	$(objdir)SignalHandlers.$(objext) \
 	$(objdir)Shell.$(objext) \
 	$(objdir)InfoProvider.$(objext) \
-	$(objdir)ShellCommandDebug.$(objext)
+	$(objdir)ShellCommandDebug.$(objext) \
+	$(objdir)ShellCommandMutexes.$(objext) \
+	$(objdir)MutexProfiler.$(objext)
 
 
 # For simplicity, we make a list of all headers in the project and have all (core) source files depend on them
@@ -152,12 +158,15 @@ headers = \
 	$(inc_build)/OpenHome/Private/Arch.h \
 	$(inc_build)/OpenHome/Private/Ascii.h \
 	$(inc_build)/OpenHome/Private/Converter.h \
+	$(inc_build)/OpenHome/Private/Atomic.h \
 	$(inc_build)/OpenHome/Private/Crc32.h \
 	$(inc_build)/OpenHome/Private/Debug.h \
 	$(inc_build)/OpenHome/Private/Fifo.h \
 	$(inc_build)/OpenHome/Private/File.h \
 	$(inc_build)/OpenHome/Private/Http.h \
 	$(inc_build)/OpenHome/Private/md5.h \
+	$(inc_build)/OpenHome/Private/Metrics.h \
+	$(inc_build)/OpenHome/Private/MutexProfiler.h \
 	$(inc_build)/OpenHome/Private/Network.h \
 	$(inc_build)/OpenHome/Private/NetworkAdapterList.h \
 	$(inc_build)/OpenHome/Private/DnsChangeNotifier.h \
@@ -170,12 +179,15 @@ headers = \
 	$(inc_build)/OpenHome/Private/Thread.h \
 	$(inc_build)/OpenHome/Private/Time.h \
 	$(inc_build)/OpenHome/Private/Timer.h \
+	$(inc_build)/OpenHome/Private/WorkerPool.h \
+	$(inc_build)/OpenHome/Private/BufferPool.h \
 	$(inc_build)/OpenHome/Private/TIpAddressUtils.h \
 	$(inc_build)/OpenHome/Private/Uri.h \
 	$(inc_build)/OpenHome/Net/Private/CpiDevice.h \
 	$(inc_build)/OpenHome/Net/Private/CpiDeviceDv.h \
 	$(inc_build)/OpenHome/Net/Private/CpiDeviceLpec.h \
 	$(inc_build)/OpenHome/Net/Private/CpiDeviceUpnp.h \
+	$(inc_build)/OpenHome/Net/Private/CpiDeviceCacheUpnp.h \
 	$(inc_build)/OpenHome/Net/Private/CpiService.h \
 	$(inc_build)/OpenHome/Net/Private/CpiStack.h \
 	$(inc_build)/OpenHome/Net/Private/CpiSubscription.h \
@@ -294,6 +306,8 @@ $(objdir)CpiDeviceLpec.$(objext) : OpenHome/Net/ControlPoint/Lpec/CpiDeviceLpec.
 	$(compiler)CpiDeviceLpec.$(objext) -c $(cppflags) $(includes) OpenHome/Net/ControlPoint/Lpec/CpiDeviceLpec.cpp
 $(objdir)CpiDeviceUpnp.$(objext) : OpenHome/Net/ControlPoint/Upnp/CpiDeviceUpnp.cpp $(headers)
 	$(compiler)CpiDeviceUpnp.$(objext) -c $(cppflags) $(includes) OpenHome/Net/ControlPoint/Upnp/CpiDeviceUpnp.cpp
+$(objdir)CpiDeviceCacheUpnp.$(objext) : OpenHome/Net/ControlPoint/Upnp/CpiDeviceCacheUpnp.cpp $(headers)
+	$(compiler)CpiDeviceCacheUpnp.$(objext) -c $(cppflags) $(includes) OpenHome/Net/ControlPoint/Upnp/CpiDeviceCacheUpnp.cpp
 $(objdir)CpiService.$(objext) : OpenHome/Net/ControlPoint/CpiService.cpp $(headers)
 	$(compiler)CpiService.$(objext) -c $(cppflags) $(includes) OpenHome/Net/ControlPoint/CpiService.cpp
 $(objdir)CpiStack.$(objext) : OpenHome/Net/ControlPoint/CpiStack.cpp $(headers)
@@ -400,6 +414,8 @@ $(objdir)NetworkAdapterList.$(objext) : OpenHome/NetworkAdapterList.cpp $(header
 	$(compiler)NetworkAdapterList.$(objext) -c $(cppflags) $(includes) OpenHome/NetworkAdapterList.cpp
 $(objdir)DnsChangeNotifier.$(objext) : OpenHome/DnsChangeNotifier.cpp $(headers)
 	$(compiler)DnsChangeNotifier.$(objext) -c $(cppflags) $(includes) OpenHome/DnsChangeNotifier.cpp
+$(objdir)Metrics.$(objext) : OpenHome/Metrics.cpp $(headers)
+	$(compiler)Metrics.$(objext) -c $(cppflags) $(includes) OpenHome/Metrics.cpp
 $(objdir)Network.$(objext) : OpenHome/Network.cpp $(headers)
 	$(compiler)Network.$(objext) -c $(cppflags) $(includes) OpenHome/Network.cpp
 $(objdir)Parser.$(objext) : OpenHome/Parser.cpp $(headers)
@@ -434,6 +450,10 @@ $(objdir)Time.$(objext) : OpenHome/Time.cpp $(headers)
 	$(compiler)Time.$(objext) -c $(cppflags) $(includes) OpenHome/Time.cpp
 $(objdir)Timer.$(objext) : OpenHome/Timer.cpp $(headers)
 	$(compiler)Timer.$(objext) -c $(cppflags) $(includes) OpenHome/Timer.cpp
+$(objdir)WorkerPool.$(objext) : OpenHome/WorkerPool.cpp $(headers)
+	$(compiler)WorkerPool.$(objext) -c $(cppflags) $(includes) OpenHome/WorkerPool.cpp
+$(objdir)BufferPool.$(objext) : OpenHome/BufferPool.cpp $(headers)
+	$(compiler)BufferPool.$(objext) -c $(cppflags) $(includes) OpenHome/BufferPool.cpp
 $(objdir)TIpAddressUtils.$(objext) : OpenHome/TIpAddressUtils.cpp $(headers)
 	$(compiler)TIpAddressUtils.$(objext) -c $(cppflags) $(includes) OpenHome/TIpAddressUtils.cpp
 $(objdir)Uri.$(objext) : OpenHome/Uri.cpp $(headers)
@@ -474,6 +494,10 @@ $(objdir)InfoProvider.$(objext) : OpenHome/Shell/InfoProvider.cpp $(headers)
 	$(compiler)InfoProvider.$(objext) -c $(cppflags) $(includes) OpenHome/Shell/InfoProvider.cpp
 $(objdir)ShellCommandDebug.$(objext) : OpenHome/Shell/ShellCommandDebug.cpp $(headers)
 	$(compiler)ShellCommandDebug.$(objext) -c $(cppflags) $(includes) OpenHome/Shell/ShellCommandDebug.cpp
+$(objdir)ShellCommandMutexes.$(objext) : OpenHome/Shell/ShellCommandMutexes.cpp $(headers)
+	$(compiler)ShellCommandMutexes.$(objext) -c $(cppflags) $(includes) OpenHome/Shell/ShellCommandMutexes.cpp
+$(objdir)MutexProfiler.$(objext) : OpenHome/MutexProfiler.cpp $(headers)
+	$(compiler)MutexProfiler.$(objext) -c $(cppflags) $(includes) OpenHome/MutexProfiler.cpp
 
 ohNetDllImpl: ohNetCore
 	$(link_dll) $(linkopts_ohNet) $(linkoutput)$(objdir)$(dllprefix)ohNet.$(dllext) $(objects_core)
@@ -581,6 +605,30 @@ $(objdir)TestFifo.$(objext) : OpenHome/Tests/TestFifo.cpp $(headers)
 $(objdir)TestFifoMain.$(objext) : OpenHome/Tests/TestFifoMain.cpp $(headers)
 	$(compiler)TestFifoMain.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestFifoMain.cpp
 
+TestCrc32: $(objdir)TestCrc32.$(exeext)
+$(objdir)TestCrc32.$(exeext) :  ohNetCore $(objdir)TestCrc32.$(objext) $(objdir)TestCrc32Main.$(objext) $(libprefix)TestFramework.$(libext)
+	$(link) $(linkoutput)$(objdir)TestCrc32.$(exeext) $(objdir)TestCrc32Main.$(objext) $(objdir)TestCrc32.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
+$(objdir)TestCrc32.$(objext) : OpenHome/Tests/TestCrc32.cpp $(headers)
+	$(compiler)TestCrc32.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestCrc32.cpp
+$(objdir)TestCrc32Main.$(objext) : OpenHome/Tests/TestCrc32Main.cpp $(headers)
+	$(compiler)TestCrc32Main.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestCrc32Main.cpp
+
+TestMetrics: $(objdir)TestMetrics.$(exeext)
+$(objdir)TestMetrics.$(exeext) :  ohNetCore $(objdir)TestMetrics.$(objext) $(objdir)TestMetricsMain.$(objext) $(libprefix)TestFramework.$(libext)
+	$(link) $(linkoutput)$(objdir)TestMetrics.$(exeext) $(objdir)TestMetricsMain.$(objext) $(objdir)TestMetrics.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
+$(objdir)TestMetrics.$(objext) : OpenHome/Tests/TestMetrics.cpp $(headers)
+	$(compiler)TestMetrics.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestMetrics.cpp
+$(objdir)TestMetricsMain.$(objext) : OpenHome/Tests/TestMetricsMain.cpp $(headers)
+	$(compiler)TestMetricsMain.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestMetricsMain.cpp
+
+TestWorkerPool: $(objdir)TestWorkerPool.$(exeext)
+$(objdir)TestWorkerPool.$(exeext) :  ohNetCore $(objdir)TestWorkerPool.$(objext) $(objdir)TestWorkerPoolMain.$(objext) $(libprefix)TestFramework.$(libext)
+	$(link) $(linkoutput)$(objdir)TestWorkerPool.$(exeext) $(objdir)TestWorkerPoolMain.$(objext) $(objdir)TestWorkerPool.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
+$(objdir)TestWorkerPool.$(objext) : OpenHome/Tests/TestWorkerPool.cpp $(headers)
+	$(compiler)TestWorkerPool.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestWorkerPool.cpp
+$(objdir)TestWorkerPoolMain.$(objext) : OpenHome/Tests/TestWorkerPoolMain.cpp $(headers)
+	$(compiler)TestWorkerPoolMain.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestWorkerPoolMain.cpp
+
 TestStream: $(objdir)TestStream.$(exeext)
 $(objdir)TestStream.$(exeext) :  ohNetCore $(objdir)TestStream.$(objext) $(objdir)TestStreamMain.$(objext) $(libprefix)TestFramework.$(libext)
 	$(link) $(linkoutput)$(objdir)TestStream.$(exeext) $(objdir)TestStreamMain.$(objext) $(objdir)TestStream.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
@@ -625,6 +673,14 @@ $(objdir)TestTime.$(objext) : OpenHome/Tests/TestTime.cpp $(headers)
 $(objdir)TestTimeMain.$(objext) : OpenHome/Tests/TestTimeMain.cpp $(headers)
 	$(compiler)TestTimeMain.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestTimeMain.cpp
 
+TestHttp: $(objdir)TestHttp.$(exeext)
+$(objdir)TestHttp.$(exeext) :  ohNetCore $(objdir)TestHttp.$(objext) $(objdir)TestHttpMain.$(objext) $(libprefix)TestFramework.$(libext)
+	$(link) $(linkoutput)$(objdir)TestHttp.$(exeext) $(objdir)TestHttpMain.$(objext) $(objdir)TestHttp.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
+$(objdir)TestHttp.$(objext) : OpenHome/Tests/TestHttp.cpp $(headers)
+	$(compiler)TestHttp.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestHttp.cpp
+$(objdir)TestHttpMain.$(objext) : OpenHome/Tests/TestHttpMain.cpp $(headers)
+	$(compiler)TestHttpMain.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestHttpMain.cpp
+
 TestTimer: $(objdir)TestTimer.$(exeext)
 $(objdir)TestTimer.$(exeext) :  ohNetCore $(objdir)TestTimer.$(objext) $(objdir)TestTimerMain.$(objext) $(libprefix)TestFramework.$(libext)
 	$(link) $(linkoutput)$(objdir)TestTimer.$(exeext) $(objdir)TestTimerMain.$(objext) $(objdir)TestTimer.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
@@ -742,6 +798,12 @@ $(objdir)TestCpDeviceListMdns.$(exeext) :  ohNetCore $(objdir)TestCpDeviceListMd
 $(objdir)TestCpDeviceListMdns.$(objext) : OpenHome/Net/Device/Bonjour/Tests/TestCpDeviceListMdns.cpp $(headers)
 	$(compiler)TestCpDeviceListMdns.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Device/Bonjour/Tests/TestCpDeviceListMdns.cpp
 
+TestMdnsRegister: $(objdir)TestMdnsRegister.$(exeext)
+$(objdir)TestMdnsRegister.$(exeext) :  ohNetCore $(objdir)TestMdnsRegister.$(objext) $(libprefix)TestFramework.$(libext)
+	$(link) $(linkoutput)$(objdir)TestMdnsRegister.$(exeext) $(objdir)$(libprefix)ohNetCore.$(libext) $(objdir)TestMdnsRegister.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
+$(objdir)TestMdnsRegister.$(objext) : OpenHome/Net/Device/Bonjour/Tests/TestMdnsRegister.cpp $(headers)
+	$(compiler)TestMdnsRegister.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Device/Bonjour/Tests/TestMdnsRegister.cpp
+
 TestDviDiscovery: $(objdir)TestDviDiscovery.$(exeext)
 $(objdir)TestDviDiscovery.$(exeext) :  ohNetCore $(objdir)TestDviDiscovery.$(objext) $(objdir)TestDviDiscoveryMain.$(objext) $(libprefix)TestFramework.$(libext)
 	$(link) $(linkoutput)$(objdir)TestDviDiscovery.$(exeext) $(objdir)TestDviDiscoveryMain.$(objext) $(objdir)TestDviDiscovery.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
@@ -782,6 +844,30 @@ $(objdir)TestDvLpec.$(objext) : OpenHome/Net/Device/Tests/TestDvLpec.cpp $(heade
 $(objdir)TestDvLpecMain.$(objext) : OpenHome/Net/Device/Tests/TestDvLpecMain.cpp $(headers)
 	$(compiler)TestDvLpecMain.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Device/Tests/TestDvLpecMain.cpp
 
+TestWebSocket: $(objdir)TestWebSocket.$(exeext)
+$(objdir)TestWebSocket.$(exeext) :  ohNetCore $(objdir)TestWebSocket.$(objext) $(objdir)TestWebSocketMain.$(objext) $(libprefix)TestFramework.$(libext)
+	$(link) $(linkoutput)$(objdir)TestWebSocket.$(exeext) $(objdir)TestWebSocketMain.$(objext) $(objdir)TestWebSocket.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
+$(objdir)TestWebSocket.$(objext) : OpenHome/Net/Device/Tests/TestWebSocket.cpp $(headers)
+	$(compiler)TestWebSocket.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Device/Tests/TestWebSocket.cpp
+$(objdir)TestWebSocketMain.$(objext) : OpenHome/Net/Device/Tests/TestWebSocketMain.cpp $(headers)
+	$(compiler)TestWebSocketMain.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Device/Tests/TestWebSocketMain.cpp
+
+TestDviPropertyUpdates: $(objdir)TestDviPropertyUpdates.$(exeext)
+$(objdir)TestDviPropertyUpdates.$(exeext) :  ohNetCore $(objdir)TestDviPropertyUpdates.$(objext) $(objdir)TestDviPropertyUpdatesMain.$(objext) $(libprefix)TestFramework.$(libext)
+	$(link) $(linkoutput)$(objdir)TestDviPropertyUpdates.$(exeext) $(objdir)TestDviPropertyUpdatesMain.$(objext) $(objdir)TestDviPropertyUpdates.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
+$(objdir)TestDviPropertyUpdates.$(objext) : OpenHome/Net/Device/Tests/TestDviPropertyUpdates.cpp $(headers)
+	$(compiler)TestDviPropertyUpdates.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Device/Tests/TestDviPropertyUpdates.cpp
+$(objdir)TestDviPropertyUpdatesMain.$(objext) : OpenHome/Net/Device/Tests/TestDviPropertyUpdatesMain.cpp $(headers)
+	$(compiler)TestDviPropertyUpdatesMain.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Device/Tests/TestDviPropertyUpdatesMain.cpp
+
+TestLoopbackBenchmark: $(objdir)TestLoopbackBenchmark.$(exeext)
+$(objdir)TestLoopbackBenchmark.$(exeext) :  ohNetCore $(objdir)TestLoopbackBenchmark.$(objext) $(objdir)TestLoopbackBenchmarkMain.$(objext) $(libprefix)TestFramework.$(libext)
+	$(link) $(linkoutput)$(objdir)TestLoopbackBenchmark.$(exeext) $(objdir)TestLoopbackBenchmarkMain.$(objext) $(objdir)TestLoopbackBenchmark.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
+$(objdir)TestLoopbackBenchmark.$(objext) : OpenHome/Net/Device/Tests/TestLoopbackBenchmark.cpp $(headers)
+	$(compiler)TestLoopbackBenchmark.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Device/Tests/TestLoopbackBenchmark.cpp
+$(objdir)TestLoopbackBenchmarkMain.$(objext) : OpenHome/Net/Device/Tests/TestLoopbackBenchmarkMain.cpp $(headers)
+	$(compiler)TestLoopbackBenchmarkMain.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Device/Tests/TestLoopbackBenchmarkMain.cpp
+
 TestDvTestBasic: $(objdir)TestDvTestBasic.$(exeext)
 $(objdir)TestDvTestBasic.$(exeext) :  ohNetCore $(objdir)TestDvTestBasic.$(objext) $(libprefix)TestFramework.$(libext)
 	$(link) $(linkoutput)$(objdir)TestDvTestBasic.$(exeext) $(objdir)TestDvTestBasic.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
@@ -871,12 +957,16 @@ tests_core = \
 	$(objdir)TestThread.$(objext) \
 	$(objdir)TestFunctorGeneric.$(objext) \
 	$(objdir)TestFifo.$(objext) \
+	$(objdir)TestCrc32.$(objext) \
+	$(objdir)TestMetrics.$(objext) \
+	$(objdir)TestWorkerPool.$(objext) \
 	$(objdir)TestStream.$(objext) \
 	$(objdir)TestFile.$(objext) \
 	$(objdir)TestQueue.$(objext) \
 	$(objdir)TestTextUtils.$(objext) \
 	$(objdir)TestNetwork.$(objext) \
 	$(objdir)TestTime.$(objext) \
+	$(objdir)TestHttp.$(objext) \
 	$(objdir)TestTimer.$(objext) \
 	$(objdir)TestTimerMock.$(objext) \
 	$(objdir)TestSsdpMListen.$(objext) \
@@ -892,13 +982,17 @@ tests_core = \
 	$(objdir)TestDvInvocation.$(objext) \
 	$(objdir)TestDvSubscription.$(objext) \
 	$(objdir)TestDvLpec.$(objext) \
+	$(objdir)TestWebSocket.$(objext) \
+	$(objdir)TestDviPropertyUpdates.$(objext) \
+	$(objdir)TestLoopbackBenchmark.$(objext) \
 	$(objdir)TestException.$(objext) \
-	$(objdir)TestCpDeviceListMdns.$(objext)
+	$(objdir)TestCpDeviceListMdns.$(objext) \
+	$(objdir)TestMdnsRegister.$(objext)
 
 TestsCore: $(tests_core)
 	$(ar)ohNetTestsCore.$(libext) $(tests_core)
 
-TestsNative: TestBuffer TestPrinter TestThread TestFunctorGeneric TestFifo TestStream TestFile TestQueue TestTextUtils TestMulticast TestNetwork TestEcho TestTime TestTimer TestTimerMock TestSsdpMListen TestSsdpUListen TestXmlParser TestDeviceList TestDeviceListStd TestDeviceListC TestInvocation TestInvocationStd TestSubscription TestProxyC TestDviDiscovery TestDviDeviceList TestDvInvocation TestDvSubscription TestDvLpec TestDvTestBasic TestAdapterChange TestDeviceFinder TestDvDeviceStd TestDvDeviceC TestCpDeviceDv TestCpDeviceDvStd TestCpDeviceDvC TestShell
+TestsNative: TestBuffer TestPrinter TestThread TestFunctorGeneric TestFifo TestCrc32 TestMetrics TestWorkerPool TestStream TestFile TestQueue TestTextUtils TestMulticast TestNetwork TestEcho TestTime TestHttp TestTimer TestTimerMock TestSsdpMListen TestSsdpUListen TestXmlParser TestDeviceList TestDeviceListStd TestDeviceListC TestInvocation TestInvocationStd TestSubscription TestProxyC TestDviDiscovery TestDviDeviceList TestDvInvocation TestDvSubscription TestDvLpec TestWebSocket TestDviPropertyUpdates TestLoopbackBenchmark TestDvTestBasic TestAdapterChange TestDeviceFinder TestDvDeviceStd TestDvDeviceC TestCpDeviceDv TestCpDeviceDvStd TestCpDeviceDvC TestShell
 
 TestsCs: TestProxyCs TestDvDeviceCs TestCpDeviceDvCs TestPerformanceDv TestPerformanceCp TestPerformanceDvCs TestPerformanceCpCs
 
@@ -983,6 +1077,7 @@ objects_jni = \
 	$(objdir)JniArgumentInt.$(objext) \
 	$(objdir)JniArgumentString.$(objext) \
 	$(objdir)JniArgumentUint.$(objext) \
+	$(objdir)JniCache.$(objext) \
 	$(objdir)JniCallbackList.$(objext) \
 	$(objdir)JniCpDevice.$(objext) \
 	$(objdir)JniCpDeviceDv.$(objext) \
@@ -1033,6 +1128,8 @@ $(objdir)JniArgumentString.$(objext) : $(publicjavadir)ArgumentString.c $(header
 	$(compiler)JniArgumentString.$(objext) -c $(java_cflags) $(includes) $(includes_jni) $(publicjavadir)ArgumentString.c
 $(objdir)JniArgumentUint.$(objext) : $(publicjavadir)ArgumentUint.c $(headers)
 	$(compiler)JniArgumentUint.$(objext) -c $(java_cflags) $(includes) $(includes_jni) $(publicjavadir)ArgumentUint.c
+$(objdir)JniCache.$(objext) : $(publicjavadir)JniCache.c $(headers)
+	$(compiler)JniCache.$(objext) -c $(java_cflags) $(includes) $(includes_jni) $(publicjavadir)JniCache.c
 $(objdir)JniCallbackList.$(objext) : $(publicjavadir)JniCallbackList.c $(headers)
 	$(compiler)JniCallbackList.$(objext) -c $(java_cflags) $(includes) $(includes_jni) $(publicjavadir)JniCallbackList.c
 $(objdir)JniCpDevice.$(objext) : $(publicjavadir)CpDevice.c $(headers)
@@ -0,0 +1,107 @@
+#ifndef HEADER_ATOMIC
+#define HEADER_ATOMIC
+
+#include <OpenHome/Types.h>
+
+#ifdef _MSC_VER
+# include <intrin.h>
+#endif
+
+namespace OpenHome {
+
+/**
+ * Minimal set of lock-free integer operations.
+ *
+ * All operations are full barriers.  These are intended for counters, flags and
+ * reference counts on hot paths where taking a Mutex would dominate the cost of
+ * the work being protected.  Prefer a Mutex for anything more complex.
+ */
+class Atomic
+{
+public:
+    inline static TUint Load(volatile TUint& aValue);
+    inline static void Store(volatile TUint& aValue, TUint aNew);
+    inline static TUint Add(volatile TUint& aValue, TUint aDelta); // returns new value
+    inline static TUint Sub(volatile TUint& aValue, TUint aDelta); // returns new value
+    inline static TBool CompareAndSwap(volatile TUint& aValue, TUint aExpected, TUint aNew);
+    inline static TUint64 Load64(volatile TUint64& aValue);
+    inline static TUint64 Add64(volatile TUint64& aValue, TUint64 aDelta); // returns new value
+    inline static TBool CompareAndSwap64(volatile TUint64& aValue, TUint64 aExpected, TUint64 aNew);
+};
+
+#ifdef _MSC_VER
+
+inline TUint Atomic::Add(volatile TUint& aValue, TUint aDelta)
+{
+    return (TUint)_InterlockedExchangeAdd((volatile long*)&aValue, (long)aDelta) + aDelta;
+}
+
+inline TBool Atomic::CompareAndSwap(volatile TUint& aValue, TUint aExpected, TUint aNew)
+{
+    return ((TUint)_InterlockedCompareExchange((volatile long*)&aValue, (long)aNew, (long)aExpected) == aExpected);
+}
+
+inline TBool Atomic::CompareAndSwap64(volatile TUint64& aValue, TUint64 aExpected, TUint64 aNew)
+{
+    return ((TUint64)_InterlockedCompareExchange64((volatile __int64*)&aValue, (__int64)aNew, (__int64)aExpected) == aExpected);
+}
+
+#else // gcc/clang
+
+inline TUint Atomic::Add(volatile TUint& aValue, TUint aDelta)
+{
+    return __sync_add_and_fetch(&aValue, aDelta);
+}
+
+inline TBool Atomic::CompareAndSwap(volatile TUint& aValue, TUint aExpected, TUint aNew)
+{
+    return __sync_bool_compare_and_swap(&aValue, aExpected, aNew);
+}
+
+inline TBool Atomic::CompareAndSwap64(volatile TUint64& aValue, TUint64 aExpected, TUint64 aNew)
+{
+    return __sync_bool_compare_and_swap(&aValue, aExpected, aNew);
+}
+
+#endif // _MSC_VER
+
+inline TUint Atomic::Load(volatile TUint& aValue)
+{
+    return Add(aValue, 0);
+}
+
+inline void Atomic::Store(volatile TUint& aValue, TUint aNew)
+{
+    TUint old = aValue;
+    while (!CompareAndSwap(aValue, old, aNew)) {
+        old = aValue;
+    }
+}
+
+inline TUint Atomic::Sub(volatile TUint& aValue, TUint aDelta)
+{
+    return Add(aValue, (TUint)(0 - aDelta));
+}
+
+inline TUint64 Atomic::Load64(volatile TUint64& aValue)
+{
+    // a CAS that never succeeds (or writes back the same value) gives an atomic read on 32-bit targets
+    TUint64 val = aValue;
+    while (!CompareAndSwap64(aValue, val, val)) {
+        val = aValue;
+    }
+    return val;
+}
+
+inline TUint64 Atomic::Add64(volatile TUint64& aValue, TUint64 aDelta)
+{
+    TUint64 old = aValue;
+    while (!CompareAndSwap64(aValue, old, old + aDelta)) {
+        old = aValue;
+    }
+    return old + aDelta;
+}
+
+} // namespace OpenHome
+
+#endif // HEADER_ATOMIC
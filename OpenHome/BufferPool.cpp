@@ -0,0 +1,215 @@
+#include <OpenHome/Private/BufferPool.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Stream.h>
+
+#include <algorithm>
+
+using namespace OpenHome;
+
+// BufferPool
+
+const TUint BufferPool::kClassBytes[kNumClasses] = { 256, 1024, 4*1024, 16*1024, kMaxPooledBytes };
+
+BufferPool::BufferPool(TUint aMaxFreePerClass)
+    : iMaxFreePerClass(aMaxFreePerClass)
+    , iLock("BUFP")
+    , iBytesInUse(0)
+    , iBytesFree(0)
+{
+}
+
+BufferPool::~BufferPool()
+{
+    ASSERT(iBytesInUse == 0);
+    for (TUint i=0; i<kNumClasses; i++) {
+        for (TUint j=0; j<(TUint)iFree[i].size(); j++) {
+            delete iFree[i][j];
+        }
+    }
+}
+
+Bwh* BufferPool::Acquire(TUint aMinBytes)
+{
+    TUint bytes = aMinBytes;
+    for (TUint i=0; i<kNumClasses; i++) {
+        if (kClassBytes[i] >= aMinBytes) {
+            bytes = kClassBytes[i];
+            AutoMutex _(iLock);
+            iBytesInUse += bytes;
+            if (iFree[i].size() > 0) {
+                Bwh* buf = iFree[i].back();
+                iFree[i].pop_back();
+                iBytesFree -= bytes;
+                return buf;
+            }
+            break;
+        }
+    }
+    if (bytes > kMaxPooledBytes) {
+        AutoMutex _(iLock);
+        iBytesInUse += bytes;
+    }
+    return new Bwh(bytes);
+}
+
+void BufferPool::Release(Bwh* aBuffer)
+{
+    if (aBuffer == NULL) {
+        return;
+    }
+    const TUint bytes = aBuffer->MaxBytes();
+    const TInt index = ClassIndex(bytes);
+    iLock.Wait();
+    iBytesInUse -= bytes;
+    if (index >= 0 && iFree[index].size() < iMaxFreePerClass) {
+        aBuffer->SetBytes(0);
+        iFree[index].push_back(aBuffer);
+        iBytesFree += bytes;
+        aBuffer = NULL;
+    }
+    iLock.Signal();
+    delete aBuffer;
+}
+
+TUint BufferPool::BytesInUse() const
+{
+    AutoMutex _(iLock);
+    return iBytesInUse;
+}
+
+TUint BufferPool::BytesFree() const
+{
+    AutoMutex _(iLock);
+    return iBytesFree;
+}
+
+TInt BufferPool::ClassIndex(TUint aBytes)
+{
+    for (TUint i=0; i<kNumClasses; i++) {
+        if (kClassBytes[i] == aBytes) {
+            return (TInt)i;
+        }
+    }
+    return -1;
+}
+
+
+// Swp
+
+Swp::Swp(BufferPool& aPool, TUint aMaxBytes, IWriter& aWriter)
+    : Swx(aMaxBytes, aWriter)
+    , iPool(aPool)
+    , iBuf(NULL)
+{
+}
+
+Swp::~Swp()
+{
+    iPool.Release(iBuf);
+}
+
+void Swp::WriteFlush()
+{
+    Swx::WriteFlush();
+    iPool.Release(iBuf);
+    iBuf = NULL;
+}
+
+TByte* Swp::Ptr()
+{
+    if (iBuf == NULL) {
+        iBuf = iPool.Acquire(iMaxBytes);
+    }
+    return const_cast<TByte*>(iBuf->Ptr());
+}
+
+
+// WriterBufferChain
+
+WriterBufferChain::WriterBufferChain(BufferPool& aPool, TUint aChunkBytes, TUint aMaxBytes)
+    : iPool(aPool)
+    , iChunkBytes(aChunkBytes)
+    , iMaxBytes(aMaxBytes)
+    , iBytes(0)
+{
+}
+
+WriterBufferChain::~WriterBufferChain()
+{
+    Reset();
+}
+
+TUint WriterBufferChain::Bytes() const
+{
+    return iBytes;
+}
+
+const Brx& WriterBufferChain::Buffer()
+{
+    if (iChunks.size() == 0) {
+        return Brx::Empty();
+    }
+    if (iChunks.size() > 1) {
+        Bwh* merged = iPool.Acquire(iBytes);
+        for (TUint i=0; i<(TUint)iChunks.size(); i++) {
+            merged->Append(*iChunks[i]);
+            iPool.Release(iChunks[i]);
+        }
+        iChunks.clear();
+        iChunks.push_back(merged);
+    }
+    return *iChunks[0];
+}
+
+void WriterBufferChain::Reset()
+{
+    for (TUint i=0; i<(TUint)iChunks.size(); i++) {
+        iPool.Release(iChunks[i]);
+    }
+    iChunks.clear();
+    iBytes = 0;
+}
+
+void WriterBufferChain::Write(TByte aValue)
+{
+    Write(Brn(&aValue, 1));
+}
+
+void WriterBufferChain::Write(const Brx& aBuffer)
+{
+    if (iBytes + aBuffer.Bytes() > iMaxBytes) {
+        THROW(WriterError);
+    }
+    const TByte* ptr = aBuffer.Ptr();
+    TUint remaining = aBuffer.Bytes();
+    while (remaining > 0) {
+        Bwh& tail = Tail(remaining);
+        const TUint bytes = std::min(remaining, tail.MaxBytes() - tail.Bytes());
+        tail.Append(ptr, bytes);
+        ptr += bytes;
+        remaining -= bytes;
+        iBytes += bytes;
+    }
+}
+
+void WriterBufferChain::WriteFlush()
+{
+}
+
+Bwh& WriterBufferChain::Tail(TUint aMinBytes)
+{
+    if (iChunks.size() > 0) {
+        Bwh* tail = iChunks.back();
+        if (tail->Bytes() < tail->MaxBytes()) {
+            return *tail;
+        }
+    }
+    // each new chunk doubles the capacity of the chain, up to the largest pooled size
+    TUint bytes = (iChunks.size() == 0? iChunkBytes : std::min(iBytes, (TUint)BufferPool::kMaxPooledBytes));
+    bytes = std::max(bytes, std::min(aMinBytes, (TUint)BufferPool::kMaxPooledBytes));
+    Bwh* chunk = iPool.Acquire(bytes);
+    iChunks.push_back(chunk);
+    return *chunk;
+}
@@ -0,0 +1,98 @@
+#ifndef HEADER_BUFFER_POOL
+#define HEADER_BUFFER_POOL
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Standard.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Stream.h>
+
+#include <vector>
+
+namespace OpenHome {
+
+/**
+ * Shared store of heap buffers, grouped into a small number of size classes.
+ *
+ * Lets objects which only occasionally need a large buffer (e.g. server sessions while a
+ * request is being processed) borrow one rather than each holding its own for their lifetime.
+ * Up to aMaxFreePerClass released buffers of each size are kept for reuse; any more are freed.
+ */
+class BufferPool : private INonCopyable
+{
+public:
+    static const TUint kNumClasses = 5;
+    static const TUint kMaxPooledBytes = 64*1024; // size of the largest class
+    static const TUint kDefaultMaxFreePerClass = 8;
+public:
+    BufferPool(TUint aMaxFreePerClass = kDefaultMaxFreePerClass);
+    ~BufferPool();
+    /**
+     * Returns an empty buffer with MaxBytes() of at least aMinBytes.
+     * Requests larger than kMaxPooledBytes are allocated (and later freed) individually.
+     */
+    Bwh* Acquire(TUint aMinBytes);
+    void Release(Bwh* aBuffer);
+    TUint BytesInUse() const;
+    TUint BytesFree() const;
+private:
+    static TInt ClassIndex(TUint aBytes);
+private:
+    static const TUint kClassBytes[kNumClasses];
+    const TUint iMaxFreePerClass;
+    mutable Mutex iLock;
+    std::vector<Bwh*> iFree[kNumClasses];
+    TUint iBytesInUse;
+    TUint iBytesFree;
+};
+
+/**
+ * Buffered writer whose buffer is borrowed from a BufferPool on first use and returned
+ * after each WriteFlush().  Holds no buffer between messages.
+ */
+class Swp : public Swx
+{
+public:
+    Swp(BufferPool& aPool, TUint aMaxBytes, IWriter& aWriter);
+    ~Swp();
+public: // from Swx
+    void WriteFlush();
+private: // from Sxx
+    TByte* Ptr();
+private:
+    BufferPool& iPool;
+    Bwh* iBuf;
+};
+
+/**
+ * Collects an arbitrary amount of data in a chain of pooled buffers.
+ *
+ * Write() throws WriterError if more than aMaxBytes is written.  Buffer() returns the data
+ * as a single contiguous buffer, merging the chain if necessary.  All buffers are returned
+ * to the pool by Reset() or on destruction.
+ */
+class WriterBufferChain : public IWriter, private INonCopyable
+{
+public:
+    WriterBufferChain(BufferPool& aPool, TUint aChunkBytes, TUint aMaxBytes);
+    ~WriterBufferChain();
+    TUint Bytes() const;
+    const Brx& Buffer();
+    void Reset();
+public: // from IWriter
+    void Write(TByte aValue);
+    void Write(const Brx& aBuffer);
+    void WriteFlush();
+private:
+    Bwh& Tail(TUint aMinBytes);
+private:
+    BufferPool& iPool;
+    const TUint iChunkBytes;
+    const TUint iMaxBytes;
+    std::vector<Bwh*> iChunks;
+    TUint iBytes;
+};
+
+} // namespace OpenHome
+
+#endif // HEADER_BUFFER_POOL
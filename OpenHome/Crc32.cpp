@@ -2,11 +2,252 @@
 
 #include <OpenHome/Private/Printer.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define CRC32_PCLMUL
+# include <cpuid.h>
+# include <wmmintrin.h>
+# include <smmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+# define CRC32_ARMV8
+# include <arm_acle.h>
+# include <string.h>
+#endif
+
+namespace OpenHome {
+
+class Crc32Tables
+{
+public:
+    Crc32Tables();
+public:
+    TUint32 iSlice[16][256]; // iSlice[0] is the classic byte-at-a-time table
+    TUint32 iX2n[32];        // x^(2^n) modulo the polynomial; used by Combine()
+};
+
+} // namespace OpenHome
+
 using namespace OpenHome;
 
-std::vector<TUint> Crc32TableInitialiser::InitialiseTable(TUint32 aPolynomial)
+typedef TUint32 (*Crc32UpdateFunction)(TUint32 aCrc, const TByte* aPtr, TUint aBytes);
+
+static TUint32 MultModP(TUint32 aA, TUint32 aB)
+{
+    // multiply aA by aB modulo the (bit reflected) polynomial
+    TUint32 m = (TUint32)1 << 31;
+    TUint32 p = 0;
+    for (;;) {
+        if (aA & m) {
+            p ^= aB;
+            if ((aA & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        aB = (aB & 1)? (aB >> 1) ^ Crc32::kDefaultPolynomial : aB >> 1;
+    }
+    return p;
+}
+
+Crc32Tables::Crc32Tables()
+{
+    std::vector<TUint32> table = Crc32TableInitialiser::InitialiseTable(Crc32::kDefaultPolynomial);
+    for (TUint i=0; i<256; i++) {
+        iSlice[0][i] = table[i];
+    }
+    for (TUint i=0; i<256; i++) {
+        TUint32 crc = iSlice[0][i];
+        for (TUint j=1; j<16; j++) {
+            crc = (crc >> 8) ^ iSlice[0][crc & 0xff];
+            iSlice[j][i] = crc;
+        }
+    }
+    TUint32 p = (TUint32)1 << 30; // x^1
+    iX2n[0] = p;
+    for (TUint i=1; i<32; i++) {
+        p = MultModP(p, p);
+        iX2n[i] = p;
+    }
+}
+
+static const Crc32Tables& Tables()
+{
+    static const Crc32Tables tables;
+    return tables;
+}
+
+static TUint32 UpdateSlice16(TUint32 aCrc, const TByte* aPtr, TUint aBytes)
+{
+    const TUint32 (*s)[256] = Tables().iSlice;
+    TUint32 crc = aCrc;
+    while (aBytes >= 16) {
+        const TUint32 a = crc ^ ((TUint32)aPtr[0] | ((TUint32)aPtr[1] << 8) | ((TUint32)aPtr[2] << 16) | ((TUint32)aPtr[3] << 24));
+        crc = s[15][a & 0xff] ^ s[14][(a >> 8) & 0xff] ^ s[13][(a >> 16) & 0xff] ^ s[12][a >> 24]
+            ^ s[11][aPtr[4]]  ^ s[10][aPtr[5]]  ^ s[9][aPtr[6]]   ^ s[8][aPtr[7]]
+            ^ s[7][aPtr[8]]   ^ s[6][aPtr[9]]   ^ s[5][aPtr[10]]  ^ s[4][aPtr[11]]
+            ^ s[3][aPtr[12]]  ^ s[2][aPtr[13]]  ^ s[1][aPtr[14]]  ^ s[0][aPtr[15]];
+        aPtr += 16;
+        aBytes -= 16;
+    }
+    while (aBytes > 0) {
+        crc = (crc >> 8) ^ s[0][(crc ^ *aPtr) & 0xff];
+        aPtr++;
+        aBytes--;
+    }
+    return crc;
+}
+
+#ifdef CRC32_PCLMUL
+
+/* Folds 64 bytes at a time using carry-less multiplication then Barrett reduces
+   the remaining 128 bits.  See Intel's "Fast CRC Computation for Generic Polynomials
+   Using PCLMULQDQ Instruction".  Constants are for the bit reflected IEEE polynomial.
+   aBytes must be at least 64 and a multiple of 16. */
+__attribute__((target("pclmul,sse4.1")))
+static TUint32 UpdatePclmulBlocks(TUint32 aCrc, const TByte* aPtr, TUint aBytes)
+{
+    static const TUint64 kK1K2[2] __attribute__((aligned(16))) = { 0x0154442bd4ULL, 0x01c6e41596ULL };
+    static const TUint64 kK3K4[2] __attribute__((aligned(16))) = { 0x01751997d0ULL, 0x00ccaa009eULL };
+    static const TUint64 kK5K0[2] __attribute__((aligned(16))) = { 0x0163cd6124ULL, 0x0000000000ULL };
+    static const TUint64 kPoly[2] __attribute__((aligned(16))) = { 0x01db710641ULL, 0x01f7011641ULL };
+
+    __m128i x1 = _mm_loadu_si128((const __m128i*)(aPtr + 0x00));
+    __m128i x2 = _mm_loadu_si128((const __m128i*)(aPtr + 0x10));
+    __m128i x3 = _mm_loadu_si128((const __m128i*)(aPtr + 0x20));
+    __m128i x4 = _mm_loadu_si128((const __m128i*)(aPtr + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)aCrc));
+    __m128i x0 = _mm_load_si128((const __m128i*)kK1K2);
+    aPtr += 64;
+    aBytes -= 64;
+
+    // fold 4 blocks of 16 bytes in parallel
+    while (aBytes >= 64) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        __m128i x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        __m128i x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        __m128i x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*)(aPtr + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*)(aPtr + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*)(aPtr + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*)(aPtr + 0x30)));
+        aPtr += 64;
+        aBytes -= 64;
+    }
+
+    // fold into 128 bits
+    x0 = _mm_load_si128((const __m128i*)kK3K4);
+    __m128i x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // fold any remaining 16 byte blocks
+    while (aBytes >= 16) {
+        x2 = _mm_loadu_si128((const __m128i*)aPtr);
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        aPtr += 16;
+        aBytes -= 16;
+    }
+
+    // fold 128 bits to 64
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+    x0 = _mm_loadl_epi64((const __m128i*)kK5K0);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduce to 32 bits
+    x0 = _mm_load_si128((const __m128i*)kPoly);
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return (TUint32)_mm_extract_epi32(x1, 1);
+}
+
+static TUint32 UpdatePclmul(TUint32 aCrc, const TByte* aPtr, TUint aBytes)
+{
+    if (aBytes >= 64) {
+        const TUint blockBytes = aBytes & ~15u;
+        aCrc = UpdatePclmulBlocks(aCrc, aPtr, blockBytes);
+        aPtr += blockBytes;
+        aBytes -= blockBytes;
+    }
+    return UpdateSlice16(aCrc, aPtr, aBytes);
+}
+
+static TBool CpuSupportsPclmul()
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+    return (ecx & bit_PCLMUL) != 0 && (ecx & bit_SSE4_1) != 0;
+}
+
+#endif // CRC32_PCLMUL
+
+#ifdef CRC32_ARMV8
+
+static TUint32 UpdateArmv8(TUint32 aCrc, const TByte* aPtr, TUint aBytes)
+{
+    while (aBytes >= 8) {
+        uint64_t word;
+        (void)memcpy(&word, aPtr, sizeof(word)); // crc32d expects little endian data, as aarch64 always is in practice
+        aCrc = __crc32d(aCrc, word);
+        aPtr += 8;
+        aBytes -= 8;
+    }
+    while (aBytes > 0) {
+        aCrc = __crc32b(aCrc, *aPtr);
+        aPtr++;
+        aBytes--;
+    }
+    return aCrc;
+}
+
+#endif // CRC32_ARMV8
+
+static Crc32UpdateFunction SelectUpdateFunction()
+{
+#if defined(CRC32_PCLMUL)
+    if (CpuSupportsPclmul()) {
+        return UpdatePclmul;
+    }
+#elif defined(CRC32_ARMV8)
+    return UpdateArmv8;
+#endif
+    return UpdateSlice16;
+}
+
+static TUint32 UpdateCrc(TUint32 aCrc, const TByte* aPtr, TUint aBytes)
+{
+    static const Crc32UpdateFunction update = SelectUpdateFunction();
+    return update(aCrc, aPtr, aBytes);
+}
+
+
+// Crc32TableInitialiser
+
+std::vector<TUint32> Crc32TableInitialiser::InitialiseTable(TUint32 aPolynomial)
 {
     std::vector<TUint32> table;
+    table.reserve(256);
     for (TUint i = 0; i < 256; i++) {
         TUint32 entry = i;
         for (TUint j = 0; j < 8; j++) {
@@ -27,58 +268,61 @@ std::vector<TUint> Crc32TableInitialiser::InitialiseTable(TUint32 aPolynomial)
 
 TUint32 Crc32::Compute(const Brx& aBuffer)
 {
-    TUint32 crc = kDefaultSeed;
-    std::vector<TUint32> table = Crc32TableInitialiser::InitialiseTable(kDefaultPolynomial);
-
-    for (TUint i = 0; i < aBuffer.Bytes(); i++) {
-        crc = (crc >> 8) ^ table[(aBuffer[i] ^ crc) & 0xff];
-    }
-    return ~crc;
+    return ~UpdateCrc(kDefaultSeed, aBuffer.Ptr(), aBuffer.Bytes());
 }
 
 TUint32 Crc32::Compute(const Brx& aBuffer, TUint32 aSeed)
 {
-    TUint32 crc = aSeed;
-    std::vector<TUint32> table = Crc32TableInitialiser::InitialiseTable(kDefaultPolynomial);
-
-    for (TUint i = 0; i < aBuffer.Bytes(); i++) {
-        crc = (crc >> 8) ^ table[(aBuffer[i] ^ crc) & 0xff];
-    }
-    return ~crc;
+    return ~UpdateCrc(aSeed, aBuffer.Ptr(), aBuffer.Bytes());
 }
 
 TUint32 Crc32::Compute(IReader& aReader)
 {
-    TUint32 crc = kDefaultSeed;
-    std::vector<TUint32> table = Crc32TableInitialiser::InitialiseTable(kDefaultPolynomial);
+    return Compute(aReader, kDefaultSeed);
+}
 
+TUint32 Crc32::Compute(IReader& aReader, TUint32 aSeed)
+{
+    TUint32 crc = aSeed;
     try {
         for (;;) {
             Brn buf = aReader.Read(kDefaultReadBytes);
-            for (TUint i = 0; i < buf.Bytes(); i++) {
-                crc = (crc >> 8) ^ table[(buf[i] ^ crc) & 0xff];
-            }
+            crc = UpdateCrc(crc, buf.Ptr(), buf.Bytes());
         }
     }
     catch (ReaderError&) {}
     return ~crc;
 }
 
-TUint32 Crc32::Compute(IReader& aReader, TUint32 aSeed)
+TUint32 Crc32::Combine(TUint32 aCrcA, TUint32 aCrcB, TUint64 aBytesB)
 {
-    TUint32 crc = aSeed;
-    std::vector<TUint32> table = Crc32TableInitialiser::InitialiseTable(kDefaultPolynomial);
-
-    try {
-        for (;;) {
-            Brn buf = aReader.Read(kDefaultReadBytes);
-            for (TUint i = 0; i < buf.Bytes(); i++) {
-                crc = (crc >> 8) ^ table[(buf[i] ^ crc) & 0xff];
-            }
+    // multiply aCrcA by x^(8*aBytesB), i.e. append aBytesB zero bytes, then add aCrcB
+    const Crc32Tables& tables = Tables();
+    TUint32 p = (TUint32)1 << 31; // x^0
+    TUint k = 3;
+    while (aBytesB != 0) {
+        if (aBytesB & 1) {
+            p = MultModP(tables.iX2n[k & 31], p);
         }
+        aBytesB >>= 1;
+        k++;
     }
-    catch (ReaderError&) {}
-    return ~crc;
+    return MultModP(p, aCrcA) ^ aCrcB;
+}
+
+TUint32 Crc32::Update(TUint32 aCrc, const Brx& aBuffer)
+{
+    return UpdateCrc(aCrc, aBuffer.Ptr(), aBuffer.Bytes());
+}
+
+TUint32 Crc32::UpdateSoftware(TUint32 aCrc, const Brx& aBuffer)
+{
+    return UpdateSlice16(aCrc, aBuffer.Ptr(), aBuffer.Bytes());
+}
+
+TBool Crc32::HardwareAccelerated()
+{
+    return SelectUpdateFunction() != UpdateSlice16;
 }
 
 
@@ -88,14 +332,12 @@ Crc32Generator::Crc32Generator(TUint aSeed)
     : iCrc32(aSeed)
     , iFinished(false)
 {
-    iTable = Crc32TableInitialiser::InitialiseTable(Crc32::kDefaultPolynomial);
 }
 
 Crc32Generator::Crc32Generator(const Brx& aBuffer, TUint aSeed)
     : iCrc32(aSeed)
     , iFinished(false)
 {
-    iTable = Crc32TableInitialiser::InitialiseTable(Crc32::kDefaultPolynomial);
     Append(aBuffer);
 }
 
@@ -104,10 +346,7 @@ void Crc32Generator::Append(const Brx& aBuffer)
     if (iFinished) {
         THROW(CrcGenerationFinished);
     }
-
-    for (TUint i = 0; i < aBuffer.Bytes(); i++) {
-        iCrc32 = (iCrc32 >> 8) ^ iTable[(aBuffer[i] ^ iCrc32) & 0xff];
-    }
+    iCrc32 = UpdateCrc(iCrc32, aBuffer.Ptr(), aBuffer.Bytes());
 }
 
 TUint32 Crc32Generator::Result()
@@ -16,6 +16,13 @@ public:
     static std::vector<TUint32> InitialiseTable(TUint32 aPolynomial);
 };
 
+/**
+ * CRC-32 (IEEE 802.3 / zlib) calculation.
+ *
+ * Uses a carry-less multiply (x86 PCLMULQDQ) or ARMv8 CRC32 implementation where the
+ * cpu supports one, falling back to slicing-by-16 tables otherwise.  Tables are
+ * shared by all callers and built once.
+ */
 class Crc32
 {
 public:
@@ -26,7 +33,22 @@ public:
     static TUint32 Compute(const Brx& aBuffer);
     static TUint32 Compute(const Brx& aBuffer, TUint32 aSeed);
     static TUint32 Compute(IReader& aReader);
-    static TUint32 Compute(IReader& aReader, TUint32 aSeed);    
+    static TUint32 Compute(IReader& aReader, TUint32 aSeed);
+    /**
+     * Return the crc of A followed by B given the (default seeded) crcs of each and the
+     * length of B.  Allows large buffers to be checksummed in parallel chunks.
+     */
+    static TUint32 Combine(TUint32 aCrcA, TUint32 aCrcB, TUint64 aBytesB);
+    /**
+     * Advance the (non-inverted) crc register aCrc over aBuffer.
+     * Compute(aBuffer, aSeed) == ~Update(aSeed, aBuffer)
+     */
+    static TUint32 Update(TUint32 aCrc, const Brx& aBuffer);
+    /**
+     * As Update() but never uses hardware acceleration.  Intended for tests.
+     */
+    static TUint32 UpdateSoftware(TUint32 aCrc, const Brx& aBuffer);
+    static TBool HardwareAccelerated();
 };
 
 class Crc32Generator
@@ -40,7 +62,6 @@ public:
 private:
     TUint32 iCrc32;
     TBool iFinished;
-    std::vector<TUint32> iTable;
 };
 
 }
\ No newline at end of file
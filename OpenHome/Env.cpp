@@ -13,6 +13,11 @@
 #include <OpenHome/Private/Shell.h>
 #include <OpenHome/Private/InfoProvider.h>
 #include <OpenHome/Private/ShellCommandDebug.h>
+#include <OpenHome/Private/Metrics.h>
+#include <OpenHome/Private/MutexProfiler.h>
+#include <OpenHome/Private/ShellCommandMutexes.h>
+#include <OpenHome/Private/WorkerPool.h>
+#include <OpenHome/Private/BufferPool.h>
 #include <OpenHome/Net/Private/MdnsProvider.h>
 #include <OpenHome/Private/TIpAddressUtils.h>
 
@@ -70,6 +75,12 @@ Environment::Environment(FunctorMsg& aLogOutput)
     , iShell(NULL)
     , iInfoAggregator(NULL)
     , iShellCommandDebug(NULL)
+    , iMetrics(NULL)
+    , iMetricsServer(NULL)
+    , iMutexProfiler(NULL)
+    , iShellCommandMutexes(NULL)
+    , iWorkerPools(NULL)
+    , iBuffers(NULL)
     , iSequenceNumber(0)
     , iCpStack(NULL)
     , iDvStack(NULL)
@@ -103,6 +114,12 @@ Environment::Environment(FunctorMsg& aLogOutput,
     , iShell(NULL)
     , iInfoAggregator(NULL)
     , iShellCommandDebug(NULL)
+    , iMetrics(NULL)
+    , iMetricsServer(NULL)
+    , iMutexProfiler(NULL)
+    , iShellCommandMutexes(NULL)
+    , iWorkerPools(NULL)
+    , iBuffers(NULL)
     , iSequenceNumber(0)
     , iCpStack(NULL)
     , iDvStack(NULL)
@@ -121,6 +138,12 @@ Environment::Environment(InitialisationParams* aInitParams)
     , iShell(NULL)
     , iInfoAggregator(NULL)
     , iShellCommandDebug(NULL)
+    , iMetrics(NULL)
+    , iMetricsServer(NULL)
+    , iMutexProfiler(NULL)
+    , iShellCommandMutexes(NULL)
+    , iWorkerPools(NULL)
+    , iBuffers(NULL)
     , iSequenceNumber(0)
     , iCpStack(NULL)
     , iDvStack(NULL)
@@ -158,12 +181,17 @@ void Environment::Construct(FunctorMsg& aLogOutput, EThreadScheduling aScheduler
     if (iOsContext == NULL) {
         throw std::bad_alloc();
     }
+    // must be created before any Mutex so that every lock owned by the stack can be profiled
+    iMutexProfiler = new OpenHome::MutexProfiler(iOsContext, iInitParams != NULL && iInitParams->IsMutexProfilingEnabled());
     iLogger = new Log(aLogOutput);
     TUint hostMin, hostMax;
     Os::ThreadGetPriorityRange(iOsContext, hostMin, hostMax);
     iThreadPriorityArbitrator = new ThreadPriorityArbitrator(hostMin, hostMax);
     iPrivateLock = new OpenHome::Mutex("ENVP");
     iSuspendResumeObserverLock = new OpenHome::Mutex("ENVR");
+    iMetrics = new MetricsRegistry();
+    iWorkerPools = new WorkerPoolRegistry();
+    iBuffers = new OpenHome::BufferPool();
 }
 
 Environment::~Environment()
@@ -173,6 +201,8 @@ Environment::~Environment()
     }
     delete iCpStack;
     delete iDvStack;
+    delete iMetricsServer;
+    delete iShellCommandMutexes;
     delete iShellCommandDebug;
     delete iInfoAggregator;
     delete iShell;
@@ -187,11 +217,15 @@ Environment::~Environment()
     delete iTimerManager;
     delete iInitParams;
     delete iPrivateLock;
+    delete iMetrics;
+    delete iWorkerPools;
+    delete iBuffers;
     ASSERT(iSuspendObservers.size() == 0);
     ASSERT(iResumeObservers.size() == 0);
     delete iSuspendResumeObserverLock;
     delete iThreadPriorityArbitrator;
     delete iLogger;
+    delete iMutexProfiler;
     Os::Destroy(iOsContext);
 }
 
@@ -251,6 +285,26 @@ OpenHome::ShellCommandDebug* Environment::ShellCommandDebug()
     return iShellCommandDebug;
 }
 
+MetricsRegistry& Environment::Metrics()
+{
+    return *iMetrics;
+}
+
+OpenHome::MutexProfiler* Environment::MutexProfiler()
+{
+    return iMutexProfiler;
+}
+
+WorkerPoolRegistry& Environment::WorkerPools()
+{
+    return *iWorkerPools;
+}
+
+OpenHome::BufferPool& Environment::Buffers()
+{
+    return *iBuffers;
+}
+
 Net::SsdpListenerMulticast& Environment::MulticastListenerClaim(const TIpAddress& aInterface)
 {
     AutoMutex a(*iPrivateLock);
@@ -443,6 +497,29 @@ void Environment::CreateShell()
     iShell = new OpenHome::Shell(*this, shellPort, shellSessionPriority);
     iInfoAggregator = new OpenHome::InfoAggregator(*iShell);
     iShellCommandDebug = new OpenHome::ShellCommandDebug(*iShell);
+    iShellCommandMutexes = new OpenHome::ShellCommandMutexes(*iShell, *iMutexProfiler);
+    std::vector<Brn> queries;
+    queries.push_back(MetricsRegistry::kQueryMetrics);
+    iInfoAggregator->Register(*iMetrics, queries);
+    std::vector<Brn> mutexQueries;
+    mutexQueries.push_back(OpenHome::MutexProfiler::kQueryMutexes);
+    iInfoAggregator->Register(*iMutexProfiler, mutexQueries);
+    std::vector<Brn> poolQueries;
+    poolQueries.push_back(WorkerPoolRegistry::kQueryWorkerPools);
+    iInfoAggregator->Register(*iWorkerPools, poolQueries);
+}
+
+void Environment::CreateMetricsServer()
+{
+    if (iMetricsServer != NULL) {
+        return;
+    }
+    TUint port;
+    TIpAddress iface;
+    if (!iInitParams->IsMetricsServerEnabled(port, iface)) {
+        return;
+    }
+    iMetricsServer = new OpenHome::MetricsServer(*this, *iMetrics, port, iface);
 }
 
 void Environment::SetCpStack(IStack* aStack)
@@ -504,6 +581,7 @@ void Environment::DoSetInitParams(InitialisationParams* aInitParams)
         iNetworkAdapterList->AddNetworkAdapterChangeListener(networkAdapterChangeListener, "Env");
     }
     CreateShell();
+    CreateMetricsServer();
     CreateMdnsProvider();
     iHttpUserAgent.Replace(iInitParams->HttpUserAgent());
     const TChar* dnsChangeTestHostName = iInitParams->DnsChangeTestHostName();
@@ -25,6 +25,12 @@ class IStackObject;
 class Shell;
 class IInfoAggregator;
 class ShellCommandDebug;
+class MetricsRegistry;
+class MetricsServer;
+class MutexProfiler;
+class WorkerPoolRegistry;
+class BufferPool;
+class ShellCommandMutexes;
 class IWriter;
 class DnsChangeNotifier;
 class IDnsChangeNotifier;
@@ -94,6 +100,10 @@ public:
     OpenHome::Shell* Shell();
     IInfoAggregator* InfoAggregator();
     OpenHome::ShellCommandDebug* ShellCommandDebug();
+    MetricsRegistry& Metrics();
+    OpenHome::MutexProfiler* MutexProfiler(); // NULL until the Environment is constructed
+    WorkerPoolRegistry& WorkerPools();
+    OpenHome::BufferPool& Buffers();
     Net::SsdpListenerMulticast& MulticastListenerClaim(const TIpAddress& aInterface);
     void MulticastListenerRelease(const TIpAddress& aInterface);
     void AddSuspendObserver(ISuspendObserver& aObserver);
@@ -129,6 +139,7 @@ private:
     void Construct(FunctorMsg& aLogOutput, EThreadScheduling aSchedulerPolicy);
     void DoSetInitParams(Net::InitialisationParams* aInitParams);
     void CreateShell();
+    void CreateMetricsServer();
     void SetCpStack(IStack* aStack);
     void SetDvStack(IStack* aStack);
     static void DnsChanged(void* aSelf);
@@ -143,6 +154,12 @@ private:
     OpenHome::Shell* iShell;
     IInfoAggregator* iInfoAggregator;
     OpenHome::ShellCommandDebug* iShellCommandDebug;
+    MetricsRegistry* iMetrics;
+    OpenHome::MetricsServer* iMetricsServer;
+    OpenHome::MutexProfiler* iMutexProfiler;
+    OpenHome::ShellCommandMutexes* iShellCommandMutexes;
+    WorkerPoolRegistry* iWorkerPools;
+    OpenHome::BufferPool* iBuffers;
     std::vector<MListener*> iMulticastListeners;
     std::vector<ISuspendObserver*> iSuspendObservers;
     std::vector<IResumeObserver*> iResumeObservers;
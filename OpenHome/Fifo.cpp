@@ -6,18 +6,28 @@ using namespace OpenHome;
 
 FifoBase::FifoBase(TUint aSlots)
     : iSlots(aSlots)
+    , iRingMask(RoundUpPow2(aSlots) - 1)
+    , iWritePos(0)
+    , iReadPos(0)
+    , iWritable(aSlots)
+    , iReadable(0)
     , iSlotsUsed(0)
-    , iMutexWrite("FIMW")
-    , iMutexRead("FIMR")
+    , iInterrupted(0)
     , iMutexInterrupt("FIMI")
-    , iSemaRead("FISR", 0)
-    , iSemaWrite("FISW", aSlots)
-    , iReadIndex(0)
-    , iWriteIndex(0)
-    , iInterrupted(false)
     , iInterruptEnabled(false)
+    , iSemaRead("FISR", 0)
+    , iSemaWrite("FISW", 0)
 {
     ASSERT(iSlots > 0);
+    iSequences = new TUint[RingSize()];
+    for (TUint i=0; i<RingSize(); i++) {
+        iSequences[i] = i;
+    }
+}
+
+FifoBase::~FifoBase()
+{
+    delete [] iSequences;
 }
 
 TUint FifoBase::Slots() const
@@ -32,77 +42,113 @@ TUint FifoBase::SlotsFree() const
 
 TUint FifoBase::SlotsUsed() const
 {
-    AutoMutex a(iMutexWrite);
-    return iSlotsUsed;
+    return Atomic::Load(iSlotsUsed);
 }
 
 void FifoBase::ReadInterrupt(TBool aInterrupt)
 {
     // An interrupt should ALWAYS be signalled, as this allows distinguishing
-    // between when iSemaRead.Signal() was called normally or by interrupt,
+    // between when a reader was woken normally or by interrupt,
     // even in the case of ReadInterrupt(false) being subsequently called.
     AutoMutex a(iMutexInterrupt);
-    if (!iInterrupted) { // don't repeat when interrupt already pending
-        iSemaRead.Signal();
-        iInterrupted = true;
+    if (Atomic::Load(iInterrupted) == 0) { // don't repeat when interrupt already pending
+        Atomic::Store(iInterrupted, 1);
+        Release(iReadable, iSemaRead);
     }
     // This extra flag lets us know whether we should take any special
-    // action (i.e., throw) after an interrupt caused iSemaRead.Signal(), or
+    // action (i.e., throw) after an interrupt woke a reader, or
     // just go back and try read again.
     iInterruptEnabled = aInterrupt;
 }
 
-TUint FifoBase::WriteOpen()
+TUint FifoBase::RingSize() const
 {
-    iSemaWrite.Wait();
-    iMutexWrite.Wait();
-    TUint index = iWriteIndex++;
-    if (iWriteIndex == Slots()) {
-        iWriteIndex = 0;
+    return iRingMask + 1;
+}
+
+TUint FifoBase::RoundUpPow2(TUint aValue)
+{ // static
+    TUint pow2 = 1;
+    while (pow2 < aValue) {
+        pow2 <<= 1;
     }
-    return index;
+    return pow2;
 }
 
-void FifoBase::WriteClose()
+void FifoBase::Acquire(volatile TUint& aCount, Semaphore& aSem)
+{ // static
+    if ((TInt)Atomic::Sub(aCount, 1) < 0) {
+        aSem.Wait();
+    }
+}
+
+void FifoBase::Release(volatile TUint& aCount, Semaphore& aSem)
+{ // static
+    if ((TInt)Atomic::Add(aCount, 1) <= 0) {
+        aSem.Signal();
+    }
+}
+
+void FifoBase::WaitForSequence(TUint aIndex, TUint aSeq)
 {
-    iSlotsUsed++;
-    iMutexWrite.Signal();
-    iSemaRead.Signal();
+    /* Holding a permit guarantees that the slot will become available but the thread
+       which last used it may not have finished with it yet.  That window is only a few
+       instructions long so spin, only sleeping if the other thread has been descheduled */
+    TUint spins = 0;
+    while (Atomic::Load(iSequences[aIndex]) != aSeq) {
+        if (++spins == kSpinsBeforeSleep) {
+            spins = 0;
+            Thread::Sleep(0);
+        }
+    }
+}
+
+TUint FifoBase::WriteOpen()
+{
+    Acquire(iWritable, iSemaWrite);
+    const TUint pos = Atomic::Add(iWritePos, 1) - 1;
+    WaitForSequence(Index(pos), pos);
+    return pos;
+}
+
+void FifoBase::WriteClose(TUint aPos)
+{
+    Atomic::Store(iSequences[Index(aPos)], aPos + 1);
+    (void)Atomic::Add(iSlotsUsed, 1);
+    Release(iReadable, iSemaRead);
 }
 
 TUint FifoBase::ReadOpen()
 {
-    TBool readAllowed = false;
-    while (!readAllowed) {  // handle multiple (erroneous) calls to ReadInterrupt(false) when Read() waiting
-        iSemaRead.Wait();
-        // check if iSemaRead was signalled legitimately or by interrupt
+    for (;;) {  // handle multiple (erroneous) calls to ReadInterrupt(false) when Read() waiting
+        Acquire(iReadable, iSemaRead);
+        if (Atomic::Load(iInterrupted) == 0) {
+            break;
+        }
+        // we may have been woken by an interrupt rather than a write
+        // ...even if not, the interrupt consumed a permit so must be handled here
         AutoMutex a(iMutexInterrupt);
-        if (iInterrupted) {
-            iInterrupted = false;
+        if (Atomic::Load(iInterrupted) != 0) {
+            Atomic::Store(iInterrupted, 0);
             if (iInterruptEnabled) {
                 iInterruptEnabled = false;
                 THROW(FifoReadError);
             }
         }
         else {
-            readAllowed = true;
+            break;
         }
     }
-    iMutexRead.Wait();
-    TUint index = iReadIndex++;
-    if(iReadIndex == Slots()) {
-        iReadIndex = 0;
-    }
-    return index;
+    const TUint pos = Atomic::Add(iReadPos, 1) - 1;
+    WaitForSequence(Index(pos), pos + 1);
+    return pos;
 }
 
-void FifoBase::ReadClose()
+void FifoBase::ReadClose(TUint aPos)
 {
-    iMutexWrite.Wait();
-    iSlotsUsed--;
-    iMutexWrite.Signal();
-    iMutexRead.Signal();
-    iSemaWrite.Signal();
+    Atomic::Store(iSequences[Index(aPos)], aPos + RingSize());
+    (void)Atomic::Sub(iSlotsUsed, 1);
+    Release(iWritable, iSemaWrite);
 }
 
 
@@ -4,6 +4,7 @@
 #include <OpenHome/Private/Standard.h>
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Exception.h>
+#include <OpenHome/Private/Atomic.h>
 
 EXCEPTION(FifoReadError)
 
@@ -13,6 +14,11 @@ namespace OpenHome {
 //
 // Writer threads are blocked while the fifo is full
 // Reader threads are blocked while the fifo is empty
+//
+// Entries are passed through a lock-free ring (each slot carries a sequence number
+// which says whether it is ready to be written or read).  Readers and writers only
+// touch a Semaphore when they have to block, so an uncontended Write()/Read() pair
+// costs a handful of atomic operations rather than several mutex/semaphore calls.
 
 class FifoBase : public INonCopyable
 {
@@ -23,28 +29,39 @@ public:
     void ReadInterrupt(TBool aInterrupt=true);
 protected:
     FifoBase(TUint aSlots);
-    TUint WriteOpen(); // return index of entry to write
-    void WriteClose(); // complete the write
-    TUint ReadOpen();  // return index of entry to read
-    void ReadClose();  // complete the read
-protected:
+    ~FifoBase();
+    TUint RingSize() const;            // always a power of 2, >= Slots()
+    TUint Index(TUint aPos) const { return aPos & iRingMask; }
+    TUint WriteOpen();                 // return position of entry to write
+    void WriteClose(TUint aPos);       // complete the write
+    TUint ReadOpen();                  // return position of entry to read
+    void ReadClose(TUint aPos);        // complete the read
+private:
+    static TUint RoundUpPow2(TUint aValue);
+    static void Acquire(volatile TUint& aCount, Semaphore& aSem);
+    static void Release(volatile TUint& aCount, Semaphore& aSem);
+    void WaitForSequence(TUint aIndex, TUint aSeq);
+private:
+    static const TUint kSpinsBeforeSleep = 1024;
     const TUint iSlots;
-    TUint iSlotsUsed;  // protected by iMutexWrite
-    mutable Mutex iMutexWrite;
-    Mutex iMutexRead;
+    const TUint iRingMask;
+    volatile TUint* iSequences;
+    volatile TUint iWritePos;
+    volatile TUint iReadPos;
+    volatile TUint iWritable;          // free slots; negative (as TInt) when writers are parked on iSemaWrite
+    volatile TUint iReadable;          // entries (plus pending interrupt); negative when readers are parked
+    mutable volatile TUint iSlotsUsed;
+    volatile TUint iInterrupted;
     Mutex iMutexInterrupt;
+    TBool iInterruptEnabled;           // protected by iMutexInterrupt
     Semaphore iSemaRead;
     Semaphore iSemaWrite;
-    TUint iReadIndex;
-    TUint iWriteIndex;
-    TBool iInterrupted;
-    TBool iInterruptEnabled;
 };
 
 template <class T> class Fifo : public FifoBase
 {
 public:
-    inline Fifo(TUint aSlots) : FifoBase(aSlots) { iBuf = new T[aSlots]; }
+    inline Fifo(TUint aSlots) : FifoBase(aSlots) { iBuf = new T[RingSize()]; }
     inline ~Fifo() { delete [] iBuf; }
     void Write(T aEntry);
     T Read();
@@ -54,14 +71,16 @@ private:
 
 template <class T> void Fifo<T>::Write(T aEntry)
 {
-    iBuf[WriteOpen()] = aEntry;
-    WriteClose();
+    const TUint pos = WriteOpen();
+    iBuf[Index(pos)] = aEntry;
+    WriteClose(pos);
 }
 
 template <class T> T Fifo<T>::Read()
 {
-    T value = iBuf[ReadOpen()];
-    ReadClose();
+    const TUint pos = ReadOpen();
+    T value = iBuf[Index(pos)];
+    ReadClose(pos);
     return value;
 }
 
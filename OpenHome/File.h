@@ -15,6 +15,7 @@ EXCEPTION(FileWriteError)
 EXCEPTION(FileSeekError)
 EXCEPTION(MakeDirFailed)
 EXCEPTION(UnlinkFailed)
+EXCEPTION(RenameFailed)
 
 namespace OpenHome {
 
@@ -60,6 +61,7 @@ public:
     virtual IFile* Open(const TChar* aFilename, FileMode aFileMode) = 0; // throws FileOpenError
     virtual void MakeDir(const TChar* aDirname) = 0; // throws DirAlreadyExists
     virtual void Unlink(const TChar* aFilename) = 0;
+    virtual void Rename(const TChar* /*aFrom*/, const TChar* /*aTo*/) { THROW(RenameFailed); } // replaces any existing aTo; throws RenameFailed (always, unless overridden)
     virtual ~IFileSystem() {}
 };
 
@@ -69,6 +71,7 @@ public: // IFileSystem
     IFile* Open(const TChar* aFilename, FileMode aFileMode);
     void MakeDir(const TChar* aDirname); // throws DirAlreadyExists
     void Unlink(const TChar* aFilename);
+    void Rename(const TChar* aFrom, const TChar* aTo);
 };
 
 class FileAnsi : public IFile
@@ -280,14 +280,32 @@ const HttpStatus HttpStatus::kHttpVersionNotSupported(505, Brn("HTTP Version Not
 
 // ReaderHttpHeader
 
+ReaderHttpHeader::DispatchEntry::DispatchEntry()
+    : iUsed(false)
+    , iHash(0)
+    , iHeader(NULL)
+{
+}
+
 ReaderHttpHeader::ReaderHttpHeader(Environment& aEnv)
     : iEnv(aEnv)
+    , iHeader(NULL)
+    , iDispatchEntries(0)
+    , iDispatchMisses(0)
+    , iObserver(NULL)
 {
 }
 
 void ReaderHttpHeader::AddHeader(IHttpHeader& aHeader)
 {
     iHeaders.push_back(&aHeader);
+    // a new header may claim fields previously recorded against another (or no) header
+    ClearDispatch();
+}
+
+void ReaderHttpHeader::SetHeaderObserver(IHttpHeaderObserver* aObserver)
+{
+    iObserver = aObserver;
 }
 
 IHttpHeader& ReaderHttpHeader::Header() const
@@ -306,16 +324,83 @@ void ReaderHttpHeader::ResetHeaders()
 }
 
 void ReaderHttpHeader::ProcessHeader(const Brx& aField, const Brx& aValue)
+{
+    if (iObserver != NULL) {
+        iObserver->NotifyHeader(aField, aValue);
+    }
+    IHttpHeader* header = Dispatch(aField);
+    if (header != NULL) {
+        iHeader = header;
+        header->Process(aValue);
+    }
+}
+
+TUint ReaderHttpHeader::Hash(const Brx& aField)
+{
+    // FNV-1a over the lower-cased field name
+    TUint hash = 2166136261u;
+    const TUint bytes = aField.Bytes();
+    const TByte* ptr = aField.Ptr();
+    for (TUint i = 0; i < bytes; i++) {
+        hash ^= (TByte)Ascii::ToLowerCase(ptr[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+IHttpHeader* ReaderHttpHeader::Dispatch(const Brx& aField)
+{
+    const TUint hash = Hash(aField);
+    TUint slot = hash & (kDispatchSlots - 1);
+    for (;;) {
+        DispatchEntry& entry = iDispatch[slot];
+        if (!entry.iUsed) {
+            break;
+        }
+        if (entry.iHash == hash && Ascii::CaseInsensitiveEquals(entry.iField, aField)) {
+            return entry.iHeader;
+        }
+        slot = (slot + 1) & (kDispatchSlots - 1);
+    }
+    IHttpHeader* header = Recognise(aField);
+    if (aField.Bytes() > kMaxDispatchFieldBytes || iDispatchEntries == kMaxDispatchEntries) {
+        return header;
+    }
+    if (header == NULL) {
+        if (iDispatchMisses == kMaxDispatchMisses) {
+            return header;
+        }
+        iDispatchMisses++;
+    }
+    DispatchEntry& entry = iDispatch[slot];
+    entry.iUsed = true;
+    entry.iHash = hash;
+    entry.iField.Replace(aField);
+    entry.iHeader = header;
+    iDispatchEntries++;
+    return header;
+}
+
+IHttpHeader* ReaderHttpHeader::Recognise(const Brx& aField)
 {
     TUint count = (TUint)iHeaders.size();
     for (TUint i = 0; i < count; i++) {
         IHttpHeader* header = iHeaders[i];
         if (header->Recognise(aField)) {
-            iHeader = header;
-            header->Process(aValue);
-            return;
+            return header;
         }
     }
+    return NULL;
+}
+
+void ReaderHttpHeader::ClearDispatch()
+{
+    for (TUint i = 0; i < kDispatchSlots; i++) {
+        iDispatch[i].iUsed = false;
+        iDispatch[i].iHeader = NULL;
+    }
+    iDispatchEntries = 0;
+    iDispatchMisses = 0;
 }
 
 
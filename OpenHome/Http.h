@@ -218,6 +218,19 @@ public:
     virtual ~IHttpHeader() {}
 };
 
+/**
+ * Optional observer of every header line received by a ReaderHttpHeader.
+ *
+ * aField and aValue point directly into the reader's buffer and are only
+ * valid for the duration of the call.  Copy them if they need to persist.
+ */
+class IHttpHeaderObserver
+{
+public:
+    virtual void NotifyHeader(const Brx& aField, const Brx& aValue) = 0;
+    virtual ~IHttpHeaderObserver() {}
+};
+
 class HttpHeader : public IHttpHeader
 {
 public:
@@ -232,20 +245,61 @@ private:
 
 class Environment;
 
+/**
+ * Base for readers of http-style headers.
+ *
+ * Incoming field names are dispatched via a small hash table keyed on the
+ * case-folded field name.  The table is filled lazily: the first time a field
+ * is seen, registered headers are asked (in registration order) whether they
+ * recognise it and the answer - a header or none - is recorded so that later
+ * lines with the same field go straight to their header (or are skipped)
+ * without calling Recognise() again.  Field names are case-insensitive, so
+ * IHttpHeader::Recognise() implementations are expected to be too.
+ *
+ * Fields that no header recognises are limited to a share of the table so
+ * that a peer sending many distinct unknown fields can't crowd out the
+ * fields that are wanted.  Fields that don't fit are still dispatched, just
+ * not recorded.
+ */
 class ReaderHttpHeader : protected INonCopyable
 {
+    static const TUint kDispatchSlots = 32; // must be a power of 2
+    static const TUint kMaxDispatchEntries = 24;
+    static const TUint kMaxDispatchMisses = 12;
+    static const TUint kMaxDispatchFieldBytes = 32;
 public:
     IHttpHeader& Header() const;
     void AddHeader(IHttpHeader& aHeader);
+    void SetHeaderObserver(IHttpHeaderObserver* aObserver);
 protected:
     ReaderHttpHeader(Environment& aEnv);
     void ResetHeaders();
     void ProcessHeader(const Brx& aField, const Brx& aValue);
+private:
+    static TUint Hash(const Brx& aField);
+    IHttpHeader* Dispatch(const Brx& aField);
+    IHttpHeader* Recognise(const Brx& aField);
+    void ClearDispatch();
 protected:
     Environment& iEnv;
+private:
+    class DispatchEntry
+    {
+    public:
+        DispatchEntry();
+    public:
+        TBool iUsed;
+        TUint iHash;
+        Bws<kMaxDispatchFieldBytes> iField;
+        IHttpHeader* iHeader; // NULL for fields no header recognises
+    };
 private:
     IHttpHeader* iHeader;
     std::vector<IHttpHeader*> iHeaders;
+    DispatchEntry iDispatch[kDispatchSlots];
+    TUint iDispatchEntries;
+    TUint iDispatchMisses;
+    IHttpHeaderObserver* iObserver;
 };
 
 class Timer;
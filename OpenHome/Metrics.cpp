@@ -0,0 +1,325 @@
+#include <OpenHome/Private/Metrics.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Http.h>
+#include <OpenHome/Private/Printer.h>
+#include <OpenHome/Private/Stream.h>
+
+#include <string.h>
+
+using namespace OpenHome;
+
+// Metric
+
+Metric::Metric(const TChar* aName, const TChar* aHelp, EType aType)
+    : iName(aName)
+    , iHelp(aHelp)
+    , iType(aType)
+{
+}
+
+const Brx& Metric::Name() const
+{
+    return iName;
+}
+
+Metric::EType Metric::Type() const
+{
+    return iType;
+}
+
+void Metric::WriteText(IWriter& aWriter)
+{
+    aWriter.Write(Brn("# HELP "));
+    aWriter.Write(iName);
+    aWriter.Write(' ');
+    aWriter.Write(iHelp);
+    aWriter.Write(Brn("\n# TYPE "));
+    aWriter.Write(iName);
+    switch (iType)
+    {
+    case eCounter:
+        aWriter.Write(Brn(" counter\n"));
+        break;
+    case eGauge:
+        aWriter.Write(Brn(" gauge\n"));
+        break;
+    case eHistogram:
+        aWriter.Write(Brn(" histogram\n"));
+        break;
+    }
+    WriteValue(aWriter);
+}
+
+
+// MetricCounter
+
+MetricCounter::MetricCounter(const TChar* aName, const TChar* aHelp)
+    : Metric(aName, aHelp, eCounter)
+    , iValue(0)
+{
+}
+
+void MetricCounter::WriteValue(IWriter& aWriter)
+{
+    Bws<Ascii::kMaxUint64StringBytes> val;
+    Ascii::AppendDec(val, Value());
+    aWriter.Write(Name());
+    aWriter.Write(' ');
+    aWriter.Write(val);
+    aWriter.Write('\n');
+}
+
+
+// MetricGauge
+
+MetricGauge::MetricGauge(const TChar* aName, const TChar* aHelp)
+    : Metric(aName, aHelp, eGauge)
+    , iValue(0)
+{
+}
+
+void MetricGauge::WriteValue(IWriter& aWriter)
+{
+    Bws<Ascii::kMaxIntStringBytes> val;
+    Ascii::AppendDec(val, Value());
+    aWriter.Write(Name());
+    aWriter.Write(' ');
+    aWriter.Write(val);
+    aWriter.Write('\n');
+}
+
+
+// MetricHistogram
+
+const TUint64 MetricHistogram::kBucketBoundsUs[kNumBuckets] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 1000000, 10000000 };
+const TChar* MetricHistogram::kBucketLabels[kNumBuckets] = {
+    "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005", "0.01", "0.025", "0.05", "0.1", "1", "10" };
+
+MetricHistogram::MetricHistogram(const TChar* aName, const TChar* aHelp)
+    : Metric(aName, aHelp, eHistogram)
+    , iCount(0)
+    , iSumUs(0)
+{
+    for (TUint i=0; i<=kNumBuckets; i++) {
+        iBuckets[i] = 0;
+    }
+}
+
+void MetricHistogram::Observe(TUint64 aUs)
+{
+    TUint i = 0;
+    while (i < kNumBuckets && aUs > kBucketBoundsUs[i]) {
+        i++;
+    }
+    (void)Atomic::Add64(iBuckets[i], 1);
+    (void)Atomic::Add64(iSumUs, aUs);
+    (void)Atomic::Add64(iCount, 1);
+}
+
+void MetricHistogram::WriteValue(IWriter& aWriter)
+{
+    // buckets are stored individually but Prometheus expects cumulative counts
+    TUint64 cumulative = 0;
+    for (TUint i=0; i<=kNumBuckets; i++) {
+        cumulative += Atomic::Load64(iBuckets[i]);
+        Bws<Ascii::kMaxUint64StringBytes> val;
+        Ascii::AppendDec(val, cumulative);
+        aWriter.Write(Name());
+        aWriter.Write(Brn("_bucket{le=\""));
+        aWriter.Write(Brn(i < kNumBuckets? kBucketLabels[i] : "+Inf"));
+        aWriter.Write(Brn("\"} "));
+        aWriter.Write(val);
+        aWriter.Write('\n');
+    }
+    const TUint64 sumUs = Atomic::Load64(iSumUs);
+    Bws<2*Ascii::kMaxUint64StringBytes + 1> sum;
+    Ascii::AppendDec(sum, sumUs / 1000000);
+    sum.AppendPrintf(".%06u", (TUint)(sumUs % 1000000));
+    aWriter.Write(Name());
+    aWriter.Write(Brn("_sum "));
+    aWriter.Write(sum);
+    aWriter.Write('\n');
+    Bws<Ascii::kMaxUint64StringBytes> count;
+    Ascii::AppendDec(count, Count());
+    aWriter.Write(Name());
+    aWriter.Write(Brn("_count "));
+    aWriter.Write(count);
+    aWriter.Write('\n');
+}
+
+
+// AutoMetricTimer
+
+AutoMetricTimer::AutoMetricTimer(Environment& aEnv, MetricHistogram& aHistogram)
+    : iEnv(aEnv)
+    , iHistogram(aHistogram)
+{
+    iStartUs = Os::TimeInUs(iEnv.OsCtx());
+}
+
+AutoMetricTimer::~AutoMetricTimer()
+{
+    iHistogram.Observe(Os::TimeInUs(iEnv.OsCtx()) - iStartUs);
+}
+
+
+// MetricsRegistry
+
+const Brn MetricsRegistry::kQueryMetrics("metrics");
+
+MetricsRegistry::MetricsRegistry()
+    : iLock("MTRX")
+{
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    for (TUint i=0; i<(TUint)iMetrics.size(); i++) {
+        delete iMetrics[i];
+    }
+}
+
+Metric* MetricsRegistry::Find(const TChar* aName, Metric::EType aType)
+{
+    Brn name(aName);
+    for (TUint i=0; i<(TUint)iMetrics.size(); i++) {
+        if (iMetrics[i]->Name() == name) {
+            ASSERT(iMetrics[i]->Type() == aType);
+            return iMetrics[i];
+        }
+    }
+    return NULL;
+}
+
+MetricCounter& MetricsRegistry::Counter(const TChar* aName, const TChar* aHelp)
+{
+    AutoMutex _(iLock);
+    Metric* metric = Find(aName, Metric::eCounter);
+    if (metric == NULL) {
+        metric = new MetricCounter(aName, aHelp);
+        iMetrics.push_back(metric);
+    }
+    return *static_cast<MetricCounter*>(metric);
+}
+
+MetricGauge& MetricsRegistry::Gauge(const TChar* aName, const TChar* aHelp)
+{
+    AutoMutex _(iLock);
+    Metric* metric = Find(aName, Metric::eGauge);
+    if (metric == NULL) {
+        metric = new MetricGauge(aName, aHelp);
+        iMetrics.push_back(metric);
+    }
+    return *static_cast<MetricGauge*>(metric);
+}
+
+MetricHistogram& MetricsRegistry::Histogram(const TChar* aName, const TChar* aHelp)
+{
+    AutoMutex _(iLock);
+    Metric* metric = Find(aName, Metric::eHistogram);
+    if (metric == NULL) {
+        metric = new MetricHistogram(aName, aHelp);
+        iMetrics.push_back(metric);
+    }
+    return *static_cast<MetricHistogram*>(metric);
+}
+
+void MetricsRegistry::WriteText(IWriter& aWriter)
+{
+    WriterBwh text(kTextGranularity);
+    {
+        AutoMutex _(iLock);
+        for (TUint i=0; i<(TUint)iMetrics.size(); i++) {
+            iMetrics[i]->WriteText(text);
+        }
+    }
+    aWriter.Write(text.Buffer());
+}
+
+void MetricsRegistry::QueryInfo(const Brx& aQuery, IWriter& aWriter)
+{
+    if (aQuery == kQueryMetrics) {
+        WriteText(aWriter);
+    }
+}
+
+
+// MetricsSession
+
+const Brn MetricsSession::kUriMetrics("/metrics");
+
+MetricsSession::MetricsSession(Environment& aEnv, MetricsRegistry& aRegistry)
+    : iRegistry(aRegistry)
+{
+    iReadBuffer = new Srs<kMaxRequestBytes>(*this);
+    iReaderUntil = new ReaderUntilS<kMaxRequestBytes>(*iReadBuffer);
+    iReaderRequest = new ReaderHttpRequest(aEnv, *iReaderUntil);
+    iReaderRequest->AddMethod(Http::kMethodGet);
+    iWriterBuffer = new Sws<kMaxWriteBytes>(*this);
+    iWriterResponse = new WriterHttpResponse(*iWriterBuffer);
+}
+
+MetricsSession::~MetricsSession()
+{
+    iReadBuffer->ReadInterrupt();
+    delete iWriterResponse;
+    delete iWriterBuffer;
+    delete iReaderRequest;
+    delete iReaderUntil;
+    delete iReadBuffer;
+}
+
+void MetricsSession::Run()
+{
+    try {
+        iReaderRequest->Read(kReadTimeoutMs);
+        if (iReaderRequest->Uri() != kUriMetrics) {
+            iWriterResponse->WriteStatus(HttpStatus::kNotFound, Http::eHttp11);
+            Http::WriteHeaderConnectionClose(*iWriterResponse);
+            iWriterResponse->WriteFlush();
+            return;
+        }
+        iWriterResponse->WriteStatus(HttpStatus::kOk, Http::eHttp11);
+        Http::WriteHeaderContentType(*iWriterResponse, Brn("text/plain; version=0.0.4"));
+        Http::WriteHeaderConnectionClose(*iWriterResponse);
+        iWriterResponse->WriteFlush();
+        iRegistry.WriteText(*iWriterBuffer);
+        iWriterBuffer->WriteFlush();
+    }
+    catch (HttpError&) {
+        try {
+            iWriterResponse->WriteStatus(HttpStatus::kBadRequest, Http::eHttp11);
+            Http::WriteHeaderConnectionClose(*iWriterResponse);
+            iWriterResponse->WriteFlush();
+        }
+        catch (WriterError&) {}
+    }
+    catch (ReaderError&) {
+    }
+    catch (WriterError&) {
+    }
+}
+
+
+// MetricsServer
+
+MetricsServer::MetricsServer(Environment& aEnv, MetricsRegistry& aRegistry, TUint aPort, const TIpAddress& aInterface)
+{
+    iServer = new SocketTcpServer(aEnv, "MetricsServer", aPort, aInterface, kPriorityNormal);
+    iServer->Add("MetricsSession", new MetricsSession(aEnv, aRegistry));
+}
+
+MetricsServer::~MetricsServer()
+{
+    delete iServer;
+}
+
+TUint MetricsServer::Port() const
+{
+    return iServer->Port();
+}
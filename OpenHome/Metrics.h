@@ -0,0 +1,189 @@
+#ifndef HEADER_METRICS
+#define HEADER_METRICS
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Atomic.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Http.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/InfoProvider.h>
+
+#include <vector>
+
+namespace OpenHome {
+
+class Environment;
+
+/**
+ * Numeric instrumentation for the stack.
+ *
+ * Metrics are created (or looked up, if a metric of the same name already exists)
+ * via MetricsRegistry then updated without taking any locks.  Snapshots are
+ * available as Prometheus-style text via MetricsRegistry::WriteText, the 'info metrics'
+ * shell command and, optionally, MetricsServer.
+ */
+
+class Metric : private INonCopyable
+{
+    friend class MetricsRegistry;
+public:
+    enum EType
+    {
+        eCounter,
+        eGauge,
+        eHistogram
+    };
+public:
+    virtual ~Metric() {}
+    const Brx& Name() const;
+    EType Type() const;
+protected:
+    Metric(const TChar* aName, const TChar* aHelp, EType aType);
+    virtual void WriteValue(IWriter& aWriter) = 0;
+private:
+    void WriteText(IWriter& aWriter);
+private:
+    Brn iName;
+    Brn iHelp;
+    EType iType;
+};
+
+class MetricCounter : public Metric
+{
+    friend class MetricsRegistry;
+public:
+    void Inc() { (void)Atomic::Add64(iValue, 1); }
+    void Add(TUint64 aValue) { (void)Atomic::Add64(iValue, aValue); }
+    TUint64 Value() { return Atomic::Load64(iValue); }
+private:
+    MetricCounter(const TChar* aName, const TChar* aHelp);
+    void WriteValue(IWriter& aWriter);
+private:
+    volatile TUint64 iValue;
+};
+
+class MetricGauge : public Metric
+{
+    friend class MetricsRegistry;
+public:
+    void Inc() { (void)Atomic::Add(iValue, 1); }
+    void Dec() { (void)Atomic::Sub(iValue, 1); }
+    void Set(TInt aValue) { Atomic::Store(iValue, (TUint)aValue); }
+    TInt Value() { return (TInt)Atomic::Load(iValue); }
+private:
+    MetricGauge(const TChar* aName, const TChar* aHelp);
+    void WriteValue(IWriter& aWriter);
+private:
+    volatile TUint iValue;
+};
+
+/**
+ * Latency histogram with fixed buckets, 100us..10s
+ *
+ * Observations are in microseconds; exposition follows Prometheus convention of seconds.
+ */
+class MetricHistogram : public Metric
+{
+    friend class MetricsRegistry;
+public:
+    static const TUint kNumBuckets = 12;
+public:
+    void Observe(TUint64 aUs);
+    TUint64 Count() { return Atomic::Load64(iCount); }
+private:
+    MetricHistogram(const TChar* aName, const TChar* aHelp);
+    void WriteValue(IWriter& aWriter);
+private:
+    static const TUint64 kBucketBoundsUs[kNumBuckets];
+    static const TChar* kBucketLabels[kNumBuckets];
+    volatile TUint64 iBuckets[kNumBuckets + 1]; // last bucket is +Inf
+    volatile TUint64 iCount;
+    volatile TUint64 iSumUs;
+};
+
+/**
+ * Utility class - records the time between construction and destruction in a histogram
+ */
+class AutoMetricTimer : private INonCopyable
+{
+public:
+    AutoMetricTimer(Environment& aEnv, MetricHistogram& aHistogram);
+    ~AutoMetricTimer();
+private:
+    Environment& iEnv;
+    MetricHistogram& iHistogram;
+    TUint64 iStartUs;
+};
+
+class MetricsRegistry : public IInfoProvider
+{
+    static const TUint kTextGranularity = 1024;
+public:
+    static const Brn kQueryMetrics;
+public:
+    MetricsRegistry();
+    ~MetricsRegistry();
+    /**
+     * Metric names must be static strings.  Calling any of these functions with the
+     * name of an existing metric returns that metric.  Requesting a name that is already
+     * registered with a different type is a programming error.
+     */
+    MetricCounter& Counter(const TChar* aName, const TChar* aHelp);
+    MetricGauge& Gauge(const TChar* aName, const TChar* aHelp);
+    MetricHistogram& Histogram(const TChar* aName, const TChar* aHelp);
+    /**
+     * Metrics are rendered into a local buffer under the registry lock; aWriter is
+     * only written to once the lock is released so a slow reader can't block
+     * registration of new metrics.
+     */
+    void WriteText(IWriter& aWriter);
+private: // from IInfoProvider
+    void QueryInfo(const Brx& aQuery, IWriter& aWriter);
+private:
+    Metric* Find(const TChar* aName, Metric::EType aType);
+private:
+    Mutex iLock;
+    std::vector<Metric*> iMetrics;
+};
+
+/**
+ * Tiny http server which responds to a GET of kUriMetrics with the contents of the MetricsRegistry.
+ * Requests for any other path are rejected with 404.
+ */
+class MetricsSession : public SocketTcpSession
+{
+public:
+    static const Brn kUriMetrics;
+private:
+    static const TUint kMaxRequestBytes = 1024;
+    static const TUint kMaxWriteBytes = 4096;
+    static const TUint kReadTimeoutMs = 5 * 1000;
+public:
+    MetricsSession(Environment& aEnv, MetricsRegistry& aRegistry);
+    ~MetricsSession();
+private: // from SocketTcpSession
+    void Run();
+private:
+    MetricsRegistry& iRegistry;
+    Srx* iReadBuffer;
+    ReaderUntil* iReaderUntil;
+    ReaderHttpRequest* iReaderRequest;
+    Sws<kMaxWriteBytes>* iWriterBuffer;
+    WriterHttpResponse* iWriterResponse;
+};
+
+class MetricsServer
+{
+public:
+    MetricsServer(Environment& aEnv, MetricsRegistry& aRegistry, TUint aPort, const TIpAddress& aInterface);
+    ~MetricsServer();
+    TUint Port() const;
+private:
+    SocketTcpServer* iServer;
+};
+
+} // namespace OpenHome
+
+#endif // HEADER_METRICS
@@ -0,0 +1,177 @@
+#include <OpenHome/Private/MutexProfiler.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Private/Atomic.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Thread.h>
+
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+using namespace OpenHome;
+
+// MutexStats
+
+MutexStats::MutexStats(const TChar* aName)
+{
+    (void)strncpy(iName, aName, 4);
+    iName[4] = 0;
+    iInstances = 0;
+    Reset();
+}
+
+void MutexStats::Reset()
+{
+    iAcquisitions = 0;
+    iContended = 0;
+    iWaitTotalUs = 0;
+    iWaitMaxUs = 0;
+    for (TUint i=0; i<kNumHoldBuckets; i++) {
+        iHoldBuckets[i] = 0;
+    }
+}
+
+void MutexStats::RecordWait(TUint64 aWaitUs, TBool aContended)
+{
+    (void)Atomic::Add64(iAcquisitions, 1);
+    if (aContended) {
+        (void)Atomic::Add64(iContended, 1);
+    }
+    (void)Atomic::Add64(iWaitTotalUs, aWaitUs);
+    TUint64 max = Atomic::Load64(iWaitMaxUs);
+    while (aWaitUs > max && !Atomic::CompareAndSwap64(iWaitMaxUs, max, aWaitUs)) {
+        max = Atomic::Load64(iWaitMaxUs);
+    }
+}
+
+void MutexStats::RecordHold(TUint64 aHoldUs)
+{
+    TUint bucket = 0;
+    TUint64 bound = 1;
+    while (bucket < kNumHoldBuckets-1 && aHoldUs >= bound) {
+        bucket++;
+        bound *= 10;
+    }
+    (void)Atomic::Add64(iHoldBuckets[bucket], 1);
+}
+
+void MutexStats::WriteRow(IWriter& aWriter)
+{
+    Bws<256> row;
+    row.AppendPrintf("%-4s %5u %12llu %10llu %14llu %11llu",
+                     iName, Atomic::Load(iInstances),
+                     Atomic::Load64(iAcquisitions), Atomic::Load64(iContended),
+                     Atomic::Load64(iWaitTotalUs), Atomic::Load64(iWaitMaxUs));
+    for (TUint i=0; i<kNumHoldBuckets; i++) {
+        row.AppendPrintf(" %10llu", Atomic::Load64(iHoldBuckets[i]));
+    }
+    row.Append('\n');
+    aWriter.Write(row);
+}
+
+
+// MutexProfiler
+
+const Brn MutexProfiler::kQueryMutexes("mutexes");
+
+static TBool CompareWaitTotal(const std::pair<TUint64, MutexStats*>& aA, const std::pair<TUint64, MutexStats*>& aB)
+{
+    return aA.first > aB.first;
+}
+
+MutexProfiler::MutexProfiler(OsContext* aOsCtx, TBool aEnabled)
+    : iEnabled(aEnabled)
+{
+    iLock = Os::MutexCreate(aOsCtx, "MPRF");
+    if (iLock == kHandleNull) {
+        throw std::bad_alloc();
+    }
+}
+
+MutexProfiler::~MutexProfiler()
+{
+    for (std::set<Mutex*>::iterator it = iMutexes.begin(); it != iMutexes.end(); ++it) {
+        (*it)->iStats = NULL;
+    }
+    for (StatsMap::iterator it = iStats.begin(); it != iStats.end(); ++it) {
+        delete it->second;
+    }
+    Os::MutexDestroy(iLock);
+}
+
+TBool MutexProfiler::Enabled() const
+{
+    return iEnabled;
+}
+
+MutexStats* MutexProfiler::Register(Mutex& aMutex, const TChar* aName)
+{
+    if (!iEnabled) {
+        return NULL;
+    }
+    TUint32 key = 0;
+    for (TUint i=0; i<4 && aName[i] != '\0'; i++) {
+        key |= ((TUint32)(TByte)aName[i]) << (8*i);
+    }
+    (void)Os::MutexLock(iLock);
+    MutexStats* stats;
+    StatsMap::iterator it = iStats.find(key);
+    if (it != iStats.end()) {
+        stats = it->second;
+    }
+    else {
+        stats = new MutexStats(aName);
+        iStats.insert(std::pair<TUint32, MutexStats*>(key, stats));
+    }
+    (void)Atomic::Add(stats->iInstances, 1);
+    (void)iMutexes.insert(&aMutex);
+    (void)Os::MutexUnlock(iLock);
+    return stats;
+}
+
+void MutexProfiler::Deregister(Mutex& aMutex)
+{
+    (void)Os::MutexLock(iLock);
+    (void)iMutexes.erase(&aMutex);
+    (void)Os::MutexUnlock(iLock);
+}
+
+void MutexProfiler::Reset()
+{
+    (void)Os::MutexLock(iLock);
+    for (StatsMap::iterator it = iStats.begin(); it != iStats.end(); ++it) {
+        it->second->Reset();
+    }
+    (void)Os::MutexUnlock(iLock);
+}
+
+void MutexProfiler::WriteTable(IWriter& aWriter)
+{
+    if (!iEnabled) {
+        aWriter.Write(Brn("Mutex profiling is disabled.  Enable via InitialisationParams::SetEnableMutexProfiling()\n"));
+        return;
+    }
+    std::vector<std::pair<TUint64, MutexStats*> > sorted;
+    (void)Os::MutexLock(iLock);
+    for (StatsMap::iterator it = iStats.begin(); it != iStats.end(); ++it) {
+        sorted.push_back(std::pair<TUint64, MutexStats*>(Atomic::Load64(it->second->iWaitTotalUs), it->second));
+    }
+    (void)Os::MutexUnlock(iLock);
+    std::sort(sorted.begin(), sorted.end(), CompareWaitTotal);
+
+    aWriter.Write(Brn("name  inst     acquired  contended  wait-total-us wait-max-us"
+                      "   hold<1us  hold<10us hold<100us   hold<1ms  hold<10ms hold>=10ms\n"));
+    // MutexStats are never deleted before the profiler so can safely be read outside iLock
+    for (TUint i=0; i<(TUint)sorted.size(); i++) {
+        sorted[i].second->WriteRow(aWriter);
+    }
+}
+
+void MutexProfiler::QueryInfo(const Brx& aQuery, IWriter& aWriter)
+{
+    if (aQuery == kQueryMutexes) {
+        WriteTable(aWriter);
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef HEADER_MUTEX_PROFILER
+#define HEADER_MUTEX_PROFILER
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/OsTypes.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/InfoProvider.h>
+
+#include <map>
+#include <set>
+
+namespace OpenHome {
+
+/**
+ * Lock contention statistics, aggregated over all Mutex instances which share a name.
+ *
+ * All updates are lock-free so may be called from Mutex::Wait()/Signal().
+ */
+class MutexStats : private INonCopyable
+{
+    friend class MutexProfiler;
+public:
+    static const TUint kNumHoldBuckets = 6; // <1us, <10us, <100us, <1ms, <10ms, >=10ms
+public:
+    void RecordWait(TUint64 aWaitUs, TBool aContended);
+    void RecordHold(TUint64 aHoldUs);
+private:
+    MutexStats(const TChar* aName);
+    void Reset();
+    void WriteRow(IWriter& aWriter);
+private:
+    TChar iName[5];
+    volatile TUint iInstances;
+    volatile TUint64 iAcquisitions;
+    volatile TUint64 iContended;
+    volatile TUint64 iWaitTotalUs;
+    volatile TUint64 iWaitMaxUs;
+    volatile TUint64 iHoldBuckets[kNumHoldBuckets];
+};
+
+class Mutex;
+
+/**
+ * Owned by Environment.  Mutexes register on construction if profiling was enabled
+ * (see InitialisationParams::SetEnableMutexProfiling) and are never profiled otherwise.
+ *
+ * Registered mutexes are tracked until they deregister on destruction.  Any that are
+ * still registered when the profiler is destroyed stop being profiled rather than
+ * keeping a pointer to freed stats.
+ */
+class MutexProfiler : public IInfoProvider
+{
+public:
+    static const Brn kQueryMutexes;
+public:
+    MutexProfiler(OsContext* aOsCtx, TBool aEnabled);
+    ~MutexProfiler();
+    TBool Enabled() const;
+    MutexStats* Register(Mutex& aMutex, const TChar* aName); // returns NULL if profiling is disabled
+    void Deregister(Mutex& aMutex);
+    void Reset();
+    void WriteTable(IWriter& aWriter); // sorted by total wait time, worst first
+private: // from IInfoProvider
+    void QueryInfo(const Brx& aQuery, IWriter& aWriter);
+private:
+    const TBool iEnabled;
+    THandle iLock; // can't use Mutex here - its Wait()/Signal() would be profiled
+    typedef std::map<TUint32, MutexStats*> StatsMap;
+    StatsMap iStats;
+    std::set<Mutex*> iMutexes;
+};
+
+} // namespace OpenHome
+
+#endif // HEADER_MUTEX_PROFILER
@@ -33,6 +33,7 @@ LOCAL_SRC_FILES := $(ohroot)OpenHome/Ascii.cpp \
                    $(ohroot)OpenHome/Net/ControlPoint/Dv/CpiDeviceDv.cpp \
                    $(ohroot)OpenHome/Net/ControlPoint/Lpec/CpiDeviceLpec.cpp \
                    $(ohroot)OpenHome/Net/ControlPoint/Upnp/CpiDeviceUpnp.cpp \
+                   $(ohroot)OpenHome/Net/ControlPoint/Upnp/CpiDeviceCacheUpnp.cpp \
                    $(ohroot)OpenHome/Net/ControlPoint/CpiService.cpp \
                    $(ohroot)OpenHome/Net/ControlPoint/CpiStack.cpp \
                    $(ohroot)OpenHome/Net/ControlPoint/CpiSubscription.cpp \
@@ -99,6 +100,8 @@ LOCAL_SRC_FILES := $(ohroot)OpenHome/Ascii.cpp \
                    $(ohroot)OpenHome/Thread.cpp \
                    $(ohroot)OpenHome/Time.cpp \
                    $(ohroot)OpenHome/Timer.cpp \
+                   $(ohroot)OpenHome/WorkerPool.cpp \
+                   $(ohroot)OpenHome/BufferPool.cpp \
                    $(ohroot)OpenHome/TIpAddressUtils.cpp \
                    $(ohroot)OpenHome/Uri.cpp \
                    $(ohroot)OpenHome/Net/XmlParser.cpp \
@@ -153,6 +156,7 @@ LOCAL_SRC_FILES := $(ohroot)OpenHome/Net/Bindings/Java/Action.c \
                    $(ohroot)OpenHome/Net/Bindings/Java/DvServerUpnp.c \
                    $(ohroot)OpenHome/Net/Bindings/Java/InitParams.c \
                    $(ohroot)OpenHome/Net/Bindings/Java/Invocation.c \
+                   $(ohroot)OpenHome/Net/Bindings/Java/JniCache.c \
                    $(ohroot)OpenHome/Net/Bindings/Java/JniCallbackList.c \
                    $(ohroot)OpenHome/Net/Bindings/Java/Library.c \
                    $(ohroot)OpenHome/Net/Bindings/Java/NetworkAdapter.c \
@@ -119,6 +119,29 @@ DllExport void STDCALL CpProxyPropertyReadUnlock(THandle aHandle);
  */
 DllExport void STDCALL CpProxyAddProperty(THandle aHandle, ServiceProperty aProperty);
 
+/**
+ * Read the values of several properties of a proxy, taking its property read lock only once.
+ *
+ * Values are packed into aBuffer in the order given by aProperties.  Int, uint and bool values
+ * take 4 bytes each (native byte order; bools are 0 or 1).  String values are UTF-8 with no nul
+ * terminator.  Binary values are copied as-is.  A property which has not yet had a value evented
+ * takes no space, so string and binary properties with no value read as empty.
+ *
+ * @param[in]  aHandle       Returned from [service]CreateEvented
+ * @param[in]  aProperties   Array of aCount properties, each previously passed to CpProxyAddProperty
+ * @param[in]  aCount        Number of entries in aProperties
+ * @param[out] aBuffer       Caller-allocated buffer to receive the values
+ * @param[in]  aBufferBytes  Size of aBuffer
+ * @param[out] aOffsets      Array of aCount+1 entries.  Value i occupies bytes
+ *                           [aOffsets[i], aOffsets[i+1]) of aBuffer.
+ *
+ * @return  Number of bytes required to hold all values.  If this is greater than aBufferBytes,
+ *          the contents of aBuffer are incomplete and the call should be repeated with a
+ *          buffer of at least this size.  aOffsets is always filled in.
+ */
+DllExport uint32_t STDCALL CpProxyPropertySnapshot(THandle aHandle, ServiceProperty* aProperties, uint32_t aCount,
+                                                   uint8_t* aBuffer, uint32_t aBufferBytes, uint32_t* aOffsets);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
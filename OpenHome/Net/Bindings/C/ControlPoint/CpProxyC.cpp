@@ -5,6 +5,9 @@
 #include <OpenHome/Net/Private/CpiDevice.h>
 #include <OpenHome/Net/C/CpDevice.h>
 #include <OpenHome/Private/Printer.h>
+#include <OpenHome/Net/Private/Service.h>
+
+#include <string.h>
 
 using namespace OpenHome;
 using namespace OpenHome::Net;
@@ -114,3 +117,66 @@ void STDCALL CpProxyAddProperty(THandle aHandle, ServiceProperty aProperty)
     ASSERT(prop != NULL);
     proxyC->AddProperty(prop);
 }
+
+static void SnapshotAppend(uint8_t* aBuffer, TUint aBufferBytes, TUint& aBytes, const void* aData, TUint aLen)
+{
+    if (aBytes + aLen <= aBufferBytes) {
+        (void)memcpy(aBuffer + aBytes, aData, aLen);
+    }
+    aBytes += aLen;
+}
+
+uint32_t STDCALL CpProxyPropertySnapshot(THandle aHandle, ServiceProperty* aProperties, uint32_t aCount,
+                                         uint8_t* aBuffer, uint32_t aBufferBytes, uint32_t* aOffsets)
+{
+    CpProxyC* proxyC = reinterpret_cast<CpProxyC*>(aHandle);
+    ASSERT(proxyC != NULL);
+    TUint bytes = 0;
+    AutoMutex _(proxyC->GetPropertyReadLock());
+    for (TUint i=0; i<aCount; i++) {
+        aOffsets[i] = bytes;
+        OpenHome::Net::Property* prop = reinterpret_cast<OpenHome::Net::Property*>(aProperties[i]);
+        ASSERT(prop != NULL);
+        try {
+            switch (prop->Parameter().Type())
+            {
+            case OpenHome::Net::Parameter::eTypeBool:
+            {
+                const uint32_t val = (static_cast<PropertyBool*>(prop)->Value()? 1 : 0);
+                SnapshotAppend(aBuffer, aBufferBytes, bytes, &val, sizeof(val));
+            }
+                break;
+            case OpenHome::Net::Parameter::eTypeInt:
+            {
+                const int32_t val = static_cast<PropertyInt*>(prop)->Value();
+                SnapshotAppend(aBuffer, aBufferBytes, bytes, &val, sizeof(val));
+            }
+                break;
+            case OpenHome::Net::Parameter::eTypeUint:
+            {
+                const uint32_t val = static_cast<PropertyUint*>(prop)->Value();
+                SnapshotAppend(aBuffer, aBufferBytes, bytes, &val, sizeof(val));
+            }
+                break;
+            case OpenHome::Net::Parameter::eTypeString:
+            {
+                const Brx& val = static_cast<PropertyString*>(prop)->Value();
+                SnapshotAppend(aBuffer, aBufferBytes, bytes, val.Ptr(), val.Bytes());
+            }
+                break;
+            case OpenHome::Net::Parameter::eTypeBinary:
+            {
+                const Brx& val = static_cast<PropertyBinary*>(prop)->Value();
+                SnapshotAppend(aBuffer, aBufferBytes, bytes, val.Ptr(), val.Bytes());
+            }
+                break;
+            default:
+                ASSERTS();
+                break;
+            }
+        }
+        catch (PropertyError&) {}
+    }
+    aOffsets[aCount] = bytes;
+    return bytes;
+}
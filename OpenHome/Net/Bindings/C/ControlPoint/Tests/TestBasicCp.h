@@ -13,6 +13,8 @@ class TestBasicCpC
 public:
     static void TestActions(CpDeviceC aDevice);
     static void TestSubscriptions(CpDeviceC aDevice);
+private:
+    static void TestSnapshot(CpDeviceC aDevice, const char* aBin, TUint aBinBytes);
 };
 
 } // namespace Net
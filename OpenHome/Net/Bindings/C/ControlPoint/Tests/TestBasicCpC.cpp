@@ -183,4 +183,63 @@ void TestBasicCpC::TestSubscriptions(CpDeviceC aDevice)
     ASSERT(valBool == 0);
 
     CpProxyOpenhomeOrgTestBasic1Destroy(proxy); // automatically unsubscribes
+
+    Print("    Snapshot...\n");
+    TestSnapshot(aDevice, bufBin, sizeof(bufBin));
+}
+
+static void STDCALL propertyChanged(void* /*aPtr*/)
+{
+}
+
+void TestBasicCpC::TestSnapshot(CpDeviceC aDevice, const char* aBin, TUint aBinBytes)
+{
+    // read the values left by TestSubscriptions via a generic proxy, as language bindings do
+    THandle proxy = CpProxyCreate("openhome-org", "TestBasic", 1, aDevice);
+    ServiceProperty props[5];
+    props[0] = ServicePropertyCreateUintCp("VarUint", propertyChanged, NULL);
+    props[1] = ServicePropertyCreateIntCp("VarInt", propertyChanged, NULL);
+    props[2] = ServicePropertyCreateBoolCp("VarBool", propertyChanged, NULL);
+    props[3] = ServicePropertyCreateStringCp("VarStr", propertyChanged, NULL);
+    props[4] = ServicePropertyCreateBinaryCp("VarBin", propertyChanged, NULL);
+    for (TUint i=0; i<5; i++) {
+        CpProxyAddProperty(proxy, props[i]);
+    }
+    Semaphore sem("TSEM", 0);
+    CpProxySetPropertyInitialEvent(proxy, updatesComplete, &sem);
+    CpProxySubscribe(proxy);
+    sem.Wait();
+
+    const char* str = "<&'tag\">";
+    const TUint strBytes = (TUint)strlen(str);
+    const TUint expected = 3*sizeof(uint32_t) + strBytes + aBinBytes;
+    uint32_t offsets[6];
+    uint8_t small[8];
+    ASSERT(CpProxyPropertySnapshot(proxy, props, 5, small, sizeof(small), offsets) == expected);
+
+    uint8_t buf[512];
+    ASSERT(CpProxyPropertySnapshot(proxy, props, 5, buf, sizeof(buf), offsets) == expected);
+    ASSERT(offsets[5] == expected);
+    uint32_t valUint;
+    (void)memcpy(&valUint, &buf[offsets[0]], sizeof(valUint));
+    ASSERT(valUint == 15);
+    int32_t valInt;
+    (void)memcpy(&valInt, &buf[offsets[1]], sizeof(valInt));
+    ASSERT(valInt == 658);
+    uint32_t valBool;
+    (void)memcpy(&valBool, &buf[offsets[2]], sizeof(valBool));
+    ASSERT(valBool == 0);
+    ASSERT(offsets[4] - offsets[3] == strBytes);
+    ASSERT(memcmp(&buf[offsets[3]], str, strBytes) == 0);
+    ASSERT(offsets[5] - offsets[4] == aBinBytes);
+    ASSERT(memcmp(&buf[offsets[4]], aBin, aBinBytes) == 0);
+
+    // a selected subset is packed in the order requested
+    ServiceProperty subset[2] = { props[3], props[1] };
+    ASSERT(CpProxyPropertySnapshot(proxy, subset, 2, buf, sizeof(buf), offsets) == strBytes + sizeof(int32_t));
+    ASSERT(offsets[1] == strBytes);
+    (void)memcpy(&valInt, &buf[offsets[1]], sizeof(valInt));
+    ASSERT(valInt == 658);
+
+    CpProxyDestroy(proxy); // also destroys the properties
 }
@@ -58,6 +58,19 @@ typedef enum EOhNetLibraryInitError
    ,eOhNetInitErrorNetworkAddressInUse
 } EOhNetLibraryInitError;
 
+/**
+ * Thread pools which may grow beyond their initial size under load.
+ * See OhNetInitParamsSetWorkerPoolLimits().
+ */
+typedef enum EOhNetWorkerPool
+{
+    eOhNetWorkerPoolXmlFetcher
+   ,eOhNetWorkerPoolActionInvoker
+   ,eOhNetWorkerPoolSubscriber
+   ,eOhNetWorkerPoolDvPublisher
+   ,eOhNetWorkerPoolDvLpec
+} EOhNetWorkerPool;
+
 /**
  * Initialise the UPnP library.
  *
@@ -363,6 +376,25 @@ DllExport void STDCALL OhNetInitParamsSetNumInvocations(OhNetHandleInitParams aP
  */
 DllExport void STDCALL OhNetInitParamsSetNumSubscriberThreads(OhNetHandleInitParams aParams, uint32_t aNumThreads);
 
+/**
+ * Set the limits for one of the elastic thread pools.
+ *
+ * The thread counts set by OhNetInitParamsSetNumXmlFetcherThreads(),
+ * OhNetInitParamsSetNumActionInvokerThreads(), OhNetInitParamsSetNumSubscriberThreads()
+ * and OhNetInitParamsSetDvNumPublisherThreads() are the number of threads created when
+ * each pool starts.  The LPEC action pool starts with one thread per action a single
+ * LPEC connection may run concurrently.  A pool grows when work is queued with none of its threads free and
+ * shrinks back once the extra threads have been idle for a while.
+ *
+ * @param[in] aParams          Initialisation params
+ * @param[in] aPool            Pool to configure
+ * @param[in] aMaxThreads      Maximum number of threads.  Values no higher than the
+ *                             initial thread count give a fixed size pool.
+ * @param[in] aIdleTimeoutMs   Time a thread above the initial count may be idle before
+ *                             it exits.  0 means these threads never exit.
+ */
+DllExport void STDCALL OhNetInitParamsSetWorkerPoolLimits(OhNetHandleInitParams aParams, EOhNetWorkerPool aPool, uint32_t aMaxThreads, uint32_t aIdleTimeoutMs);
+
 /**
  * Set the maximum time control points will wait for action invocations to begin responding.
  *
@@ -512,6 +544,17 @@ DllExport void STDCALL OhNetInitParamsSetDvEnableBonjour(OhNetHandleInitParams a
  */
 DllExport void STDCALL OhNetInitParamsSetHostUdpIsLowQuality(OhNetHandleInitParams aParams, int32_t aLowQuality);
 
+/**
+ * Run actions invoked on a control point's view of a device in the same process (CpDeviceDv)
+ * on the calling thread rather than on an action invoker thread.
+ *
+ * Async completion callbacks will then run before the Begin...() call returns.
+ *
+ * @param[in] aParams          Initialisation params
+ * @param[in] aEnable          0 => use action invoker threads (default); 1 => invoke on the caller's thread
+ */
+DllExport void STDCALL OhNetInitParamsSetCpDeviceDvInvokeOnCallerThread(OhNetHandleInitParams aParams, uint32_t aEnable);
+
 /**
 * Set HTTP user agent string.
 *
@@ -206,6 +206,12 @@ void STDCALL OhNetInitParamsSetNumSubscriberThreads(OhNetHandleInitParams aParam
     ip->SetNumSubscriberThreads(aNumThreads);
 }
 
+void STDCALL OhNetInitParamsSetWorkerPoolLimits(OhNetHandleInitParams aParams, EOhNetWorkerPool aPool, uint32_t aMaxThreads, uint32_t aIdleTimeoutMs)
+{
+    InitialisationParams* ip = reinterpret_cast<InitialisationParams*>(aParams);
+    ip->SetWorkerPoolLimits((InitialisationParams::EWorkerPool)aPool, aMaxThreads, aIdleTimeoutMs);
+}
+
 void STDCALL OhNetInitParamsSetInvocationTimeout(OhNetHandleInitParams aParams, uint32_t aTimeoutMs)
 {
     InitialisationParams* ip = reinterpret_cast<InitialisationParams*>(aParams);
@@ -312,6 +318,12 @@ void STDCALL OhNetInitParamsSetHostUdpIsLowQuality(OhNetHandleInitParams aParams
     ip->SetHostUdpIsLowQuality(lowQuality);
 }
 
+void STDCALL OhNetInitParamsSetCpDeviceDvInvokeOnCallerThread(OhNetHandleInitParams aParams, uint32_t aEnable)
+{
+    InitialisationParams* ip = reinterpret_cast<InitialisationParams*>(aParams);
+    ip->SetCpDeviceDvInvokeOnCallerThread(aEnable != 0);
+}
+
 uint32_t STDCALL OhNetInitParamsTcpConnectTimeoutMs(OhNetHandleInitParams aParams)
 {
     InitialisationParams* ip = reinterpret_cast<InitialisationParams*>(aParams);
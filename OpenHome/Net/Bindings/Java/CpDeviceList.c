@@ -7,6 +7,7 @@
 #include "CpDeviceList.h"
 #include "CpDeviceListCallback.h"
 #include "JniCallbackList.h"
+#include "JniCache.h"
 #include "OpenHome/Defines.h"
 #include "OpenHome/Net/C/CpDevice.h"
 #include "OpenHome/Net/C/CpDeviceUpnp.h"
@@ -19,7 +20,6 @@ void STDCALL deviceAddedCallback(void* aPtr, CpDeviceC aDevice) {
 	JniObjRef* ref = (JniObjRef*) aPtr;
 	JavaVM *vm = ref->vm;
 	JNIEnv *env;
-	jclass cls;
 	jmethodID mid;
 	jint ret;
 	jint attached;
@@ -39,9 +39,7 @@ void STDCALL deviceAddedCallback(void* aPtr, CpDeviceC aDevice) {
 			return;
 		}
 	}
-	cls = (*env)->GetObjectClass(env, ref->callbackObj);
-	mid = (*env)->GetMethodID(env, cls, "deviceAdded", "(J)V");
-    (*env)->DeleteLocalRef(env, cls);
+	mid = JniCacheGetCallback(env, &gJniCache.deviceListDeviceAdded, ref->callbackObj);
 	if (mid == 0) {
 		printf("CpDeviceListJNI: Method ID \"deviceAdded()\" not found.\n");
 		fflush(stdout);
@@ -56,7 +54,6 @@ void STDCALL deviceRemovedCallback(void* aPtr, CpDeviceC aDevice) {
 	JniObjRef* ref = (JniObjRef*) aPtr;
 	JavaVM *vm = ref->vm;
 	JNIEnv *env;
-	jclass cls;
 	jmethodID mid;
 	jint ret;
 	jint attached;
@@ -76,9 +73,7 @@ void STDCALL deviceRemovedCallback(void* aPtr, CpDeviceC aDevice) {
 			return;
 		}
 	}
-	cls = (*env)->GetObjectClass(env, ref->callbackObj);
-	mid = (*env)->GetMethodID(env, cls, "deviceRemoved", "(J)V");
-    (*env)->DeleteLocalRef(env, cls);
+	mid = JniCacheGetCallback(env, &gJniCache.deviceListDeviceRemoved, ref->callbackObj);
 	if (mid == 0) {
 		printf("CpDeviceListJNI: Method ID \"deviceRemoved()\" not found.\n");
 		fflush(stdout);
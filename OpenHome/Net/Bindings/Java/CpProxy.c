@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include "CpProxy.h"
 #include "JniCallbackList.h"
+#include "JniCache.h"
 #include "OpenHome/Net/C/CpProxy.h"
 
 #ifdef __cplusplus
@@ -17,7 +18,6 @@ static void STDCALL CallbackChange(void* aPtr)
 	JniObjRef* ref = (JniObjRef*) aPtr;
 	JavaVM *vm = ref->vm;
 	JNIEnv *env;
-	jclass cls;
 	jmethodID mid;
 	jint ret;
 	jint attached;
@@ -37,9 +37,7 @@ static void STDCALL CallbackChange(void* aPtr)
 			return;
 		}
 	}
-	cls = (*env)->GetObjectClass(env, ref->callbackObj);
-	mid = (*env)->GetMethodID(env, cls, "notifyChange", "()V");
-    (*env)->DeleteLocalRef(env, cls);
+	mid = JniCacheGetCallback(env, &gJniCache.propertyChangeNotify, ref->callbackObj);
 	if (mid == 0) {
 		printf("Method ID notifyChange() not found.\n");
 		return;
@@ -54,7 +52,6 @@ static void STDCALL CallbackInitial(void* aPtr)
 	JniObjRef* ref = (JniObjRef*) aPtr;
 	JavaVM *vm = ref->vm;
 	JNIEnv *env;
-	jclass cls;
 	jmethodID mid;
 	jint ret;
 	jint attached;
@@ -74,9 +71,7 @@ static void STDCALL CallbackInitial(void* aPtr)
 			return;
 		}
 	}
-	cls = (*env)->GetObjectClass(env, ref->callbackObj);
-	mid = (*env)->GetMethodID(env, cls, "notifyChange", "()V");
-    (*env)->DeleteLocalRef(env, cls);
+	mid = JniCacheGetCallback(env, &gJniCache.propertyChangeNotify, ref->callbackObj);
 	if (mid == 0) {
 		printf("Method ID notifyChange() not found.\n");
 		return;
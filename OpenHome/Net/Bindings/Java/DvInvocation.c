@@ -7,6 +7,7 @@
 #include <string.h>
 #include <OpenHome/Os.h>
 #include "DvInvocation.h"
+#include "JniCache.h"
 #include "OpenHome/Net/C/DvProvider.h"
 
 #ifdef __cplusplus
@@ -181,21 +182,16 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvInvocation_DvInvocation
 	const char* name = (*aEnv)->GetStringUTFChars(aEnv, aName, NULL);
 	aEnv = aEnv;
 
-	statusClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/device/DvInvocation$InvocationStatusInt");
-	if (statusClass == NULL)
-	{
-		printf("Unable to find class org/openhome/net/device/DvInvocation$InvocationStatusInt\n");
-		return NULL;
-	}
-	cid = (*aEnv)->GetMethodID(aEnv, statusClass, "<init>", "(Lorg/openhome/net/device/DvInvocation;II)V");
+	statusClass = JniCacheGetClass(aEnv, &gJniCache.invocationStatusInt);
+	cid = gJniCache.invocationStatusInt.ctor;
 	if (cid == NULL) {
 		printf("Unable to find constructor for class org/openhome/net/device/DvInvocation$InvocationStatusInt\n");
-        return NULL;
+		(*aEnv)->ReleaseStringUTFChars(aEnv, aName, name);
+		return NULL;
 	}
 	result = DvInvocationReadInt(invocation, name, &value);
 	status = (*aEnv)->NewObject(aEnv, statusClass, cid, aObject, value, result);
 	(*aEnv)->ReleaseStringUTFChars(aEnv, aName, name);
-	(*aEnv)->DeleteLocalRef(aEnv, statusClass);
 	
 	return status;
 }
@@ -217,23 +213,18 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvInvocation_DvInvocation
 	const char* name = (*aEnv)->GetStringUTFChars(aEnv, aName, NULL);
 	aEnv = aEnv;
 
-	statusClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/device/DvInvocation$InvocationStatusUint");
-	if (statusClass == NULL)
-	{
-		printf("Unable to find class org/openhome/net/device/DvInvocation$InvocationStatusUint\n");
-		return NULL;
-	}
-	cid = (*aEnv)->GetMethodID(aEnv, statusClass, "<init>", "(Lorg/openhome/net/device/DvInvocation;JI)V");
+	statusClass = JniCacheGetClass(aEnv, &gJniCache.invocationStatusUint);
+	cid = gJniCache.invocationStatusUint.ctor;
 	if (cid == NULL) {
 		printf("Unable to find constructor for class org/openhome/net/device/DvInvocation$InvocationStatusUint\n");
-        return NULL;
+		(*aEnv)->ReleaseStringUTFChars(aEnv, aName, name);
+		return NULL;
 	}
 	result = DvInvocationReadUint(invocation, name, &value);
 	// Need to cast value to a jlong as Java constructor expects a long,
 	// otherwise it will corrupt the value of "result".
 	status = (*aEnv)->NewObject(aEnv, statusClass, cid, aObject, (jlong)value, result);
 	(*aEnv)->ReleaseStringUTFChars(aEnv, aName, name);
-	(*aEnv)->DeleteLocalRef(aEnv, statusClass);
 	
 	return status;
 }
@@ -255,21 +246,16 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvInvocation_DvInvocation
 	const char* name = (*aEnv)->GetStringUTFChars(aEnv, aName, NULL);
 	aEnv = aEnv;
 
-	statusClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/device/DvInvocation$InvocationStatusBool");
-	if (statusClass == NULL)
-	{
-		printf("Unable to find class org/openhome/net/device/DvInvocation$InvocationStatusBool\n");
-		return NULL;
-	}
-	cid = (*aEnv)->GetMethodID(aEnv, statusClass, "<init>", "(Lorg/openhome/net/device/DvInvocation;II)V");
+	statusClass = JniCacheGetClass(aEnv, &gJniCache.invocationStatusBool);
+	cid = gJniCache.invocationStatusBool.ctor;
 	if (cid == NULL) {
 		printf("Unable to find constructor for class org/openhome/net/device/DvInvocation$InvocationStatusBool\n");
-        return NULL;
+		(*aEnv)->ReleaseStringUTFChars(aEnv, aName, name);
+		return NULL;
 	}
 	result = DvInvocationReadBool(invocation, name, &value);
 	status = (*aEnv)->NewObject(aEnv, statusClass, cid, aObject, value, result);
 	(*aEnv)->ReleaseStringUTFChars(aEnv, aName, name);
-	(*aEnv)->DeleteLocalRef(aEnv, statusClass);
 	
 	return status;
 }
@@ -282,53 +268,27 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvInvocation_DvInvocation
 JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvInvocation_DvInvocationReadString
   (JNIEnv *aEnv, jclass aObject, jlong aInvocation, jstring aName)
 {
-    jclass stringClass;
-    jclass statusClass;
-    jmethodID cidString;
-    jmethodID cidStatus;
     jobject status;
     char* value;
     uint32_t len;
-    jbyteArray byteArray;
-    jstring utf8;
     jobject valueJava;
     int result;
     DvInvocationC invocation = (DvInvocationC) (size_t)aInvocation;
     const char* name = (*aEnv)->GetStringUTFChars(aEnv, aName, NULL);
+    jclass statusClass = JniCacheGetClass(aEnv, &gJniCache.invocationStatusString);
 
-    stringClass = (*aEnv)->FindClass(aEnv, "java/lang/String");
-    if (stringClass == NULL)
-    {
-        printf("Unable to find class java/lang/String\n");
-         return NULL;
-    }
-    cidString = (*aEnv)->GetMethodID(aEnv, stringClass, "<init>", "([BLjava/lang/String;)V");
-    if (cidString == NULL) {
-        printf("Unable to find constructor for class java/lang/String\n");
-        return NULL;
-    }
-    statusClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/device/DvInvocation$InvocationStatusString");
-    if (statusClass == NULL)
-    {
-        printf("Unable to find class org/openhome/net/device/DvInvocation$InvocationStatusString\n");
-        return NULL;
-    }
-    cidStatus = (*aEnv)->GetMethodID(aEnv, statusClass, "<init>", "(Lorg/openhome/net/device/DvInvocation;Ljava/lang/String;I)V");
-    if (cidStatus == NULL) {
+    if (gJniCache.invocationStatusString.ctor == NULL) {
         printf("Unable to find constructor for class org/openhome/net/device/DvInvocation$InvocationStatusString\n");
+        (*aEnv)->ReleaseStringUTFChars(aEnv, aName, name);
         return NULL;
     }
     result = DvInvocationReadStringAsBuffer(invocation, name, &value, &len);
     if (result == 0) {
-        byteArray = (*aEnv)->NewByteArray(aEnv, len);
-        (*aEnv)->SetByteArrayRegion(aEnv, byteArray, 0, len, (jbyte *) value);
-        utf8 = (*aEnv)->NewStringUTF(aEnv, "UTF-8");
-        valueJava = (*aEnv)->NewObject(aEnv, stringClass, cidString, byteArray, utf8);
+        valueJava = JniCacheNewStringUtf8(aEnv, value, len);
     } else {
         valueJava = NULL;
     }
-    status = (*aEnv)->NewObject(aEnv, statusClass, cidStatus, aObject, valueJava, result);
-    // local refs for stringClass and statusClass will be deleted when method returns
+    status = (*aEnv)->NewObject(aEnv, statusClass, gJniCache.invocationStatusString.ctor, aObject, valueJava, result);
     (*aEnv)->ReleaseStringUTFChars(aEnv, aName, name);
     
     return status;
@@ -353,16 +313,12 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvInvocation_DvInvocation
 	const char* name = (*aEnv)->GetStringUTFChars(aEnv, aName, NULL);
 	aEnv = aEnv;
 	
-	statusClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/device/DvInvocation$InvocationStatusBinary");
-	if (statusClass == NULL)
-	{
-		printf("Unable to find class org/openhome/net/device/DvInvocation$InvocationStatusBinary\n");
-		return NULL;
-	}
-	cid = (*aEnv)->GetMethodID(aEnv, statusClass, "<init>", "(Lorg/openhome/net/device/DvInvocation;[BI)V");
+	statusClass = JniCacheGetClass(aEnv, &gJniCache.invocationStatusBinary);
+	cid = gJniCache.invocationStatusBinary.ctor;
 	if (cid == NULL) {
 		printf("Unable to find constructor for class org/openhome/net/device/DvInvocation$InvocationStatusBinary\n");
-        return NULL;
+		(*aEnv)->ReleaseStringUTFChars(aEnv, aName, name);
+		return NULL;
 	}
 	result = DvInvocationReadBinary(invocation, name, &value, &len);
     if (result == 0) {
@@ -373,7 +329,6 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvInvocation_DvInvocation
     }
 	status = (*aEnv)->NewObject(aEnv, statusClass, cid, aObject, valueJava, result);
 	(*aEnv)->ReleaseStringUTFChars(aEnv, aName, name);
-	(*aEnv)->DeleteLocalRef(aEnv, statusClass);
 	
 	return status;
 }
@@ -514,23 +469,16 @@ JNIEXPORT jint JNICALL Java_org_openhome_net_device_DvInvocation_DvInvocationWri
   (JNIEnv *aEnv, jclass aClass, jlong aInvocation, jstring aValue)
 {
     DvInvocationC invocation = (DvInvocationC) (size_t)aInvocation;
-    jclass cls = (*aEnv)->GetObjectClass(aEnv, aValue); // local ref will be deleted when method returns
-    jmethodID mid;
-    jstring utf8;
     jbyteArray byteArray;
     jbyte *data;
     jsize len;
     int32_t result;
     aClass = aClass;
 
-    mid = (*aEnv)->GetMethodID(aEnv, cls, "getBytes", "(Ljava/lang/String;)[B");
-    if (mid == 0) {
-        printf("DvInvocationJNI: Method ID \"getBytes()\" not found.\n");
-        fflush(stdout);
+    byteArray = JniCacheGetBytesUtf8(aEnv, aValue);
+    if (byteArray == NULL) {
         return 1; // error
     }
-    utf8 = (*aEnv)->NewStringUTF(aEnv, "UTF-8");
-    byteArray = (*aEnv)->CallObjectMethod(aEnv, aValue, mid, utf8);
     len = (*aEnv)->GetArrayLength(aEnv, byteArray);
     data = (*aEnv)->GetByteArrayElements(aEnv, byteArray, NULL);
     result = DvInvocationWriteStringAsBuffer(invocation, (char *)data, len);
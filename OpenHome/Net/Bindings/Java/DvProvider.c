@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include "DvProvider.h"
 #include "JniCallbackList.h"
+#include "JniCache.h"
 #include "OpenHome/Net/C/DvProvider.h"
 
 #ifdef __cplusplus
@@ -18,7 +19,6 @@ static void STDCALL CallbackDvInvocation(void* aPtr, DvInvocationC aInvocation)
 	JavaVM *vm = ref->vm;
 	jint ret;
 	JNIEnv *env;
-	jclass cls;
 	jmethodID mid;
     jint attached;
 	
@@ -36,9 +36,7 @@ static void STDCALL CallbackDvInvocation(void* aPtr, DvInvocationC aInvocation)
             return;
         }
     }
-	cls = (*env)->GetObjectClass(env, ref->callbackObj);
-	mid = (*env)->GetMethodID(env, cls, "actionInvoked", "(J)V");
-    (*env)->DeleteLocalRef(env, cls);
+	mid = JniCacheGetCallback(env, &gJniCache.invocationActionInvoked, ref->callbackObj);
 	if (mid == 0) {
 		printf("Method ID actionInvoked() not found.\n");
 		return;
@@ -190,20 +188,14 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvProvider_DvProviderSetP
 	ServiceProperty property = (ServiceProperty) (size_t)aProperty;
 	aEnv = aEnv;
 	
-	statusClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/device/DvProvider$PropertySetStatus");
-	if (statusClass == NULL)
-	{
-		printf("Unable to find class org/openhome/net/device/DvProvider$PropertySetStatus\n");
-		return NULL;
-	}
-	cid = (*aEnv)->GetMethodID(aEnv, statusClass, "<init>", "(Lorg/openhome/net/device/DvProvider;II)V");
+	statusClass = JniCacheGetClass(aEnv, &gJniCache.propertySetStatus);
+	cid = gJniCache.propertySetStatus.ctor;
 	if (cid == NULL) {
 		printf("Unable to find constructor for class org/openhome/net/device/DvProvider$PropertySetStatus\n");
         return NULL;
 	}
 	result = DvProviderSetPropertyInt(provider, property, aValue, &changed);
 	status = (*aEnv)->NewObject(aEnv, statusClass, cid, aObject, changed, result);
-	(*aEnv)->DeleteLocalRef(aEnv, statusClass);
 	
 	return status;
 }
@@ -226,20 +218,14 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvProvider_DvProviderSetP
 	ServiceProperty property = (ServiceProperty) (size_t)aProperty;
 	aEnv = aEnv;
 	
-	statusClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/device/DvProvider$PropertySetStatus");
-	if (statusClass == NULL)
-	{
-		printf("Unable to find class org/openhome/net/device/DvProvider$PropertySetStatus\n");
-		return NULL;
-	}
-	cid = (*aEnv)->GetMethodID(aEnv, statusClass, "<init>", "(Lorg/openhome/net/device/DvProvider;II)V");
+	statusClass = JniCacheGetClass(aEnv, &gJniCache.propertySetStatus);
+	cid = gJniCache.propertySetStatus.ctor;
 	if (cid == NULL) {
 		printf("Unable to find constructor for class org/openhome/net/device/DvProvider$PropertySetStatus\n");
         return NULL;
 	}
 	result = DvProviderSetPropertyUint(provider, property, value, &changed);
 	status = (*aEnv)->NewObject(aEnv, statusClass, cid, aObject, changed, result);
-	(*aEnv)->DeleteLocalRef(aEnv, statusClass);
 	
 	return status;
 }
@@ -261,20 +247,14 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvProvider_DvProviderSetP
 	ServiceProperty property = (ServiceProperty) (size_t)aProperty;
 	aEnv = aEnv;
 	
-	statusClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/device/DvProvider$PropertySetStatus");
-	if (statusClass == NULL)
-	{
-		printf("Unable to find class org/openhome/net/device/DvProvider$PropertySetStatus\n");
-		return NULL;
-	}
-	cid = (*aEnv)->GetMethodID(aEnv, statusClass, "<init>", "(Lorg/openhome/net/device/DvProvider;II)V");
+	statusClass = JniCacheGetClass(aEnv, &gJniCache.propertySetStatus);
+	cid = gJniCache.propertySetStatus.ctor;
 	if (cid == NULL) {
 		printf("Unable to find constructor for class org/openhome/net/device/DvProvider$PropertySetStatus\n");
         return NULL;
 	}
 	result = DvProviderSetPropertyBool(provider, property, aValue, &changed);
 	status = (*aEnv)->NewObject(aEnv, statusClass, cid, aObject, changed, result);
-	(*aEnv)->DeleteLocalRef(aEnv, statusClass);
 	
 	return status;
 }
@@ -297,13 +277,8 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvProvider_DvProviderSetP
 	ServiceProperty property = (ServiceProperty) (size_t)aProperty;
 	aEnv = aEnv;
 	
-	statusClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/device/DvProvider$PropertySetStatus");
-	if (statusClass == NULL)
-	{
-		printf("Unable to find class org/openhome/net/device/DvProvider$PropertySetStatus\n");
-		return NULL;
-	}
-	cid = (*aEnv)->GetMethodID(aEnv, statusClass, "<init>", "(Lorg/openhome/net/device/DvProvider;II)V");
+	statusClass = JniCacheGetClass(aEnv, &gJniCache.propertySetStatus);
+	cid = gJniCache.propertySetStatus.ctor;
 	if (cid == NULL) {
 		printf("Unable to find constructor for class org/openhome/net/device/DvProvider$PropertySetStatus\n");
         return NULL;
@@ -311,7 +286,6 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvProvider_DvProviderSetP
 	result = DvProviderSetPropertyString(provider, property, value, &changed);
 	status = (*aEnv)->NewObject(aEnv, statusClass, cid, aObject, changed, result);
 	(*aEnv)->ReleaseStringUTFChars(aEnv, aValue, value);
-	(*aEnv)->DeleteLocalRef(aEnv, statusClass);
 	
 	return status;
 }
@@ -334,13 +308,8 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvProvider_DvProviderSetP
 	ServiceProperty property = (ServiceProperty) (size_t)aProperty;
 	aEnv = aEnv;
 	
-	statusClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/device/DvProvider$PropertySetStatus");
-	if (statusClass == NULL)
-	{
-		printf("Unable to find class org/openhome/net/device/DvProvider$PropertySetStatus\n");
-		return NULL;
-	}
-	cid = (*aEnv)->GetMethodID(aEnv, statusClass, "<init>", "(Lorg/openhome/net/device/DvProvider;II)V");
+	statusClass = JniCacheGetClass(aEnv, &gJniCache.propertySetStatus);
+	cid = gJniCache.propertySetStatus.ctor;
 	if (cid == NULL) {
 		printf("Unable to find constructor for class org/openhome/net/device/DvProvider$PropertySetStatus\n");
         return NULL;
@@ -348,7 +317,6 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_device_DvProvider_DvProviderSetP
 	(*aEnv)->GetByteArrayRegion(aEnv, aData, 0, aLen, (jbyte *)data);
 	result = DvProviderSetPropertyBinary(provider, property, data, aLen, &changed);
 	status = (*aEnv)->NewObject(aEnv, statusClass, cid, aObject, changed, result);
-	(*aEnv)->DeleteLocalRef(aEnv, statusClass);
 	
 	return status;
 }
@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include "Invocation.h"
 #include "JniCallbackList.h"
+#include "JniCache.h"
 #include "OpenHome/Defines.h"
 #include "OpenHome/Net/C/CpService.h"
 
@@ -18,7 +19,6 @@ void STDCALL AsyncComplete(void* aPtr, OhNetHandleAsync aAsync) {
 	JniObjRef* ref = (JniObjRef*) aPtr;
 	JavaVM *vm = ref->vm;
 	JNIEnv *env;
-	jclass cls;
 	jmethodID mid;
 	jint ret;
     jint attached;
@@ -40,9 +40,7 @@ void STDCALL AsyncComplete(void* aPtr, OhNetHandleAsync aAsync) {
     }
 
 	
-	cls = (*env)->GetObjectClass(env, ref->callbackObj);
-	mid = (*env)->GetMethodID(env, cls, "asyncComplete", "(JJ)V");
-    (*env)->DeleteLocalRef(env, cls);
+	mid = JniCacheGetCallback(env, &gJniCache.invocationAsyncComplete, ref->callbackObj);
 	if (mid == 0)
 	{
 		printf("Method ID not found.\n");
@@ -144,14 +142,8 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_controlpoint_Invocation_CpInvoca
 	if (CpInvocationError(invocation, &code, &desc) == 0) {
         return NULL;
     }
-    proxyErrorClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/controlpoint/ProxyError");
-    if (proxyErrorClass == NULL)
-    {
-        printf("Unable to find class org/openhome/net/controlpoint/ProxyError\n");
-        fflush(stdout);
-        return NULL;
-    }
-    mid = (*aEnv)->GetMethodID(aEnv, proxyErrorClass, "<init>", "(ILjava/lang/String;)V");
+    proxyErrorClass = JniCacheGetClass(aEnv, &gJniCache.proxyError);
+    mid = gJniCache.proxyError.ctor;
     if (mid == NULL) {
         printf("Unable to find constructor for class org/openhome/net/controlpoint/ProxyError\n");
         fflush(stdout);
@@ -159,7 +151,6 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_controlpoint_Invocation_CpInvoca
     }
     descString = desc == NULL ? NULL : (*aEnv)->NewStringUTF(aEnv, desc);
     proxyError = (*aEnv)->NewObject(aEnv, proxyErrorClass, mid, (jint)code, descString);
-    (*aEnv)->DeleteLocalRef(aEnv, proxyErrorClass);
     
     return proxyError;
 }
@@ -0,0 +1,180 @@
+#include <jni.h>
+#include <stdio.h>
+#include <string.h>
+#include "JniCache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+JniCache gJniCache = {
+    { "java/lang/String", "([BLjava/lang/String;)V", NULL, NULL },
+    { "java/lang/String", "getBytes", "(Ljava/lang/String;)[B", NULL },
+    NULL,
+
+    { "org/openhome/net/core/Property$PropertyInitialised", "(Lorg/openhome/net/core/Property;JJ)V", NULL, NULL },
+    { "org/openhome/net/core/PropertyError", NULL, NULL, NULL },
+    { "org/openhome/net/controlpoint/ProxyError", "(ILjava/lang/String;)V", NULL, NULL },
+    { "org/openhome/net/device/DvProvider$PropertySetStatus", "(Lorg/openhome/net/device/DvProvider;II)V", NULL, NULL },
+
+    { "org/openhome/net/device/DvInvocation$InvocationStatusInt", "(Lorg/openhome/net/device/DvInvocation;II)V", NULL, NULL },
+    { "org/openhome/net/device/DvInvocation$InvocationStatusUint", "(Lorg/openhome/net/device/DvInvocation;JI)V", NULL, NULL },
+    { "org/openhome/net/device/DvInvocation$InvocationStatusBool", "(Lorg/openhome/net/device/DvInvocation;II)V", NULL, NULL },
+    { "org/openhome/net/device/DvInvocation$InvocationStatusString", "(Lorg/openhome/net/device/DvInvocation;Ljava/lang/String;I)V", NULL, NULL },
+    { "org/openhome/net/device/DvInvocation$InvocationStatusBinary", "(Lorg/openhome/net/device/DvInvocation;[BI)V", NULL, NULL },
+
+    { "org/openhome/net/controlpoint/IPropertyChangeListener", "notifyChange", "()V", NULL },
+    { "org/openhome/net/device/IDvInvocationListener", "actionInvoked", "(J)V", NULL },
+    { "org/openhome/net/controlpoint/Invocation", "asyncComplete", "(JJ)V", NULL },
+    { "org/openhome/net/controlpoint/CpDeviceList", "deviceAdded", "(J)V", NULL },
+    { "org/openhome/net/controlpoint/CpDeviceList", "deviceRemoved", "(J)V", NULL }
+};
+
+static jmethodID LookupMethod(JNIEnv *aEnv, jclass aClass, const char* aName, const char* aSignature)
+{
+    jmethodID mid = (*aEnv)->GetMethodID(aEnv, aClass, aName, aSignature);
+    if (mid == NULL) {
+        (*aEnv)->ExceptionClear(aEnv);
+        printf("JniCache: Unable to find method %s%s\n", aName, aSignature);
+        fflush(stdout);
+    }
+    return mid;
+}
+
+static void ReleaseClass(JNIEnv *aEnv, JniCacheClass* aClass)
+{
+    if (aClass->cls != NULL) {
+        (*aEnv)->DeleteGlobalRef(aEnv, aClass->cls);
+        aClass->cls = NULL;
+    }
+    aClass->ctor = NULL;
+}
+
+jclass JniCacheGetClass(JNIEnv *aEnv, JniCacheClass* aClass)
+{
+    jclass local;
+    if (aClass->cls != NULL) {
+        return aClass->cls;
+    }
+    local = (*aEnv)->FindClass(aEnv, aClass->name);
+    if (local == NULL) {
+        (*aEnv)->ExceptionClear(aEnv);
+        printf("JniCache: Unable to find class %s\n", aClass->name);
+        fflush(stdout);
+        return NULL;
+    }
+    // the class object is shared, so its monitor serialises threads racing to resolve it
+    (*aEnv)->MonitorEnter(aEnv, local);
+    if (aClass->cls == NULL) {
+        if (aClass->ctorSignature != NULL) {
+            aClass->ctor = LookupMethod(aEnv, local, "<init>", aClass->ctorSignature);
+        }
+        aClass->cls = (jclass)(*aEnv)->NewGlobalRef(aEnv, local);
+    }
+    (*aEnv)->MonitorExit(aEnv, local);
+    (*aEnv)->DeleteLocalRef(aEnv, local);
+    return aClass->cls;
+}
+
+jmethodID JniCacheGetCallback(JNIEnv *aEnv, JniCacheMethod* aMethod, jobject aCallbackObj)
+{
+    jclass cls;
+    jmethodID mid;
+    if (aMethod->mid != NULL) {
+        return aMethod->mid;
+    }
+    cls = (*aEnv)->FindClass(aEnv, aMethod->className);
+    if (cls != NULL) {
+        // every thread resolving this gets the same ID so there's no need to serialise them
+        aMethod->mid = LookupMethod(aEnv, cls, aMethod->name, aMethod->signature);
+        (*aEnv)->DeleteLocalRef(aEnv, cls);
+        return aMethod->mid;
+    }
+    (*aEnv)->ExceptionClear(aEnv);
+    cls = (*aEnv)->GetObjectClass(aEnv, aCallbackObj);
+    mid = (*aEnv)->GetMethodID(aEnv, cls, aMethod->name, aMethod->signature);
+    if (mid == NULL) {
+        (*aEnv)->ExceptionClear(aEnv);
+    }
+    (*aEnv)->DeleteLocalRef(aEnv, cls);
+    return mid;
+}
+
+static jclass GetStringClass(JNIEnv *aEnv)
+{
+    jstring utf8;
+    jclass cls = JniCacheGetClass(aEnv, &gJniCache.string);
+    if (cls == NULL || gJniCache.charsetUtf8 != NULL) {
+        return cls;
+    }
+    (*aEnv)->MonitorEnter(aEnv, cls);
+    if (gJniCache.charsetUtf8 == NULL) {
+        gJniCache.stringGetBytes.mid = LookupMethod(aEnv, cls, gJniCache.stringGetBytes.name, gJniCache.stringGetBytes.signature);
+        utf8 = (*aEnv)->NewStringUTF(aEnv, "UTF-8");
+        gJniCache.charsetUtf8 = (jstring)(*aEnv)->NewGlobalRef(aEnv, utf8);
+        (*aEnv)->DeleteLocalRef(aEnv, utf8);
+    }
+    (*aEnv)->MonitorExit(aEnv, cls);
+    return cls;
+}
+
+JNIEXPORT void JNICALL JNI_OnUnload(JavaVM *aVm, void *aReserved)
+{
+    JNIEnv *env;
+    JniCache *c = &gJniCache;
+    aReserved = aReserved;
+
+    if ((*aVm)->GetEnv(aVm, (void **)&env, JNI_VERSION_1_4) != JNI_OK) {
+        return;
+    }
+    ReleaseClass(env, &c->string);
+    c->stringGetBytes.mid = NULL;
+    if (c->charsetUtf8 != NULL) {
+        (*env)->DeleteGlobalRef(env, c->charsetUtf8);
+        c->charsetUtf8 = NULL;
+    }
+    ReleaseClass(env, &c->propertyInitialised);
+    ReleaseClass(env, &c->propertyError);
+    ReleaseClass(env, &c->proxyError);
+    ReleaseClass(env, &c->propertySetStatus);
+    ReleaseClass(env, &c->invocationStatusInt);
+    ReleaseClass(env, &c->invocationStatusUint);
+    ReleaseClass(env, &c->invocationStatusBool);
+    ReleaseClass(env, &c->invocationStatusString);
+    ReleaseClass(env, &c->invocationStatusBinary);
+    c->propertyChangeNotify.mid = NULL;
+    c->invocationActionInvoked.mid = NULL;
+    c->invocationAsyncComplete.mid = NULL;
+    c->deviceListDeviceAdded.mid = NULL;
+    c->deviceListDeviceRemoved.mid = NULL;
+}
+
+jstring JniCacheNewStringUtf8(JNIEnv *aEnv, const char* aData, uint32_t aLen)
+{
+    jbyteArray byteArray;
+    jstring str;
+    jclass cls = GetStringClass(aEnv);
+    if (cls == NULL || gJniCache.string.ctor == NULL) {
+        printf("Unable to find constructor for class java/lang/String\n");
+        return NULL;
+    }
+    byteArray = (*aEnv)->NewByteArray(aEnv, aLen);
+    (*aEnv)->SetByteArrayRegion(aEnv, byteArray, 0, aLen, (jbyte *)aData);
+    str = (jstring)(*aEnv)->NewObject(aEnv, cls, gJniCache.string.ctor, byteArray, gJniCache.charsetUtf8);
+    (*aEnv)->DeleteLocalRef(aEnv, byteArray);
+    return str;
+}
+
+jbyteArray JniCacheGetBytesUtf8(JNIEnv *aEnv, jstring aString)
+{
+    if (GetStringClass(aEnv) == NULL || gJniCache.stringGetBytes.mid == NULL) {
+        printf("Method ID \"getBytes()\" not found.\n");
+        fflush(stdout);
+        return NULL;
+    }
+    return (jbyteArray)(*aEnv)->CallObjectMethod(aEnv, aString, gJniCache.stringGetBytes.mid, gJniCache.charsetUtf8);
+}
+
+#ifdef __cplusplus
+}
+#endif
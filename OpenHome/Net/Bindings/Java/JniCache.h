@@ -0,0 +1,93 @@
+#ifndef HEADER_JNICACHE
+#define HEADER_JNICACHE
+
+#include <jni.h>
+#include <stdint.h>
+
+/**
+  * A class (held as a global ref) and, optionally, its constructor.
+  *
+  * Resolved by JniCacheGetClass on first use from a Java thread rather than in
+  * JNI_OnLoad, as FindClass there can initialise classes that are themselves
+  * still waiting on System.loadLibrary.
+  */
+typedef struct
+{
+    const char* name;
+    const char* ctorSignature;          /* NULL if the constructor isn't used */
+    jclass cls;
+    jmethodID ctor;
+} JniCacheClass;
+
+/**
+  * A callback method, identified by an interface or base class so that the ID is
+  * valid for any object implementing or extending it.
+  */
+typedef struct
+{
+    const char* className;
+    const char* name;
+    const char* signature;
+    jmethodID mid;
+} JniCacheMethod;
+
+/**
+  * Classes and method IDs used on the invocation, property and callback paths.
+  *
+  * Each member is resolved once, on first use, so that these paths don't need
+  * FindClass or GetMethodID on every call.  A class which can't be found is looked
+  * up again on its next use; callers report a failed lookup in the same way as
+  * they did before members were cached.
+  */
+typedef struct
+{
+    JniCacheClass string;               /* String(byte[], String) */
+    JniCacheMethod stringGetBytes;      /* String.getBytes(String) */
+    jstring charsetUtf8;                /* "UTF-8" */
+
+    JniCacheClass propertyInitialised;
+    JniCacheClass propertyError;
+    JniCacheClass proxyError;
+    JniCacheClass propertySetStatus;
+
+    JniCacheClass invocationStatusInt;
+    JniCacheClass invocationStatusUint;
+    JniCacheClass invocationStatusBool;
+    JniCacheClass invocationStatusString;
+    JniCacheClass invocationStatusBinary;
+
+    JniCacheMethod propertyChangeNotify;     /* IPropertyChangeListener.notifyChange() */
+    JniCacheMethod invocationActionInvoked;  /* IDvInvocationListener.actionInvoked(long) */
+    JniCacheMethod invocationAsyncComplete;  /* Invocation.asyncComplete(long, long) */
+    JniCacheMethod deviceListDeviceAdded;    /* CpDeviceList.deviceAdded(long) */
+    JniCacheMethod deviceListDeviceRemoved;  /* CpDeviceList.deviceRemoved(long) */
+} JniCache;
+
+extern JniCache gJniCache;
+
+/**
+  * Returns aClass's class, resolving it (and its constructor, if any) on first use.
+  * Returns NULL if the class can't be found; aClass->ctor is NULL if either lookup failed.
+  */
+jclass JniCacheGetClass(JNIEnv *aEnv, JniCacheClass* aClass);
+
+/**
+  * Returns the ID of aMethod for aCallbackObj, resolving it on first use.
+  * Callbacks may run on native threads whose class loader can't see aMethod's class;
+  * the ID is then looked up from aCallbackObj's own class for this call only.
+  */
+jmethodID JniCacheGetCallback(JNIEnv *aEnv, JniCacheMethod* aMethod, jobject aCallbackObj);
+
+/**
+  * Construct a java.lang.String from aLen bytes of UTF-8 data.
+  * Returns NULL if the String class couldn't be resolved.
+  */
+jstring JniCacheNewStringUtf8(JNIEnv *aEnv, const char* aData, uint32_t aLen);
+
+/**
+  * Encode aString as UTF-8.
+  * Returns NULL if String.getBytes couldn't be resolved.
+  */
+jbyteArray JniCacheGetBytesUtf8(JNIEnv *aEnv, jstring aString);
+
+#endif // HEADER_JNICACHE
@@ -7,6 +7,7 @@
 #include "Property.h"
 #include "PropertyCallback.h"
 #include "JniCallbackList.h"
+#include "JniCache.h"
 #include "OpenHome/Net/C/OhNet.h"
 #include "OpenHome/Net/C/Service.h"
 
@@ -19,7 +20,6 @@ void STDCALL ChangeCallback(void* aPtr)
     JniObjRef* ref = (JniObjRef*) aPtr;
     JavaVM *vm = ref->vm;
     JNIEnv *env;
-    jclass cls;
     jmethodID mid;
     jint ret;
     jint attached;
@@ -39,9 +39,7 @@ void STDCALL ChangeCallback(void* aPtr)
             return;
         }
     }
-    cls = (*env)->GetObjectClass(env, ref->callbackObj);
-    mid = (*env)->GetMethodID(env, cls, "notifyChange", "()V");
-    (*env)->DeleteLocalRef(env, cls);
+    mid = JniCacheGetCallback(env, &gJniCache.propertyChangeNotify, ref->callbackObj);
     if (mid == 0) {
         printf("PropertyJNI: Method ID notifyChange() not found.\n");
         return;
@@ -1,6 +1,7 @@
 #include <jni.h>
 #include <stdio.h>
 #include "PropertyCallback.h"
+#include "JniCache.h"
 #include "PropertyBool.h"
 #include "OpenHome/Net/C/OhNet.h"
 #include "OpenHome/Net/C/Service.h"
@@ -26,13 +27,8 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_core_PropertyBool_ServicePropert
 
     InitialiseReferences(aEnv, aListener, &ref);
 
-    statusClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/core/Property$PropertyInitialised");
-    if (statusClass == NULL)
-    {
-        printf("Unable to find class org/openhome/net/core/Property$PropertyInitialised\n");
-        return NULL;
-    }
-    cid = (*aEnv)->GetMethodID(aEnv, statusClass, "<init>", "(Lorg/openhome/net/core/Property;JJ)V");
+    statusClass = JniCacheGetClass(aEnv, &gJniCache.propertyInitialised);
+    cid = gJniCache.propertyInitialised.ctor;
     if (cid == NULL) {
         printf("Unable to find constructor for class org/openhome/net/core/Property$PropertyInitialised\n");
         return NULL;
@@ -77,7 +73,7 @@ JNIEXPORT jint JNICALL Java_org_openhome_net_core_PropertyBool_ServicePropertyVa
 
     result = ServicePropertyValueBool(property, &val);
     if (result != 0) {
-        jclass errorClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/core/PropertyError");
+        jclass errorClass = JniCacheGetClass(aEnv, &gJniCache.propertyError);
         if (errorClass == NULL) {
             printf("Unable to find class org/openhome/net/core/PropertyError\n");
         } else {
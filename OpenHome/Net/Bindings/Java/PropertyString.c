@@ -1,6 +1,7 @@
 #include <jni.h>
 #include <stdio.h>
 #include "PropertyCallback.h"
+#include "JniCache.h"
 #include "PropertyString.h"
 #include "OpenHome/Net/C/OhNet.h"
 #include "OpenHome/Net/C/Service.h"
@@ -26,13 +27,8 @@ JNIEXPORT jobject JNICALL Java_org_openhome_net_core_PropertyString_ServicePrope
 
 	InitialiseReferences(aEnv, aListener, &ref);
 
-	statusClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/core/Property$PropertyInitialised");
-	if (statusClass == NULL)
-	{
-		printf("Unable to find class org/openhome/net/core/Property$PropertyInitialised\n");
-		return NULL;
-	}
-	cid = (*aEnv)->GetMethodID(aEnv, statusClass, "<init>", "(Lorg/openhome/net/core/Property;JJ)V");
+	statusClass = JniCacheGetClass(aEnv, &gJniCache.propertyInitialised);
+	cid = gJniCache.propertyInitialised.ctor;
 	if (cid == NULL) {
 		printf("Unable to find constructor for class org/openhome/net/core/Property$PropertyInitialised\n");
         return NULL;
@@ -71,35 +67,18 @@ JNIEXPORT jstring JNICALL Java_org_openhome_net_core_PropertyString_ServicePrope
   (JNIEnv *aEnv, jclass aClass, jlong aProperty)
 {
 	ServiceProperty property = (ServiceProperty) (size_t)aProperty;
-    jclass stringClass;
-    jmethodID cidString;
     const char* value;
     uint32_t len;
-    jbyteArray byteArray;
-    jstring utf8;
     jstring valueJava;
     int result;
     aClass = aClass;
 
     result = ServicePropertyGetValueString(property, &value, &len);
     if (result == 0) {
-        stringClass = (*aEnv)->FindClass(aEnv, "java/lang/String");
-        if (stringClass == NULL) {
-            printf("Unable to find class java/lang/String\n");
-            return NULL;
-        }
-        cidString = (*aEnv)->GetMethodID(aEnv, stringClass, "<init>", "([BLjava/lang/String;)V");
-        if (cidString == NULL) {
-            printf("Unable to find constructor for class java/lang/String\n");
-            return NULL;
-        }
-        byteArray = (*aEnv)->NewByteArray(aEnv, len);
-        (*aEnv)->SetByteArrayRegion(aEnv, byteArray, 0, len, (jbyte *) value);
-        utf8 = (*aEnv)->NewStringUTF(aEnv, "UTF-8");
-        valueJava = (*aEnv)->NewObject(aEnv, stringClass, cidString, byteArray, utf8);
+        valueJava = JniCacheNewStringUtf8(aEnv, value, len);
     }
     else {
-        jclass errorClass = (*aEnv)->FindClass(aEnv, "org/openhome/net/core/PropertyError");
+        jclass errorClass = JniCacheGetClass(aEnv, &gJniCache.propertyError);
         if (errorClass == NULL) {
             printf("Unable to find class org/openhome/net/core/PropertyError\n");
         }
@@ -122,22 +101,15 @@ JNIEXPORT jint JNICALL Java_org_openhome_net_core_PropertyString_ServiceProperty
 {
 	ServiceProperty property = (ServiceProperty) (size_t)aProperty;
 	jint result;
-    jclass cls = (*aEnv)->GetObjectClass(aEnv, aValue); // local ref will be deleted when method returns
-    jmethodID mid;
-    jstring utf8;
     jbyteArray byteArray;
     jbyte *data;
     jsize len;
     aClass = aClass;
 
-    mid = (*aEnv)->GetMethodID(aEnv, cls, "getBytes", "(Ljava/lang/String;)[B");
-    if (mid == 0) {
-        printf("PropertyStringJNI: Method ID \"getBytes()\" not found.\n");
-        fflush(stdout);
+    byteArray = JniCacheGetBytesUtf8(aEnv, aValue);
+    if (byteArray == NULL) {
         return 1; // error
     }
-    utf8 = (*aEnv)->NewStringUTF(aEnv, "UTF-8");
-    byteArray = (*aEnv)->CallObjectMethod(aEnv, aValue, mid, utf8);
     len = (*aEnv)->GetArrayLength(aEnv, byteArray);
     data = (*aEnv)->GetByteArrayElements(aEnv, byteArray, NULL);
     result = ServicePropertySetValueStringAsBuffer(property, (char *)data, len);
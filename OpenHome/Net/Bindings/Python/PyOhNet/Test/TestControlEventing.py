@@ -187,6 +187,16 @@ class TestControlEventing:
         self._CheckSetGet( 'Multiple:VarInt', val2, res['ValueInt'], self.evVarInt )
         self._CheckSetGet( 'Multiple:VarInt', bool1, res['ValueBool'], None )
 
+        snapshot = self.testBasic.Snapshot()
+        print( '\nSnapshot returned --> %s' % snapshot )
+        self._CheckSetGet( 'Snapshot:VarUint', val1, snapshot['VarUint'] )
+        self._CheckSetGet( 'Snapshot:VarInt', val2, snapshot['VarInt'] )
+        self._CheckSetGet( 'Snapshot:VarBool', bool1, snapshot['VarBool'] )
+        self._CheckSetGet( 'Snapshot:VarStr', string, snapshot['VarStr'] )
+        self._CheckSetGet( 'Snapshot:VarBin', randomData, snapshot['VarBin'] )
+        snapshot = self.testBasic.Snapshot( ['VarInt'] )
+        self._CheckSetGet( 'Snapshot(VarInt):VarInt', val2, snapshot['VarInt'] )
+
         # ==== Combined actions ====
 
         res = self.testBasic.SyncIncrement( 42 )
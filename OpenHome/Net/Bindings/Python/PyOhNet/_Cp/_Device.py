@@ -2,8 +2,11 @@
 """
 import PyOhNet
 import ctypes
+import hashlib
+import os
 import re
 import sys
+import threading
 import types
 import xml.etree.ElementTree as ET
 import _Cp._GenProxy as GenProxy
@@ -18,6 +21,77 @@ except:
     from urllib.request import urlopen
 
 
+kMaxConcurrentFetches = 8       # max service XML fetches in progress at once per device
+kFetchTimeoutSecs     = 10      # give up on a service XML fetch after this long
+
+# Generated proxy modules, keyed by (service type, hash of service XML). Different
+# implementations of a service type may publish differing service XML, so the XML
+# itself (not just the type and version) identifies the proxy to use.
+_proxyModules   = {}
+_proxyCacheLock = threading.Lock()
+_proxyCacheDir  = None
+
+
+def _GeneratorDigest():
+    """Hash of the proxy generator's source, so that cached proxies are regenerated when it changes"""
+    path = os.path.splitext( GenProxy.__file__ )[0] + '.py'
+    try:
+        with open( path, 'rb' ) as f:
+            return hashlib.sha1( f.read() ).hexdigest()[:12]
+    except (IOError, OSError):
+        # no source (e.g. frozen install) - fall back to the compiled module
+        with open( GenProxy.__file__, 'rb' ) as f:
+            return hashlib.sha1( f.read() ).hexdigest()[:12]
+
+_generatorDigest = _GeneratorDigest()
+
+
+def SetProxyCacheDir( aPath ):
+    """Also cache generated proxy code in the specified directory (None to disable),
+       so that each service definition is only ever parsed once per machine"""
+    global _proxyCacheDir
+    if aPath is not None and not os.path.isdir( aPath ):
+        os.makedirs( aPath )
+    _proxyCacheDir = aPath
+
+
+def _ProxyText( aType, aProxyName, aXml, aDigest ):
+    """Return generated proxy code, reading from/writing to the disk cache if enabled"""
+    cacheDir = _proxyCacheDir
+    if cacheDir is None:
+        return GenProxy.GenProxy( aType, aXml ).text
+    path = os.path.join( cacheDir, '%s_%s_%s.py' % (aProxyName, aDigest, _generatorDigest) )
+    if os.path.isfile( path ):
+        with open( path, 'rb' ) as f:
+            return f.read().decode( 'utf8' )
+    text = GenProxy.GenProxy( aType, aXml ).text
+    # write then rename so that other processes sharing the cache never see partial files
+    tmpPath = '%s.%d.%d.tmp' % (path, os.getpid(), threading.current_thread().ident)
+    with open( tmpPath, 'wb' ) as f:
+        f.write( text.encode( 'utf8' ))
+    try:
+        os.rename( tmpPath, path )
+    except OSError:
+        os.remove( tmpPath )    # another process got there first (Windows won't replace)
+    return text
+
+
+def _ProxyModule( aType, aProxyName, aXml ):
+    """Return module containing the proxy for the given service XML, generating it on first use"""
+    digest = hashlib.sha1( aXml ).hexdigest()
+    key = (aType, digest)
+    with _proxyCacheLock:
+        if key in _proxyModules:
+            return _proxyModules[key]
+    text = _ProxyText( aType, aProxyName, aXml, digest )
+    proxyModule = types.ModuleType( aProxyName )
+    exec( text, proxyModule.__dict__ )
+    with _proxyCacheLock:
+        proxyModule = _proxyModules.setdefault( key, proxyModule )
+        sys.modules[aProxyName] = proxyModule
+    return proxyModule
+
+
 class Device():
     """UPnP Device (from perspective of a control point)"""
 
@@ -72,9 +146,34 @@ class Device():
                 result.append( {'type': svType, 'url': url, 'domain': domainName, 'name': name, 'version': int( version )} )
         return result
 
-    # noinspection PyUnusedLocal
+    @staticmethod
+    def _FetchServiceXml( aServices ):
+        """Fetch service XML for all services, several at a time. Stored as aService['xml']"""
+        pending = list( aServices )
+        lock = threading.Lock()
+
+        def Fetch():
+            while True:
+                with lock:
+                    if not pending:
+                        return
+                    service = pending.pop( 0 )
+                try:
+                    service['xml'] = urlopen( service['url'], timeout=kFetchTimeoutSecs ).read()
+                except Exception as e:
+                    service['error'] = e
+
+        threads = []
+        for i in range( min( kMaxConcurrentFetches, len( pending ))):
+            thread = threading.Thread( target=Fetch )
+            thread.daemon = True
+            thread.start()
+            threads.append( thread )
+        for thread in threads:
+            thread.join()
+
     def _AddProxy( self, aService ):
-        """Generate and add proxy for specified service"""
+        """Add proxy for specified service, using service XML fetched by _FetchServiceXml"""
         # The proxy code is auto-generated (from the service XML) and then
         # imported and added as a class attribute to the device. Named as
         # 'DomainService'. All ohNet proxy actions and properties are
@@ -86,44 +185,15 @@ class Device():
         proxyName = 'CpProxy%s%s%s' % \
             (aService['domain'], aService['name'][0].upper() + aService['name'][1:], aService['version'])
 
-        # generate the proxy from the service XML
-        serviceXml = urlopen( aService['url'] ).read()  # <<<<<<<<<==================================== This is failure point in discovery
-                                                        # we get list of services back from ohnet, but fail to open URL for FIRST service
-                                                        # so cannot create proxy (and everything eventually times out). No idea why - most
-                                                        # likely product doesn't respond for whatever reason. Pissing around with delays
-                                                        # doesn't seem to help much (adding prints did a bit, so some delays somewhere will
-                                                        # probably reduce this) 
-        proxy = GenProxy.GenProxy( aService['type'], serviceXml )
-
-        # 'import' the generated proxies
-        # we always rebuild the module with the most recently read service
-        # definition, as service implementation details can vary between
-        # different implementations of the same same services. More efficient
-        # to only build module on first request and re-use it, but this DOES
-        # give issues in case described above
-        if proxyName in sys.modules.keys():
-            proxyModule = sys.modules[proxyName]
-        else:
-            proxyModule = types.ModuleType( proxyName )
-            sys.modules[proxyName] = proxyModule
-        exec( proxy.text, proxyModule.__dict__ )
-
-        # # FOR DEBUG - write generated proxies to, and import from file
-        # #             NOTE - no mutex protection on file access, so do NOT use this
-        # #                    technique except when debugging is necessary
-        # import os
-        # head, tail = os.path.split( os.path.dirname( __file__ ))
-        # proxyDir = os.path.join( head, '.GeneratedProxies' )
-        # if not os.path.exists( proxyDir ):
-        #     os.mkdir( proxyDir )
-        # if proxyDir not in sys.path:
-        #     sys.path.append( proxyDir )
-        # proxyPath = os.path.join( proxyDir, proxyName + '.py' )
-        # proxy.Write( proxyPath )
-        # exec( 'import %s as proxyModule' % proxyName )
+        if 'error' in aService:
+            # failure to fetch the service XML has been seen with some products - we get
+            # the list of services back from ohNet but the SCPD URL doesn't respond
+            raise PyOhNet.OhNetError( 'Failed to fetch service XML for %s from %s - %s' %
+                                      (aService['type'], aService['url'], aService['error'] ))
+        proxyModule = _ProxyModule( aService['type'], proxyName, aService['xml'] )
 
         # add to list of available proxies
-        setattr( self, attrName, eval( 'proxyModule.%s( self )' % proxyName ))
+        setattr( self, attrName, getattr( proxyModule, proxyName )( self ))
         self.proxies.append( attrName )
 
     def _GetUdn( self ):
@@ -149,10 +219,11 @@ class Device():
         """Start device - add proxies for all or specified services on device"""
         if not aProxies:
             aProxies = ['all']
-        services = self._GetServices()
+        services = [service for service in self._GetServices()
+                    if service['name'] in aProxies or 'all' in aProxies]
+        self._FetchServiceXml( services )
         for service in services:
-            if service['name'] in aProxies or 'all' in aProxies:
-                self._AddProxy( service )
+            self._AddProxy( service )
 
     def Shutdown( self ):
         if self.handle:
@@ -3,6 +3,7 @@
 import abc
 import copy
 import ctypes
+import struct
 import PyOhNet
 
 
@@ -21,6 +22,11 @@ class Property:
         msg = '      %s' % self.name
         return msg
 
+    @abc.abstractmethod
+    def FromSnapshot( self, aData ):
+        """Convert this property's bytes from CpProxyPropertySnapshot to a value"""
+        pass
+
 
 class PropertyInt( Property ):
 
@@ -34,6 +40,11 @@ class PropertyInt( Property ):
         self.lib.ServicePropertyValueInt( self.handle, ctypes.byref( val ) )
         return val.value
 
+    def FromSnapshot( self, aData ):
+        if len( aData ) == 0:
+            return 0
+        return struct.unpack( '=i', aData )[0]
+
     def SetValue( self, aValue ):
         changed = self.lib.ServicePropertySetValueInt( self.handle, aValue )
         return changed != 0
@@ -51,6 +62,11 @@ class PropertyUint( Property ):
         self.lib.ServicePropertyValueUint( self.handle, ctypes.byref( val ) )
         return val.value
 
+    def FromSnapshot( self, aData ):
+        if len( aData ) == 0:
+            return 0
+        return struct.unpack( '=I', aData )[0]
+
     def SetValue( self, aValue ):
         changed = self.lib.ServicePropertySetValueUint( self.handle, aValue )
         return changed != 0
@@ -68,6 +84,11 @@ class PropertyBool( Property ):
         self.lib.ServicePropertyValueBool( self.handle, ctypes.byref( val ) )
         return val.value != 0
 
+    def FromSnapshot( self, aData ):
+        if len( aData ) == 0:
+            return False
+        return struct.unpack( '=I', aData )[0] != 0
+
     def SetValue( self, aValue ):
         val = 0
         if aValue:
@@ -93,6 +114,9 @@ class PropertyString( Property ):
         self.lib.OhNetFree( strn )
         return string
 
+    def FromSnapshot( self, aData ):
+        return aData.decode( 'utf8', 'replace' )
+
     def SetValue( self, aValue ):
         val = ctypes.c_char_p( aValue.encode( 'utf8', 'replace' ))
         changed = self.lib.ServicePropertySetValueString( self.handle, val )
@@ -118,6 +142,9 @@ class PropertyBinary( Property ):
         self.lib.OhNetFree( pBytes )
         return binary
 
+    def FromSnapshot( self, aData ):
+        return list( bytearray( aData ))
+
     def SetValue( self, aValue ):
         val = ctypes.c_void_p( aValue )
         length = len( aValue )
@@ -295,8 +295,7 @@ class GenProxy:
         msg += '\n    # ---- Property Changed callbacks ----\n'
         for prop in aProperties:
             msg += '\n    def _%sPropertyChanged( self, aDummy ):\n' % prop['name']
-            msg += '        if self._property%sCb is not None:\n' % prop['name']
-            msg += '            self._property%sCb()\n' % prop['name']
+            msg += '        self._EventCallback( self._property%sCb )\n' % prop['name']
         msg += '\n'
         return msg
 
@@ -23,6 +23,9 @@ class Proxy():
         self.actions         = []
         self.properties      = []
         self.semaReady       = threading.Semaphore( 0 )   # Sema rather than Event as can be multiple
+        self._snapshotLock   = threading.Lock()
+        self._snapshotBuf    = ctypes.create_string_buffer( 1024 )
+        self._eventValues    = threading.local()          # per-callback snapshot (see _EventCallback)
         CB = PyOhNet.makeCb( None, ctypes.c_void_p )      # actions ongoing at any time
         self._AnyEvent = CB( self._AnyEventCb )
         CB = PyOhNet.makeCb( None, ctypes.c_void_p )
@@ -47,18 +50,33 @@ class Proxy():
         self.properties.append( aProperty )
 
     def _PropertyValue( self, aProperty ):
+        if getattr( self._eventValues, 'active', False ):
+            # inside an event callback - values can't change until it returns, so
+            # read them all in one call and serve later reads from that snapshot
+            if self._eventValues.values is None:
+                self._eventValues.values = self.Snapshot()
+            return self._eventValues.values[aProperty.name]
         self.lib.CpProxyPropertyReadLock( self.handle )
         val = aProperty.Value()
         self.lib.CpProxyPropertyReadUnlock( self.handle )
         return val
 
+    def _EventCallback( self, aCb ):
+        if aCb is None:
+            return
+        self._eventValues.active = True
+        self._eventValues.values = None
+        try:
+            aCb()
+        finally:
+            self._eventValues.active = False
+            self._eventValues.values = None
+
     def _AnyEventCb( self, aDummy ):
-        if self._propertyAnyCb is not None:
-            self._propertyAnyCb()
+        self._EventCallback( self._propertyAnyCb )
 
     def _InitEventCb( self, aDummy ):
-        if self._propertyInitCb is not None:
-            self._propertyInitCb()
+        self._EventCallback( self._propertyInitCb )
 
     def _Str( self, aName=None ):
         msg = '  %s' % aName
@@ -80,6 +98,32 @@ class Proxy():
     def Unsubscribe( self ):
         self.lib.CpProxyUnsubscribe( self.handle )
 
+    def Snapshot( self, aNames=None ):
+        """Return a dict of property name -> value, read with a single call into ohNet.
+           aNames optionally restricts the snapshot to the named properties"""
+        if aNames is None:
+            props = self.properties
+        else:
+            byName = dict( (prop.name, prop) for prop in self.properties )
+            props = [byName[name] for name in aNames]
+        count = len( props )
+        if count == 0:
+            return {}
+        handles = (ctypes.c_void_p * count)( *[prop.handle.value for prop in props] )
+        offsets = (ctypes.c_uint32 * (count+1))()
+        with self._snapshotLock:
+            while True:
+                bufBytes = len( self._snapshotBuf )
+                needed = self.lib.CpProxyPropertySnapshot( self.handle, handles, count, self._snapshotBuf, bufBytes, offsets )
+                if needed <= bufBytes:
+                    break
+                self._snapshotBuf = ctypes.create_string_buffer( needed )
+            data = ctypes.string_at( self._snapshotBuf, needed )
+        values = {}
+        for i in range( count ):
+            values[props[i].name] = props[i].FromSnapshot( data[offsets[i]:offsets[i+1]] )
+        return values
+
     def SetPropertyChanged( self, aCb ):
         self._propertyAnyCb = aCb
         self.lib.CpProxySetPropertyChanged( self.handle, self._AnyEvent, None )
@@ -8,6 +8,7 @@
 #include <OpenHome/Net/Core/CpProxy.h>
 #include <OpenHome/Net/Private/Error.h>
 #include <OpenHome/Net/Private/CpiSubscription.h>
+#include <OpenHome/Private/Metrics.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -189,6 +190,11 @@ void ArgumentString::TransferTo(Brh& aBrh)
     iValue.TransferTo(aBrh);
 }
 
+void ArgumentString::TransferTo(Brhz& aBrhz)
+{
+    iValue.TransferTo(aBrhz);
+}
+
 void ArgumentString::ProcessInput(IInputArgumentProcessor& aProcessor)
 {
     aProcessor.ProcessString(iValue);
@@ -627,118 +633,29 @@ void OpenHome::Net::Invocation::Clear()
 }
 
 
-// Invoker
-
-Invoker::Invoker(const TChar* aName, Fifo<Invoker*>& aFree)
-    : Thread(aName)
-    , iFree(aFree)
-    , iInvocation(NULL)
-    , iLock("MVOK")
-{
-}
-
-Invoker::~Invoker()
-{
-    Kill();
-    Join();
-}
-
-void Invoker::Invoke(Invocation* aInvocation)
-{
-    iLock.Wait();
-    iInvocation = aInvocation;
-    iLock.Signal();
-    Signal();
-}
-
-void Invoker::Interrupt(const Service& aService)
-{
-    AutoMutex a(iLock);
-    if (iInvocation != NULL) {
-        iInvocation->Interrupt(aService);
-    }
-}
-
-void Invoker::SetError(Error::ELevel aLevel, TUint aCode, const Brx& aDescription, const TChar* aLogStr)
-{
-    iInvocation->SetError(aLevel, aCode, aDescription);
-    // the above error details might be ignored if an earlier (presumed more detailed) error had been set
-    Error::ELevel level = Error::eNone;
-    TUint code = 0;
-    const TChar* desc = NULL;
-    (void)iInvocation->Error(level, code, desc);
-    const Brx& actionName = iInvocation->Action().Name();
-    const Brx& udn = iInvocation->Device().Udn();
-    LOG_ERROR(kService, "Error - %s(%s, %d, %s) - from invocation %p, on action %.*s, from device %.*s\n",
-        aLogStr, Error::LevelName(level), code, (desc==NULL? "" : desc), iInvocation, PBUF(actionName), PBUF(udn));
-}
-
-void Invoker::Run()
-{
-    for (;;) {
-        Wait();
-        try {
-            const Brx& actionName = iInvocation->Action().Name();
-            LOG(kService, "Invoker::Run (%s %p), action %.*s, device %.*s\n",
-                          (const TChar*)Name().Ptr(), iInvocation, PBUF(actionName), PBUF(iInvocation->Udn()));
-            iInvocation->Invoker().InvokeAction(*iInvocation);
-        }
-        catch (HttpError&) {
-            SetError(Error::eHttp, Error::kCodeUnknown, Error::kDescriptionUnknown, "Http");
-        }
-        catch (UriError&) {
-            SetError(Error::eHttp, Error::kCodeUnknown, Error::kDescriptionUnknown, "Uri");
-        }
-        catch (NetworkError&) {
-            SetError(Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown, "Network");
-        }
-        catch (NetworkTimeout&) {
-            SetError(Error::eSocket, Error::eCodeTimeout, Error::kDescriptionSocketTimeout, "NetworkTimeout");
-        }
-        catch (ReaderError&) {
-            SetError(Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown, "Reader");
-        }
-        catch (WriterError&) {
-            SetError(Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown, "Writer");
-        }
-        catch (ParameterValidationError&) {
-            SetError(Error::eService, Error::eCodeParameterInvalid, Error::kDescriptionParameterInvalid, "Parameter");
-        }
-        iLock.Wait();
-        iInvocation->SignalCompleted();
-        iInvocation = NULL;
-        iLock.Signal();
-        iFree.Write(this);
-    }
-}
-
-
 // InvocationManager
 
 InvocationManager::InvocationManager(CpStack& aCpStack)
-    : Thread("InvocationManager")
-    , iCpStack(aCpStack)
+    : iCpStack(aCpStack)
     , iLock("INVM")
-    , iFreeInvocations(aCpStack.Env().InitParams()->NumInvocations())
-    , iWaitingInvocations(aCpStack.Env().InitParams()->NumInvocations())
-    , iFreeInvokers(aCpStack.Env().InitParams()->NumActionInvokerThreads())
-{
-    TUint i;
-    iInvokers = (Invoker**)malloc(sizeof(*iInvokers) * iCpStack.Env().InitParams()->NumActionInvokerThreads());
-    for (i=0; i<iCpStack.Env().InitParams()->NumActionInvokerThreads(); i++) {
-        Bws<Thread::kMaxNameBytes+1> thName;
-        thName.AppendPrintf("ActionInvoker %d", i);
-        thName.PtrZ();
-        iInvokers[i] = new Invoker((const TChar*)thName.Ptr(), iFreeInvokers);
-        iFreeInvokers.Write(iInvokers[i]);
-        iInvokers[i]->Start();
-    }
-
-    for (i=0; i<iCpStack.Env().InitParams()->NumInvocations(); i++) {
+    , iActiveLock("INVA")
+    , iNumInvocations(aCpStack.Env().InitParams()->NumInvocations())
+    , iMaxInvocations(MaxInvocations(*aCpStack.Env().InitParams()))
+    , iFreeInvocations(iMaxInvocations)
+    , iWaitingInvocations(iMaxInvocations)
+    , iActive(true)
+    , iMetricWaiting(aCpStack.Env().Metrics().Gauge("ohnet_cp_invocations_waiting", "Invocations queued awaiting a free invoker thread"))
+    , iMetricInvocations(aCpStack.Env().Metrics().Counter("ohnet_cp_invocations_total", "Actions invoked by the control point stack"))
+    , iMetricErrors(aCpStack.Env().Metrics().Counter("ohnet_cp_invocation_errors_total", "Control point action invocations which failed"))
+    , iMetricLatency(aCpStack.Env().Metrics().Histogram("ohnet_cp_invocation_seconds", "Time taken to invoke an action on a remote device"))
+{
+    for (TUint i=0; i<iNumInvocations; i++) {
         iFreeInvocations.Write(new OpenHome::Net::Invocation(iCpStack, iFreeInvocations));
     }
-    iActive = true;
-    Start();
+    InitialisationParams* initParams = iCpStack.Env().InitParams();
+    TUint maxThreads, idleTimeoutMs;
+    initParams->GetWorkerPoolLimits(InitialisationParams::eWorkerPoolActionInvoker, maxThreads, idleTimeoutMs);
+    iInvokers = new WorkerPool(iCpStack.Env(), "ActionInvoker", *this, initParams->NumActionInvokerThreads(), maxThreads, idleTimeoutMs);
 }
 
 InvocationManager::~InvocationManager()
@@ -747,28 +664,49 @@ InvocationManager::~InvocationManager()
     iActive = false;
     iLock.Signal();
 
-    iFreeInvokers.ReadInterrupt();
-    Kill();
-    Join();
+    delete iInvokers;
 
-    TUint i;
-    for (i=0; i<iCpStack.Env().InitParams()->NumActionInvokerThreads(); i++) {
-        delete iInvokers[i];
+    while (iWaitingInvocations.SlotsUsed() > 0) {
+        OpenHome::Net::Invocation* invocation = iWaitingInvocations.Read();
+        iMetricWaiting.Dec();
+        invocation->SetError(Error::eAsync,
+                             Error::eCodeShutdown,
+                             Error::kDescriptionAsyncShutdown);
+        invocation->SignalCompleted();
     }
-    free(iInvokers);
 
-    for (i=0; i<iCpStack.Env().InitParams()->NumInvocations(); i++) {
+    for (TUint i=0; i<iNumInvocations; i++) {
         OpenHome::Net::Invocation* invocation = iFreeInvocations.Read();
         delete invocation;
     }
 }
 
+TUint InvocationManager::MaxInvocations(InitialisationParams& aInitParams)
+{ // static
+    // keep the configured ratio of invocations to invoker threads as the invoker pool grows
+    TUint maxThreads, idleTimeoutMs;
+    aInitParams.GetWorkerPoolLimits(InitialisationParams::eWorkerPoolActionInvoker, maxThreads, idleTimeoutMs);
+    const TUint numThreads = aInitParams.NumActionInvokerThreads();
+    const TUint numInvocations = aInitParams.NumInvocations();
+    if (maxThreads <= numThreads) {
+        return numInvocations;
+    }
+    return (TUint)(((TUint64)numInvocations * maxThreads) / numThreads);
+}
+
 OpenHome::Net::Invocation* InvocationManager::Invocation()
 {
-    AutoMutex a(iLock);
+    iLock.Wait();
     if (!iActive) {
+        iLock.Signal();
         return NULL;
     }
+    if (iFreeInvocations.SlotsUsed() == 0 && iNumInvocations < iMaxInvocations) {
+        iNumInvocations++;
+        iLock.Signal();
+        return new OpenHome::Net::Invocation(iCpStack, iFreeInvocations);
+    }
+    iLock.Signal();
     return iFreeInvocations.Read();
 }
 
@@ -778,46 +716,101 @@ void InvocationManager::Invoke(OpenHome::Net::Invocation* aInvocation)
     if (asyncBeginHandler) {
         asyncBeginHandler(*aInvocation);
     }
+    iMetricWaiting.Inc();
     iWaitingInvocations.Write(aInvocation);
-    Signal();
+    iInvokers->JobAdded();
+}
+
+void InvocationManager::InvokeOnCallerThread(OpenHome::Net::Invocation* aInvocation)
+{
+    FunctorAsync& asyncBeginHandler = iCpStack.Env().InitParams()->AsyncBeginHandler();
+    if (asyncBeginHandler) {
+        asyncBeginHandler(*aInvocation);
+    }
+    Process(aInvocation);
 }
 
 void InvocationManager::Interrupt(const Service& aService)
 {
-    const TUint numThreads = iCpStack.Env().InitParams()->NumActionInvokerThreads();
-    for (TUint i=0; i<numThreads; i++) {
-        iInvokers[i]->Interrupt(aService);
+    AutoMutex a(iActiveLock);
+    for (std::list<OpenHome::Net::Invocation*>::iterator it=iActiveInvocations.begin(); it!=iActiveInvocations.end(); ++it) {
+        (*it)->Interrupt(aService);
     }
 }
 
-void InvocationManager::Run()
+void InvocationManager::SetError(OpenHome::Net::Invocation& aInvocation, Error::ELevel aLevel, TUint aCode, const Brx& aDescription, const TChar* aLogStr)
 {
-    for (;;) {
-        Wait();
-        OpenHome::Net::Invocation* invocation = NULL;
-        try {
-            invocation = iWaitingInvocations.Read();
-            if (invocation->Interrupt()) {
-                // the service associated with this invocation is being deleted
-                // complete it with an error immediately and process the next waiting
-                invocation->SetError(Error::eAsync,
-                                     Error::eCodeInterrupted,
-                                     Error::kDescriptionAsyncInterrupted);
-                invocation->SignalCompleted();
-            }
-            else {
-                Invoker* invoker = iFreeInvokers.Read();
-                invoker->Invoke(invocation);
-            }
-        }
-        catch (FifoReadError&) {
-            if (invocation != NULL) {
-                invocation->SetError(Error::eAsync,
-                                     Error::eCodeShutdown,
-                                     Error::kDescriptionAsyncShutdown);
-                invocation->SignalCompleted();
-            }
-            break;
-        }
+    iMetricErrors.Inc();
+    aInvocation.SetError(aLevel, aCode, aDescription);
+    // the above error details might be ignored if an earlier (presumed more detailed) error had been set
+    Error::ELevel level = Error::eNone;
+    TUint code = 0;
+    const TChar* desc = NULL;
+    (void)aInvocation.Error(level, code, desc);
+    const Brx& actionName = aInvocation.Action().Name();
+    const Brx& udn = aInvocation.Device().Udn();
+    LOG_ERROR(kService, "Error - %s(%s, %d, %s) - from invocation %p, on action %.*s, from device %.*s\n",
+        aLogStr, Error::LevelName(level), code, (desc==NULL? "" : desc), &aInvocation, PBUF(actionName), PBUF(udn));
+}
+
+void InvocationManager::RunInvocation(OpenHome::Net::Invocation& aInvocation)
+{
+    iMetricInvocations.Inc();
+    AutoMetricTimer _(iCpStack.Env(), iMetricLatency);
+    try {
+        const Brx& actionName = aInvocation.Action().Name();
+        LOG(kService, "InvocationManager::RunInvocation (%.*s %p), action %.*s, device %.*s\n",
+                      PBUF(Thread::CurrentThreadName()), &aInvocation, PBUF(actionName), PBUF(aInvocation.Udn()));
+        aInvocation.Invoker().InvokeAction(aInvocation);
+    }
+    catch (HttpError&) {
+        SetError(aInvocation, Error::eHttp, Error::kCodeUnknown, Error::kDescriptionUnknown, "Http");
+    }
+    catch (UriError&) {
+        SetError(aInvocation, Error::eHttp, Error::kCodeUnknown, Error::kDescriptionUnknown, "Uri");
+    }
+    catch (NetworkError&) {
+        SetError(aInvocation, Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown, "Network");
+    }
+    catch (NetworkTimeout&) {
+        SetError(aInvocation, Error::eSocket, Error::eCodeTimeout, Error::kDescriptionSocketTimeout, "NetworkTimeout");
+    }
+    catch (ReaderError&) {
+        SetError(aInvocation, Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown, "Reader");
+    }
+    catch (WriterError&) {
+        SetError(aInvocation, Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown, "Writer");
+    }
+    catch (ParameterValidationError&) {
+        SetError(aInvocation, Error::eService, Error::eCodeParameterInvalid, Error::kDescriptionParameterInvalid, "Parameter");
+    }
+}
+
+void InvocationManager::ProcessJob()
+{
+    OpenHome::Net::Invocation* invocation = iWaitingInvocations.Read();
+    iMetricWaiting.Dec();
+    Process(invocation);
+}
+
+void InvocationManager::Process(OpenHome::Net::Invocation* aInvocation)
+{
+    if (aInvocation->Interrupt()) {
+        // the service associated with this invocation is being deleted
+        // complete it with an error immediately
+        aInvocation->SetError(Error::eAsync,
+                              Error::eCodeInterrupted,
+                              Error::kDescriptionAsyncInterrupted);
+        aInvocation->SignalCompleted();
+        return;
     }
+    iActiveLock.Wait();
+    iActiveInvocations.push_back(aInvocation);
+    iActiveLock.Signal();
+    RunInvocation(*aInvocation);
+    // stop Interrupt() reaching this invocation before it completes and is recycled
+    iActiveLock.Wait();
+    iActiveInvocations.remove(aInvocation);
+    iActiveLock.Signal();
+    aInvocation->SignalCompleted();
 }
@@ -17,6 +17,7 @@
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Private/Fifo.h>
 #include <OpenHome/Private/Timer.h>
+#include <OpenHome/Private/WorkerPool.h>
 #include <OpenHome/Functor.h>
 #include <OpenHome/Net/Private/AsyncPrivate.h>
 #include <OpenHome/Net/Private/Error.h>
@@ -25,8 +26,14 @@
 
 #include <vector>
 #include <map>
+#include <list>
 
 namespace OpenHome {
+
+class MetricCounter;
+class MetricGauge;
+class MetricHistogram;
+
 namespace Net {
 
 class Invocation;
@@ -172,6 +179,7 @@ public:
     DllExport ~ArgumentString();
     DllExport const Brx& Value() const;
     DllExport void TransferTo(Brh& aBrh);
+    void TransferTo(Brhz& aBrhz);
     void ProcessInput(IInputArgumentProcessor& aProcessor);
     void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer);
 private:
@@ -403,56 +411,44 @@ private:
 };
 
 /**
- * Dedicated thread which processes action invocations
- *
- * Intended for internal use only
+ * Singleton which manages the pool of Invocation instances and the threads which run them
  */
-class Invoker : public Thread
-{
-public:
-    Invoker(const TChar* aName, Fifo<Invoker*>& aFree);
-    ~Invoker();
-
-    /**
-     * Signal that aInvocation should be invoked
-     */
-    void Invoke(Invocation* aInvocation);
-    
-    /**
-     * Interrupt any current invocation if its action is a member of aService
-     */
-    void Interrupt(const Service& aService);
-private:
-    void SetError(Error::ELevel aLevel, TUint aCode, const Brx& aDescription, const TChar* aLogStr);
-    void Run();
-private:
-    Fifo<Invoker*>& iFree;
-    Invocation* iInvocation;
-    OpenHome::Mutex iLock;
-};
-
-/**
- * Singleton which manages the pools of Invocation and Invoker instances
- */
-class InvocationManager : public Thread
+class InvocationManager : private IWorkerPoolHandler
 {
     friend class CpiService;
 public:
     InvocationManager(CpStack& aCpStack);
     ~InvocationManager();
     void Invoke(OpenHome::Net::Invocation* aInvocation);
+    /**
+     * Run aInvocation to completion (including its callback) on the calling thread.
+     * Only suitable for invokers which don't block, such as a device in the same process.
+     */
+    void InvokeOnCallerThread(OpenHome::Net::Invocation* aInvocation);
     void Interrupt(const Service& aService);
 private:
+    static TUint MaxInvocations(InitialisationParams& aInitParams);
     OpenHome::Net::Invocation* Invocation();
-    void Run();
+    void Process(OpenHome::Net::Invocation* aInvocation);
+    void RunInvocation(OpenHome::Net::Invocation& aInvocation);
+    void SetError(OpenHome::Net::Invocation& aInvocation, Error::ELevel aLevel, TUint aCode, const Brx& aDescription, const TChar* aLogStr);
+private: // from IWorkerPoolHandler
+    void ProcessJob();
 private:
     CpStack& iCpStack;
     OpenHome::Mutex iLock;
+    OpenHome::Mutex iActiveLock;
+    TUint iNumInvocations;
+    TUint iMaxInvocations;
     Fifo<OpenHome::Net::Invocation*> iFreeInvocations;
     Fifo<OpenHome::Net::Invocation*> iWaitingInvocations;
-    Fifo<Invoker*> iFreeInvokers;
-    Invoker** iInvokers;
+    std::list<OpenHome::Net::Invocation*> iActiveInvocations;
+    WorkerPool* iInvokers;
     TBool iActive;
+    MetricGauge& iMetricWaiting;
+    MetricCounter& iMetricInvocations;
+    MetricCounter& iMetricErrors;
+    MetricHistogram& iMetricLatency;
 };
 
 } // namespace Net
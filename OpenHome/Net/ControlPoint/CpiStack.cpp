@@ -4,6 +4,8 @@
 #include <OpenHome/Net/Private/XmlFetcher.h>
 #include <OpenHome/Net/Private/CpiSubscription.h>
 #include <OpenHome/Net/Private/CpiDevice.h>
+#include <OpenHome/Net/Private/CpiDeviceCacheUpnp.h>
+#include <OpenHome/Private/File.h>
 #include <OpenHome/Private/Printer.h>
 
 using namespace OpenHome;
@@ -19,6 +21,13 @@ CpStack::CpStack(OpenHome::Environment& aStack)
     iXmlFetchManager = new OpenHome::Net::XmlFetchManager(*this);
     iSubscriptionManager = new CpiSubscriptionManager(*this);
     iDeviceListUpdater = new CpiDeviceListUpdater();
+    iFileSystem = NULL;
+    iDeviceCacheUpnp = NULL;
+    const Brx& cachePath = iEnv.InitParams()->CpDeviceCache();
+    if (cachePath.Bytes() > 0) {
+        iFileSystem = new FileSystemAnsi();
+        iDeviceCacheUpnp = new CpiDeviceCacheUpnp(iEnv, *iFileSystem, cachePath);
+    }
 }
 
 CpStack::~CpStack()
@@ -27,6 +36,8 @@ CpStack::~CpStack()
     delete iSubscriptionManager;
     delete iXmlFetchManager;
     delete iInvocationManager;
+    delete iDeviceCacheUpnp;
+    delete iFileSystem;
 }
 
 InvocationManager& CpStack::InvocationManager()
@@ -48,3 +59,8 @@ CpiDeviceListUpdater& CpStack::DeviceListUpdater()
 {
     return *iDeviceListUpdater;
 }
+
+CpiDeviceCacheUpnp* CpStack::DeviceCacheUpnp()
+{
+    return iDeviceCacheUpnp;
+}
@@ -14,12 +14,14 @@
 #include <vector>
 
 namespace OpenHome {
+class IFileSystem;
 namespace Net {
 
 class InvocationManager;
 class XmlFetchManager;
 class CpiSubscriptionManager;
 class CpiDeviceListUpdater;
+class CpiDeviceCacheUpnp;
 
 class CpStack : public IStack, private INonCopyable
 {
@@ -30,6 +32,7 @@ public:
     OpenHome::Net::XmlFetchManager& XmlFetchManager();
     CpiSubscriptionManager& SubscriptionManager();
     CpiDeviceListUpdater& DeviceListUpdater();
+    CpiDeviceCacheUpnp* DeviceCacheUpnp(); // NULL unless InitialisationParams::SetCpDeviceCache() was called
 private:
     ~CpStack();
 private:
@@ -38,6 +41,8 @@ private:
     OpenHome::Net::XmlFetchManager* iXmlFetchManager;
     CpiSubscriptionManager* iSubscriptionManager;
     CpiDeviceListUpdater* iDeviceListUpdater;
+    IFileSystem* iFileSystem;
+    CpiDeviceCacheUpnp* iDeviceCacheUpnp;
 };
 
 } // namespace Net
@@ -483,98 +483,11 @@ void CpiSubscription::ListObjectDetails() const
 }
 
 
-// Subscriber
-
-Subscriber::Subscriber(const TChar* aName, Fifo<Subscriber*>& aFree)
-    : Thread(aName)
-    , iFree(aFree)
-    , iSubscription(NULL)
-{
-}
-
-Subscriber::~Subscriber()
-{
-    Kill();
-    Join();
-}
-
-void Subscriber::Subscribe(CpiSubscription* aSubscription)
-{
-    iSubscription = aSubscription;
-    Signal();
-}
-
-#ifdef DEFINE_TRACE
-void Subscriber::Error(const TChar* aErr)
-#else
-void Subscriber::Error(const TChar* /*aErr*/)
-#endif
-{
-    LOG_ERROR(kEvent, "Error - %s - from (%p) SID ", aErr, iSubscription);
-    if (iSubscription->Sid().Bytes() > 0) {
-        LOG_ERROR(kEvent, iSubscription->Sid());
-    }
-    else {
-        LOG_ERROR(kEvent, "(null)");
-    }
-    LOG_ERROR(kEvent, "\n");
-    // don't try to resubscribe as we may get stuck in an endless cycle of errors
-}
-
-void Subscriber::Run()
-{
-    for (;;) {
-        TBool exit = false;
-        try {
-            Wait();
-        }
-        catch (ThreadKill&) {
-            if (iSubscription == NULL) {
-                return;
-            }
-            exit = true;
-        }
-        try {
-            iSubscription->RunInSubscriber();
-        }
-        catch (HttpError&) {
-            Error("Http");
-        }
-        catch (UriError&) {
-            Error("Uri");
-        }
-        catch (NetworkError&) {
-            Error("Network");
-        }
-        catch (NetworkTimeout&) {
-            Error("Timeout");
-        }
-        catch (WriterError&) {
-            Error("Writer");
-        }
-        catch (ReaderError&) {
-            Error("Reader");
-        }
-        catch (XmlError&) {
-            Error("XmlError");
-        }
-        iSubscription->RemoveRef();
-        iSubscription = NULL;
-        if (exit) {
-            break;
-        }
-        iFree.Write(this);
-    }
-}
-
-
 // CpiSubscriptionManager
 
 CpiSubscriptionManager::CpiSubscriptionManager(CpStack& aCpStack)
-    : Thread("CpSubscriptionMgr")
-    , iCpStack(aCpStack)
+    : iCpStack(aCpStack)
     , iLock("SBSL")
-    , iFree(aCpStack.Env().InitParams()->NumSubscriberThreads())
     , iWaiter("SBSS", 0)
     , iShutdownSem("SBMS", 0)
     , iInterface(kIpAddressV4AllAdapters)
@@ -599,19 +512,11 @@ CpiSubscriptionManager::CpiSubscriptionManager(CpStack& aCpStack)
         iLock.Signal();
     }
 
-    const TUint numThreads = iCpStack.Env().InitParams()->NumSubscriberThreads();
-    iSubscribers = (Subscriber**)malloc(sizeof(*iSubscribers) * numThreads);
-    for (TUint i=0; i<numThreads; i++) {
-        Bws<Thread::kMaxNameBytes+1> thName;
-        thName.AppendPrintf("Subscriber %d", i);
-        thName.PtrZ();
-        iSubscribers[i] = new Subscriber((const TChar*)thName.Ptr(), iFree);
-        iFree.Write(iSubscribers[i]);
-        iSubscribers[i]->Start();
-    }
-
     iActive = true;
-    Start();
+    InitialisationParams* initParams = iCpStack.Env().InitParams();
+    TUint maxThreads, idleTimeoutMs;
+    initParams->GetWorkerPoolLimits(InitialisationParams::eWorkerPoolSubscriber, maxThreads, idleTimeoutMs);
+    iSubscribers = new WorkerPool(iCpStack.Env(), "Subscriber", *this, initParams->NumSubscriberThreads(), maxThreads, idleTimeoutMs);
 }
 
 CpiSubscriptionManager::~CpiSubscriptionManager()
@@ -641,13 +546,7 @@ CpiSubscriptionManager::~CpiSubscriptionManager()
         }
     }
 
-    Kill();
-    Join();
-
-    for (TUint i=0; i<iCpStack.Env().InitParams()->NumSubscriberThreads(); i++) {
-        delete iSubscribers[i];
-    }
-    free(iSubscribers);
+    delete iSubscribers;
 
     iCpStack.Env().NetworkAdapterList().RemoveSubnetListChangeListener(iSubnetListenerId);
     iCpStack.Env().NetworkAdapterList().RemoveCurrentChangeListener(iInterfaceListListenerId);
@@ -724,7 +623,7 @@ void CpiSubscriptionManager::ScheduleLocked(CpiSubscription& aSubscription)
 {
     ASSERT(iActive);
     iList.push_back(&aSubscription);
-    Signal();
+    iSubscribers->JobAdded();
 }
 
 TUint CpiSubscriptionManager::EventServerPort()
@@ -840,25 +739,62 @@ void CpiSubscriptionManager::ShutdownHasHung()
     iShutdownSem.Signal();
 }
 
-void CpiSubscriptionManager::Run()
+#ifdef DEFINE_TRACE
+void CpiSubscriptionManager::LogError(CpiSubscription& aSubscription, const TChar* aErr)
+#else
+void CpiSubscriptionManager::LogError(CpiSubscription& aSubscription, const TChar* /*aErr*/)
+#endif
 {
-    for (;;) {
-        Wait();
-        Subscriber* subscriber = iFree.Read();
-        iLock.Wait();
-        CpiSubscription* subscription = iList.front();
-        iList.front() = NULL;
-        iList.pop_front();
-        iLock.Signal();
+    LOG_ERROR(kEvent, "Error - %s - from (%p) SID ", aErr, &aSubscription);
+    if (aSubscription.Sid().Bytes() > 0) {
+        LOG_ERROR(kEvent, aSubscription.Sid());
+    }
+    else {
+        LOG_ERROR(kEvent, "(null)");
+    }
+    LOG_ERROR(kEvent, "\n");
+    // don't try to resubscribe as we may get stuck in an endless cycle of errors
+}
 
-        subscriber->Subscribe(subscription);
+void CpiSubscriptionManager::ProcessJob()
+{
+    iLock.Wait();
+    CpiSubscription* subscription = iList.front();
+    iList.front() = NULL;
+    iList.pop_front();
+    iLock.Signal();
 
-        iLock.Wait();
-        TBool shutdownSignal = ReadyForShutdown();
-        iLock.Signal();
-        if (shutdownSignal) {
-            iShutdownSem.Signal();
-        }
+    try {
+        subscription->RunInSubscriber();
+    }
+    catch (HttpError&) {
+        LogError(*subscription, "Http");
+    }
+    catch (UriError&) {
+        LogError(*subscription, "Uri");
+    }
+    catch (NetworkError&) {
+        LogError(*subscription, "Network");
+    }
+    catch (NetworkTimeout&) {
+        LogError(*subscription, "Timeout");
+    }
+    catch (WriterError&) {
+        LogError(*subscription, "Writer");
+    }
+    catch (ReaderError&) {
+        LogError(*subscription, "Reader");
+    }
+    catch (XmlError&) {
+        LogError(*subscription, "XmlError");
+    }
+    subscription->RemoveRef();
+
+    iLock.Wait();
+    TBool shutdownSignal = ReadyForShutdown();
+    iLock.Signal();
+    if (shutdownSignal) {
+        iShutdownSem.Signal();
     }
 }
 
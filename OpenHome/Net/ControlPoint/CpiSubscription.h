@@ -6,7 +6,7 @@
 #include <OpenHome/Net/Private/CpiService.h>
 #include <OpenHome/Private/Timer.h>
 #include <OpenHome/Private/Thread.h>
-#include <OpenHome/Private/Fifo.h>
+#include <OpenHome/Private/WorkerPool.h>
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/Standard.h>
 #include <OpenHome/Net/Private/EventUpnp.h>
@@ -177,34 +177,15 @@ private:
     friend class CpiSubscriptionManager;
 };
 
-/**
- * Dedicated thread which processes subscription events
- *
- * Subscribe, renew (subscription) and unsubscribe are handled in these threads.
- * Notification of state variable changes are handled separately (e.g. EventSessionUpnp for UPnP)
- *
- * Intended for internal use only
- */
-class Subscriber : public Thread
-{
-public:
-    Subscriber(const TChar* aName, Fifo<Subscriber*>& aFree);
-    ~Subscriber();
-    void Subscribe(CpiSubscription* aSubscription);
-private:
-    void Error(const TChar* aErr);
-    void Run();
-private:
-    Fifo<Subscriber*>& iFree;
-    CpiSubscription* iSubscription;
-};
-
 class PendingSubscription;
 
 /**
- * Singleton which manages the pools of Subscriber and active Subscription instances
+ * Singleton which manages active Subscription instances and the pool of Subscriber threads
+ *
+ * Subscribe, renew (subscription) and unsubscribe are handled in Subscriber threads.
+ * Notification of state variable changes are handled separately (e.g. EventSessionUpnp for UPnP)
  */
-class CpiSubscriptionManager : public Thread, private IResumeObserver, private ISuspendObserver
+class CpiSubscriptionManager : private IResumeObserver, private ISuspendObserver, private IWorkerPoolHandler
 {
 public:
     CpiSubscriptionManager(CpStack& aCpStack);
@@ -246,13 +227,14 @@ private:
     void HandleInterfaceChange(TBool aNewSubnet);
     TBool ReadyForShutdown() const;
     void ShutdownHasHung();
-    void Run();
+    void LogError(CpiSubscription& aSubscription, const TChar* aErr);
+private: // from IWorkerPoolHandler
+    void ProcessJob();
 private:
     CpStack& iCpStack;
     OpenHome::Mutex iLock;
     std::list<CpiSubscription*> iList;
-    Fifo<Subscriber*> iFree;
-    Subscriber** iSubscribers;
+    WorkerPool* iSubscribers;
     std::map<TUint,CpiSubscription*> iMap;
     TBool iActive;
     TBool iCleanShutdown;
@@ -13,6 +13,8 @@
 #include <OpenHome/Private/Debug.h>
 #include <OpenHome/Private/Env.h>
 
+#include <algorithm>
+
 using namespace OpenHome;
 using namespace OpenHome::Net;
 
@@ -22,6 +24,7 @@ CpiDeviceDv::CpiDeviceDv(CpStack& aCpStack, DviDevice& aDevice)
     : iDeviceDv(aDevice)
     , iLock("CpDv")
     , iShutdownSem("CpDv", 1)
+    , iInvokeOnCallerThread(aCpStack.Env().InitParams()->CpDeviceDvInvokeOnCallerThread())
 {
     iDeviceDv.AddWeakRef();
     iDeviceCp = new CpiDevice(aCpStack, iDeviceDv.Udn(), *this, *this, NULL);
@@ -44,7 +47,13 @@ void CpiDeviceDv::InvokeAction(Invocation& aInvocation)
 {
     iDeviceDv.GetDvStack().NotifyControlPointUsed(Brn("Device/local"));
     aInvocation.SetInvoker(*iInvocable);
-    iDeviceCp->GetCpStack().InvocationManager().Invoke(&aInvocation);
+    InvocationManager& invocationManager = iDeviceCp->GetCpStack().InvocationManager();
+    if (iInvokeOnCallerThread) {
+        invocationManager.InvokeOnCallerThread(&aInvocation);
+    }
+    else {
+        invocationManager.Invoke(&aInvocation);
+    }
 }
 
 TBool CpiDeviceDv::GetAttribute(const char* aKey, Brh& aValue) const
@@ -216,7 +225,10 @@ void CpiDeviceDv::Invocable::InvokeAction(Invocation& aInvocation)
         aInvocation.SetError(Error::eUpnp, err.Code(), err.Reason());
     }
     else {
-        InvocationDv stream(aInvocation, *service);
+        // inputs can only be moved if nothing will log them once the invocation completes
+        const TBool transferInputs = (iDevice.iInvokeOnCallerThread &&
+                                      !iDevice.iDeviceCp->GetCpStack().Env().InitParams()->AsyncEndHandler());
+        InvocationDv stream(aInvocation, *service, transferInputs);
         stream.Start();
         service->RemoveRef();
     }
@@ -225,10 +237,11 @@ void CpiDeviceDv::Invocable::InvokeAction(Invocation& aInvocation)
 
 // InvocationDv
 
-InvocationDv::InvocationDv(Invocation& aInvocation, DviService& aService)
+InvocationDv::InvocationDv(Invocation& aInvocation, DviService& aService, TBool aTransferInputs)
     : iInvocation(aInvocation)
     , iService(aService)
     , iWriteArg(NULL)
+    , iTransferInputs(aTransferInputs)
 {
 }
 
@@ -288,7 +301,12 @@ TBool InvocationDv::InvocationReadBool(const TChar* aName)
 void InvocationDv::InvocationReadString(const TChar* aName, Brhz& aString)
 {
     ArgumentString* arg = static_cast<ArgumentString*>(InputArgument(aName));
-    aString.Set(arg->Value());
+    if (iTransferInputs && arg->Value().Bytes() > 0) {
+        arg->TransferTo(aString);
+    }
+    else {
+        aString.Set(arg->Value());
+    }
 }
 
 TInt InvocationDv::InvocationReadInt(const TChar* aName)
@@ -306,7 +324,12 @@ TUint InvocationDv::InvocationReadUint(const TChar* aName)
 void InvocationDv::InvocationReadBinary(const TChar* aName, Brh& aData)
 {
     ArgumentBinary* arg = static_cast<ArgumentBinary*>(InputArgument(aName));
-    aData.Set(arg->Value());
+    if (iTransferInputs && arg->Value().Bytes() > 0) {
+        arg->TransferTo(aData);
+    }
+    else {
+        aData.Set(arg->Value());
+    }
 }
 
 void InvocationDv::InvocationReadEnd()
@@ -386,12 +409,19 @@ void InvocationDv::InvocationWriteString(TByte aValue)
 void InvocationDv::InvocationWriteString(const Brx& aValue)
 {
     ASSERT(iWriteArg != NULL);
-    OutputProcessorDv procDv;
-    iWriteArg->ProcessOutput(procDv, aValue);
+    const TUint bytes = iWriteBuf.Bytes() + aValue.Bytes();
+    if (bytes > iWriteBuf.MaxBytes()) {
+        iWriteBuf.Grow(std::max(bytes, 2 * iWriteBuf.MaxBytes()));
+    }
+    iWriteBuf.Append(aValue);
 }
 
 void InvocationDv::InvocationWriteStringEnd(const TChar* /*aName*/)
 {
+    ASSERT(iWriteArg != NULL);
+    OutputProcessorDv procDv;
+    iWriteArg->ProcessOutput(procDv, iWriteBuf);
+    iWriteBuf.SetBytes(0);
     iWriteArg = NULL;
 }
 
@@ -494,6 +524,10 @@ void PropertyWriterDv::Release()
 
 void OutputProcessorDv::ProcessString(const Brx& aBuffer, Brhz& aVal)
 {
+    if (aVal.Bytes() == 0) {
+        aVal.Set(aBuffer);
+        return;
+    }
     TUint bytes = aVal.Bytes() + aBuffer.Bytes();
     Bwh tmp(bytes + 1);
     tmp.Append(aVal);
@@ -523,6 +557,10 @@ void OutputProcessorDv::ProcessBool(const Brx& aBuffer, TBool& aVal)
 
 void OutputProcessorDv::ProcessBinary(const Brx& aBuffer, Brh& aVal)
 {
+    if (aVal.Bytes() == 0) {
+        aVal.Set(aBuffer);
+        return;
+    }
     Bwh tmp(aVal.Bytes() + aBuffer.Bytes());
     tmp.Append(aVal);
     tmp.Append(aBuffer);
@@ -70,15 +70,24 @@ private:
     Mutex iLock;
     Semaphore iShutdownSem;
     Invocable* iInvocable;
+    const TBool iInvokeOnCallerThread;
     friend class Invocable;
 };
 
 class Argument;
 
+/**
+ * Passes a control point Invocation to a DviService in the same process.
+ *
+ * Int, uint and bool values are passed directly.  String and binary outputs are collected
+ * then copied into their argument once.  If aTransferInputs is true, string and binary input
+ * values are moved into the provider's buffers rather than copied, leaving the invocation's
+ * input arguments empty.
+ */
 class InvocationDv : public IDviInvocation, private INonCopyable
 {
 public:
-    InvocationDv(Invocation& aInvocation, DviService& aService);
+    InvocationDv(Invocation& aInvocation, DviService& aService, TBool aTransferInputs);
     void Start();
 private: // IDviInvocation
     void Invoke();
@@ -123,6 +132,8 @@ private:
     TUint iReadIndex;
     TUint iWriteIndex;
     OpenHome::Net::Argument* iWriteArg; // used for binary & string writing only
+    Bwh iWriteBuf;                      // ...as is this
+    const TBool iTransferInputs;
 };
 
 class PropertyWriterDv : public IPropertyWriter, private INonCopyable
@@ -13,10 +13,13 @@
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/Parser.h>
 #include <OpenHome/Private/Debug.h>
+#include <OpenHome/Private/TIpAddressUtils.h>
 #include <OpenHome/Private/Converter.h>
 #include <OpenHome/Net/Private/CpiStack.h>
 #include <OpenHome/Net/Private/CpiSubscription.h>
 
+#include <string.h>
+
 using namespace OpenHome;
 using namespace OpenHome::Net;
 
@@ -26,15 +29,47 @@ CpiDeviceLpec::CpiDeviceLpec(CpStack& aCpStack, Endpoint aLocation, const Brx& a
     : iCpStack(aCpStack)
     , iLock("CLP1")
     , iLocation(aLocation)
+    , iHasLocation(true)
+    , iLpecName(aLpecName)
+    , iStateChanged(aStateChanged)
+    , iDevice(NULL)
+    , iPendingLock("CLP2")
+    , iPendingAborted(false)
+    , iConnected(false)
+    , iExiting(false)
+{
+    /* The local socket belongs to the server on this host's configured LPEC port.  Servers
+       on other (or OS assigned) ports have to be reached over tcp. */
+    InitialisationParams* initParams = iCpStack.Env().InitParams();
+    const Brx& localPath = initParams->LpecLocalSocket();
+    const TUint localPort = initParams->DvLpecServerPort();
+    if (localPath.Bytes() > 0 && localPort != 0 && aLocation.Port() == localPort &&
+        TIpAddressUtils::IsLoopback(aLocation.Address())) {
+        iLocalPath.Set(localPath);
+    }
+    Construct();
+}
+
+CpiDeviceLpec::CpiDeviceLpec(CpStack& aCpStack, const Brx& aLocalPath, const Brx& aLpecName, Functor aStateChanged)
+    : iCpStack(aCpStack)
+    , iLock("CLP1")
+    , iLocalPath(aLocalPath)
+    , iHasLocation(false)
     , iLpecName(aLpecName)
     , iStateChanged(aStateChanged)
     , iDevice(NULL)
-    , iResponseHandler(NULL)
+    , iPendingLock("CLP2")
+    , iPendingAborted(false)
     , iConnected(false)
     , iExiting(false)
 {
-    iReadBuffer = new Srs<1024>(iSocket);
-    iReaderUntil = new ReaderUntilS<kMaxReadBufferBytes>(*iReadBuffer);
+    Construct();
+}
+
+void CpiDeviceLpec::Construct()
+{
+    iReadBuffer = new Srs<kReadBufferBytes>(iSocket);
+    iReaderLine = new ReaderLine(*iReadBuffer, kInitialLineBytes, kMaxLineBytes);
     iWriteBuffer = new Sws<kMaxWriteBufferBytes>(iSocket);
     iThread = new ThreadFunctor("LpecClient", MakeFunctor(*this, &CpiDeviceLpec::LpecThread));
     iInvocable = new Invocable(*this);
@@ -48,7 +83,7 @@ CpiDeviceLpec::~CpiDeviceLpec()
     delete iThread;
     delete iInvocable;
     delete iWriteBuffer;
-    delete iReaderUntil;
+    delete iReaderLine;
     delete iReadBuffer;
     iSocket.Close();
 }
@@ -71,14 +106,33 @@ TBool CpiDeviceLpec::Connected() const
     return iConnected;
 }
 
+void CpiDeviceLpec::Connect()
+{
+    if (iLocalPath.Bytes() > 0) {
+        try {
+            iSocket.OpenLocal(iCpStack.Env());
+            iSocket.ConnectLocal(iLocalPath, iCpStack.Env().InitParams()->TcpConnectTimeoutMs());
+            return;
+        }
+        catch (NetworkError&) {
+            iSocket.Close();
+            if (!iHasLocation || iExiting) {
+                throw;
+            }
+            LOG(kLpec, "LPEC: no local socket for %.*s, falling back to tcp\n", PBUF(iLpecName));
+        }
+    }
+    iSocket.Open(iCpStack.Env());
+    iSocket.Connect(iLocation, iCpStack.Env().InitParams()->TcpConnectTimeoutMs());
+}
+
 void CpiDeviceLpec::LpecThread()
 {
     try {
-        iSocket.Open(iCpStack.Env());
-        iSocket.Connect(iLocation, iCpStack.Env().InitParams()->TcpConnectTimeoutMs());
+        Connect();
         TBool starting = true;
         for (;;) {
-            Brn line = iReaderUntil->ReadUntil(Ascii::kLf);
+            Brn line = iReaderLine->ReadLine();
             if (line.Bytes() > 0 && line[line.Bytes()-1] == Ascii::kCr) {
                 line.Set(line.Ptr(), line.Bytes()-1);
             }
@@ -123,8 +177,8 @@ void CpiDeviceLpec::LpecThread()
             else if (method == Lpec::kMethodEvent) {
                 HandleEventedUpdate(parser.Remaining());
             }
-            else if (iResponseHandler == NULL || !iResponseHandler->HandleLpecResponse(method, parser.Remaining())) {
-                LOG_ERROR(kLpec, "Unexpected LPEC message: %.*s\n", PBUF(line));
+            else {
+                HandleResponse(method, parser.Remaining(), line);
             }
         }
     }
@@ -142,6 +196,7 @@ void CpiDeviceLpec::LpecThread()
             LogError("ReaderError");
         }
     }
+    AbortResponses();
 }
 
 void CpiDeviceLpec::LogError(const TChar* aError)
@@ -211,6 +266,60 @@ void CpiDeviceLpec::HandleEventedUpdate(const Brx& aUpdate)
     subscription->RemoveRef();
 }
 
+void CpiDeviceLpec::HandleResponse(const Brn& aMethod, const Brx& aBody, const Brx& aLine)
+{
+    /* The device sends exactly one response (RESPONSE, ERROR, SUBSCRIBE or UNSUBSCRIBE)
+       per request, in the order requests were received.  Requests may be pipelined so
+       match each response against the oldest outstanding request. */
+    iPendingLock.Wait();
+    if (iPendingResponses.size() == 0) {
+        iPendingLock.Signal();
+        LOG_ERROR(kLpec, "Unexpected LPEC message: %.*s\n", PBUF(aLine));
+        return;
+    }
+    ILpecResponse* handler = iPendingResponses.front();
+    iPendingResponses.pop_front();
+    iPendingLock.Signal();
+    if (!handler->HandleLpecResponse(aMethod, aBody)) {
+        LOG_ERROR(kLpec, "Unexpected LPEC message: %.*s\n", PBUF(aLine));
+        handler->HandleLpecAbort();
+    }
+}
+
+void CpiDeviceLpec::QueueResponse(ILpecResponse* aResponse)
+{
+    AutoMutex a(iPendingLock);
+    if (iPendingAborted) {
+        THROW(WriterError);
+    }
+    iPendingResponses.push_back(aResponse);
+}
+
+TBool CpiDeviceLpec::DequeueResponse(ILpecResponse* aResponse)
+{
+    // only used when writing a request failed
+    AutoMutex a(iPendingLock);
+    for (std::list<ILpecResponse*>::iterator it = iPendingResponses.begin(); it != iPendingResponses.end(); ++it) {
+        if (*it == aResponse) {
+            iPendingResponses.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void CpiDeviceLpec::AbortResponses()
+{
+    iPendingLock.Wait();
+    iPendingAborted = true;
+    std::list<ILpecResponse*> pending;
+    pending.swap(iPendingResponses);
+    iPendingLock.Signal();
+    for (std::list<ILpecResponse*>::iterator it = pending.begin(); it != pending.end(); ++it) {
+        (*it)->HandleLpecAbort();
+    }
+}
+
 void CpiDeviceLpec::InvokeAction(Invocation& aInvocation)
 {
     aInvocation.SetInvoker(*iInvocable);
@@ -227,24 +336,33 @@ TUint CpiDeviceLpec::Subscribe(CpiSubscription& aSubscription, const OpenHome::U
 {
     Semaphore sem("CLS2", 0);
     SubscriptionResponse resp(sem);
-    AutoMutex a(iLock);
-    iResponseHandler = &resp;
-    iWriteBuffer->Write(Lpec::kMethodSubscribe);
-    iWriteBuffer->Write(' ');
-    iWriteBuffer->Write(iLpecName);
-    iWriteBuffer->Write('/');
-    iWriteBuffer->Write(aSubscription.ServiceType().Name());
-    iWriteBuffer->Write(Lpec::kMsgTerminator);
-    iWriteBuffer->WriteFlush();
+    iLock.Wait();
+    try {
+        QueueResponse(&resp);
+        iWriteBuffer->Write(Lpec::kMethodSubscribe);
+        iWriteBuffer->Write(' ');
+        iWriteBuffer->Write(iLpecName);
+        iWriteBuffer->Write('/');
+        iWriteBuffer->Write(aSubscription.ServiceType().Name());
+        iWriteBuffer->Write(Lpec::kMsgTerminator);
+        iWriteBuffer->WriteFlush();
+    }
+    catch (WriterError&) {
+        DequeueResponse(&resp);
+        iLock.Signal();
+        throw;
+    }
+    iLock.Signal();
 
     sem.Wait();
+    if (resp.Aborted()) {
+        THROW(WriterError);
+    }
     Bws<128> sid(iDevice->Udn());
     sid.Append('-');
     sid.Append(resp.SidFragment());
     Brh sid2(sid);
     aSubscription.SetSid(sid2);
-
-    iResponseHandler = NULL;
     return kSubscriptionDurationSecs;
 }
 
@@ -255,16 +373,31 @@ TUint CpiDeviceLpec::Renew(CpiSubscription& /*aSubscription*/)
 
 void CpiDeviceLpec::Unsubscribe(CpiSubscription& aSubscription, const Brx& /*aSid*/)
 {
+    // no great benefit in waiting for a response but one still has to be matched against the request
+    UnsubscribeResponse* resp = new UnsubscribeResponse();
     AutoMutex a(iLock);
-    iWriteBuffer->Write(Lpec::kMethodUnsubscribe);
-    iWriteBuffer->Write(' ');
-    iWriteBuffer->Write(iLpecName);
-    iWriteBuffer->Write('/');
-    iWriteBuffer->Write(aSubscription.ServiceType().Name());
-    iWriteBuffer->Write(Lpec::kMsgTerminator);
-    iWriteBuffer->WriteFlush();
-
-    // no great benefit in waiting for a response
+    try {
+        QueueResponse(resp);
+    }
+    catch (WriterError&) {
+        delete resp;
+        throw;
+    }
+    try {
+        iWriteBuffer->Write(Lpec::kMethodUnsubscribe);
+        iWriteBuffer->Write(' ');
+        iWriteBuffer->Write(iLpecName);
+        iWriteBuffer->Write('/');
+        iWriteBuffer->Write(aSubscription.ServiceType().Name());
+        iWriteBuffer->Write(Lpec::kMsgTerminator);
+        iWriteBuffer->WriteFlush();
+    }
+    catch (WriterError&) {
+        if (DequeueResponse(resp)) {
+            delete resp;
+        }
+        throw;
+    }
 }
 
 TBool CpiDeviceLpec::OrphanSubscriptionsOnSubnetChange() const
@@ -294,16 +427,30 @@ void CpiDeviceLpec::Release()
 
 CpiDeviceLpec::Invocable::Invocable(CpiDeviceLpec& aDevice)
     : iDevice(aDevice)
-    , iSem("CLPS", 0)
-    , iInvocation(NULL)
 {
 }
 
 void CpiDeviceLpec::Invocable::InvokeAction(Invocation& aInvocation)
 {
-    AutoMutex a(iDevice.iLock);
-    iDevice.iResponseHandler = this;
-    iInvocation = &aInvocation;
+    /* May be called concurrently from several Invoker threads.  Each writes its request
+       then waits for its own response without blocking further requests. */
+    InvocationResponse resp(aInvocation);
+    iDevice.iLock.Wait();
+    try {
+        iDevice.QueueResponse(&resp);
+        WriteRequest(aInvocation);
+    }
+    catch (WriterError&) {
+        iDevice.DequeueResponse(&resp);
+        iDevice.iLock.Signal();
+        throw;
+    }
+    iDevice.iLock.Signal();
+    resp.Wait();
+}
+
+void CpiDeviceLpec::Invocable::WriteRequest(Invocation& aInvocation)
+{
     iDevice.iWriteBuffer->Write(Lpec::kMethodAction);
     iDevice.iWriteBuffer->Write(' ');
     iDevice.iWriteBuffer->Write(iDevice.iLpecName);
@@ -321,10 +468,6 @@ void CpiDeviceLpec::Invocable::InvokeAction(Invocation& aInvocation)
     }
     iDevice.iWriteBuffer->Write(Lpec::kMsgTerminator);
     iDevice.iWriteBuffer->WriteFlush();
-
-    iSem.Wait(); // wait for response
-    iInvocation = NULL;
-    iDevice.iResponseHandler = NULL;
 }
 
 void CpiDeviceLpec::Invocable::ProcessString(const Brx& aVal)
@@ -371,7 +514,31 @@ void CpiDeviceLpec::Invocable::ProcessBinary(const Brx& aVal)
     iDevice.iWriteBuffer->Write(Lpec::kArgumentDelimiter);
 }
 
-TBool CpiDeviceLpec::Invocable::HandleLpecResponse(const Brx& aMethod, const Brx& aBody)
+
+// CpiDeviceLpec::InvocationResponse
+
+CpiDeviceLpec::InvocationResponse::InvocationResponse(Invocation& aInvocation)
+    : iInvocation(aInvocation)
+    , iSem("CLPS", 0)
+    , iAborted(false)
+{
+}
+
+void CpiDeviceLpec::InvocationResponse::Wait()
+{
+    iSem.Wait();
+    if (iAborted) {
+        THROW(WriterError);
+    }
+}
+
+void CpiDeviceLpec::InvocationResponse::HandleLpecAbort()
+{
+    iAborted = true;
+    iSem.Signal();
+}
+
+TBool CpiDeviceLpec::InvocationResponse::HandleLpecResponse(const Brx& aMethod, const Brx& aBody)
 {
     Brn body = Ascii::Trim(aBody);
     Parser parser(body);
@@ -385,7 +552,7 @@ TBool CpiDeviceLpec::Invocable::HandleLpecResponse(const Brx& aMethod, const Brx
         }
         parser.Next(Lpec::kArgumentDelimiter);
         Brn description = parser.Next(Lpec::kArgumentDelimiter);
-        iInvocation->SetError(Error::eUpnp/*nearest alternative to eProtocol*/, code, description);
+        iInvocation.SetError(Error::eUpnp/*nearest alternative to eProtocol*/, code, description);
         iSem.Signal();
         return true;
     }
@@ -393,7 +560,7 @@ TBool CpiDeviceLpec::Invocable::HandleLpecResponse(const Brx& aMethod, const Brx
         return false;
     }
 
-    const std::vector<Argument*>& outArgs = iInvocation->OutputArguments();
+    const std::vector<Argument*>& outArgs = iInvocation.OutputArguments();
     try {
         OutputProcessor outputProcessor;
         for (TUint i=0; i<outArgs.size(); i++) {
@@ -419,6 +586,7 @@ TBool CpiDeviceLpec::Invocable::HandleLpecResponse(const Brx& aMethod, const Brx
 
 CpiDeviceLpec::SubscriptionResponse::SubscriptionResponse(Semaphore& aComplete)
     : iComplete(aComplete)
+    , iAborted(false)
 {
 }
 
@@ -427,6 +595,17 @@ const Brx& CpiDeviceLpec::SubscriptionResponse::SidFragment() const
     return iSidFragment;
 }
 
+TBool CpiDeviceLpec::SubscriptionResponse::Aborted() const
+{
+    return iAborted;
+}
+
+void CpiDeviceLpec::SubscriptionResponse::HandleLpecAbort()
+{
+    iAborted = true;
+    iComplete.Signal();
+}
+
 TBool CpiDeviceLpec::SubscriptionResponse::HandleLpecResponse(const Brx& aMethod, const Brx& aBody)
 {
     if (aMethod != Lpec::kMethodSubscribe) {
@@ -438,6 +617,71 @@ TBool CpiDeviceLpec::SubscriptionResponse::HandleLpecResponse(const Brx& aMethod
 }
 
 
+// CpiDeviceLpec::UnsubscribeResponse
+
+TBool CpiDeviceLpec::UnsubscribeResponse::HandleLpecResponse(const Brx& aMethod, const Brx& /*aBody*/)
+{
+    if (aMethod != Lpec::kMethodUnsubscribe && aMethod != Lpec::kMethodError) {
+        return false; // HandleLpecAbort() will follow
+    }
+    delete this;
+    return true;
+}
+
+void CpiDeviceLpec::UnsubscribeResponse::HandleLpecAbort()
+{
+    delete this;
+}
+
+
+// CpiDeviceLpec::ReaderLine
+
+CpiDeviceLpec::ReaderLine::ReaderLine(IReader& aReader, TUint aInitialBytes, TUint aMaxBytes)
+    : iReader(aReader)
+    , iBuf(aInitialBytes)
+    , iOffset(0)
+    , iMaxBytes(aMaxBytes)
+{
+    ASSERT(aInitialBytes <= aMaxBytes);
+}
+
+Brn CpiDeviceLpec::ReaderLine::ReadLine()
+{
+    TUint searched = iOffset;
+    for (;;) {
+        const TByte* ptr = iBuf.Ptr();
+        for (; searched < iBuf.Bytes(); searched++) {
+            if (ptr[searched] == Ascii::kLf) {
+                Brn line(ptr + iOffset, searched - iOffset);
+                iOffset = searched + 1;
+                return line;
+            }
+        }
+        // no complete line buffered; discard lines already returned before reading more
+        if (iOffset > 0) {
+            const TUint remaining = iBuf.Bytes() - iOffset;
+            (void)memmove(const_cast<TByte*>(ptr), ptr + iOffset, remaining);
+            iBuf.SetBytes(remaining);
+            searched -= iOffset;
+            iOffset = 0;
+        }
+        if (iBuf.Bytes() == iBuf.MaxBytes()) {
+            if (iBuf.MaxBytes() == iMaxBytes) {
+                LOG_ERROR(kLpec, "LPEC: line exceeds %u bytes\n", iMaxBytes);
+                THROW(ReaderError);
+            }
+            const TUint bytes = 2 * iBuf.MaxBytes();
+            iBuf.Grow(bytes < iMaxBytes? bytes : iMaxBytes);
+        }
+        Brn buf = iReader.Read(iBuf.MaxBytes() - iBuf.Bytes());
+        if (buf.Bytes() == 0) {
+            THROW(ReaderError);
+        }
+        iBuf.Append(buf);
+    }
+}
+
+
 // CpiDeviceLpec::OutputProcessor
 
 void CpiDeviceLpec::OutputProcessor::ProcessString(const Brx& aBuffer, Brhz& aVal)
@@ -12,6 +12,7 @@
 #include <OpenHome/Private/Thread.h>
 
 #include <limits.h>
+#include <list>
 
 namespace OpenHome {
     class Uri;
@@ -25,6 +26,7 @@ class ILpecResponse
 {
 public:
     virtual TBool HandleLpecResponse(const Brx& aMethod, const Brx& aBody) = 0;
+    virtual void HandleLpecAbort() = 0; // connection lost before a response arrived
     virtual ~ILpecResponse() {}
 };
 
@@ -32,15 +34,29 @@ class CpiDeviceLpec : private ICpiProtocol, private ICpiDeviceObserver
 {
     static const TUint kSubscriptionDurationSecs = 60 * 60 * 24; // arbitrarily chosen largish value
 public:
+    /**
+     * Connect to aLocation.  If aLocation is a loopback address and
+     * InitialisationParams::SetLpecLocalSocket() was called, the local socket is tried first.
+     */
     CpiDeviceLpec(CpStack& aCpStack, Endpoint aLocation, const Brx& aLpecName, Functor aStateChanged);
+    /**
+     * Connect to a device stack on this host which is listening on the local socket aLocalPath
+     */
+    CpiDeviceLpec(CpStack& aCpStack, const Brx& aLocalPath, const Brx& aLpecName, Functor aStateChanged);
     void Destroy();
     CpiDevice* Device();
     TBool Connected() const;
 private:
     ~CpiDeviceLpec();
+    void Construct();
+    void Connect();
     void LpecThread();
     void LogError(const TChar* aError);
     void HandleEventedUpdate(const Brx& aUpdate);
+    void HandleResponse(const Brn& aMethod, const Brx& aBody, const Brx& aLine);
+    void QueueResponse(ILpecResponse* aResponse); // call with iLock held, immediately before writing the request
+    TBool DequeueResponse(ILpecResponse* aResponse); // false if AbortResponses() already claimed aResponse
+    void AbortResponses();
 private: // from ICpiProtocol
     void InvokeAction(Invocation& aInvocation);
     TBool GetAttribute(const TChar* aKey, Brh& aValue) const;
@@ -54,36 +70,64 @@ private: // from ICpiProtocol
 private: // from ICpiDeviceObserver
     void Release();
 private:
-    class Invocable : public IInvocable, private IInputArgumentProcessor, private ILpecResponse, private INonCopyable
+    class Invocable : public IInvocable, private IInputArgumentProcessor, private INonCopyable
     {
     public:
         Invocable(CpiDeviceLpec& aDevice);
     private: // from IInvocable
         void InvokeAction(Invocation& aInvocation);
+    private:
+        void WriteRequest(Invocation& aInvocation);
     private: // from IInputArgumentProcessor
         void ProcessString(const Brx& aVal);
         void ProcessInt(TInt aVal);
         void ProcessUint(TUint aVal);
         void ProcessBool(TBool aVal);
         void ProcessBinary(const Brx& aVal);
+    private:
+        CpiDeviceLpec& iDevice;
+    };
+    /**
+     * One per in-flight action.  Lives on the stack of the Invoker thread which
+     * wrote the request; completed by LpecThread.
+     */
+    class InvocationResponse : public ILpecResponse, private INonCopyable
+    {
+    public:
+        InvocationResponse(Invocation& aInvocation);
+        void Wait(); // throws WriterError if the connection was lost
     private: // from ILpecResponse
         TBool HandleLpecResponse(const Brx& aMethod, const Brx& aBody);
+        void HandleLpecAbort();
     private:
-        CpiDeviceLpec& iDevice;
+        Invocation& iInvocation;
         Semaphore iSem;
-        Invocation* iInvocation;
+        TBool iAborted;
     };
     class SubscriptionResponse : public ILpecResponse, private INonCopyable
     {
     public:
         SubscriptionResponse(Semaphore& aComplete);
         const Brx& SidFragment() const;
+        TBool Aborted() const;
     private: // from ILpecResponse
         TBool HandleLpecResponse(const Brx& aMethod, const Brx& aBody);
+        void HandleLpecAbort();
     private:
         Semaphore& iComplete;
+        TBool iAborted;
         Bws<Ascii::kMaxUintStringBytes> iSidFragment;
     };
+    /**
+     * Placeholder for the response to an unsubscribe, which no caller waits for.
+     * Allocated per request; deletes itself once the response or an abort arrives.
+     */
+    class UnsubscribeResponse : public ILpecResponse, private INonCopyable
+    {
+    private: // from ILpecResponse
+        TBool HandleLpecResponse(const Brx& aMethod, const Brx& aBody);
+        void HandleLpecAbort();
+    };
     class OutputProcessor : public IOutputProcessor
     {
     private: // from IOutputProcessor
@@ -93,23 +137,45 @@ private:
         void ProcessBool(const Brx& aBuffer, TBool& aVal);
         void ProcessBinary(const Brx& aBuffer, Brh& aVal);
     };
+    /**
+     * Line reader whose buffer grows to fit the longest line received, up to aMaxBytes.
+     * Returned lines remain valid until the next call to ReadLine().
+     * ReadLine() throws ReaderError if a line exceeds aMaxBytes.
+     */
+    class ReaderLine : private INonCopyable
+    {
+    public:
+        ReaderLine(IReader& aReader, TUint aInitialBytes, TUint aMaxBytes);
+        Brn ReadLine();
+    private:
+        IReader& iReader;
+        Bwh iBuf;
+        TUint iOffset;
+        TUint iMaxBytes;
+    };
 private:
-    static const TUint kMaxReadBufferBytes = 12000;
+    static const TUint kReadBufferBytes = 4096;
+    static const TUint kInitialLineBytes = 12000;
+    static const TUint kMaxLineBytes = 1024 * 1024;
     static const TUint kMaxWriteBufferBytes = 4000;
 
     CpStack& iCpStack;
-    Mutex iLock;
+    Mutex iLock; // serialises writes; held only while a request is written, never while awaiting its response
     SocketTcpClient iSocket;
     Srx* iReadBuffer;
-    ReaderUntilS<kMaxReadBufferBytes>* iReaderUntil;
+    ReaderLine* iReaderLine;
     Sws<kMaxWriteBufferBytes>* iWriteBuffer;
     Endpoint iLocation;
+    Brh iLocalPath;
+    TBool iHasLocation; // false => can only connect via iLocalPath
     Bws<64> iLpecName;
     Functor iStateChanged;
     CpiDevice* iDevice;
     ThreadFunctor* iThread;
     Invocable* iInvocable;
-    ILpecResponse* iResponseHandler;
+    Mutex iPendingLock;
+    std::list<ILpecResponse*> iPendingResponses; // in the order requests were written.  NULL => discard response
+    TBool iPendingAborted;
     TBool iConnected;
     TBool iExiting;
 };
@@ -7,6 +7,7 @@
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Net/Private/DviStack.h>
 #include <OpenHome/Private/NetworkAdapterList.h>
+#include <OpenHome/OsWrapper.h>
 
 #include <vector>
 
@@ -317,6 +318,25 @@ static void TestInvocation(CpDevice& aDevice)
     delete proxy;
 }
 
+static void TestInvocationLatency(CpDevice& aDevice, Environment& aEnv)
+{
+    static const TUint kIterations = 2000;
+    CpProxyOpenhomeOrgTestBasic1* proxy = new CpProxyOpenhomeOrgTestBasic1(aDevice);
+    Brn valStr("latency");
+    const TUint startMs = Os::TimeInMs(aEnv.OsCtx());
+    for (TUint i=0; i<kIterations; i++) {
+        TUint result;
+        proxy->SyncIncrement(i, result);
+        ASSERT(result == i+1);
+        Brh resultStr;
+        proxy->SyncEchoString(valStr, resultStr);
+        ASSERT(resultStr == valStr);
+    }
+    const TUint elapsedMs = Os::TimeInMs(aEnv.OsCtx()) - startMs;
+    Print("    %u invocations in %ums\n", 2*kIterations, elapsedMs);
+    delete proxy;
+}
+
 static void STDCALL updatesComplete(void* aPtr)
 {
     reinterpret_cast<Semaphore*>(aPtr)->Signal();
@@ -444,7 +464,20 @@ void TestCpDeviceDv(CpStack& aCpStack, DvStack& aDvStack)
     CpDeviceDv* cpDevice = CpDeviceDv::New(aCpStack, device->Device());
     TestInvocation(*cpDevice);
     TestSubscription(*cpDevice);
+    Print("  Latency (invoker threads)\n");
+    TestInvocationLatency(*cpDevice, aDvStack.Env());
+    cpDevice->RemoveRef();
+
+    InitialisationParams* initParams = aDvStack.Env().InitParams();
+    initParams->SetCpDeviceDvInvokeOnCallerThread(true);
+    cpDevice = CpDeviceDv::New(aCpStack, device->Device());
+    Print(" Invoking on caller's thread\n");
+    TestInvocation(*cpDevice);
+    TestSubscription(*cpDevice);
+    Print("  Latency (caller's thread)\n");
+    TestInvocationLatency(*cpDevice, aDvStack.Env());
     cpDevice->RemoveRef();
+    initParams->SetCpDeviceDvInvokeOnCallerThread(false);
     delete device;
 
     Print("TestCpDeviceDv - completed\n");
@@ -0,0 +1,379 @@
+#include <OpenHome/Net/Private/CpiDeviceCacheUpnp.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/File.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Timer.h>
+#include <OpenHome/Private/Crc32.h>
+#include <OpenHome/Private/Converter.h>
+#include <OpenHome/Private/Debug.h>
+
+#include <time.h>
+
+using namespace OpenHome;
+using namespace OpenHome::Net;
+
+/* File format (all integers 32-bit big endian unless noted)
+     magic "OHDC"
+     version
+     save time (64-bit, seconds since the epoch)
+     entry count
+     for each entry:
+       udn length, udn
+       location length, location
+       max age (seconds)
+       last seen (64-bit, seconds since the epoch)
+       xml length, xml
+     crc32 of all preceding bytes
+
+   The file is written to <path>.tmp then renamed over <path> so that a crash
+   part way through a write can't leave a truncated cache. */
+
+// CpiDeviceCacheUpnp::Entry
+
+CpiDeviceCacheUpnp::Entry::Entry(const Brx& aUdn, const Brx& aLocation, TUint aMaxAgeSecs, const Brx& aXml, TUint64 aSeenSecs)
+    : iUdn(aUdn)
+    , iLocation(aLocation)
+    , iMaxAgeSecs(aMaxAgeSecs)
+    , iXml(aXml)
+    , iSeenSecs(aSeenSecs)
+{
+}
+
+const Brx& CpiDeviceCacheUpnp::Entry::Udn() const
+{
+    return iUdn;
+}
+
+const Brx& CpiDeviceCacheUpnp::Entry::Location() const
+{
+    return iLocation;
+}
+
+TUint CpiDeviceCacheUpnp::Entry::MaxAgeSecs() const
+{
+    return iMaxAgeSecs;
+}
+
+const Brx& CpiDeviceCacheUpnp::Entry::Xml() const
+{
+    return iXml;
+}
+
+TUint64 CpiDeviceCacheUpnp::Entry::SeenSecs() const
+{
+    return iSeenSecs;
+}
+
+void CpiDeviceCacheUpnp::Entry::Refresh(TUint aMaxAgeSecs, TUint64 aSeenSecs)
+{
+    iMaxAgeSecs = aMaxAgeSecs;
+    iSeenSecs = aSeenSecs;
+}
+
+TUint CpiDeviceCacheUpnp::Entry::RemainingSecs(TUint64 aNowSecs) const
+{
+    const TUint64 expiry = iSeenSecs + iMaxAgeSecs;
+    if (aNowSecs < iSeenSecs) { // clock has gone backwards; assume no time has passed
+        return iMaxAgeSecs;
+    }
+    return (expiry <= aNowSecs? 0 : (TUint)(expiry - aNowSecs));
+}
+
+
+// CpiDeviceCacheUpnp
+
+const Brn CpiDeviceCacheUpnp::kMagic("OHDC");
+
+CpiDeviceCacheUpnp::CpiDeviceCacheUpnp(Environment& aEnv, IFileSystem& aFileSystem, const Brx& aPath)
+    : iFileSystem(aFileSystem)
+    , iPath(aPath)
+    , iLock("CDCL")
+    , iWriteLock("CDCW")
+    , iDirty(false)
+    , iRefreshed(false)
+{
+    iWriteTimer = new Timer(aEnv, MakeFunctor(*this, &CpiDeviceCacheUpnp::WriteTimerExpired), "CpiDeviceCacheUpnp");
+    Load();
+}
+
+CpiDeviceCacheUpnp::~CpiDeviceCacheUpnp()
+{
+    delete iWriteTimer;
+    Flush();
+    Clear();
+}
+
+void CpiDeviceCacheUpnp::Store(const Brx& aUdn, const Brx& aLocation, TUint aMaxAgeSecs, const Brx& aXml)
+{
+    const TUint64 now = NowSecs();
+    AutoMutex _(iLock);
+    Brn udn(aUdn);
+    EntryMap::iterator it = iEntries.find(udn);
+    if (it != iEntries.end()) {
+        Entry* entry = it->second;
+        if (entry->Location() == aLocation && entry->MaxAgeSecs() == aMaxAgeSecs && entry->Xml() == aXml) {
+            entry->Refresh(aMaxAgeSecs, now);
+            iRefreshed = true;
+            return;
+        }
+        iEntries.erase(it);
+        delete entry;
+    }
+    Entry* entry = new Entry(aUdn, aLocation, aMaxAgeSecs, aXml, now);
+    iEntries.insert(std::pair<Brn, Entry*>(Brn(entry->Udn()), entry));
+    ScheduleWrite();
+}
+
+void CpiDeviceCacheUpnp::Remove(const Brx& aUdn)
+{
+    AutoMutex _(iLock);
+    Brn udn(aUdn);
+    EntryMap::iterator it = iEntries.find(udn);
+    if (it == iEntries.end()) {
+        return;
+    }
+    Entry* entry = it->second;
+    iEntries.erase(it);
+    delete entry;
+    ScheduleWrite();
+}
+
+void CpiDeviceCacheUpnp::Refresh(const Brx& aUdn, TUint aMaxAgeSecs)
+{
+    const TUint64 now = NowSecs();
+    AutoMutex _(iLock);
+    Brn udn(aUdn);
+    EntryMap::iterator it = iEntries.find(udn);
+    if (it != iEntries.end()) {
+        it->second->Refresh(aMaxAgeSecs, now);
+        iRefreshed = true;
+    }
+}
+
+TBool CpiDeviceCacheUpnp::TryGetXml(const Brx& aUdn, const Brx& aLocation, Brh& aXml) const
+{
+    AutoMutex _(iLock);
+    Brn udn(aUdn);
+    EntryMap::const_iterator it = iEntries.find(udn);
+    if (it == iEntries.end() || it->second->Location() != aLocation) {
+        return false;
+    }
+    aXml.Set(it->second->Xml());
+    return true;
+}
+
+void CpiDeviceCacheUpnp::CopyEntries(std::vector<Entry*>& aEntries) const
+{
+    const TUint64 now = NowSecs();
+    AutoMutex _(iLock);
+    aEntries.reserve(aEntries.size() + iEntries.size());
+    for (EntryMap::const_iterator it = iEntries.begin(); it != iEntries.end(); ++it) {
+        const Entry& entry = *(it->second);
+        const TUint remaining = entry.RemainingSecs(now);
+        if (remaining > 0) {
+            aEntries.push_back(new Entry(entry.Udn(), entry.Location(), remaining, entry.Xml(), now));
+        }
+    }
+}
+
+TUint CpiDeviceCacheUpnp::Count() const
+{
+    AutoMutex _(iLock);
+    return (TUint)iEntries.size();
+}
+
+void CpiDeviceCacheUpnp::Flush()
+{
+    iLock.Wait();
+    const TBool changed = (iDirty || iRefreshed);
+    iLock.Signal();
+    if (changed) {
+        Write();
+    }
+}
+
+TUint64 CpiDeviceCacheUpnp::NowSecs()
+{
+    return (TUint64)time(NULL);
+}
+
+void CpiDeviceCacheUpnp::Load()
+{
+    Bwh buf;
+    IFile* file = NULL;
+    try {
+        file = iFileSystem.Open(iPath.CString(), eFileReadOnly);
+        const TUint bytes = file->Bytes();
+        if (bytes > 0) {
+            buf.Grow(bytes);
+            file->Read(buf);
+        }
+    }
+    catch (FileOpenError&) {
+        LOG(kDevice, "CpiDeviceCacheUpnp: no cache at %s\n", iPath.CString());
+    }
+    catch (FileReadError&) {
+        LOG_ERROR(kDevice, "CpiDeviceCacheUpnp: error reading %s\n", iPath.CString());
+        buf.SetBytes(0);
+    }
+    delete file;
+
+    const TUint kCrcBytes = 4;
+    if (buf.Bytes() < kMagic.Bytes() + 8 + kCrcBytes) {
+        return;
+    }
+    Brn body(buf.Ptr(), buf.Bytes() - kCrcBytes);
+    if (Crc32::Compute(body) != Converter::BeUint32At(buf, body.Bytes())) {
+        LOG_ERROR(kDevice, "CpiDeviceCacheUpnp: ignoring corrupt cache %s\n", iPath.CString());
+        return;
+    }
+    ReaderBuffer reader(body);
+    ReaderBinary readerBinary(reader);
+    try {
+        if (reader.Read(kMagic.Bytes()) != kMagic || readerBinary.ReadUintBe(4) != kVersion) {
+            LOG_ERROR(kDevice, "CpiDeviceCacheUpnp: ignoring unsupported cache %s\n", iPath.CString());
+            return;
+        }
+        const TUint64 saved = readerBinary.ReadUint64Be(8);
+        const TUint64 now = NowSecs();
+        if (now < saved) {
+            LOG(kDevice, "CpiDeviceCacheUpnp: %s was saved in the future; clock may have changed\n", iPath.CString());
+        }
+        const TUint count = readerBinary.ReadUintBe(4);
+        TUint expired = 0;
+        AutoMutex _(iLock);
+        for (TUint i=0; i<count; i++) {
+            // ReaderBuffer::Read returns fewer than the requested bytes at the end of a truncated cache
+            TUint bytes = readerBinary.ReadUintBe(4);
+            Brn udn = reader.Read(bytes);
+            if (udn.Bytes() != bytes) {
+                THROW(ReaderError);
+            }
+            bytes = readerBinary.ReadUintBe(4);
+            Brn location = reader.Read(bytes);
+            if (location.Bytes() != bytes) {
+                THROW(ReaderError);
+            }
+            const TUint maxAge = readerBinary.ReadUintBe(4);
+            const TUint64 seen = readerBinary.ReadUint64Be(8);
+            bytes = readerBinary.ReadUintBe(4);
+            Brn xml = reader.Read(bytes);
+            if (xml.Bytes() != bytes) {
+                THROW(ReaderError);
+            }
+            Entry* entry = new Entry(udn, location, maxAge, xml, seen);
+            if (entry->RemainingSecs(now) == 0) {
+                expired++;
+                delete entry;
+            }
+            else if (!iEntries.insert(std::pair<Brn, Entry*>(Brn(entry->Udn()), entry)).second) {
+                delete entry;
+            }
+        }
+        if (expired > 0) {
+            LOG(kDevice, "CpiDeviceCacheUpnp: discarded %u expired devices from %s\n", expired, iPath.CString());
+        }
+    }
+    catch (ReaderError&) {
+        LOG_ERROR(kDevice, "CpiDeviceCacheUpnp: ignoring truncated cache %s\n", iPath.CString());
+        AutoMutex _(iLock);
+        Clear();
+        return;
+    }
+    LOG(kDevice, "CpiDeviceCacheUpnp: loaded %u devices from %s\n", (TUint)iEntries.size(), iPath.CString());
+}
+
+void CpiDeviceCacheUpnp::Write()
+{
+    AutoMutex _(iWriteLock);
+    WriterBwh writer(16 * 1024);
+    WriterBinary writerBinary(writer);
+    const TUint64 now = NowSecs();
+    iLock.Wait();
+    iDirty = false;
+    iRefreshed = false;
+    writer.Write(kMagic);
+    writerBinary.WriteUint32Be(kVersion);
+    writerBinary.WriteUint64Be(now);
+    TUint count = 0;
+    for (EntryMap::const_iterator it = iEntries.begin(); it != iEntries.end(); ++it) {
+        if (it->second->RemainingSecs(now) > 0) {
+            count++;
+        }
+    }
+    writerBinary.WriteUint32Be(count);
+    for (EntryMap::const_iterator it = iEntries.begin(); it != iEntries.end(); ++it) {
+        const Entry& entry = *(it->second);
+        if (entry.RemainingSecs(now) == 0) {
+            continue;
+        }
+        writerBinary.WriteUint32Be(entry.Udn().Bytes());
+        writer.Write(entry.Udn());
+        writerBinary.WriteUint32Be(entry.Location().Bytes());
+        writer.Write(entry.Location());
+        writerBinary.WriteUint32Be(entry.MaxAgeSecs());
+        writerBinary.WriteUint64Be(entry.SeenSecs());
+        writerBinary.WriteUint32Be(entry.Xml().Bytes());
+        writer.Write(entry.Xml());
+    }
+    iLock.Signal();
+    writerBinary.WriteUint32Be(Crc32::Compute(writer.Buffer()));
+
+    Bwh tmpPath(iPath.Bytes() + 5);
+    tmpPath.Append(iPath);
+    tmpPath.Append(Brn(".tmp"));
+    Brhz tmp(tmpPath);
+    IFile* file = NULL;
+    TBool written = false;
+    try {
+        file = iFileSystem.Open(tmp.CString(), eFileWriteOnly);
+        file->Write(writer.Buffer());
+        file->Flush();
+        file->Sync();
+        written = true;
+    }
+    catch (FileOpenError&) {
+        LOG_ERROR(kDevice, "CpiDeviceCacheUpnp: unable to open %s\n", tmp.CString());
+    }
+    catch (FileWriteError&) {
+        LOG_ERROR(kDevice, "CpiDeviceCacheUpnp: error writing %s\n", tmp.CString());
+    }
+    delete file;
+    try {
+        if (written) {
+            iFileSystem.Rename(tmp.CString(), iPath.CString());
+        }
+        else if (file != NULL) {
+            iFileSystem.Unlink(tmp.CString());
+        }
+    }
+    catch (RenameFailed&) {
+        LOG_ERROR(kDevice, "CpiDeviceCacheUpnp: unable to replace %s\n", iPath.CString());
+    }
+    catch (UnlinkFailed&) {
+    }
+}
+
+void CpiDeviceCacheUpnp::ScheduleWrite()
+{
+    // called with iLock held
+    if (!iDirty) {
+        iDirty = true;
+        iWriteTimer->FireIn(kWriteDelayMs); // batch the burst of changes seen at startup into a single write
+    }
+}
+
+void CpiDeviceCacheUpnp::WriteTimerExpired()
+{
+    Write();
+}
+
+void CpiDeviceCacheUpnp::Clear()
+{
+    for (EntryMap::iterator it = iEntries.begin(); it != iEntries.end(); ++it) {
+        delete it->second;
+    }
+    iEntries.clear();
+}
@@ -0,0 +1,103 @@
+/**
+ * Persistent record of UPnP devices discovered by control points
+ *
+ * NOT intended for use by clients of the library
+ */
+
+#ifndef HEADER_CPIDEVICECACHEUPNP
+#define HEADER_CPIDEVICECACHEUPNP
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Standard.h>
+
+#include <map>
+#include <vector>
+
+namespace OpenHome {
+class Environment;
+class IFileSystem;
+class Timer;
+namespace Net {
+
+/**
+ * Udn, location, max age and device xml of every UPnP device a control point has
+ * successfully fetched xml for, saved to a file so that device lists can report
+ * known devices as soon as they're started in a later run.
+ *
+ * Devices are forgotten when they send byebye, their max age expires or they fail
+ * a contactable check.  Changes are written to disk (shortly after they happen)
+ * from a timer callback.  Enabled via InitialisationParams::SetCpDeviceCache().
+ *
+ * Each entry records the (wall clock) time its device was last seen.  Entries whose
+ * max age has run out since then are dropped when the cache is loaded or written;
+ * CopyEntries() reports the max age remaining for the others.
+ */
+class CpiDeviceCacheUpnp : private INonCopyable
+{
+public:
+    class Entry : private INonCopyable
+    {
+    public:
+        Entry(const Brx& aUdn, const Brx& aLocation, TUint aMaxAgeSecs, const Brx& aXml, TUint64 aSeenSecs);
+        const Brx& Udn() const;
+        const Brx& Location() const;
+        TUint MaxAgeSecs() const;
+        const Brx& Xml() const;
+        TUint64 SeenSecs() const;
+        void Refresh(TUint aMaxAgeSecs, TUint64 aSeenSecs);
+        TUint RemainingSecs(TUint64 aNowSecs) const; // 0 => expired
+    private:
+        Brh iUdn;
+        Brh iLocation;
+        TUint iMaxAgeSecs;
+        Brh iXml;
+        TUint64 iSeenSecs;
+    };
+public:
+    CpiDeviceCacheUpnp(Environment& aEnv, IFileSystem& aFileSystem, const Brx& aPath);
+    ~CpiDeviceCacheUpnp(); // writes any changes not yet saved
+    void Store(const Brx& aUdn, const Brx& aLocation, TUint aMaxAgeSecs, const Brx& aXml);
+    void Remove(const Brx& aUdn);
+    /**
+     * Records that a device has been seen again (without changes worth writing immediately).
+     */
+    void Refresh(const Brx& aUdn, TUint aMaxAgeSecs);
+    /**
+     * Returns true and sets aXml if a device with aUdn was last seen at aLocation.
+     */
+    TBool TryGetXml(const Brx& aUdn, const Brx& aLocation, Brh& aXml) const;
+    /**
+     * Copies all unexpired entries into aEntries, with their remaining max age.
+     * Caller takes ownership of the copies.
+     */
+    void CopyEntries(std::vector<Entry*>& aEntries) const;
+    TUint Count() const;
+    void Flush(); // write any outstanding changes now
+private:
+    static TUint64 NowSecs();
+    void Load();
+    void Write();
+    void ScheduleWrite();
+    void WriteTimerExpired();
+    void Clear();
+private:
+    static const TUint kVersion = 2;
+    static const TUint kWriteDelayMs = 1000;
+    static const Brn kMagic;
+    typedef std::map<Brn, Entry*, BufferCmp> EntryMap;
+    IFileSystem& iFileSystem;
+    Brhz iPath;
+    mutable Mutex iLock;
+    Mutex iWriteLock;
+    EntryMap iEntries;
+    Timer* iWriteTimer;
+    TBool iDirty;
+    TBool iRefreshed; // seen times have changed since the last write
+};
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_CPIDEVICECACHEUPNP
@@ -22,6 +22,8 @@
 #include <OpenHome/Net/Private/Globals.h>
 #include <OpenHome/Private/TIpAddressUtils.h>
 #include <OpenHome/Net/Private/Error.h>
+#include <OpenHome/Net/Private/CpiDeviceCacheUpnp.h>
+#include <OpenHome/Net/Private/Ssdp.h>
 
 #include <string.h>
 
@@ -47,6 +49,7 @@ CpiDeviceUpnp::CpiDeviceUpnp(CpStack& aCpStack, const Brx& aUdn, const Brx& aLoc
     , iNewLocation(NULL)
     , iXmlCheckLocation(NULL)
     , iXmlCheckRefresh(NULL)
+    , iFromCache(false)
 {
     Environment& env = aCpStack.Env();
     iHostUdpIsLowQuality = env.InitParams()->IsHostUdpLowQuality();
@@ -72,6 +75,7 @@ CpiDeviceUpnp::CpiDeviceUpnp(CpStack& aCpStack, const Brx& aLocation, IDeviceRem
     , iNewLocation(NULL)
     , iXmlCheckLocation(NULL)
     , iXmlCheckRefresh(NULL)
+    , iFromCache(false)
 {
     iHostUdpIsLowQuality = true; // device was "discovered" based on old IP address so we have no reason to be confident that UDP is reliable
     iDevice = NULL; // we need to read device XML to find the udn first
@@ -112,6 +116,38 @@ TBool CpiDeviceUpnp::Ready() const
     return iDeviceXml != NULL;
 }
 
+const Brx& CpiDeviceUpnp::Xml() const
+{
+    return iXml;
+}
+
+TBool CpiDeviceUpnp::SetCachedXml(const Brx& aXml)
+{
+    AutoMutex _(iLock);
+    ASSERT(iDeviceXml == NULL);
+    iXml.Set(aXml);
+    try {
+        iDeviceXmlDocument = new DeviceXmlDocument(iXml);
+        iDeviceXml = new DeviceXml(iDeviceXmlDocument->Find(Udn()));
+    }
+    catch (XmlError&) {
+        const Brx& udn = Udn();
+        LOG_ERROR(kDevice, "Ignoring invalid cached xml for %.*s\n", PBUF(udn));
+        delete iDeviceXmlDocument;
+        iDeviceXmlDocument = NULL;
+        iXml.Set(Brx::Empty());
+        return false;
+    }
+    iFromCache = true;
+    return true;
+}
+
+TBool CpiDeviceUpnp::IsFromCache() const
+{
+    AutoMutex _(iLock);
+    return iFromCache;
+}
+
 void CpiDeviceUpnp::UpdateMaxAge(TUint aSeconds)
 {
     iMaxAgeSeconds = aSeconds;
@@ -392,6 +428,7 @@ void CpiDeviceUpnp::TimerExpired()
     }
     else {
         iDevice->SetExpired(true);
+        RemoveFromCache();
         iDeviceList.Remove(Udn());
     }
 }
@@ -485,6 +522,14 @@ TBool CpiDeviceUpnp::UdnMatches(const Brx& aFound, const Brx& aTarget)
     return (udn == aTarget);
 }
 
+void CpiDeviceUpnp::RemoveFromCache()
+{
+    CpiDeviceCacheUpnp* cache = iCpStack.DeviceCacheUpnp();
+    if (cache != NULL) {
+        cache->Remove(Udn());
+    }
+}
+
 void CpiDeviceUpnp::XmlFetchReadUdnCompleted(IAsync& aAsync)
 {
     iLock.Wait();
@@ -612,6 +657,7 @@ void CpiDeviceUpnp::XmlCheckRefreshCompleted(IAsync& aAsync)
 
         if (!interrupted && !contactable) {
             Log::Print("XmlCheckRefreshCompleted - FAIL - %.*s\n", PBUF(Udn()));
+            RemoveFromCache();
             iDeviceList.Remove(Udn());
         }
     }
@@ -642,10 +688,11 @@ void CpiDeviceUpnp::Invocable::InvokeAction(Invocation& aInvocation)
 
 // CpiDeviceListUpnp
 
-CpiDeviceListUpnp::CpiDeviceListUpnp(CpStack& aCpStack, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
+CpiDeviceListUpnp::CpiDeviceListUpnp(CpStack& aCpStack, const SsdpNotifyFilter& aNotifyFilter, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
     : CpiDeviceList(aCpStack, aAdded, aRemoved)
     , iSsdpLock("DLSM")
     , iEnv(aCpStack.Env())
+    , iNotifyFilter(aNotifyFilter)
     , iStarted(false)
     , iNoRemovalsFromRefresh(false)
     , iRepeatMsearchMs(30 * 1000)
@@ -670,7 +717,7 @@ CpiDeviceListUpnp::CpiDeviceListUpnp(CpStack& aCpStack, FunctorCpiDevice aAdded,
         iInterface = current->Address();
         iUnicastListener = new SsdpListenerUnicast(iCpStack.Env(), *this, iInterface);
         iMulticastListener = &(iCpStack.Env().MulticastListenerClaim(iInterface));
-        iNotifyHandlerId = iMulticastListener->AddNotifyHandler(this);
+        iNotifyHandlerId = iMulticastListener->AddNotifyHandler(this, iNotifyFilter);
     }
     iSsdpLock.Signal();
     iCpStack.Env().AddResumeObserver(*this);
@@ -726,6 +773,14 @@ void CpiDeviceListUpnp::Add(CpiDeviceUpnp* aDevice)
     const TUint maxAgeMs = aDevice->MaxAgeSeconds() * 1000;
     const TUint repeatMsearchMs = (3 * maxAgeMs) / 4;
 
+    CpiDeviceCacheUpnp* cache = iCpStack.DeviceCacheUpnp();
+    if (cache != NULL && !aDevice->Ready()) {
+        Brh xml;
+        if (cache->TryGetXml(aDevice->Udn(), aDevice->Location(), xml)) {
+            (void)aDevice->SetCachedXml(xml);
+        }
+    }
+
     CpiDeviceList::Add(&aDevice->Device());
 
     if (repeatMsearchMs > iRepeatMsearchMs) {
@@ -767,6 +822,7 @@ TBool CpiDeviceListUpnp::Update(const Brx& aUdn, const Brx& aLocation, TUint aMa
         }
         deviceUpnp->UpdateMaxAge(aMaxAge);
         iLock.Signal();
+        RefreshCache(aUdn, aMaxAge);
         device->RemoveRef();
         return !iRefreshing;
     }
@@ -782,10 +838,13 @@ void CpiDeviceListUpnp::DoStart()
     iStarted = true;
     iLock.Signal();
     if (needsStart) {
-        AutoMutex a(iSsdpLock);
-        if (iUnicastListener != NULL) {
-            iUnicastListener->Start();
+        {
+            AutoMutex a(iSsdpLock);
+            if (iUnicastListener != NULL) {
+                iUnicastListener->Start();
+            }
         }
+        AddCachedDevices();
     }
 }
 
@@ -831,7 +890,11 @@ TBool CpiDeviceListUpnp::IsDeviceReady(CpiDevice& aDevice)
 {
     CpiDeviceUpnp* deviceUpnp = reinterpret_cast<CpiDeviceUpnp*>(aDevice.OwnerData());
     if (deviceUpnp->Ready()) {
-        // device was 'discovered' at last known location => we've already fetched xml
+        /* device was 'discovered' at last known location => we've already fetched xml
+           or xml came from the device cache => report it now but check it's still there */
+        if (deviceUpnp->IsFromCache()) {
+            deviceUpnp->CheckStillAvailable();
+        }
         return true;
     }
     deviceUpnp->FetchXml();
@@ -936,7 +999,7 @@ void CpiDeviceListUpnp::HandleInterfaceChange()
         iUnicastListener = new SsdpListenerUnicast(iCpStack.Env(), *this, iInterface);
         iUnicastListener->Start();
         iMulticastListener = &(iCpStack.Env().MulticastListenerClaim(iInterface));
-        iNotifyHandlerId = iMulticastListener->AddNotifyHandler(this);
+        iNotifyHandlerId = iMulticastListener->AddNotifyHandler(this, iNotifyFilter);
     }
     Refresh();
 }
@@ -967,13 +1030,106 @@ void CpiDeviceListUpnp::XmlFetchCompleted(CpiDeviceUpnp& aDevice, TBool aError)
         const Brx& location = aDevice.Location();
         LOG_ERROR(kDevice, "Device xml fetch error {udn{%.*s}, location{%.*s}}\n",
                              PBUF(udn), PBUF(location));
+        RemoveFromCache(aDevice.Udn());
         Remove(aDevice.Udn());
     }
     else {
+        CpiDeviceCacheUpnp* cache = iCpStack.DeviceCacheUpnp();
+        if (cache != NULL) {
+            cache->Store(aDevice.Udn(), aDevice.Location(), aDevice.MaxAgeSeconds(), aDevice.Xml());
+        }
         SetDeviceReady(aDevice.Device());
     }
 }
 
+void CpiDeviceListUpnp::AddCachedDevices()
+{
+    CpiDeviceCacheUpnp* cache = iCpStack.DeviceCacheUpnp();
+    if (cache == NULL) {
+        return;
+    }
+    std::vector<CpiDeviceCacheUpnp::Entry*> entries;
+    cache->CopyEntries(entries);
+    for (TUint i=0; i<(TUint)entries.size(); i++) {
+        const CpiDeviceCacheUpnp::Entry& entry = *entries[i];
+        if (IsLocationReachable(entry.Location())) {
+            try {
+                AnnounceCachedDevice(entry);
+            }
+            catch (XmlError&) {
+                LOG_ERROR(kDevice, "Discarding invalid cached device %.*s\n", PBUF(entry.Udn()));
+                cache->Remove(entry.Udn());
+            }
+        }
+        delete entries[i];
+    }
+}
+
+void CpiDeviceListUpnp::AnnounceCachedDevice(const CpiDeviceCacheUpnp::Entry& aEntry)
+{
+    /* Replay the alive notifications the device would have sent.  Each type of list
+       then applies its normal filtering and, from Add(), picks up the cached xml. */
+    const Brx& udn = aEntry.Udn();
+    const Brx& location = aEntry.Location();
+    const TUint maxAge = aEntry.MaxAgeSecs();
+    DeviceXmlDocument doc(aEntry.Xml());
+    Brn device = doc.Find(udn);
+    if (doc.Root().Udn() == udn) {
+        SsdpNotifyRootAlive(udn, location, maxAge);
+    }
+    SsdpNotifyUuidAlive(udn, location, maxAge);
+    Brn domain;
+    Brn type;
+    TUint version;
+    Bwh canonicalDomain;
+    Parser parser(XmlParserBasic::Find("deviceType", device));
+    (void)parser.Next(':'); // "urn"
+    if (Ssdp::ParseUrnDevice(parser.Remaining(), domain, type, version)) {
+        canonicalDomain.Grow(domain.Bytes());
+        Ssdp::UpnpDomainToCanonical(domain, canonicalDomain);
+        SsdpNotifyDeviceTypeAlive(udn, canonicalDomain, type, version, location, maxAge);
+    }
+    Brn serviceList;
+    try {
+        serviceList.Set(XmlParserBasic::Find("serviceList", device));
+    }
+    catch (XmlError&) {
+        return; // no services
+    }
+    for (;;) {
+        Brn service;
+        try {
+            service.Set(XmlParserBasic::Find("service", serviceList, serviceList));
+        }
+        catch (XmlError&) {
+            break;
+        }
+        Parser parser(XmlParserBasic::Find("serviceType", service));
+        (void)parser.Next(':'); // "urn"
+        if (Ssdp::ParseUrnService(parser.Remaining(), domain, type, version)) {
+            canonicalDomain.Grow(domain.Bytes());
+            Ssdp::UpnpDomainToCanonical(domain, canonicalDomain);
+            SsdpNotifyServiceTypeAlive(udn, canonicalDomain, type, version, location, maxAge);
+        }
+    }
+}
+
+void CpiDeviceListUpnp::RemoveFromCache(const Brx& aUdn)
+{
+    CpiDeviceCacheUpnp* cache = iCpStack.DeviceCacheUpnp();
+    if (cache != NULL) {
+        cache->Remove(aUdn);
+    }
+}
+
+void CpiDeviceListUpnp::RefreshCache(const Brx& aUdn, TUint aMaxAge)
+{
+    CpiDeviceCacheUpnp* cache = iCpStack.DeviceCacheUpnp();
+    if (cache != NULL) {
+        cache->Refresh(aUdn, aMaxAge);
+    }
+}
+
 void CpiDeviceListUpnp::DeviceLocationChanged(CpiDeviceUpnp* aOriginal, CpiDeviceUpnp* aNew)
 {
     Remove(aOriginal->Udn());
@@ -1004,21 +1160,25 @@ void CpiDeviceListUpnp::SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx&
 
 void CpiDeviceListUpnp::SsdpNotifyRootByeBye(const Brx& aUuid)
 {
+    RemoveFromCache(aUuid);
     Remove(aUuid);
 }
 
 void CpiDeviceListUpnp::SsdpNotifyUuidByeBye(const Brx& aUuid)
 {
+    RemoveFromCache(aUuid);
     Remove(aUuid);
 }
 
 void CpiDeviceListUpnp::SsdpNotifyDeviceTypeByeBye(const Brx& aUuid, const Brx& /*aDomain*/, const Brx& /*aType*/, TUint /*aVersion*/)
 {
+    RemoveFromCache(aUuid);
     Remove(aUuid);
 }
 
 void CpiDeviceListUpnp::SsdpNotifyServiceTypeByeBye(const Brx& aUuid, const Brx& /*aDomain*/, const Brx& /*aType*/, TUint /*aVersion*/)
 {
+    RemoveFromCache(aUuid);
     Remove(aUuid);
 }
 
@@ -1033,7 +1193,7 @@ void CpiDeviceListUpnp::NotifyResumed()
 // CpiDeviceListUpnpAll
 
 CpiDeviceListUpnpAll::CpiDeviceListUpnpAll(CpStack& aCpStack, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
-    : CpiDeviceListUpnp(aCpStack, aAdded, aRemoved)
+    : CpiDeviceListUpnp(aCpStack, SsdpNotifyFilter(eSsdpAll), aAdded, aRemoved)
 {
 }
 
@@ -1096,7 +1256,7 @@ void CpiDeviceListUpnpAll::SsdpNotification(const Brx& aUuid, const Brx& aLocati
 // CpiDeviceListUpnpRoot
 
 CpiDeviceListUpnpRoot::CpiDeviceListUpnpRoot(CpStack& aCpStack, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
-    : CpiDeviceListUpnp(aCpStack, aAdded, aRemoved)
+    : CpiDeviceListUpnp(aCpStack, SsdpNotifyFilter(eSsdpRoot), aAdded, aRemoved)
 {
 }
 
@@ -1137,7 +1297,7 @@ void CpiDeviceListUpnpRoot::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLo
 // CpiDeviceListUpnpUuid
 
 CpiDeviceListUpnpUuid::CpiDeviceListUpnpUuid(CpStack& aCpStack, const Brx& aUuid, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
-    : CpiDeviceListUpnp(aCpStack, aAdded, aRemoved)
+    : CpiDeviceListUpnp(aCpStack, SsdpNotifyFilter(eSsdpUuid, aUuid), aAdded, aRemoved)
     , iUuid(aUuid)
 {
 }
@@ -1183,7 +1343,7 @@ void CpiDeviceListUpnpUuid::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLo
 
 CpiDeviceListUpnpDeviceType::CpiDeviceListUpnpDeviceType(CpStack& aCpStack, const Brx& aDomainName, const Brx& aDeviceType,
                                                          TUint aVersion, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
-    : CpiDeviceListUpnp(aCpStack, aAdded, aRemoved)
+    : CpiDeviceListUpnp(aCpStack, SsdpNotifyFilter(eSsdpDeviceType, aDomainName, aDeviceType), aAdded, aRemoved)
     , iDomainName(aDomainName)
     , iDeviceType(aDeviceType)
     , iVersion(aVersion)
@@ -1232,7 +1392,7 @@ void CpiDeviceListUpnpDeviceType::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, co
 
 CpiDeviceListUpnpServiceType::CpiDeviceListUpnpServiceType(CpStack& aCpStack, const Brx& aDomainName, const Brx& aServiceType,
                                                            TUint aVersion, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
-    : CpiDeviceListUpnp(aCpStack, aAdded, aRemoved)
+    : CpiDeviceListUpnp(aCpStack, SsdpNotifyFilter(eSsdpServiceType, aDomainName, aServiceType), aAdded, aRemoved)
     , iDomainName(aDomainName)
     , iServiceType(aServiceType)
     , iVersion(aVersion)
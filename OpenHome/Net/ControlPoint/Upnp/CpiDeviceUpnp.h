@@ -17,6 +17,7 @@
 #include <OpenHome/Net/Private/CpiService.h>
 #include <OpenHome/Net/Private/DeviceXml.h>
 #include <OpenHome/Net/Private/XmlFetcher.h>
+#include <OpenHome/Net/Private/CpiDeviceCacheUpnp.h>
 #include <OpenHome/Private/Env.h>
 
 namespace OpenHome {
@@ -41,6 +42,13 @@ public:
     TUint MaxAgeSeconds() const;
     CpiDevice& Device();
     TBool Ready() const;
+    const Brx& Xml() const;
+    /**
+     * Use device xml from CpiDeviceCacheUpnp rather than fetching it.
+     * Returns false (leaving the device to fetch its xml as normal) if aXml can't be parsed.
+     */
+    TBool SetCachedXml(const Brx& aXml);
+    TBool IsFromCache() const;
 
     /**
      * Called to reset the maxage timeout each time an alive message is received.
@@ -75,6 +83,7 @@ private:
     void XmlCheckLocationCompleted(IAsync& aAsync);
     void XmlCheckRefreshCompleted(IAsync& aAsync);
     static TBool UdnMatches(const Brx& aFound, const Brx& aTarget);
+    void RemoveFromCache();
 private:
     class Invocable : public IInvocable, private INonCopyable
     {
@@ -105,6 +114,7 @@ private:
     CpiDeviceUpnp* iNewLocation;
     XmlFetch* iXmlCheckLocation;
     XmlFetch* iXmlCheckRefresh;
+    TBool iFromCache;
     friend class Invocable;
 };
 
@@ -120,7 +130,7 @@ public:
     void DeviceLocationChanged(CpiDeviceUpnp* aOriginal, CpiDeviceUpnp* aNew);
     void TryAdd(const Brx& aLocation);
 protected:
-    CpiDeviceListUpnp(CpStack& aCpStack, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
+    CpiDeviceListUpnp(CpStack& aCpStack, const SsdpNotifyFilter& aNotifyFilter, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
     ~CpiDeviceListUpnp();
 
     void StopListeners();
@@ -162,6 +172,10 @@ private:
     void SubnetListChanged();
     void HandleInterfaceChange();
     void RemoveAll();
+    void AddCachedDevices();
+    void AnnounceCachedDevice(const CpiDeviceCacheUpnp::Entry& aEntry);
+    void RemoveFromCache(const Brx& aUdn);
+    void RefreshCache(const Brx& aUdn, TUint aMaxAge);
 protected:
     SsdpListenerUnicast* iUnicastListener;
     Mutex iSsdpLock;
@@ -172,6 +186,7 @@ private:
     Environment& iEnv;
     TIpAddress iInterface;
     SsdpListenerMulticast* iMulticastListener;
+    SsdpNotifyFilter iNotifyFilter;
     TInt iNotifyHandlerId;
     TUint iInterfaceChangeListenerId;
     TUint iSubnetListChangeListenerId;
@@ -6,6 +6,7 @@
 #include <OpenHome/Exception.h>
 #include <OpenHome/Private/Debug.h>
 #include <OpenHome/Net/Core/OhNet.h>
+#include <OpenHome/Private/Metrics.h>
 
 #include <stdlib.h>
 
@@ -278,121 +279,20 @@ TUint XmlFetch::Type() const
 }
 
 
-// XmlFetcher
-
-XmlFetcher::XmlFetcher(const TChar* aName, Fifo<XmlFetcher*>& aFree)
-    : Thread(aName)
-    , iFree(aFree)
-    , iLock("XMLF")
-    , iFetch(NULL)
-{
-}
-
-XmlFetcher::~XmlFetcher()
-{
-    Kill();
-
-    iLock.Wait();
-    if (iFetch != NULL) {
-        iFetch->Interrupt();
-    }
-    iLock.Signal();
-
-    Join();
-}
-
-void XmlFetcher::Fetch(XmlFetch* aFetch)
-{
-    iLock.Wait();
-    iFetch = aFetch;
-    iLock.Signal();
-
-    Signal();
-}
-
-#ifdef DEFINE_TRACE
-void XmlFetcher::LogError(const TChar* aErr)
-#else
-void XmlFetcher::LogError(const TChar* /*aErr*/)
-#endif
-{
-    const Brx& absUri = iFetch->Uri().AbsoluteUri();
-    LOG_ERROR(kXmlFetch, "Error - %s - from %.*s\n", aErr, PBUF(absUri));
-}
-
-void XmlFetcher::Run()
-{
-    XmlFetch *fetch = NULL;
-
-    for (;;) {
-        Wait();
-
-        iLock.Wait();
-        fetch = iFetch;
-        iLock.Signal();
-
-        if (fetch != NULL) {
-            try {
-                if (fetch->Interrupted()) {
-                    fetch->SetError(Error::eAsync, Error::eCodeInterrupted,
-                                    Error::kDescriptionAsyncInterrupted);
-                } else {
-                    fetch->Fetch();
-                }
-            }
-            catch (HttpError &) {
-                LogError("Http");
-            }
-            catch (NetworkTimeout &) {
-                // error already set in XmlFetch::Fetch()
-                LogError("NetworkTimeout");
-            }
-            catch (NetworkError &) {
-                iFetch->SetError(Error::eSocket, Error::kCodeUnknown, kNetworkErrorDescription);
-                LogError("Network");
-            }
-            catch (WriterError &) {
-                LogError("Writer");
-            }
-            catch (ReaderError &) {
-                iFetch->SetError(Error::eSocket, Error::kCodeUnknown, kReaderErrorDescription);
-                LogError("Reader");
-            }
-
-            iLock.Wait();
-            iFetch = NULL;
-            iLock.Signal();
-
-            fetch->SignalCompleted();
-            delete fetch;
-        }
-
-        iFree.Write(this);
-    }
-}
-
-
 // XmlFetchManager
 
 XmlFetchManager::XmlFetchManager(CpStack& aCpStack)
-    : Thread("XmlFetchManager")
-    , iCpStack(aCpStack)
+    : iCpStack(aCpStack)
     , iLock("FETL")
-    , iFree(iCpStack.Env().InitParams()->NumXmlFetcherThreads())
+    , iActive(true)
+    , iMetricFetches(aCpStack.Env().Metrics().Counter("ohnet_cp_xml_fetches_total", "Device and service descriptions fetched"))
+    , iMetricErrors(aCpStack.Env().Metrics().Counter("ohnet_cp_xml_fetch_errors_total", "Device and service description fetches which failed"))
+    , iMetricLatency(aCpStack.Env().Metrics().Histogram("ohnet_cp_xml_fetch_seconds", "Time taken to fetch a device or service description"))
 {
-    const TUint numThreads = iCpStack.Env().InitParams()->NumXmlFetcherThreads();
-    iFetchers = (XmlFetcher**)malloc(sizeof(*iFetchers) * numThreads);
-    for (TUint i=0; i<numThreads; i++) {
-        Bws<Thread::kMaxNameBytes+1> thName;
-        thName.AppendPrintf("XmlFetcher %d", i);
-        thName.PtrZ();
-        iFetchers[i] = new XmlFetcher((const TChar*)thName.Ptr(), iFree);
-        iFree.Write(iFetchers[i]);
-        iFetchers[i]->Start();
-    }
-
-    iActive = true;
-    Start();
+    InitialisationParams* initParams = iCpStack.Env().InitParams();
+    TUint maxThreads, idleTimeoutMs;
+    initParams->GetWorkerPoolLimits(InitialisationParams::eWorkerPoolXmlFetcher, maxThreads, idleTimeoutMs);
+    iFetchers = new WorkerPool(iCpStack.Env(), "XmlFetcher", *this, initParams->NumXmlFetcherThreads(), maxThreads, idleTimeoutMs);
 }
 
 XmlFetchManager::~XmlFetchManager()
@@ -401,16 +301,12 @@ XmlFetchManager::~XmlFetchManager()
 
     iLock.Wait();
     iActive = false;
+    for (std::list<XmlFetch*>::iterator it=iActiveFetches.begin(); it!=iActiveFetches.end(); ++it) {
+        (*it)->Interrupt();
+    }
     iLock.Signal();
-    Kill();
-    Join();
 
-    iFree.ReadInterrupt();
-
-    for (TUint i=0; i<iCpStack.Env().InitParams()->NumXmlFetcherThreads(); i++) {
-        delete iFetchers[i];
-    }
-    free(iFetchers);
+    delete iFetchers;
 
     TUint size = (TUint)iList.size();
     while (size > 0) {
@@ -419,6 +315,7 @@ XmlFetchManager::~XmlFetchManager()
                         Error::kDescriptionAsyncShutdown);
         fetch->SignalCompleted();
         iList.pop_front();
+        delete fetch;
         size--;
     }
 
@@ -449,23 +346,64 @@ void XmlFetchManager::Fetch(XmlFetch* aFetch)
         return;
     }
     iList.push_back(aFetch);
-    Signal();
+    iFetchers->JobAdded();
+}
+
+#ifdef DEFINE_TRACE
+void XmlFetchManager::LogError(XmlFetch& aFetch, const TChar* aErr)
+#else
+void XmlFetchManager::LogError(XmlFetch& aFetch, const TChar* /*aErr*/)
+#endif
+{
+    iMetricErrors.Inc();
+    const Brx& absUri = aFetch.Uri().AbsoluteUri();
+    LOG_ERROR(kXmlFetch, "Error - %s - from %.*s\n", aErr, PBUF(absUri));
 }
 
-void XmlFetchManager::Run()
+void XmlFetchManager::ProcessJob()
 {
-    for (;;) {
-        Wait();
-        XmlFetcher* fetcher = iFree.Read();
-        iLock.Wait();
-        if (!iActive) {
-            iLock.Signal();
-            continue; // the next Wait() will throw ThreadKill
+    iLock.Wait();
+    XmlFetch* fetch = iList.front();
+    iList.pop_front();
+    iActiveFetches.push_back(fetch);
+    if (!iActive) {
+        fetch->Interrupt(); // we've raced with ~XmlFetchManager
+    }
+    iLock.Signal();
+
+    try {
+        if (fetch->Interrupted()) {
+            fetch->SetError(Error::eAsync, Error::eCodeInterrupted,
+                            Error::kDescriptionAsyncInterrupted);
+        } else {
+            iMetricFetches.Inc();
+            AutoMetricTimer _(iCpStack.Env(), iMetricLatency);
+            fetch->Fetch();
         }
-        XmlFetch* fetch = iList.front();
-        iList.front() = NULL;
-        iList.pop_front();
-        iLock.Signal();
-        fetcher->Fetch(fetch);
     }
+    catch (HttpError &) {
+        LogError(*fetch, "Http");
+    }
+    catch (NetworkTimeout &) {
+        // error already set in XmlFetch::Fetch()
+        LogError(*fetch, "NetworkTimeout");
+    }
+    catch (NetworkError &) {
+        fetch->SetError(Error::eSocket, Error::kCodeUnknown, kNetworkErrorDescription);
+        LogError(*fetch, "Network");
+    }
+    catch (WriterError &) {
+        LogError(*fetch, "Writer");
+    }
+    catch (ReaderError &) {
+        fetch->SetError(Error::eSocket, Error::kCodeUnknown, kReaderErrorDescription);
+        LogError(*fetch, "Reader");
+    }
+
+    iLock.Wait();
+    iActiveFetches.remove(fetch);
+    iLock.Signal();
+
+    fetch->SignalCompleted();
+    delete fetch;
 }
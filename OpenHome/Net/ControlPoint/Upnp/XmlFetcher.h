@@ -9,7 +9,7 @@
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Private/Uri.h>
 #include <OpenHome/Types.h>
-#include <OpenHome/Private/Fifo.h>
+#include <OpenHome/Private/WorkerPool.h>
 #include <OpenHome/Private/Network.h>
 #include <OpenHome/Private/Stream.h>
 #include <OpenHome/Private/Http.h>
@@ -22,6 +22,8 @@ EXCEPTION(XmlFetchError)
 
 namespace OpenHome {
 class SocketTcpClient;
+class MetricCounter;
+class MetricHistogram;
 namespace Net {
 
 class CpStack;
@@ -71,24 +73,9 @@ private:
     friend class XmlFetchManager;
 };
 
-class XmlFetcher : public Thread
-{
-public:
-    XmlFetcher(const TChar* aName, Fifo<XmlFetcher*>& aFree);
-    ~XmlFetcher();
-    void Fetch(XmlFetch* aFetch);
-private:
-    void LogError(const TChar* aErr);
-    void Run();
-private:
-    Fifo<XmlFetcher*>& iFree;
-    OpenHome::Mutex iLock;
-    XmlFetch* iFetch;
-};
-
 class CpStack;
 
-class XmlFetchManager : public Thread
+class XmlFetchManager : private IWorkerPoolHandler
 {
 public:
     XmlFetchManager(CpStack& aCpStack);
@@ -96,14 +83,19 @@ public:
     XmlFetch* Fetch();
     void Fetch(XmlFetch* aFetch);
 private:
-    void Run();
+    void LogError(XmlFetch& aFetch, const TChar* aErr);
+private: // from IWorkerPoolHandler
+    void ProcessJob();
 private:
     CpStack& iCpStack;
     OpenHome::Mutex iLock;
     std::list<XmlFetch*> iList;
-    Fifo<XmlFetcher*> iFree;
-    XmlFetcher** iFetchers;
+    std::list<XmlFetch*> iActiveFetches;
+    WorkerPool* iFetchers;
     TBool iActive;
+    MetricCounter& iMetricFetches;
+    MetricCounter& iMetricErrors;
+    MetricHistogram& iMetricLatency;
 };
 
 } // namespace Net
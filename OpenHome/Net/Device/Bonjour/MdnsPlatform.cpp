@@ -5,6 +5,7 @@
 #include <OpenHome/Private/Network.h>
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Private/Timer.h>
+#include <OpenHome/Private/Time.h>
 #include <OpenHome/Private/Arch.h>
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Private/NetworkAdapterList.h>
@@ -138,14 +139,15 @@ mDNSInterfaceID MdnsPlatform::InterfaceIdAllocator::GetIdForAddress(const TIpAdd
 MdnsPlatform::MdnsService::MdnsService(mDNS& aMdns)
     : iMdns(aMdns)
     , iAction(eInvalid)
+    , iRecord(NULL)
+    , iActivation(0)
 {
 }
 
-void MdnsPlatform::MdnsService::Set(MdnsServiceAction aAction, TUint aHandle, ServiceRecordSet& aService, const TChar* aName, const TChar* aType, const mDNSInterfaceID aInterfaceId, TUint aPort, const TChar* aInfo)
+void MdnsPlatform::MdnsService::Set(MdnsServiceAction aAction, ServiceRecord& aRecord, const TChar* aName, const TChar* aType, const mDNSInterfaceID aInterfaceId, TUint aPort, const TChar* aInfo)
 {
     iAction = aAction;
-    iHandle = aHandle;
-    iService = &aService;
+    iRecord = &aRecord;
 
     if(aName==NULL)
     {
@@ -171,6 +173,31 @@ void MdnsPlatform::MdnsService::Set(MdnsServiceAction aAction, TUint aHandle, Se
     iInfo.Replace((aInfo == NULL) ? "" : aInfo);
 }
 
+MdnsPlatform::MdnsServiceAction MdnsPlatform::MdnsService::Action() const
+{
+    return iAction;
+}
+
+MdnsPlatform::ServiceRecord& MdnsPlatform::MdnsService::Record()
+{
+    return *iRecord;
+}
+
+void MdnsPlatform::MdnsService::SetName(const MdnsService& aService)
+{
+    iName.Replace(aService.iName);
+}
+
+void MdnsPlatform::MdnsService::SetActivation(TUint aActivation)
+{
+    iActivation = aActivation;
+}
+
+TUint MdnsPlatform::MdnsService::Activation() const
+{
+    return iActivation;
+}
+
 TUint MdnsPlatform::MdnsService::PerformAction()
 {
     switch (iAction)
@@ -188,6 +215,24 @@ TUint MdnsPlatform::MdnsService::PerformAction()
     }
 }
 
+TBool MdnsPlatform::MdnsService::IsCompletedBy(mStatus aStatus) const
+{
+    /* mDNSCore reports a (re-)registration as NoError once probing completes or as
+     * NameConflict once a conflicting registration has been withdrawn.  Deregistration
+     * is reported as MemFree once all of the service's records have gone. */
+    switch (iAction)
+    {
+    case eRegister:
+    case eRenameAndReregister:
+        return (aStatus == mStatus_NoError || aStatus == mStatus_NameConflict);
+    case eDeregister:
+        return (aStatus == mStatus_MemFree);
+    case eInvalid:
+    default:
+        return false;
+    }
+}
+
 TUint MdnsPlatform::MdnsService::Register()
 {
     domainlabel name;
@@ -200,19 +245,150 @@ TUint MdnsPlatform::MdnsService::Register()
     SetDomainName(domain, "local");
     SetDomainName(host, "");
     SetPort(port, iPort);
-    return mDNS_RegisterService(&iMdns, iService, &name, &type, &domain, 0, port, NULL, (const mDNSu8*)iInfo.PtrZ(), (mDNSu16)strlen(iInfo.PtrZ()), 0, 0, iInterfaceId, &MdnsPlatform::ServiceCallback, this, 0);
+    return mDNS_RegisterService(&iMdns, &iRecord->RecordSet(), &name, &type, &domain, 0, port, NULL, (const mDNSu8*)iInfo.PtrZ(), (mDNSu16)strlen(iInfo.PtrZ()), 0, 0, iInterfaceId, &MdnsPlatform::ServiceCallback, iRecord, 0);
 }
 
 TUint MdnsPlatform::MdnsService::Deregister()
 {
-    return mDNS_DeregisterService(&iMdns, iService);
+    return mDNS_DeregisterService(&iMdns, &iRecord->RecordSet());
 }
 
 TUint MdnsPlatform::MdnsService::RenameAndReregister()
 {
     domainlabel name;
     SetDomainLabel(name, iName.PtrZ());
-    return mDNS_RenameAndReregisterService(&iMdns, iService, &name);
+    return mDNS_RenameAndReregisterService(&iMdns, &iRecord->RecordSet(), &name);
+}
+
+
+// MdnsPlatform::ServiceRecord
+
+MdnsPlatform::ServiceRecord::ServiceRecord(Environment& aEnv, MdnsPlatform& aPlatform)
+    : iEnv(aEnv)
+    , iPlatform(aPlatform)
+    , iActive(NULL)
+    , iActivations(0)
+    , iTimedActivation(0)
+    , iTimeoutAt(0)
+{
+    memset(&iRecordSet, 0, sizeof(iRecordSet));
+    iTimer = new Timer(aEnv, MakeFunctor(*this, &MdnsPlatform::ServiceRecord::TimerExpired), "MdnsServiceRecord");
+}
+
+MdnsPlatform::ServiceRecord::~ServiceRecord()
+{
+    delete iTimer;
+    delete iActive;
+    std::list<MdnsService*>::iterator it;
+    for (it = iQueue.begin(); it != iQueue.end(); ++it) {
+        delete *it;
+    }
+}
+
+ServiceRecordSet& MdnsPlatform::ServiceRecord::RecordSet()
+{
+    return iRecordSet;
+}
+
+TBool MdnsPlatform::ServiceRecord::Enqueue(MdnsService* aService, std::vector<MdnsService*>& aRedundant)
+{
+    if (iActive == NULL) {
+        ASSERT(iQueue.size() == 0);
+        Activate(aService);
+        return true;
+    }
+    if (iQueue.size() > 0) {
+        /* Only the last queued operation can be collapsed - it hasn't reached the
+         * mDNS core yet so the record is still in whatever state the operations
+         * before it leave it in. */
+        MdnsService* last = iQueue.back();
+        const MdnsServiceAction action = aService->Action();
+        if (action == eDeregister && last->Action() == eRegister) {
+            // register then deregister is a no-op
+            iQueue.pop_back();
+            aRedundant.push_back(last);
+            aRedundant.push_back(aService);
+            return false;
+        }
+        if (action == eDeregister && last->Action() == eDeregister) {
+            aRedundant.push_back(aService);
+            return false;
+        }
+        if (action == eRenameAndReregister && last->Action() == eRegister) {
+            // register under the new name instead
+            last->SetName(*aService);
+            aRedundant.push_back(aService);
+            return false;
+        }
+        if (action == eRenameAndReregister && last->Action() == eRenameAndReregister) {
+            iQueue.pop_back();
+            aRedundant.push_back(last);
+        }
+    }
+    iQueue.push_back(aService);
+    return false;
+}
+
+MdnsPlatform::MdnsService* MdnsPlatform::ServiceRecord::Complete(MdnsService* aService, MdnsService*& aNext)
+{
+    aNext = NULL;
+    if (iActive == NULL || (aService != NULL && aService != iActive)) {
+        return NULL;
+    }
+    MdnsService* completed = iActive;
+    iActive = NULL;
+    iTimedActivation = 0; // iTimer may still fire but will be ignored
+    if (iQueue.size() > 0) {
+        Activate(iQueue.front());
+        iQueue.pop_front();
+        aNext = iActive;
+    }
+    return completed;
+}
+
+
+MdnsPlatform::MdnsService* MdnsPlatform::ServiceRecord::Complete(mStatus aStatus, MdnsService*& aNext)
+{
+    aNext = NULL;
+    if (iActive == NULL || !iActive->IsCompletedBy(aStatus)) {
+        return NULL;
+    }
+    return Complete(iActive, aNext);
+}
+
+void MdnsPlatform::ServiceRecord::StartTimeout(TUint aActivation)
+{
+    if (iActive == NULL || iActive->Activation() != aActivation) {
+        return; // already completed
+    }
+    iTimedActivation = aActivation;
+    iTimeoutAt = Time::Now(iEnv) + kTimeoutMs;
+    iTimer->FireAt(iTimeoutAt);
+}
+
+MdnsPlatform::MdnsService* MdnsPlatform::ServiceRecord::CompleteTimedOut(MdnsService*& aNext)
+{
+    aNext = NULL;
+    /* A callback from an earlier (since completed) timeout may arrive after iTimer
+     * has been restarted for a later operation so check the deadline too. */
+    if (iActive == NULL || iTimedActivation != iActive->Activation() || !Time::IsInPastOrNow(iEnv, iTimeoutAt)) {
+        return NULL;
+    }
+    return Complete(iActive, aNext);
+}
+
+void MdnsPlatform::ServiceRecord::Activate(MdnsService* aService)
+{
+    if (++iActivations == 0) {
+        iActivations = 1; // 0 is reserved for iTimedActivation
+    }
+    aService->SetActivation(iActivations);
+    iActive = aService;
+}
+
+void MdnsPlatform::ServiceRecord::TimerExpired()
+{
+    iPlatform.ServiceTimedOut(*this);
 }
 
 
@@ -221,6 +397,7 @@ TUint MdnsPlatform::MdnsService::RenameAndReregister()
 MdnsPlatform::MdnsEventScheduler::MdnsEventScheduler(Environment& aStack, mDNS* aMdns)
     : iMdns(aMdns)
     , iNextEvent(kEventInvalid)
+    , iEventPending(false)
     , iEnabled(true)
     , iLock("MEVT")
 {
@@ -238,11 +415,12 @@ void MdnsPlatform::MdnsEventScheduler::TrySchedule(TInt aEvent)
     if (aEvent < kEventInvalid) {
         THROW(MdnsImpossibleEvent);
     }
-    else if (aEvent == iNextEvent) {
+    else if (iEventPending && aEvent == iNextEvent) {
         THROW(MdnsDuplicateEvent);
     }
     else {
         iNextEvent = aEvent;
+        iEventPending = true;
         if (iEnabled) {
             iTimer->FireAt(iNextEvent);
         }
@@ -263,6 +441,12 @@ void MdnsPlatform::MdnsEventScheduler::SetEnabled(TBool aEnable)
 
 void MdnsPlatform::MdnsEventScheduler::TimerExpired()
 {
+    /* An event can be requested for the time that has just fired (e.g. by a
+     * register call made in the same millisecond).  It isn't a duplicate so
+     * must be allowed to schedule another run. */
+    iLock.Wait();
+    iEventPending = false;
+    iLock.Signal();
     if (!mDNS_Execute(iMdns)) {
         LOG_ERROR(kBonjour, "Bonjour             Call to mDNS_Execute() failed. Retrying...\n");
         Log::Print("MdnsPlatform::MdnsEventScheduler::TimerExpired() Call to mDNS_Execute() failed. Retrying...\n");
@@ -614,7 +798,8 @@ MdnsPlatform::MdnsPlatform(Environment& aEnv, const TChar* aHost, TBool aHasCach
     , iServicesLock("BNJ3")
     , iFifoFree(kMaxQueueLength)
     , iFifoPending(kMaxQueueLength)
-    , iSem("BNJS", 0)
+    , iServicesOutstanding(0)
+    , iSemServicesIdle("BNJS", 0)
     , iStop(false)
     , iMdnsCache(NULL)
     , iDiscoveryLock("BNJ6")
@@ -661,6 +846,11 @@ MdnsPlatform::~MdnsPlatform()
     }
 
     mDNS_Close(iMdns);
+    // anything still pending is also referenced (and owned) by its ServiceRecord
+    iFifoPending.ReadInterrupt(false);
+    while (iFifoPending.SlotsUsed() > 0) {
+        (void)iFifoPending.Read();
+    }
     Map::iterator it = iServices.begin();
     while (it != iServices.end()) {
         delete it->second;
@@ -678,10 +868,6 @@ MdnsPlatform::~MdnsPlatform()
     while (iFifoFree.SlotsUsed() > 0) {
         delete iFifoFree.Read();
     }
-    iFifoPending.ReadInterrupt(false);
-    while (iFifoPending.SlotsUsed() > 0) {
-        delete iFifoPending.Read();
-    }
     delete iEventScheduler;
     free(iMdnsCache);
 }
@@ -856,28 +1042,130 @@ void MdnsPlatform::ServiceThread()
      * deregister call to respond.
      *
      * From profiling, calls to register can take ~600ms and calls to
-     * deregister can take ~4000ms before the callback is made, so we store a
-     * queue of pending calls and have a thread that processes them in order.
+     * deregister can take ~4000ms before the callback is made.  Each
+     * ServiceRecord therefore queues calls behind its own outstanding one and
+     * only passes a call to iFifoPending once it can start.  This thread
+     * starts calls as they arrive, so calls on different records overlap.
      */
     while (!iStop) {
         try {
-            Log::Print("MdnsPlatform::ServiceThread - read fifo\n");
             MdnsService* service = iFifoPending.Read();
-            Log::Print("MdnsPlatform::ServiceThread - perform action (%p)\n", service);
+            ServiceRecord& record = service->Record();
+            const TUint activation = service->Activation();
+            LOG(kBonjour, "Bonjour             ServiceThread - perform action (%p)\n", service);
             TUint status = service->PerformAction();
-            Log::Print("MdnsPlatform::ServiceThread - performed action\n");
-            iFifoFree.Write(service);
-            if (status == mStatus_NoError) {
-                Log::Print("MdnsPlatform::ServiceThread - waiting\n");
-                iSem.Wait();
+            if (status != mStatus_NoError) {
+                // no callback will follow; move on to this record's next call
+                LOG(kBonjour, "Bonjour             ServiceThread - action failed (%d)\n", status);
+                CompleteService(record, service);
+            }
+            else {
+                // service may already have been completed (and reused) by a callback
+                StartServiceTimeout(record, activation);
             }
         }
         catch (FifoReadError&) {
-            Log::Print("MdnsPlatform::ServiceThread - caught (ignored) FifoReadError\n");
+            LOG(kBonjour, "Bonjour             ServiceThread - caught (ignored) FifoReadError\n");
         }
     }
 }
 
+void MdnsPlatform::EnqueueService(MdnsServiceAction aAction, TUint aHandle, const TChar* aName, const TChar* aType, const mDNSInterfaceID aInterfaceId, TUint aPort, const TChar* aInfo)
+{
+    /* Claim a free MdnsService before taking iServicesLock; completing a call
+     * (which is what frees MdnsServices up) requires iServicesLock. */
+    MdnsService* mdnsService;
+    try {
+        mdnsService = iFifoFree.Read();
+    }
+    catch (FifoReadError&) {
+        return;
+    }
+    std::vector<MdnsService*> redundant;
+    iServicesLock.Wait();
+    Map::iterator it = iServices.find(aHandle);
+    if (it == iServices.end()) {
+        iServicesLock.Signal();
+        iFifoFree.Write(mdnsService);
+        return;
+    }
+    mdnsService->Set(aAction, *it->second, aName, aType, aInterfaceId, aPort, aInfo);
+    iServicesOutstanding++;
+    if (it->second->Enqueue(mdnsService, redundant)) {
+        iFifoPending.Write(mdnsService);
+    }
+    for (TUint i=0; i<(TUint)redundant.size(); i++) {
+        iServicesOutstanding--;
+        iFifoFree.Write(redundant[i]);
+    }
+    if (iServicesOutstanding == 0) {
+        iSemServicesIdle.Signal();
+    }
+    iServicesLock.Signal();
+}
+
+void MdnsPlatform::CompleteService(ServiceRecord& aRecord, MdnsService* aService)
+{
+    AutoMutex _(iServicesLock);
+    MdnsService* next;
+    MdnsService* completed = aRecord.Complete(aService, next);
+    ServiceCompletedLocked(completed, next);
+}
+
+void MdnsPlatform::CompleteService(ServiceRecord& aRecord, mStatus aStatus)
+{
+    AutoMutex _(iServicesLock);
+    MdnsService* next;
+    MdnsService* completed = aRecord.Complete(aStatus, next);
+    if (completed == NULL) {
+        LOG(kBonjour, "Bonjour             ServiceCallback - status %d doesn't complete outstanding action (ignored)\n", aStatus);
+    }
+    ServiceCompletedLocked(completed, next);
+}
+
+void MdnsPlatform::StartServiceTimeout(ServiceRecord& aRecord, TUint aActivation)
+{
+    AutoMutex _(iServicesLock);
+    aRecord.StartTimeout(aActivation);
+}
+
+void MdnsPlatform::ServiceTimedOut(ServiceRecord& aRecord)
+{
+    AutoMutex _(iServicesLock);
+    MdnsService* next;
+    MdnsService* completed = aRecord.CompleteTimedOut(next);
+    if (completed != NULL) {
+        LOG_ERROR(kBonjour, "Bonjour             ServiceRecord - action %d timed out, moving on\n", completed->Action());
+    }
+    ServiceCompletedLocked(completed, next);
+}
+
+void MdnsPlatform::ServiceCompletedLocked(MdnsService* aCompleted, MdnsService* aNext)
+{
+    if (aCompleted == NULL) {
+        return;
+    }
+    iFifoFree.Write(aCompleted);
+    if (aNext != NULL) {
+        iFifoPending.Write(aNext);
+    }
+    if (--iServicesOutstanding == 0) {
+        iSemServicesIdle.Signal();
+    }
+}
+
+void MdnsPlatform::WaitServicesIdle()
+{
+    iServicesLock.Wait();
+    if (iServicesOutstanding == 0) {
+        iServicesLock.Signal();
+        return;
+    }
+    iSemServicesIdle.Clear();
+    iServicesLock.Signal();
+    iSemServicesIdle.Wait();
+}
+
 void MdnsPlatform::SetAddress(mDNSAddr& aAddress, const Endpoint& aEndpoint)
 {
     LOG(kBonjour, "Bonjour             SetAddress ");
@@ -951,10 +1239,10 @@ void MdnsPlatform::DoSetHostName()
 TUint MdnsPlatform::CreateService()
 {
     LOG(kBonjour, "Bonjour             CreateService\n");
-    ServiceRecordSet* service = new ServiceRecordSet();
+    ServiceRecord* service = new ServiceRecord(iEnv, *this);
     iServicesLock.Wait();
     TUint handle = iNextServiceIndex;
-    iServices.insert(std::pair<TUint, ServiceRecordSet*>(handle, service));
+    iServices.insert(std::pair<TUint, ServiceRecord*>(handle, service));
     iNextServiceIndex++;
     iServicesLock.Signal();
     LOG(kBonjour, "Bonjour             CreateService - Complete\n");
@@ -964,21 +1252,7 @@ TUint MdnsPlatform::CreateService()
 void MdnsPlatform::DeregisterService(TUint aHandle)
 {
     LOG(kBonjour, "Bonjour             DeregisterService\n");
-    iServicesLock.Wait();
-    Map::iterator it = iServices.find(aHandle);
-    if (it != iServices.end()) {
-        MdnsService* mdnsService;
-        try {
-            mdnsService = iFifoFree.Read();
-        }
-        catch (FifoReadError&) {
-            iServicesLock.Signal();
-            return;
-        }
-        mdnsService->Set(eDeregister, aHandle, *it->second, NULL, NULL, 0, 0, NULL);
-        iFifoPending.Write(mdnsService);
-    }
-    iServicesLock.Signal();
+    EnqueueService(eDeregister, aHandle, NULL, NULL, 0, 0, NULL);
     LOG(kBonjour, "Bonjour             DeregisterService - Complete\n");
 }
 
@@ -986,42 +1260,17 @@ void MdnsPlatform::RegisterService(TUint aHandle, const TChar* aName, const TCha
 {
     LOG(kBonjour, "Bonjour             RegisterService\n");
     iServicesLock.Wait();
-    Map::iterator it = iServices.find(aHandle);
-    ASSERT(it != iServices.end());
-    ServiceRecordSet* service = it->second;
+    ASSERT(iServices.find(aHandle) != iServices.end());
     iServicesLock.Signal();
-    MdnsService* mdnsService;
-
-    try {
-        mdnsService = iFifoFree.Read();
-    }
-    catch (FifoReadError&) {
-        return;
-    }
     mDNSInterfaceID interfaceId = iInterfaceIdAllocator.GetIdForAddress(aInterface);
-    mdnsService->Set(eRegister, aHandle, *service, aName, aType, interfaceId, aPort, aInfo);
-    iFifoPending.Write(mdnsService);
-
+    EnqueueService(eRegister, aHandle, aName, aType, interfaceId, aPort, aInfo);
     LOG(kBonjour, "Bonjour             RegisterService - Complete\n");
 }
 
 void MdnsPlatform::RenameAndReregisterService(TUint aHandle, const TChar* aName)
 {
     LOG(kBonjour, "Bonjour             RenameAndReregisterService\n");
-    iServicesLock.Wait();
-    ServiceRecordSet* service = iServices[aHandle];
-    iServicesLock.Signal();
-    MdnsService* mdnsService;
-
-    try {
-        mdnsService = iFifoFree.Read();
-    }
-    catch (FifoReadError) {
-        return;
-    }
-    mdnsService->Set(eRenameAndReregister, aHandle, *service, aName, NULL, 0, 0, NULL);
-    iFifoPending.Write(mdnsService);
-
+    EnqueueService(eRenameAndReregister, aHandle, aName, NULL, 0, 0, NULL);
     LOG(kBonjour, "Bonjour             RenameAndReregisterService - Complete\n");
 }
 
@@ -1030,7 +1279,10 @@ void MdnsPlatform::ServiceCallback(mDNS* m, ServiceRecordSet* aRecordSet, mStatu
     LOG(kBonjour, "Bonjour             ServiceCallback - aRecordSet: %p, aStatus: %d\n", aRecordSet, aStatus);
 
     MdnsPlatform& platform = *(MdnsPlatform*) m->p;
-    platform.iSem.Signal();
+    ServiceRecord* record = (ServiceRecord*)aRecordSet->ServiceContext;
+    if (record != NULL) {
+        platform.CompleteService(*record, aStatus);
+    }
 }
 
 void MdnsPlatform::Lock()
@@ -1159,7 +1411,6 @@ void MdnsPlatform::Close()
 
     iThreadService->Kill();
     iFifoPending.ReadInterrupt(true);
-    iSem.Signal();
     delete iThreadService;
 }
 
@@ -16,6 +16,7 @@
 #include <OpenHome/Net/Private/dns_sd.h>
 
 #include <vector>
+#include <list>
 #include <map>
 
 EXCEPTION(MdnsImpossibleEvent);
@@ -169,6 +170,7 @@ public:
     void DeregisterService(TUint aHandle);
     void RegisterService(TUint aHandle, const TChar* aName, const TChar* aType, const TIpAddress& aInterface, TUint aPort, const TChar* aInfo);
     void RenameAndReregisterService(TUint aHandle, const TChar* aName);
+    void WaitServicesIdle(); // blocks until all queued register/deregister/rename calls have completed (or timed out)
     void AppendTxtRecord(Bwx& aBuffer, const TChar* aKey, const TChar* aValue);
 
     void DeviceDiscovered(const Brx& aType, const Brx& aFriendlyName, const Brx& aUglyName, const Brx&  aIpAddress, TUint aPort); // called from extern C mDNS callback DNSResolveReply
@@ -230,12 +232,19 @@ private:
         eDeregister,
         eRenameAndReregister,
     };
+    class ServiceRecord;
     class MdnsService
     {
     public:
         MdnsService(mDNS& aMdns);
-        void Set(MdnsServiceAction aAction, TUint aHandle, ServiceRecordSet& aService, const TChar* aName, const TChar* aType, const mDNSInterfaceID aInterfaceId, TUint aPort, const TChar* aInfo);
+        void Set(MdnsServiceAction aAction, ServiceRecord& aRecord, const TChar* aName, const TChar* aType, const mDNSInterfaceID aInterfaceId, TUint aPort, const TChar* aInfo);
+        MdnsServiceAction Action() const;
+        ServiceRecord& Record();
+        void SetName(const MdnsService& aService);
+        void SetActivation(TUint aActivation);
+        TUint Activation() const; // identifies the period this action was outstanding on its record
         TUint PerformAction();
+        TBool IsCompletedBy(mStatus aStatus) const; // whether a ServiceCallback() with aStatus reports this action's completion
     private:
         TUint Register();
         TUint Deregister();
@@ -244,14 +253,75 @@ private:
         // NOTE: all buffer sizes taken from mDNSEmbeddedAPI.h
         mDNS& iMdns;
         MdnsServiceAction iAction;
-        TUint iHandle;
-        ServiceRecordSet* iService;
+        ServiceRecord* iRecord;
+        TUint iActivation;
         Bws<MAX_DOMAIN_LABEL-1> iName;
         Bws<MAX_DOMAIN_NAME-1> iType;
         mDNSInterfaceID iInterfaceId;
         TUint iPort;
         Bws<2048> iInfo;
     };
+    /**
+     * Per-handle state.  Only one operation may be outstanding on a record at a time;
+     * later operations queue here until the mDNS core reports completion of the
+     * outstanding one.  Operations on different records are independent.
+     * An operation the mDNS core doesn't report completion of within kTimeoutMs
+     * is failed so that the operations queued behind it can proceed.
+     */
+    class ServiceRecord : private INonCopyable
+    {
+        static const TUint kTimeoutMs = 10000;
+    public:
+        ServiceRecord(Environment& aEnv, MdnsPlatform& aPlatform);
+        ~ServiceRecord();
+        ServiceRecordSet& RecordSet();
+        /**
+         * Returns true if aService should be performed immediately.  Otherwise it is
+         * queued, possibly collapsing with the last queued operation.  Any operations
+         * made redundant are appended to aRedundant.
+         */
+        TBool Enqueue(MdnsService* aService, std::vector<MdnsService*>& aRedundant);
+        /**
+         * Complete the outstanding operation (only if it is aService, when aService is
+         * non-NULL).  Returns the completed operation or NULL if there was none.
+         * aNext is set to the queued operation which is now outstanding, if any.
+         */
+        MdnsService* Complete(MdnsService* aService, MdnsService*& aNext);
+        /**
+         * As Complete(), but only if aStatus (from ServiceCallback()) reports completion
+         * of the outstanding operation.
+         */
+        MdnsService* Complete(mStatus aStatus, MdnsService*& aNext);
+        /**
+         * Start timing the outstanding operation, which has just been passed to the
+         * mDNS core, if it is still the one identified by aActivation.
+         */
+        void StartTimeout(TUint aActivation);
+        /**
+         * As Complete(), but only if the outstanding operation has timed out.
+         */
+        MdnsService* CompleteTimedOut(MdnsService*& aNext);
+    private:
+        void Activate(MdnsService* aService);
+        void TimerExpired();
+    private:
+        Environment& iEnv;
+        MdnsPlatform& iPlatform;
+        ServiceRecordSet iRecordSet;
+        MdnsService* iActive;
+        std::list<MdnsService*> iQueue;
+        Timer* iTimer;
+        TUint iActivations;
+        TUint iTimedActivation; // activation of the operation iTimer is running for; 0 if none
+        TUint iTimeoutAt;
+    };
+private:
+    void EnqueueService(MdnsServiceAction aAction, TUint aHandle, const TChar* aName, const TChar* aType, const mDNSInterfaceID aInterfaceId, TUint aPort, const TChar* aInfo);
+    void CompleteService(ServiceRecord& aRecord, MdnsService* aService);
+    void CompleteService(ServiceRecord& aRecord, mStatus aStatus);
+    void StartServiceTimeout(ServiceRecord& aRecord, TUint aActivation);
+    void ServiceTimedOut(ServiceRecord& aRecord);
+    void ServiceCompletedLocked(MdnsService* aCompleted, MdnsService* aNext);
     class MdnsEventScheduler
     {
     // MdnsEventSchedulers public interface functions MUST be called with mDNS_Lock() held
@@ -271,6 +341,7 @@ private:
         mDNS* iMdns;
         Timer* iTimer;
         TInt iNextEvent;
+        TBool iEventPending; // iNextEvent has been scheduled but not yet fired
         TBool iEnabled;
         Mutex iLock;
     };
@@ -308,11 +379,12 @@ private:
     InterfaceIdAllocator iInterfaceIdAllocator;
     TUint iSubnetListChangeListenerId;
     TUint iCurrentAdapterChangeListenerId;
-    typedef std::map<TUint, ServiceRecordSet*> Map;
+    typedef std::map<TUint, ServiceRecord*> Map;
     Mutex iServicesLock;
     Fifo<MdnsService*> iFifoFree;
     Fifo<MdnsService*> iFifoPending;
-    Semaphore iSem;
+    TUint iServicesOutstanding;
+    Semaphore iSemServicesIdle;
     ThreadFunctor* iThreadService;
     Map iServices;
     TUint iNextServiceIndex;
@@ -0,0 +1,93 @@
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/OptionParser.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Net/Core/OhNet.h>
+#include <OpenHome/Net/Private/MdnsPlatform.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/OsWrapper.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::Net;
+using namespace OpenHome::TestFramework;
+
+/*
+ * Measures how long MdnsPlatform takes to publish (and then withdraw) a number of
+ * service records.  Calls on different records are pipelined so this should be
+ * close to the time taken for a single record rather than growing with the count.
+ */
+
+void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::InitialisationParams* aInitParams)
+{
+    OptionParser parser;
+    OptionBool loopback("-l", "--loopback", "Use the loopback adapter only");
+    parser.AddOption(&loopback);
+    OptionUint adapter("-a", "--adapter", 0, "[0...n] Adapter index to use");
+    parser.AddOption(&adapter);
+    OptionUint count("-n", "--count", 10, "Number of service records to publish");
+    parser.AddOption(&count);
+    if (!parser.Parse(aArgc, aArgv) || parser.HelpDisplayed()) {
+        return;
+    }
+    if (loopback.Value()) {
+        aInitParams->SetUseLoopbackNetworkAdapter();
+    }
+    Library* lib = new Library(aInitParams);
+    std::vector<NetworkAdapter*>* subnetList = lib->CreateSubnetList();
+    TIpAddress interface = (*subnetList)[adapter.Value()]->Address();
+    Library::DestroySubnetList(subnetList);
+
+    Print("TestMdnsRegister - publishing %u records\n", count.Value());
+    // Bonjour is not enabled in aInitParams so this is the only mDNS instance
+    MdnsPlatform* mdns = new MdnsPlatform(lib->Env(), "Test-MdnsRegister", false);
+    // exclude the mDNS core's initial interface probe delay (500ms) from timings
+    Thread::Sleep(1000);
+    std::vector<TUint> handles;
+    for (TUint i=0; i<count.Value(); i++) {
+        handles.push_back(mdns->CreateService());
+    }
+
+    Bws<200> info;
+    mdns->AppendTxtRecord(info, "path", "/");
+    OsContext* osCtx = lib->Env().OsCtx();
+    TUint start = Os::TimeInMs(osCtx);
+    for (TUint i=0; i<(TUint)handles.size(); i++) {
+        Bws<32> name("TestMdnsRegister-");
+        Ascii::AppendDec(name, i);
+        mdns->RegisterService(handles[i], (const TChar*)name.PtrZ(), "_http._tcp", interface, 4000 + i, info.PtrZ());
+    }
+    mdns->WaitServicesIdle();
+    TUint registerMs = Os::TimeInMs(osCtx) - start;
+    Print("    registered in %ums\n", registerMs);
+
+    /* Deregister, register, deregister, register on each record.  The first
+     * deregister starts immediately; the following register and deregister
+     * cancel each other out while queued so only one register follows. */
+    start = Os::TimeInMs(osCtx);
+    for (TUint i=0; i<(TUint)handles.size(); i++) {
+        Bws<32> name("TestMdnsRegister-");
+        Ascii::AppendDec(name, i);
+        mdns->DeregisterService(handles[i]);
+        mdns->RegisterService(handles[i], (const TChar*)name.PtrZ(), "_http._tcp", interface, 4000 + i, info.PtrZ());
+        mdns->DeregisterService(handles[i]);
+        mdns->RegisterService(handles[i], (const TChar*)name.PtrZ(), "_http._tcp", interface, 4000 + i, info.PtrZ());
+    }
+    mdns->WaitServicesIdle();
+    TUint reregisterMs = Os::TimeInMs(osCtx) - start;
+    Print("    reregistered in %ums\n", reregisterMs);
+
+    start = Os::TimeInMs(osCtx);
+    for (TUint i=0; i<(TUint)handles.size(); i++) {
+        mdns->DeregisterService(handles[i]);
+    }
+    mdns->WaitServicesIdle();
+    TUint deregisterMs = Os::TimeInMs(osCtx) - start;
+    Print("    deregistered in %ums\n", deregisterMs);
+
+    delete mdns;
+    delete lib;
+}
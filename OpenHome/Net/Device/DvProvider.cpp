@@ -46,6 +46,22 @@ DvProvider::~DvProvider()
     iService->RemoveRef();
 }
 
+void DvProvider::SetPropertyModeration(const TChar* aPropertyName, TUint aMinIntervalMs)
+{
+    Brn name(aPropertyName);
+    const std::vector<Property*>& properties = iService->Properties();
+    for (TUint i=0; i<properties.size(); i++) {
+        if (properties[i]->Parameter().Name() == name) {
+            iService->PropertiesLock();
+            properties[i]->SetModerationMs(aMinIntervalMs);
+            iService->PropertiesUnlock();
+            return;
+        }
+    }
+    Log::Print("ERROR: SetPropertyModeration - no property %s in %.*s\n", aPropertyName, PBUF(iService->ServiceType().Name()));
+    ASSERTS();
+}
+
 bool DvProvider::SetPropertyInt(PropertyInt& aProperty, TInt aValue)
 {
     if (aProperty.SetValue(aValue)) {
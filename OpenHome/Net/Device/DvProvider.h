@@ -44,6 +44,14 @@ public:
      * This must only be called following a call to PropertiesLock().
      */
     void PropertiesUnlock();
+    /**
+     * Limit the rate at which changes to one property are evented.
+     *
+     * Subscribers receive an update to the named property at most once every aMinIntervalMs;
+     * intermediate values are dropped.  Changes to other properties are still evented immediately.
+     * 0 removes any limit.  aPropertyName must name one of the service's properties.
+     */
+    DllExport void SetPropertyModeration(const TChar* aPropertyName, TUint aMinIntervalMs);
 protected:
     DllExport DvProvider(DviDevice& aDevice, const TChar* aDomain, const TChar* aType, TUint aVersion);
     DllExport virtual ~DvProvider();
@@ -87,6 +87,8 @@ void DviDevice::Destroy()
         iServices[i]->RemoveRef();
     }
     iServices.clear();
+    iServicesByPath.clear();
+    iServicesByName.clear();
     iServiceLock.Signal();
     delete iProviderSubscriptionLongPoll;
     RemoveWeakRef();
@@ -207,6 +209,9 @@ void DviDevice::AddService(DviService* aService)
     iServiceLock.Wait();
     iServices.push_back(aService);
     aService->AddRef();
+    const OpenHome::Net::ServiceType& type = aService->ServiceType();
+    iServicesByPath.insert(std::pair<Brn,DviService*>(Brn(type.PathUpnp()), aService));
+    iServicesByName.insert(std::pair<Brn,DviService*>(Brn(type.Name()), aService));
     iServiceLock.Signal();
     ConfigChanged();
 }
@@ -237,7 +242,7 @@ DviService* DviDevice::ServiceReference(const ServiceType& aServiceType)
     const TUint count = (TUint)iServices.size();
     for (TUint i=0; i<count; i++) {
         DviService* s = iServices[i];
-        ServiceType type = s->ServiceType();
+        const OpenHome::Net::ServiceType& type = s->ServiceType();
         Bwh serviceUpnpDomain(type.Domain().Bytes() + 10);
         Ssdp::CanonicalDomainToUpnp(type.Domain(), serviceUpnpDomain);
 
@@ -257,7 +262,17 @@ DviService* DviDevice::ServiceReference(const Brx& aServiceName)
 {
     DviService* service = NULL;
     iServiceLock.Wait();
+    // control/event urls we publish use PathUpnp() so will normally match exactly
+    Brn path(aServiceName);
+    ServiceMap::iterator it = iServicesByPath.find(path);
+    if (it != iServicesByPath.end()) {
+        service = it->second;
+        service->AddRef();
+        iServiceLock.Signal();
+        return service;
+    }
 
+    // ...otherwise allow for UPnP-style domains or requests for an earlier version
     Parser p(aServiceName);
     const Brn domain = p.Next('-');
     Bwh upnpDomain(domain.Bytes() + 10);
@@ -269,13 +284,14 @@ DviService* DviDevice::ServiceReference(const Brx& aServiceName)
         version = Ascii::Uint(versionBuf);
     }
     catch (AsciiError&) {
+        iServiceLock.Signal();
         return service;
     }
 
     const TUint count = (TUint)iServices.size();
     for (TUint i=0; i<count; i++) {
         DviService* s = iServices[i];
-        ServiceType type = s->ServiceType();
+        const OpenHome::Net::ServiceType& type = s->ServiceType();
         Bwh serviceUpnpDomain(type.Domain().Bytes() + 10);
         Ssdp::CanonicalDomainToUpnp(type.Domain(), serviceUpnpDomain);
 
@@ -291,6 +307,17 @@ DviService* DviDevice::ServiceReference(const Brx& aServiceName)
     return service;
 }
 
+DviService* DviDevice::ServiceByName(const Brx& aName)
+{
+    AutoMutex _(iServiceLock);
+    Brn name(aName);
+    ServiceMap::iterator it = iServicesByName.find(name);
+    if (it == iServicesByName.end()) {
+        return NULL;
+    }
+    return it->second;
+}
+
 void DviDevice::AddDevice(DviDevice* aDevice)
 {
     ASSERT(!Enabled());
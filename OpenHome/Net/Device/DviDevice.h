@@ -63,6 +63,7 @@ public:
     DviService& Service(TUint aIndex) const;
     DviService* ServiceReference(const ServiceType& aServiceType);
     DviService* ServiceReference(const Brx& aServiceName);
+    DviService* ServiceByName(const Brx& aName); // matches ServiceType::Name() only.  Doesn't claim a ref
     void AddService(DviService* aService);
     void AddDevice(DviDevice* aDevice); // embedded device
     TUint DeviceCount() const;
@@ -113,6 +114,11 @@ private:
     TBool iConfigUpdated;
     DviDevice* iParent;
     std::vector<DviService*> iServices;
+    // lookup tables for request dispatch.  Services can only be added while disabled so these
+    // are complete whenever the device is enabled.
+    typedef std::map<Brn,DviService*,BufferCmp> ServiceMap;
+    ServiceMap iServicesByPath; // keyed on ServiceType::PathUpnp()
+    ServiceMap iServicesByName; // keyed on ServiceType::Name()
     std::vector<DviDevice*> iDevices;
     std::vector<IDvProtocol*> iProtocols;
     IResourceManager* iResourceManager;
@@ -4,6 +4,7 @@
 #include <OpenHome/Net/Private/DviSubscription.h>
 #include <OpenHome/Net/Private/DviService.h>
 #include <OpenHome/Private/Converter.h>
+#include <OpenHome/Private/Atomic.h>
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Net/Private/DviStack.h>
 
@@ -23,35 +24,119 @@ static void WriteTag(IWriter& aWriter, const Brx& aTag, const Brx& aValue)
 }
 
 
-// PropertyUpdate
+// PropertyValue
+
+PropertyValue::PropertyValue(const Brx& aName, const Brx& aValue)
+    : iRefCount(1)
+{
+    WriterBwh writer(aName.Bytes()*2 + aValue.Bytes() + 32);
+    PropertyWriter::WriteVariableStart(writer, aName);
+    const TUint valueOffset = writer.Buffer().Bytes();
+    writer.Write(aValue);
+    PropertyWriter::WriteVariableEnd(writer, aName);
+    writer.TransferTo(iElement);
+    iName.Set(iElement.Ptr() + valueOffset - 1 - aName.Bytes(), aName.Bytes()); // WriteVariableStart() ends "<name>"
+    iValue.Set(iElement.Ptr() + valueOffset, aValue.Bytes());
+}
 
-PropertyUpdate::Property::Property(const Brx& aName, const Brx& aValue)
-    : iName(aName)
-    , iValue(aValue)
+PropertyValue::~PropertyValue()
 {
 }
 
-PropertyUpdate::Property::Property(const Brx& aName, WriterBwh& aValue)
-    : iName(aName)
+void PropertyValue::AddRef()
 {
-    aValue.TransferTo(iValue);
+    (void)Atomic::Add(iRefCount, 1);
 }
 
-const Brx& PropertyUpdate::Property::Name() const
+void PropertyValue::RemoveRef()
+{
+    if (Atomic::Sub(iRefCount, 1) == 0) {
+        delete this;
+    }
+}
+
+const Brx& PropertyValue::Name() const
 {
     return iName;
 }
 
-const Brx& PropertyUpdate::Property::Value() const
+const Brx& PropertyValue::Value() const
 {
     return iValue;
 }
 
-void PropertyUpdate::Property::TransferValueTo(Property& aDest)
+const Brx& PropertyValue::Element() const
+{
+    return iElement;
+}
+
+
+// PropertyValueLog
+
+PropertyValueLog::PropertyValueLog(const std::vector<Property*>& aProperties)
+    : iLock("PVLL")
+    , iRefCount(0)
+{
+    for (TUint i=0; i<(TUint)aProperties.size(); i++) {
+        const Property& prop = *aProperties[i];
+        Brn name(prop.Parameter().Name());
+        iLatest.insert(std::pair<Brn,Entry>(name, Entry(prop)));
+    }
+}
+
+PropertyValueLog::~PropertyValueLog()
+{
+    for (EntryMap::iterator it = iLatest.begin(); it != iLatest.end(); ++it) {
+        if (it->second.iValue != NULL) {
+            it->second.iValue->RemoveRef();
+        }
+    }
+}
+
+PropertyValue* PropertyValueLog::Find(const Brx& aName, TUint& aSeqNum)
 {
-    iValue.TransferTo(aDest.iValue);
+    AutoMutex _(iLock);
+    Brn name(aName);
+    EntryMap::iterator it = iLatest.find(name);
+    if (it == iLatest.end()) {
+        aSeqNum = 0; // not a property of this service; Intern() won't record it
+        return NULL;
+    }
+    Entry& entry = it->second;
+    aSeqNum = entry.iProperty->SequenceNumber();
+    if (entry.iValue == NULL || entry.iSeqNum != aSeqNum) {
+        return NULL;
+    }
+    entry.iValue->AddRef();
+    return entry.iValue;
+}
+
+PropertyValue* PropertyValueLog::Intern(const Brx& aName, TUint aSeqNum, const Brx& aValue)
+{
+    AutoMutex _(iLock);
+    Brn name(aName);
+    EntryMap::iterator it = iLatest.find(name);
+    if (it == iLatest.end() || aSeqNum == 0) {
+        return new PropertyValue(aName, aValue);
+    }
+    Entry& entry = it->second;
+    if (entry.iValue != NULL) {
+        if (entry.iSeqNum == aSeqNum) {
+            entry.iValue->AddRef();
+            return entry.iValue;
+        }
+        entry.iValue->RemoveRef();
+    }
+    PropertyValue* value = new PropertyValue(aName, aValue);
+    value->AddRef(); // one reference for iLatest, the other for our caller
+    entry.iValue = value;
+    entry.iSeqNum = aSeqNum;
+    return value;
 }
 
+
+// PropertyUpdate
+
 PropertyUpdate::PropertyUpdate(const Brx& aSid, TUint aSeqNum)
     : iSid(aSid)
     , iSeqNum(aSeqNum)
@@ -61,18 +146,13 @@ PropertyUpdate::PropertyUpdate(const Brx& aSid, TUint aSeqNum)
 PropertyUpdate::~PropertyUpdate()
 {
     for (TUint i=0; i<(TUint)iProperties.size(); i++) {
-        delete iProperties[i];
+        iProperties[i]->RemoveRef();
     }
 }
 
-void PropertyUpdate::Add(const Brx& aName, const Brx& aValue)
-{
-    iProperties.push_back(new Property(aName, aValue));
-}
-
-void PropertyUpdate::Add(const Brx& aName, WriterBwh& aValue)
+void PropertyUpdate::Add(PropertyValue* aValue)
 {
-    iProperties.push_back(new Property(aName, aValue));
+    iProperties.push_back(aValue);
 }
 
 const Brx& PropertyUpdate::Sid() const
@@ -93,22 +173,22 @@ void PropertyUpdate::Merge(PropertyUpdate& aPropertyUpdate)
     ASSERT(iSid == aPropertyUpdate.Sid());
     ASSERT(iSeqNum < aPropertyUpdate.SeqNum());
     iSeqNum = aPropertyUpdate.SeqNum();
-    for (TInt i=(TInt)aPropertyUpdate.iProperties.size() - 1; i >= 0; i--) {
+    for (TUint i=0; i<(TUint)aPropertyUpdate.iProperties.size(); i++) {
+        PropertyValue* src = aPropertyUpdate.iProperties[i];
         TBool found = false;
-        Property* srcProp = aPropertyUpdate.iProperties[i];
-        for (TUint j=0; j<iProperties.size(); j++) {
-            Property* destProp = iProperties[j];
-            if (destProp->Name() == srcProp->Name()) {
-                srcProp->TransferValueTo(*destProp);
+        for (TUint j=0; j<(TUint)iProperties.size(); j++) {
+            if (iProperties[j]->Name() == src->Name()) {
+                iProperties[j]->RemoveRef();
+                iProperties[j] = src;
                 found = true;
                 break;
             }
         }
         if (!found) {
-            iProperties.push_back(srcProp);
-            aPropertyUpdate.iProperties.erase(aPropertyUpdate.iProperties.begin() + i);
+            iProperties.push_back(src);
         }
     }
+    aPropertyUpdate.iProperties.clear();
 }
 
 void PropertyUpdate::Write(IWriter& aWriter)
@@ -123,7 +203,7 @@ void PropertyUpdate::Write(IWriter& aWriter)
     WriteTag(aWriter, WebSocket::kTagSeq, seq);
     aWriter.Write(Brn("<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">"));
     for (TUint i=0; i<(TUint)iProperties.size(); i++) {
-        PropertyWriter::WriteVariable(aWriter, iProperties[i]->Name(), iProperties[i]->Value());
+        aWriter.Write(iProperties[i]->Element());
     }
     aWriter.Write(Brn("</e:propertyset>"));
     aWriter.Write('<');
@@ -135,8 +215,9 @@ void PropertyUpdate::Write(IWriter& aWriter)
 
 // PropertyWriter2
 
-PropertyWriter2::PropertyWriter2(IPropertyUpdateMerger& aMerger, const Brx& aSid, TUint aSeqNum)
+PropertyWriter2::PropertyWriter2(IPropertyUpdateMerger& aMerger, PropertyValueLog& aLog, const Brx& aSid, TUint aSeqNum)
     : iMerger(aMerger)
+    , iLog(aLog)
 {
     iPropertyUpdate = new PropertyUpdate(aSid, aSeqNum);
 }
@@ -144,27 +225,43 @@ PropertyWriter2::PropertyWriter2(IPropertyUpdateMerger& aMerger, const Brx& aSid
 PropertyWriter2::~PropertyWriter2()
 {
     delete iPropertyUpdate;
+    iMerger.ReleaseLog(iLog);
 }
 
 void PropertyWriter2::PropertyWriteString(const Brx& aName, const Brx& aValue)
 {
-    WriterBwh writer(1024);
-    Converter::ToXmlEscaped(writer, aValue);
-    iPropertyUpdate->Add(aName, writer);
+    TUint seqNum;
+    PropertyValue* value = iLog.Find(aName, seqNum);
+    if (value == NULL) {
+        WriterBwh writer(1024);
+        Converter::ToXmlEscaped(writer, aValue);
+        value = iLog.Intern(aName, seqNum, writer.Buffer());
+    }
+    iPropertyUpdate->Add(value);
 }
 
 void PropertyWriter2::PropertyWriteInt(const Brx& aName, TInt aValue)
 {
-    Bws<Ascii::kMaxIntStringBytes> buf;
-    (void)Ascii::AppendDec(buf, aValue);
-    iPropertyUpdate->Add(aName, buf);
+    TUint seqNum;
+    PropertyValue* value = iLog.Find(aName, seqNum);
+    if (value == NULL) {
+        Bws<Ascii::kMaxIntStringBytes> buf;
+        (void)Ascii::AppendDec(buf, aValue);
+        value = iLog.Intern(aName, seqNum, buf);
+    }
+    iPropertyUpdate->Add(value);
 }
 
 void PropertyWriter2::PropertyWriteUint(const Brx& aName, TUint aValue)
 {
-    Bws<Ascii::kMaxUintStringBytes> buf;
-    (void)Ascii::AppendDec(buf, aValue);
-    iPropertyUpdate->Add(aName, buf);
+    TUint seqNum;
+    PropertyValue* value = iLog.Find(aName, seqNum);
+    if (value == NULL) {
+        Bws<Ascii::kMaxUintStringBytes> buf;
+        (void)Ascii::AppendDec(buf, aValue);
+        value = iLog.Intern(aName, seqNum, buf);
+    }
+    iPropertyUpdate->Add(value);
 }
 
 void PropertyWriter2::PropertyWriteBool(const Brx& aName, TBool aValue)
@@ -174,9 +271,14 @@ void PropertyWriter2::PropertyWriteBool(const Brx& aName, TBool aValue)
 
 void PropertyWriter2::PropertyWriteBinary(const Brx& aName, const Brx& aValue)
 {
-    WriterBwh writer(1024);
-    Converter::ToBase64(writer, aValue);
-    iPropertyUpdate->Add(aName, writer);
+    TUint seqNum;
+    PropertyValue* value = iLog.Find(aName, seqNum);
+    if (value == NULL) {
+        WriterBwh writer(1024);
+        Converter::ToBase64(writer, aValue);
+        value = iLog.Intern(aName, seqNum, writer.Buffer());
+    }
+    iPropertyUpdate->Add(value);
 }
 
 void PropertyWriter2::PropertyWriteEnd()
@@ -219,29 +321,32 @@ const Brx& PropertyUpdatesFlattened::ClientId() const
     return iClientId;
 }
 
-void PropertyUpdatesFlattened::AddSubscription(DviSubscription* aSubscription)
+void PropertyUpdatesFlattened::AddSubscription(DviSubscription* aSubscription, PropertyValueLog& aLog)
 {
     Brn buf(aSubscription->Sid());
-    iSubscriptionMap.insert(std::pair<Brn,DviSubscription*>(buf, aSubscription));
+    iSubscriptionMap.insert(std::pair<Brn,Subscription>(buf, Subscription(aSubscription, aLog)));
 }
 
-void PropertyUpdatesFlattened::RemoveSubscription(const Brx& aSid, TBool aExpired)
+PropertyValueLog* PropertyUpdatesFlattened::RemoveSubscription(const Brx& aSid, TBool aExpired)
 {
     Brn sid(aSid);
     SubscriptionMap::iterator it = iSubscriptionMap.find(sid);
-    if (it != iSubscriptionMap.end()) {
-        // remove any pending updates for this subscription too
-        UpdatesMap::iterator it2 = iUpdatesMap.find(sid);
-        if (it2 != iUpdatesMap.end()) {
-            delete it2->second;
-            iUpdatesMap.erase(it2);
-        }
-        DviSubscription* subscription = it->second;
-        iSubscriptionMap.erase(it);
-        if (!aExpired) {
-            subscription->Remove();
-        }
+    if (it == iSubscriptionMap.end()) {
+        return NULL;
     }
+    // remove any pending updates for this subscription too
+    UpdatesMap::iterator it2 = iUpdatesMap.find(sid);
+    if (it2 != iUpdatesMap.end()) {
+        delete it2->second;
+        iUpdatesMap.erase(it2);
+    }
+    DviSubscription* subscription = it->second.iSubscription;
+    PropertyValueLog* log = it->second.iLog;
+    iSubscriptionMap.erase(it);
+    if (!aExpired) {
+        subscription->Remove();
+    }
+    return log;
 }
 
 TBool PropertyUpdatesFlattened::ContainsSubscription(const Brx& aSid) const
@@ -250,6 +355,16 @@ TBool PropertyUpdatesFlattened::ContainsSubscription(const Brx& aSid) const
     return (iSubscriptionMap.find(sid) != iSubscriptionMap.end());
 }
 
+PropertyValueLog* PropertyUpdatesFlattened::Log(const Brx& aSid) const
+{
+    Brn sid(aSid);
+    SubscriptionMap::const_iterator it = iSubscriptionMap.find(sid);
+    if (it == iSubscriptionMap.end()) {
+        return NULL;
+    }
+    return it->second.iLog;
+}
+
 TBool PropertyUpdatesFlattened::IsEmpty() const
 {
     return (iSubscriptionMap.size() == 0);
@@ -283,17 +398,13 @@ void PropertyUpdatesFlattened::SetClientSignal(Semaphore* aSem)
     }
 }
 
-void PropertyUpdatesFlattened::WriteUpdates(IWriter& aWriter)
+void PropertyUpdatesFlattened::TakeUpdates(std::vector<PropertyUpdate*>& aUpdates)
 {
-    aWriter.Write(Brn("<root>"));
-    UpdatesMap::iterator it = iUpdatesMap.begin();
-    while (it != iUpdatesMap.end()) {
-        it->second->Write(aWriter);
-        delete it->second;
-        it++;
+    aUpdates.reserve(iUpdatesMap.size());
+    for (UpdatesMap::iterator it = iUpdatesMap.begin(); it != iUpdatesMap.end(); ++it) {
+        aUpdates.push_back(it->second);
     }
     iUpdatesMap.clear();
-    aWriter.Write(Brn("</root>"));
 }
 
 
@@ -313,9 +424,12 @@ DviPropertyUpdateCollection::~DviPropertyUpdateCollection()
     for (TUint i=0; i<(TUint)iUpdates.size(); i++) {
         delete iUpdates[i];
     }
+    for (LogMap::iterator it = iLogs.begin(); it != iLogs.end(); ++it) {
+        delete it->second;
+    }
 }
 
-void DviPropertyUpdateCollection::AddSubscription(const Brx& aClientId, DviSubscription* aSubscription)
+void DviPropertyUpdateCollection::AddSubscription(const Brx& aClientId, DviSubscription* aSubscription, DviService& aService)
 {
     AutoMutex a(iLock);
     PropertyUpdatesFlattened* updates = FindByClientId(aClientId);
@@ -323,7 +437,17 @@ void DviPropertyUpdateCollection::AddSubscription(const Brx& aClientId, DviSubsc
         updates = new PropertyUpdatesFlattened(aClientId);
         iUpdates.push_back(updates);
     }
-    updates->AddSubscription(aSubscription);
+    PropertyValueLog* log;
+    LogMap::iterator it = iLogs.find(&aService);
+    if (it == iLogs.end()) {
+        log = new PropertyValueLog(aService.Properties());
+        iLogs.insert(std::pair<const DviService*,PropertyValueLog*>(&aService, log));
+    }
+    else {
+        log = it->second;
+    }
+    log->iRefCount++;
+    updates->AddSubscription(aSubscription, *log);
 }
 
 void DviPropertyUpdateCollection::RemoveSubscription(const Brx& aSid)
@@ -339,7 +463,10 @@ void DviPropertyUpdateCollection::RemoveSubscription(const Brx& aSid, TBool aExp
     if (updates == NULL) {
         THROW(InvalidSid);
     }
-    updates->RemoveSubscription(aSid, aExpired);
+    PropertyValueLog* log = updates->RemoveSubscription(aSid, aExpired);
+    if (log != NULL) {
+        ReleaseLogLocked(*log);
+    }
     if (updates->IsEmpty()) {
         delete updates;
         iUpdates.erase(iUpdates.begin() + index);
@@ -358,12 +485,23 @@ void DviPropertyUpdateCollection::SetClientSignal(const Brx& aClientId, Semaphor
 
 void DviPropertyUpdateCollection::WriteUpdates(const Brx& aClientId, IWriter& aWriter)
 {
-    AutoMutex a(iLock);
+    std::vector<PropertyUpdate*> pending;
+    iLock.Wait();
     PropertyUpdatesFlattened* updates = FindByClientId(aClientId);
     if (updates == NULL) {
+        iLock.Signal();
         THROW(InvalidClientId);
     }
-    updates->WriteUpdates(aWriter);
+    updates->TakeUpdates(pending);
+    iLock.Signal();
+
+    // values are immutable and reference counted so can be serialised without blocking publishers
+    aWriter.Write(Brn("<root>"));
+    for (TUint i=0; i<(TUint)pending.size(); i++) {
+        pending[i]->Write(aWriter);
+        delete pending[i];
+    }
+    aWriter.Write(Brn("</root>"));
 }
 
 PropertyUpdatesFlattened* DviPropertyUpdateCollection::FindByClientId(const Brx& aClientId)
@@ -409,10 +547,13 @@ PropertyUpdatesFlattened* DviPropertyUpdateCollection::FindBySid(const Brx& aSid
 IPropertyWriter* DviPropertyUpdateCollection::ClaimWriter(const IDviSubscriptionUserData* /*aUserData*/, const Brx& aSid, TUint aSequenceNumber)
 {
     AutoMutex a(iLock);
-    if (FindBySid(aSid) != NULL) {
-        return new PropertyWriter2(*this, aSid, aSequenceNumber);
+    PropertyUpdatesFlattened* updates = FindBySid(aSid);
+    if (updates == NULL) {
+        return NULL;
     }
-    return NULL;
+    PropertyValueLog* log = updates->Log(aSid);
+    log->iRefCount++; // released by ~PropertyWriter2
+    return new PropertyWriter2(*this, *log, aSid, aSequenceNumber);
 }
 
 void DviPropertyUpdateCollection::ReleaseWriter(IPropertyWriter* aWriter)
@@ -456,3 +597,23 @@ PropertyUpdate* DviPropertyUpdateCollection::MergeUpdate(PropertyUpdate* aUpdate
     }
     return updates->MergeUpdate(aUpdate);
 }
+
+void DviPropertyUpdateCollection::ReleaseLog(PropertyValueLog& aLog)
+{
+    AutoMutex a(iLock);
+    ReleaseLogLocked(aLog);
+}
+
+void DviPropertyUpdateCollection::ReleaseLogLocked(PropertyValueLog& aLog)
+{
+    if (--aLog.iRefCount > 0) {
+        return;
+    }
+    for (LogMap::iterator it = iLogs.begin(); it != iLogs.end(); ++it) {
+        if (it->second == &aLog) {
+            iLogs.erase(it);
+            break;
+        }
+    }
+    delete &aLog;
+}
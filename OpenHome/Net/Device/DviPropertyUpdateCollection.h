@@ -7,6 +7,7 @@
 #include <OpenHome/Net/Private/DviSubscription.h>
 
 #include <map>
+#include <vector>
 
 EXCEPTION(InvalidSid)
 EXCEPTION(InvalidClientId)
@@ -14,26 +15,77 @@ EXCEPTION(InvalidClientId)
 namespace OpenHome {
 namespace Net {
 
-class PropertyUpdate
+/**
+ * Evented property value, pre-serialised as an <e:property> element.
+ *
+ * Reference counted so that a single copy can be queued for every long-poll client
+ * subscribed to the service which published it.
+ */
+class PropertyValue : private INonCopyable
 {
 public:
-    class Property
+    PropertyValue(const Brx& aName, const Brx& aValue); // aValue must already be escaped
+    void AddRef();
+    void RemoveRef();
+    const Brx& Name() const;
+    const Brx& Value() const;
+    const Brx& Element() const;
+private:
+    ~PropertyValue();
+private:
+    volatile TUint iRefCount;
+    Brh iElement;
+    Brn iName;
+    Brn iValue;
+};
+
+/**
+ * Latest value of each property published to long-poll clients of a single service.
+ *
+ * Values are identified by their property and its sequence number.  The first subscription
+ * to publish a change serialises the value; every other subscription finds it by sequence
+ * number and shares it, so a change seen by many clients is encoded and held in memory once.
+ * Only the latest value of each property is retained; older values are freed once every
+ * client they were queued for has collected them.
+ */
+class PropertyValueLog : private INonCopyable
+{
+    friend class DviPropertyUpdateCollection;
+public:
+    PropertyValueLog(const std::vector<Property*>& aProperties);
+    ~PropertyValueLog();
+    /**
+     * Returns the value already interned for aName at its property's current sequence
+     * number (with a reference claimed for the caller) or NULL if the value must be
+     * serialised and passed to Intern().  aSeqNum is set to the sequence number to pass.
+     *
+     * Must be called from within the property's Write() so that its value and sequence
+     * number can't change before Intern() is called.
+     */
+    PropertyValue* Find(const Brx& aName, TUint& aSeqNum);
+    PropertyValue* Intern(const Brx& aName, TUint aSeqNum, const Brx& aValue); // returns a value with a reference claimed for the caller
+private:
+    class Entry
     {
     public:
-        Property(const Brx& aName, const Brx& aValue);
-        Property(const Brx& aName, WriterBwh& aValue);
-        const Brx& Name() const;
-        const Brx& Value() const;
-        void TransferValueTo(Property& aDest);
-    private:
-        Brh iName;
-        Brh iValue;
+        Entry(const Property& aProperty) : iProperty(&aProperty), iValue(NULL), iSeqNum(0) {}
+        const Property* iProperty;
+        PropertyValue* iValue;
+        TUint iSeqNum;
     };
+private:
+    Mutex iLock;
+    typedef std::map<Brn,Entry,BufferCmp> EntryMap;
+    EntryMap iLatest;
+    TUint iRefCount; // protected by DviPropertyUpdateCollection's lock
+};
+
+class PropertyUpdate : private INonCopyable
+{
 public:
     PropertyUpdate(const Brx& aSid, TUint aSeqNum);
     ~PropertyUpdate();
-    void Add(const Brx& aName, const Brx& aValue);
-    void Add(const Brx& aName, WriterBwh& aValue);
+    void Add(PropertyValue* aValue); // takes ownership of the caller's reference
     const Brx& Sid() const;
     TUint SeqNum() const;
     void Merge(PropertyUpdate& aPropertyUpdate);
@@ -41,19 +93,20 @@ public:
 private:
     Brh iSid;
     TUint iSeqNum;
-    std::vector<Property*> iProperties;
+    std::vector<PropertyValue*> iProperties;
 };
 
 class IPropertyUpdateMerger
 {
 public:
     virtual PropertyUpdate* MergeUpdate(PropertyUpdate* aUpdate) = 0;
+    virtual void ReleaseLog(PropertyValueLog& aLog) = 0;
 };
 
 class PropertyWriter2 : public IPropertyWriter, private INonCopyable
 {
 public:
-    PropertyWriter2(IPropertyUpdateMerger& aMerger, const Brx& aSid, TUint aSeqNum);
+    PropertyWriter2(IPropertyUpdateMerger& aMerger, PropertyValueLog& aLog, const Brx& aSid, TUint aSeqNum);
     ~PropertyWriter2();
 private: // IPropertyWriter
     void PropertyWriteString(const Brx& aName, const Brx& aValue);
@@ -65,6 +118,7 @@ private: // IPropertyWriter
     void Release();
 private:
     IPropertyUpdateMerger& iMerger;
+    PropertyValueLog& iLog;
     PropertyUpdate* iPropertyUpdate;
 };
 
@@ -74,18 +128,27 @@ public:
     PropertyUpdatesFlattened(const Brx& aClientId);
     ~PropertyUpdatesFlattened();
     const Brx& ClientId() const;
-    void AddSubscription(DviSubscription* aSubscription);
-    void RemoveSubscription(const Brx& aSid, TBool aExpired);
+    void AddSubscription(DviSubscription* aSubscription, PropertyValueLog& aLog);
+    PropertyValueLog* RemoveSubscription(const Brx& aSid, TBool aExpired); // returns log used by the subscription
     TBool ContainsSubscription(const Brx& aSid) const;
+    PropertyValueLog* Log(const Brx& aSid) const;
     TBool IsEmpty() const;
     PropertyUpdate* MergeUpdate(PropertyUpdate* aUpdate);
     void SetClientSignal(Semaphore* aSem);
-    void WriteUpdates(IWriter& aWriter);
+    void TakeUpdates(std::vector<PropertyUpdate*>& aUpdates);
+private:
+    class Subscription
+    {
+    public:
+        Subscription(DviSubscription* aSubscription, PropertyValueLog& aLog) : iSubscription(aSubscription), iLog(&aLog) {}
+        DviSubscription* iSubscription;
+        PropertyValueLog* iLog;
+    };
 private:
     Brh iClientId;
     typedef std::map<Brn,PropertyUpdate*,BufferCmp> UpdatesMap;
     UpdatesMap iUpdatesMap;
-    typedef std::map<Brn,DviSubscription*,BufferCmp> SubscriptionMap;
+    typedef std::map<Brn,Subscription,BufferCmp> SubscriptionMap;
     SubscriptionMap iSubscriptionMap;
     Semaphore* iSem;
 };
@@ -97,7 +160,7 @@ class DviPropertyUpdateCollection : public IPropertyWriterFactory, private IProp
 public:
     DviPropertyUpdateCollection(DvStack& aDvStack);
     ~DviPropertyUpdateCollection();
-    void AddSubscription(const Brx& aClientId, DviSubscription* aSubscription);
+    void AddSubscription(const Brx& aClientId, DviSubscription* aSubscription, DviService& aService);
     void RemoveSubscription(const Brx& aSid);
     void SetClientSignal(const Brx& aClientId, Semaphore* aSem);
     void WriteUpdates(const Brx& aClientId, IWriter& aWriter);
@@ -116,10 +179,15 @@ private: // IPropertyWriterFactory
     void LogUserData(IWriter& aWriter, const IDviSubscriptionUserData& aUserData);
 private: // IPropertyUpdateMerger
     PropertyUpdate* MergeUpdate(PropertyUpdate* aUpdate);
+    void ReleaseLog(PropertyValueLog& aLog);
+private:
+    void ReleaseLogLocked(PropertyValueLog& aLog);
 private:
     DvStack& iDvStack;
     Mutex iLock;
     std::vector<PropertyUpdatesFlattened*> iUpdates;
+    typedef std::map<const DviService*,PropertyValueLog*> LogMap;
+    LogMap iLogs;
 };
 
 } // namespace Net
@@ -78,7 +78,7 @@ void DviProviderSubscriptionLongPoll::Subscribe(IDvInvocation& aInvocation, cons
     aInvocation.EndResponse();
 
     // Start subscription, prompting availability of the first update (covering all state variables)
-    iPropertyUpdateCollection.AddSubscription(aClientId, subscription);
+    iPropertyUpdateCollection.AddSubscription(aClientId, subscription, *service);
     iDvStack.SubscriptionManager().AddSubscription(*subscription);
     service->AddSubscription(subscription);
 }
@@ -126,6 +126,8 @@ void DviService::Enable()
 void DviService::AddAction(Action* aAction, FunctorDviInvocation aFunctor)
 {
     DvAction action(aAction, aFunctor);
+    Brn name(aAction->Name());
+    iActionMap.insert(std::pair<Brn,TUint>(name, (TUint)iDvActions.size()));
     iDvActions.push_back(action);
 }
 
@@ -159,27 +161,27 @@ void DviService::Invoke(IDviInvocation& aInvocation, const Brx& aActionName, TBo
 
     {
         AutoFunctor a(MakeFunctor(*this, &DviService::InvocationCompleted));
-        for (TUint i=0; i<iDvActions.size(); i++) {
-            if (iDvActions[i].Action()->Name() == aActionName) {
-                try {
-                    iDvActions[i].Functor()(aInvocation);
-                }
-                catch (InvocationError&) {
-                    // avoid calls to aInvocation.InvocationReportError in other catch blocks
-                    throw;
-                }
-                catch (AssertionFailed&) {
-                    throw;
-                }
-                catch (Exception& e) {
-                    Brn msg(e.Message());
-                    aInvocation.InvocationReportError(801, msg);
-                }
-                catch (...) {
-                    aInvocation.InvocationReportError(801, Brn("Unknown error"));
-                }
-                return;
+        Brn name(aActionName);
+        ActionMap::const_iterator it = iActionMap.find(name);
+        if (it != iActionMap.end()) {
+            try {
+                iDvActions[it->second].Functor()(aInvocation);
             }
+            catch (InvocationError&) {
+                // avoid calls to aInvocation.InvocationReportError in other catch blocks
+                throw;
+            }
+            catch (AssertionFailed&) {
+                throw;
+            }
+            catch (Exception& e) {
+                Brn msg(e.Message());
+                aInvocation.InvocationReportError(801, msg);
+            }
+            catch (...) {
+                aInvocation.InvocationReportError(801, Brn("Unknown error"));
+            }
+            return;
         }
     }
 
@@ -15,6 +15,7 @@
 #include <OpenHome/Net/Core/OhNet.h>
 
 #include <vector>
+#include <map>
 
 EXCEPTION(InvocationError)
 
@@ -110,6 +111,8 @@ private:
     TUint iRefCount;
     Mutex iPropertiesLock;
     std::vector<DvAction> iDvActions;
+    typedef std::map<Brn,TUint,BufferCmp> ActionMap;
+    ActionMap iActionMap; // action name -> index into iDvActions
     std::vector<Property*> iProperties;
     std::vector<DviSubscription*> iSubscriptions;
     TBool iDisabled;
@@ -9,6 +9,10 @@
 #include <OpenHome/Private/Debug.h>
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/Converter.h>
+#include <OpenHome/Private/Metrics.h>
+#include <OpenHome/Private/Atomic.h>
+#include <OpenHome/Private/Time.h>
+#include <OpenHome/OsWrapper.h>
 
 #include <vector>
 #include <stdlib.h>
@@ -63,12 +67,16 @@ DviSubscription::DviSubscription(DvStack& aDvStack, DviDevice& aDevice, IPropert
     , iPublisherSuccesses(0)
     , iPublisherQueue(NULL)
     , iExpired(false)
+    , iPublishPending(0)
+    , iNextPending(NULL)
 {
     iDevice.AddWeakRef();
     aSid.TransferTo(iSid);
     iWriterFactory.NotifySubscriptionCreated(iSid);
     Functor functor = MakeFunctor(*this, &DviSubscription::Expired);
     iTimer = new Timer(iDvStack.Env(), functor, "DviSubscription");
+    functor = MakeFunctor(*this, &DviSubscription::ModerationTimerExpired);
+    iModerationTimer = new Timer(iDvStack.Env(), functor, "DviSubscriptionModeration");
     iDvStack.Env().AddObject(this);
 }
 
@@ -85,6 +93,7 @@ void DviSubscription::Start(DviService& aService)
     for (TUint i=0; i<properties.size(); i++) {
         // store all seq nums as 0 initially to ensure all are published by the first call to WriteChanges()
         iPropertySequenceNumbers.push_back(0);
+        iPropertyPublishTimes.push_back(0);
         if (properties[i]->SequenceNumber() == 0) {
             const Brx& service = iService->ServiceType().Name();
             const Brx& propName = properties[i]->Parameter().Name();
@@ -98,6 +107,7 @@ void DviSubscription::Start(DviService& aService)
 void DviSubscription::Stop()
 {
     iTimer->Cancel();
+    iModerationTimer->Cancel();
     iLock.Wait();
     if (iService != NULL) {
         iService->RemoveRef();
@@ -180,9 +190,10 @@ void DviSubscription::WriteChanges()
         return;
     }
     IPropertyWriter* writer = NULL;
+    TUint deferMs = 0;
     try {
         AutoMutex a(iLock); // claim lock here to fully serialise updates to a single subscriber
-        writer = CreateWriter();
+        writer = CreateWriter(deferMs);
         if (writer != NULL) {
             writer->PropertyWriteEnd();
         }
@@ -205,9 +216,14 @@ void DviSubscription::WriteChanges()
     if (writer != NULL) {
         iWriterFactory.ReleaseWriter(writer);
     }
+    if (deferMs > 0) {
+        // some changes were held back by moderation; publish them once they fall due
+        // (not done from CreateWriter as iLock must not be held while using TimerManager)
+        iModerationTimer->FireIn(deferMs);
+    }
 }
 
-IPropertyWriter* DviSubscription::CreateWriter()
+IPropertyWriter* DviSubscription::CreateWriter(TUint& aDeferMs)
 {
     LOG_DEBUG(kDvEvent, "WriteChanges for subscription %.*s seq - %u\n", PBUF(iSid), iSequenceNumber);
 
@@ -218,7 +234,10 @@ IPropertyWriter* DviSubscription::CreateWriter()
 
     const std::vector<Property*>& properties = iService->Properties();
     ASSERT(properties.size() == iPropertySequenceNumbers.size()); // services can't change definition after first advertisement
+    const TUint now = Time::Now(iDvStack.Env());
+    const TBool initialEvent = (iSequenceNumber == 0);
     TBool changed = false;
+    aDeferMs = 0;
     {
         AutoPropertiesLock b(*iService);
         for (TUint i=0; i<properties.size(); i++) {
@@ -226,8 +245,14 @@ IPropertyWriter* DviSubscription::CreateWriter()
             const TUint seq = prop->SequenceNumber();
             ASSERT(seq != 0); // => implementor hasn't initialised the property
             if (seq != iPropertySequenceNumbers[i]) {
-                changed = true;
-                break;
+                const TUint delayMs = ModerationDelayMs(*prop, i, now, initialEvent);
+                if (delayMs == 0) {
+                    changed = true;
+                    break;
+                }
+                if (aDeferMs == 0 || delayMs < aDeferMs) {
+                    aDeferMs = delayMs;
+                }
             }
         }
 
@@ -247,18 +272,38 @@ IPropertyWriter* DviSubscription::CreateWriter()
         iSequenceNumber++;
     }
 
+    aDeferMs = 0;
     AutoPropertiesLock b(*iService);
     for (TUint i=0; i<properties.size(); i++) {
         Property* prop = properties[i];
         const TUint seq = prop->SequenceNumber();
         if (seq != iPropertySequenceNumbers[i]) {
+            const TUint delayMs = ModerationDelayMs(*prop, i, now, initialEvent);
+            if (delayMs > 0) {
+                // leave iPropertySequenceNumbers alone so that the latest value is sent later
+                if (aDeferMs == 0 || delayMs < aDeferMs) {
+                    aDeferMs = delayMs;
+                }
+                continue;
+            }
             prop->Write(*writer);
             iPropertySequenceNumbers[i] = seq;
+            iPropertyPublishTimes[i] = now;
         }
     }
     return writer;
 }
 
+TUint DviSubscription::ModerationDelayMs(const Property& aProperty, TUint aIndex, TUint aNow, TBool aInitialEvent) const
+{
+    const TUint moderationMs = aProperty.ModerationMs();
+    if (moderationMs == 0 || aInitialEvent) { // initial event always reports every property
+        return 0;
+    }
+    const TUint elapsedMs = aNow - iPropertyPublishTimes[aIndex];
+    return (elapsedMs >= moderationMs? 0 : moderationMs - elapsedMs);
+}
+
 const Brx& DviSubscription::Sid() const
 {
     return iSid;
@@ -338,6 +383,7 @@ DviSubscription::~DviSubscription()
     iWriterFactory.NotifySubscriptionDeleted(iSid);
     iDevice.RemoveWeakRef();
     delete iTimer;
+    delete iModerationTimer;
     if (iUserData != NULL) {
         iUserData->Release();
     }
@@ -357,6 +403,12 @@ void DviSubscription::Expired()
     iDvStack.SubscriptionManager().QueueUpdate(*this);
 }
 
+void DviSubscription::ModerationTimerExpired()
+{
+    // as with Expired(), don't touch iLock from the timer thread; the publish will pick up whatever is now due
+    iDvStack.SubscriptionManager().QueueUpdate(*this);
+}
+
 
 // AutoSubscriptionRef
 
@@ -457,133 +509,159 @@ void PropertyWriter::PropertyWriteBinary(const Brx& aName, const Brx& aValue)
 }
 
 
-// Publisher
+// PublisherPool
 
-Publisher::Publisher(const TChar* aName, TUint aPriority, IPublisherObserver& aObserver, Fifo<Publisher*>& aFree, TUint aModerationMs)
-    : Thread(aName, aPriority)
+PublisherPool::PublisherPool(Environment& aEnv, const TChar* aName, TUint aPriority, IPublisherObserver& aObserver,
+                             TUint aMinThreads, TUint aMaxThreads, TUint aIdleTimeoutMs, TUint aModerationMs)
+    : iEnv(aEnv)
     , iObserver(aObserver)
-    , iFree(aFree)
     , iModerationMs(aModerationMs)
-    , iModerator("PBMS", 0)
+    , iLock("DVPP")
+    , iHead(NULL)
+    , iTail(NULL)
+    , iFreeSlots(aMinThreads)
+    , iWaiting(0)
+    , iModerationTimer(NULL)
+    , iMetricPending(aEnv.Metrics().Gauge("ohnet_dv_publish_queue_depth", "Event updates queued awaiting a free publisher thread"))
+    , iMetricLatency(aEnv.Metrics().Histogram("ohnet_dv_publish_seconds", "Time taken to deliver an event to a subscriber"))
+    , iMetricRequests(aEnv.Metrics().Counter("ohnet_dv_publish_requests_total", "Requests to publish changes to a subscription"))
+    , iMetricCoalesced(aEnv.Metrics().Counter("ohnet_dv_publish_coalesced_total", "Publish requests merged into one already queued"))
 {
+    LOG_DEBUG(kDvEvent, "> PublisherPool %s: creating %u publisher threads\n", aName, aMinThreads);
+    if (iModerationMs > 0) {
+        iModerationTimer = new Timer(aEnv, MakeFunctor(*this, &PublisherPool::ReleaseSlots), "PublisherPoolModeration");
+    }
+    iPublishers = new WorkerPool(aEnv, aName, *this, aMinThreads, aMaxThreads, aIdleTimeoutMs, aPriority);
 }
 
-Publisher::~Publisher()
+PublisherPool::~PublisherPool()
 {
-    Kill();
-    Join();
+    delete iModerationTimer;
+    delete iPublishers;
+    while (iHead != NULL) {
+        DviSubscription* subscription = iHead;
+        iHead = subscription->iNextPending;
+        subscription->iNextPending = NULL;
+        Atomic::Store(subscription->iPublishPending, 0);
+        subscription->RemoveRef();
+    }
 }
 
-void Publisher::Publish(DviSubscription* aSubscription)
+std::list<DviSubscription*> PublisherPool::GetUpdates()
 {
-    iSubscription = aSubscription;
-    Signal();
+    AutoMutex amx(iLock);
+    std::list<DviSubscription*> updates;
+    for (DviSubscription* subscription = iHead; subscription != NULL; subscription = subscription->iNextPending) {
+        updates.push_back(subscription);
+    }
+    return updates;
+}
+
+void PublisherPool::QueueUpdate(DviSubscription& aSubscription)
+{
+    iMetricRequests.Inc();
+    // iPublishPending is shared by both of DviSubscriptionManager's pools so is updated atomically
+    if (!Atomic::CompareAndSwap(aSubscription.iPublishPending, 0, 1)) {
+        iMetricCoalesced.Inc();
+        aSubscription.RemoveRef(); // the queued entry already holds a reference
+        return;
+    }
+    iLock.Wait();
+    aSubscription.iNextPending = NULL;
+    if (iTail == NULL) {
+        iHead = &aSubscription;
+    }
+    else {
+        iTail->iNextPending = &aSubscription;
+    }
+    iTail = &aSubscription;
+    iMetricPending.Inc();
+    if (iModerationMs == 0) {
+        iPublishers->JobAdded();
+    }
+    else if (iFreeSlots > 0) {
+        iFreeSlots--;
+        iPublishers->JobAdded();
+    }
+    else {
+        iWaiting++;
+    }
+    iLock.Signal();
 }
 
 #ifdef DEFINE_TRACE
-void Publisher::Error(const TChar* aErr)
+void PublisherPool::Error(DviSubscription& aSubscription, const TChar* aErr)
 #else
-void Publisher::Error(const TChar* /*aErr*/)
+void PublisherPool::Error(DviSubscription& aSubscription, const TChar* /*aErr*/)
 #endif
 {
     LOG_ERROR(kDvEvent, "Error - %s - from SID ", aErr);
-    LOG_ERROR(kDvEvent, iSubscription->Sid());
+    LOG_ERROR(kDvEvent, aSubscription.Sid());
     LOG_ERROR(kDvEvent, "\n");
 }
 
-void Publisher::Run()
+void PublisherPool::ProcessJob()
 {
-    for (;;) {
-        Wait();
-        TBool timeout = false;
-        try {
-            iSubscription->WriteChanges();
-        }
-        catch (NetworkTimeout& ex) {
-            Error(ex.Message());
-            iObserver.NotifyPublishError(*iSubscription);
-            timeout = true;
-        }
-        catch (Exception& ex) {
-            Error(ex.Message());
-        }
-
-        if (!timeout) {
-            iObserver.NotifyPublishSuccess(*iSubscription);
-        }
-        iSubscription->RemoveRef();
-        if (iModerationMs > 0) {
-            try {
-                iModerator.Wait(iModerationMs);
-            }
-            catch (Timeout&) {}
-        }
-        iFree.Write(this);
+    iLock.Wait();
+    DviSubscription* subscription = iHead;
+    iHead = subscription->iNextPending;
+    if (iHead == NULL) {
+        iTail = NULL;
     }
-}
-
-// PublisherPool
-
-PublisherPool::PublisherPool(const TChar* aName, TUint aPriority, IPublisherObserver& aObserver,
-                             TUint aNumPublisherThreads, TUint aPoolNumber, TUint aModerationMs)
-    : Thread(aName, aPriority)
-    , iNumPublishers(aNumPublisherThreads)
-    , iFree(aNumPublisherThreads)
-    , iLock("DVPP")
-{
-    LOG_DEBUG(kDvEvent, "> PublisherPool %u: creating %u publisher threads\n", aPoolNumber, iNumPublishers);
-    iPublishers = (Publisher**)malloc(sizeof(*iPublishers) * iNumPublishers);
+    subscription->iNextPending = NULL;
+    iMetricPending.Dec();
+    iLock.Signal();
+    // clear before publishing so that changes made from here on queue another publish
+    Atomic::Store(subscription->iPublishPending, 0);
 
-    for (TUint i=0; i<iNumPublishers; i++) {
-        Bws<Thread::kMaxNameBytes+1> thName;
-        thName.AppendPrintf("Publisher_%d_%d", aPoolNumber, i);
-        thName.PtrZ();
-        iPublishers[i] = new Publisher((const TChar*)thName.Ptr(), aPriority, aObserver, iFree, aModerationMs);
-        iFree.Write(iPublishers[i]);
-        iPublishers[i]->Start();
+    TBool timeout = false;
+    try {
+        AutoMetricTimer _(iEnv, iMetricLatency);
+        subscription->WriteChanges();
+    }
+    catch (NetworkTimeout& ex) {
+        Error(*subscription, ex.Message());
+        iObserver.NotifyPublishError(*subscription);
+        timeout = true;
+    }
+    catch (Exception& ex) {
+        Error(*subscription, ex.Message());
     }
-    Start();
-}
-
-std::list<DviSubscription*> PublisherPool::GetUpdates()
-{
-    AutoMutex amx(iLock);
-    return iPendingUpdates;
-}
-
-void PublisherPool::QueueUpdate(DviSubscription& aSubscription)
-{
-    iLock.Wait();
-    iPendingUpdates.push_back(&aSubscription);
-    Signal();
-    iLock.Signal();
-}
 
-void PublisherPool::Run()
-{
-    for (;;) {
-        Wait();
-        Publisher* publisher = iFree.Read();
-        iLock.Wait();
-        DviSubscription* subscription = iPendingUpdates.front();
-        iPendingUpdates.pop_front();
-        iLock.Signal();
-        publisher->Publish(subscription);
+    if (!timeout) {
+        iObserver.NotifyPublishSuccess(*subscription);
+    }
+    subscription->RemoveRef();
+    if (iModerationMs > 0) {
+        // hold this publish's slot for iModerationMs, limiting the rate we publish at
+        const TUint releaseTime = Os::TimeInMs(iEnv.OsCtx()) + iModerationMs;
+        AutoMutex _(iLock);
+        if (iSlotReleaseTimes.empty()) {
+            iModerationTimer->FireAt(releaseTime);
+        }
+        iSlotReleaseTimes.push_back(releaseTime);
     }
 }
 
-PublisherPool::~PublisherPool()
+void PublisherPool::ReleaseSlots()
 {
-    iLock.Wait();
-    Kill();
-    Join();
-    iLock.Signal();
-    for (TUint i=0; i<iNumPublishers; i++) {
-        delete iPublishers[i];
+    /* All slots are held for the same time so iSlotReleaseTimes is in release order.
+       TimerManager runs timers due up to now+1 so release those too; re-arming for
+       now+1 would run this callback again in the same pass. */
+    const TUint now = Os::TimeInMs(iEnv.OsCtx());
+    AutoMutex _(iLock);
+    while (!iSlotReleaseTimes.empty() && (TInt)(iSlotReleaseTimes.front() - now) <= 1) {
+        iSlotReleaseTimes.pop_front();
+        if (iWaiting > 0) {
+            iWaiting--;
+            iPublishers->JobAdded();
+        }
+        else {
+            iFreeSlots++;
+        }
     }
-    free(iPublishers);
-    for (std::list<DviSubscription*>::iterator it = iPendingUpdates.begin(); it != iPendingUpdates.end(); ++it) {
-        (*it)->RemoveRef();
+    if (!iSlotReleaseTimes.empty()) {
+        iModerationTimer->FireAt(iSlotReleaseTimes.front());
     }
 }
 
@@ -596,6 +674,9 @@ DviSubscriptionManager::DviSubscriptionManager(DvStack& aDvStack, TUint aPriorit
     : iDvStack(aDvStack)
     , iLock("DSBM")
     , iCount(0)
+    , iMetricSubscriptions(aDvStack.Env().Metrics().Gauge("ohnet_dv_subscriptions", "Active event subscriptions to device stack services"))
+    , iMetricPublishes(aDvStack.Env().Metrics().Counter("ohnet_dv_publishes_total", "Event updates delivered to subscribers"))
+    , iMetricPublishErrors(aDvStack.Env().Metrics().Counter("ohnet_dv_publish_errors_total", "Event updates which timed out before delivery"))
 {
     IInfoAggregator* infoAggregator = iDvStack.Env().InfoAggregator();
     if (infoAggregator != NULL) {
@@ -606,10 +687,10 @@ DviSubscriptionManager::DviSubscriptionManager(DvStack& aDvStack, TUint aPriorit
     InitialisationParams* initParams = iDvStack.Env().InitParams();
     const TUint numPublisherThreads = initParams->DvNumPublisherThreads();
     const TUint moderationMs = initParams->DvPublisherModerationTimeMs();
-    Brn quickPoolThName("DviPublisherPool1");
-    Brn slowPoolThName("DviPublisherPool2");
-    iPublishersQuick = new PublisherPool((const TChar*)quickPoolThName.Ptr(), aPriority, *this, numPublisherThreads, 1, moderationMs);
-    iPublishersSlow = new PublisherPool((const TChar*)slowPoolThName.Ptr(), aPriority, *this, numPublisherThreads, 2, moderationMs);
+    TUint maxThreads, idleTimeoutMs;
+    initParams->GetWorkerPoolLimits(InitialisationParams::eWorkerPoolDvPublisher, maxThreads, idleTimeoutMs);
+    iPublishersQuick = new PublisherPool(iDvStack.Env(), "Publisher_1", aPriority, *this, numPublisherThreads, maxThreads, idleTimeoutMs, moderationMs);
+    iPublishersSlow = new PublisherPool(iDvStack.Env(), "Publisher_2", aPriority, *this, numPublisherThreads, maxThreads, idleTimeoutMs, moderationMs);
 }
 
 DviSubscriptionManager::~DviSubscriptionManager()
@@ -628,6 +709,7 @@ void DviSubscriptionManager::AddSubscription(DviSubscription& aSubscription)
     aSubscription.iPublisherQueue = iPublishersQuick;
     aSubscription.AddRef();
     iCount++;
+    iMetricSubscriptions.Set((TInt)iMap.size());
     iLock.Signal();
 }
 
@@ -639,6 +721,7 @@ void DviSubscriptionManager::RemoveSubscription(DviSubscription& aSubscription)
     if (it != iMap.end()) {
         it->second->RemoveRef();
         iMap.erase(it);
+        iMetricSubscriptions.Set((TInt)iMap.size());
     }
     iLock.Signal();
 }
@@ -667,6 +750,7 @@ void DviSubscriptionManager::QueueUpdate(DviSubscription& aSubscription)
 
 void DviSubscriptionManager::NotifyPublishSuccess(DviSubscription& aSubscription)
 {
+    iMetricPublishes.Inc();
     aSubscription.iPublisherFailures = 0;
     if (++aSubscription.iPublisherSuccesses == kPublisherSuccessThreshold && aSubscription.iPublisherQueue == iPublishersSlow) {
         LOG_INFO(kDvEvent, "DviSubscriptionManager - %u successful publishes, moving to quick queue. SID is %.*s\n"
@@ -677,6 +761,7 @@ void DviSubscriptionManager::NotifyPublishSuccess(DviSubscription& aSubscription
 
 void DviSubscriptionManager::NotifyPublishError(DviSubscription& aSubscription)
 {
+    iMetricPublishErrors.Inc();
     aSubscription.iPublisherSuccesses = 0;
     aSubscription.iPublisherFailures++;
     LOG_INFO(kDvEvent, "DviSubscriptionManager - Publishing Failure %u of %u. SID is %.*s\n",
@@ -712,7 +797,7 @@ void DviSubscriptionManager::QueryInfo(const Brx& aQuery, IWriter& aWriter)
     iAllPendingUpdates.merge(slowUpdates, SidComparison);
     for (it2=iAllPendingUpdates.begin(); it2!=iAllPendingUpdates.end(); ++it2) {
         aWriter.Write(Brn("\n\t"));
-        it->second->Log(aWriter);
+        (*it2)->Log(aWriter);
     }
     aWriter.Write(Brn("\n"));
 }
@@ -9,6 +9,7 @@
 #include <OpenHome/Private/Timer.h>
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Private/Fifo.h>
+#include <OpenHome/Private/WorkerPool.h>
 #include <OpenHome/Net/Core/OhNet.h>
 #include <OpenHome/Private/InfoProvider.h>
 
@@ -19,6 +20,11 @@
 EXCEPTION(DvSubscriptionError)
 
 namespace OpenHome {
+
+class MetricCounter;
+class MetricGauge;
+class MetricHistogram;
+
 namespace Net {
 
 class IDviSubscriptionUserData
@@ -51,6 +57,7 @@ class IPublisherQueue;
 class DviSubscription : private IStackObject
 {
     friend class DviSubscriptionManager;
+    friend class PublisherPool;
 public:
     DviSubscription(DvStack& aDvStack, DviDevice& aDevice, IPropertyWriterFactory& aWriterFactory,
                     IDviSubscriptionUserData* aUserData, Brh& aSid);
@@ -71,8 +78,10 @@ private: // from IStackObject
     void ListObjectDetails() const;
 private:
     virtual ~DviSubscription();
-    IPropertyWriter* CreateWriter();
+    IPropertyWriter* CreateWriter(TUint& aDeferMs);
+    TUint ModerationDelayMs(const Property& aProperty, TUint aIndex, TUint aNow, TBool aInitialEvent) const;
     void Expired();
+    void ModerationTimerExpired();
     void DoRenew(TUint& aSeconds);
 private:
     DvStack& iDvStack;
@@ -85,12 +94,18 @@ private:
     Brh iSid;
     DviService* iService;
     std::vector<TUint> iPropertySequenceNumbers;
+    std::vector<TUint> iPropertyPublishTimes; // when each property was last sent; used for moderation
     TUint iSequenceNumber;
     Timer* iTimer;
+    Timer* iModerationTimer;
     TUint iPublisherFailures;
     TUint iPublisherSuccesses;
     IPublisherQueue* iPublisherQueue;
     TBool iExpired;
+    // PublisherPool's intrusive queue.  iPublishPending is set while the subscription is queued
+    // (in any pool); further updates before its publish starts are coalesced into that publish.
+    volatile TUint iPublishPending;
+    DviSubscription* iNextPending;
 };
 
 class AutoSubscriptionRef : public INonCopyable
@@ -106,6 +121,8 @@ class PropertyWriter : public IPropertyWriter
 {
 public:
     static void WriteVariable(IWriter& aWriter, const Brx& aName, const Brx& aValue);
+    static void WriteVariableStart(IWriter& aWriter, const Brx& aName);
+    static void WriteVariableEnd(IWriter& aWriter, const Brx& aName);
 protected:
     PropertyWriter();
     void SetWriter(IWriter& aWriter);
@@ -113,9 +130,7 @@ private:
     inline void WriteVariable(const Brx& aName, const Brx& aValue);
     inline void WriteVariableStart(const Brx& aName);
     inline void WriteVariableEnd(const Brx& aName);
-    static void WriteVariableStart(IWriter& aWriter, const Brx& aName);
-    static void WriteVariableEnd(IWriter& aWriter, const Brx& aName);
-private: // IPropertyWriter
+protected: // IPropertyWriter
     void PropertyWriteString(const Brx& aName, const Brx& aValue);
     void PropertyWriteInt(const Brx& aName, TInt aValue);
     void PropertyWriteUint(const Brx& aName, TUint aValue);
@@ -140,39 +155,46 @@ public:
     virtual void NotifyPublishError(DviSubscription& aSubscription) = 0;
 };
 
-class Publisher : public Thread
+/**
+ * Publishes queued subscriptions from a WorkerPool.
+ *
+ * A subscription is queued at most once.  Any QueueUpdate() for a subscription that is already
+ * waiting is dropped; the publish it's waiting for will send all changes made before it starts.
+ *
+ * If aModerationMs is non-zero, at most aMinThreads publishes are started per aModerationMs.
+ * Each publish holds one of aMinThreads slots until aModerationMs after it completes; a timer
+ * then hands the slot to the next queued subscription.  No worker thread waits out the delay.
+ */
+class PublisherPool : public IPublisherQueue, private IWorkerPoolHandler
 {
 public:
-    Publisher(const TChar* aName, TUint aPriority, IPublisherObserver& aObserver, Fifo<Publisher*>& aFree, TUint aModerationMs);
-    ~Publisher();
-    void Publish(DviSubscription* aSubscription);
-private:
-    void Error(const TChar* aErr);
-    void Run();
-private:
-    IPublisherObserver& iObserver;
-    Fifo<Publisher*>& iFree;
-    DviSubscription* iSubscription;
-    const TUint iModerationMs;
-    Semaphore iModerator;
-};
-
-class PublisherPool : public Thread, public IPublisherQueue
-{
-public:
-    PublisherPool(const TChar* aName, TUint aPriority, IPublisherObserver& aObserver, TUint aNumPublisherThreads, TUint aPoolNumber, TUint aModerationMs);
+    PublisherPool(Environment& aEnv, const TChar* aName, TUint aPriority, IPublisherObserver& aObserver,
+                  TUint aMinThreads, TUint aMaxThreads, TUint aIdleTimeoutMs, TUint aModerationMs);
     ~PublisherPool();
     std::list<DviSubscription*> GetUpdates();
 public: // from IPublisherQueue
     void QueueUpdate(DviSubscription& aSubscription);
-private: // from Thread
-    void Run();
+private: // from IWorkerPoolHandler
+    void ProcessJob();
+private:
+    void Error(DviSubscription& aSubscription, const TChar* aErr);
+    void ReleaseSlots();
 private:
-    TUint iNumPublishers;
-    Fifo<Publisher*> iFree;
+    Environment& iEnv;
+    IPublisherObserver& iObserver;
+    const TUint iModerationMs;
     Mutex iLock;
-    std::list<DviSubscription*> iPendingUpdates;
-    Publisher** iPublishers;
+    DviSubscription* iHead;
+    DviSubscription* iTail;
+    TUint iFreeSlots;         // moderation only: publishes which may start now
+    TUint iWaiting;           // moderation only: queued subscriptions not yet passed to iPublishers
+    std::list<TUint> iSlotReleaseTimes; // moderation only: when each slot in use becomes free again
+    Timer* iModerationTimer;
+    WorkerPool* iPublishers;
+    MetricGauge& iMetricPending;
+    MetricHistogram& iMetricLatency;
+    MetricCounter& iMetricRequests;
+    MetricCounter& iMetricCoalesced;
 };
 
 class DviSubscriptionManager : private IPublisherObserver
@@ -202,6 +224,9 @@ private:
     TUint iCount;
     PublisherPool* iPublishersQuick;
     PublisherPool* iPublishersSlow;
+    MetricGauge& iMetricSubscriptions;
+    MetricCounter& iMetricPublishes;
+    MetricCounter& iMetricPublishErrors;
 };
 
 } // namespace Net
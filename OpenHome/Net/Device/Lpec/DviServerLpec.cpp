@@ -309,9 +309,41 @@ void PropertyWriterFactoryLpec::RemoveRef()
 }
 
 
+// LpecActionPool
+
+LpecActionPool::LpecActionPool(Environment& aEnv, TUint aMinThreads, TUint aMaxThreads, TUint aIdleTimeoutMs)
+    : iLock("DLPA")
+{
+    iPool = new WorkerPool(aEnv, "LpecAction", *this, aMinThreads, aMaxThreads, aIdleTimeoutMs);
+}
+
+LpecActionPool::~LpecActionPool()
+{
+    delete iPool;
+    // sessions wait for their actions before exiting so nothing can still be queued
+    ASSERT(iQueue.size() == 0);
+}
+
+void LpecActionPool::Queue(ILpecAction& aAction)
+{
+    AutoMutex a(iLock);
+    iQueue.push_back(&aAction);
+    iPool->JobAdded();
+}
+
+void LpecActionPool::ProcessJob()
+{
+    iLock.Wait();
+    ILpecAction* action = iQueue.front();
+    iQueue.pop_front();
+    iLock.Signal();
+    action->Run();
+}
+
+
 // DviSessionLpec
 
-DviSessionLpec::DviSessionLpec(DvStack& aDvStack, const TIpAddress& aAdapter, TUint aPort)
+DviSessionLpec::DviSessionLpec(DvStack& aDvStack, LpecActionPool& aActionPool, const TIpAddress& aAdapter, TUint aPort)
     : iDvStack(aDvStack)
     , iAdapter(aAdapter)
     , iPort(aPort)
@@ -321,12 +353,23 @@ DviSessionLpec::DviSessionLpec(DvStack& aDvStack, const TIpAddress& aAdapter, TU
     , iByeByeLock("DLP4")
     , iDeviceLock("DLP5")
     , iActive(false)
+    , iActionPool(aActionPool)
+    , iMaxConcurrentActions(aDvStack.Env().InitParams()->DvLpecMaxConcurrentActions())
+    , iFreeActions(iMaxConcurrentActions)
+    , iActionLock("DLP6")
+    , iWritingResponses(false)
 {
+    ASSERT(iMaxConcurrentActions > 0);
     iReadBuffer = new Srs<1024>(*this);
     iReaderUntil = new ReaderUntilS<kMaxReadBytes>(*iReadBuffer);
-    iWriteBuffer = new Sws<kWriteBufferBytes>(*this);
+    iWriteBuffer = new Swp(aDvStack.Env().Buffers(), kWriteBufferBytes, *this);
     iEventWriterAdapter = new EventWriterAdapter(*iWriteBuffer, iWriteLock, iSubscriptions);
     iPropertyWriterFactory = new PropertyWriterFactoryLpec(*iEventWriterAdapter);
+    for (TUint i=0; i<iMaxConcurrentActions; i++) {
+        ActionInvocation* action = new ActionInvocation(*this);
+        iActions.push_back(action);
+        iFreeActions.Write(action);
+    }
 }
 
 DviSessionLpec::~DviSessionLpec()
@@ -337,6 +380,10 @@ DviSessionLpec::~DviSessionLpec()
     iSubscriptions.clear();
     iSubscriptionLock.Signal();
     iShutdownSem.Wait();
+    // Run() has exited so all actions have completed
+    for (TUint i=0; i<iMaxConcurrentActions; i++) {
+        delete iActions[i];
+    }
     iWriteLock.Wait();
     /* nothing to do inside this lock.  Taking it after calling Disable() confirms that
        no evented update is currently using iWriteBuffer. */
@@ -403,21 +450,24 @@ void DviSessionLpec::Run()
             iResponseStarted = iResponseEnded = false;
             iParser.Set(iRequestBuf);
             Brn method = iParser.Next(' ');
+            if (Ascii::CaseInsensitiveEquals(method, Lpec::kMethodAction)) {
+                DispatchAction(iRequestBuf);
+                continue;
+            }
+            if (method.Bytes() == 0) {
+                /* Allow blank lines - these may be entered to make output from
+                   manual LPEC session more readable */
+                continue;
+            }
+            // other requests affect session state so wait for any earlier actions to respond first
+            WaitForActions();
             try {
-                if (Ascii::CaseInsensitiveEquals(method, Lpec::kMethodAction)) {
-                    Action();
-                }
-                else if (Ascii::CaseInsensitiveEquals(method, Lpec::kMethodSubscribe)) {
+                if (Ascii::CaseInsensitiveEquals(method, Lpec::kMethodSubscribe)) {
                     Subscribe();
                 }
                 else if (Ascii::CaseInsensitiveEquals(method, Lpec::kMethodUnsubscribe)) {
                     Unsubscribe();
                 }
-                else if (method.Bytes() == 0) {
-                    /* Allow blank lines - these may be entered to make output from
-                       manual LPEC session more readable */
-                    continue;
-                }
                 else {
                     ReportErrorNoThrow(LpecError::kCommandNotRecognised);
                 }
@@ -431,7 +481,7 @@ void DviSessionLpec::Run()
                 ReportErrorNoThrow(LpecError::kMethodExecutionError);
             }
             if (!iResponseEnded) {
-                InvocationWriteEnd();
+                WriteResponseEnd();
             }
         }
     }
@@ -439,6 +489,7 @@ void DviSessionLpec::Run()
     }
     catch (WriterError&) {
     }
+    WaitForActions();
 
     iDeviceLock.Wait();
     std::map<Brn,DviDevice*,BufferCmp>::iterator it = iDeviceMap.begin();
@@ -487,26 +538,63 @@ void DviSessionLpec::Announce()
     }
 }
 
-void DviSessionLpec::Action()
+void DviSessionLpec::DispatchAction(const Brx& aRequest)
 {
-    try {
-        AutoMutex a(iDeviceLock);
-        ParseDeviceAndService();
-        Brn versionBuf = iParser.Next(' ');
-        try {
-            iVersion = Ascii::Uint(versionBuf);
+    ActionInvocation* action = iFreeActions.Read(); // blocks if iMaxConcurrentActions are already in progress
+    action->Set(aRequest);
+    iActionLock.Wait();
+    iActionsInOrder.push_back(action);
+    iActionLock.Signal();
+    iActionPool.Queue(*action);
+}
+
+void DviSessionLpec::ActionComplete(ActionInvocation& aAction)
+{
+    /* Write responses for any completed actions that are no longer waiting on an earlier request.
+       Writes happen outside iActionLock so other actions can complete while a response is sent.
+       Only one thread writes at a time, keeping responses in order; it collects responses
+       for actions that complete while it is writing. */
+    std::vector<ActionInvocation*> completed;
+    iActionLock.Wait();
+    aAction.SetComplete();
+    if (iWritingResponses) {
+        iActionLock.Signal();
+        return;
+    }
+    iWritingResponses = true;
+    for (;;) {
+        while (iActionsInOrder.size() > 0 && iActionsInOrder.front()->Complete()) {
+            completed.push_back(iActionsInOrder.front());
+            iActionsInOrder.pop_front();
         }
-        catch (AsciiError&) {
-            ReportError(LpecError::kVersionNotSpecified);
+        if (completed.size() == 0) {
+            iWritingResponses = false;
+            iActionLock.Signal();
+            return;
         }
-        if (iVersion > iTargetService->ServiceType().Version()) {
-            ReportError(LpecError::kVersionNotSupported);
+        iActionLock.Signal();
+        for (TUint i=0; i<(TUint)completed.size(); i++) {
+            try {
+                AutoMutex a(iWriteLock);
+                iWriteBuffer->Write(completed[i]->Response());
+                iWriteBuffer->WriteFlush();
+            }
+            catch (WriterError&) {
+            }
+            iFreeActions.Write(completed[i]);
         }
-        Invoke();
+        completed.clear();
+        iActionLock.Wait();
     }
-    catch (LpecParseError&) {
+}
+
+void DviSessionLpec::WaitForActions()
+{
+    for (TUint i=0; i<iMaxConcurrentActions; i++) {
+        (void)iFreeActions.Read();
     }
-    catch (InvocationError&) {
+    for (TUint i=0; i<iMaxConcurrentActions; i++) {
+        iFreeActions.Write(iActions[i]);
     }
 }
 
@@ -593,38 +681,39 @@ void DviSessionLpec::Unsubscribe()
 
 void DviSessionLpec::ParseDeviceAndService()
 {
-    iTargetDevice = NULL;
-    iTargetService = NULL;
+    const LpecError* err = FindDeviceAndService(iParser, iTargetDevice, iTargetService);
+    if (err != NULL) {
+        ReportErrorNoThrow(*err);
+        THROW(LpecParseError);
+    }
+}
+
+const LpecError* DviSessionLpec::FindDeviceAndService(Parser& aParser, DviDevice*& aDevice, DviService*& aService)
+{
+    aDevice = NULL;
+    aService = NULL;
 
-    Brn deviceName = iParser.Next('/');
+    Brn deviceName = aParser.Next('/');
     std::map<Brn,DviDevice*,BufferCmp>::iterator it = iDeviceMap.begin();
     while (it != iDeviceMap.end()) {
         const TChar* name = NULL;
         it->second->GetAttribute("Lpec.Name", &name);
         if (name != NULL && Brn(name) == deviceName) {
-            iTargetDevice = it->second;
+            aDevice = it->second;
             break;
         }
         it++;
     }
-    if (iTargetDevice == NULL) {
-        ReportErrorNoThrow(LpecError::kDeviceNotFound);
-        THROW(LpecParseError);
+    if (aDevice == NULL) {
+        return &LpecError::kDeviceNotFound;
     }
 
-    Brn serviceName = iParser.Next(' ');
-    const TUint count = iTargetDevice->ServiceCount();
-    for (TUint i=0; i<count; i++) {
-        DviService& service = iTargetDevice->Service(i);
-        if (service.ServiceType().Name() == serviceName) {
-            iTargetService = &service;
-            break;
-        }
-    }
-    if (iTargetService == NULL) {
-        ReportErrorNoThrow(LpecError::kServiceNotFound);
-        THROW(LpecParseError);
+    Brn serviceName = aParser.Next(' ');
+    aService = aDevice->ServiceByName(serviceName);
+    if (aService == NULL) {
+        return &LpecError::kServiceNotFound;
     }
+    return NULL;
 }
 
 void DviSessionLpec::DoUnsubscribe(TUint aIndex, TBool aRespond)
@@ -678,28 +767,159 @@ void DviSessionLpec::ReportErrorNoThrow(TUint aCode, const Brx& aDescription)
     iResponseStarted = true;
 }
 
-void DviSessionLpec::Invoke()
+void DviSessionLpec::WriteResponseEnd()
+{
+    ASSERT(iResponseStarted);
+    iResponseEnded = true;
+    try {
+        iWriteBuffer->Write(Lpec::kMsgTerminator);
+        iWriteBuffer->WriteFlush();
+    }
+    catch (WriterError&) {
+    }
+    iWriteLock.Signal();
+}
+
+// DviSessionLpec::ActionInvocation
+
+DviSessionLpec::ActionInvocation::ActionInvocation(DviSessionLpec& aSession)
+    : iSession(aSession)
+    , iRequest(kMaxReadBytes)
+    , iResponse(kResponseGranularity)
+    , iResponseStarted(false)
+    , iResponseEnded(false)
+    , iComplete(false)
+    , iTargetDevice(NULL)
+    , iTargetService(NULL)
+    , iVersion(0)
+{
+}
+
+void DviSessionLpec::ActionInvocation::Set(const Brx& aRequest)
+{
+    iRequest.Replace(aRequest);
+    iParser.Set(iRequest);
+    (void)iParser.Next(' '); // skip method, already known to be ACTION
+    iResponse.Reset();
+    iResponseStarted = iResponseEnded = false;
+    iComplete = false;
+    iTargetDevice = NULL;
+    iTargetService = NULL;
+    iVersion = 0;
+}
+
+void DviSessionLpec::ActionInvocation::Run()
+{
+    Execute();
+    iSession.ActionComplete(*this);
+}
+
+void DviSessionLpec::ActionInvocation::Execute()
+{
+    DviDevice* device = NULL;
+    try {
+        {
+            AutoMutex a(iSession.iDeviceLock);
+            const LpecError* err = iSession.FindDeviceAndService(iParser, iTargetDevice, iTargetService);
+            if (err != NULL) {
+                ReportErrorNoThrow(*err);
+                THROW(LpecParseError);
+            }
+            // the session may drop its reference to the device (on bye-bye) while we're running
+            iTargetDevice->AddWeakRef();
+            device = iTargetDevice;
+        }
+        AutoDeviceRef r(device);
+        Brn versionBuf = iParser.Next(' ');
+        try {
+            iVersion = Ascii::Uint(versionBuf);
+        }
+        catch (AsciiError&) {
+            ReportError(LpecError::kVersionNotSpecified);
+        }
+        if (iVersion > iTargetService->ServiceType().Version()) {
+            ReportError(LpecError::kVersionNotSupported);
+        }
+        Invoke();
+    }
+    catch (LpecParseError&) {
+    }
+    catch (InvocationError&) {
+    }
+    if (!iResponseStarted) {
+        ASSERT(!iResponseEnded);
+        ReportErrorNoThrow(LpecError::kMethodExecutionError);
+    }
+    if (!iResponseEnded) {
+        InvocationWriteEnd();
+    }
+}
+
+TBool DviSessionLpec::ActionInvocation::Complete() const
+{
+    return iComplete;
+}
+
+void DviSessionLpec::ActionInvocation::SetComplete()
+{
+    iComplete = true;
+}
+
+const Brx& DviSessionLpec::ActionInvocation::Response() const
+{
+    return iResponse.Buffer();
+}
+
+void DviSessionLpec::ActionInvocation::ReportError(const LpecError& aError)
+{
+    ReportErrorNoThrow(aError);
+    THROW(InvocationError);
+}
+
+void DviSessionLpec::ActionInvocation::ReportErrorNoThrow(const LpecError& aError)
+{
+    ReportErrorNoThrow(aError.Code(), aError.Description());
+}
+
+void DviSessionLpec::ActionInvocation::ReportErrorNoThrow(TUint aCode, const Brx& aDescription)
+{
+    if (!iResponseStarted) {
+        ASSERT(!iResponseEnded);
+        iResponse.Write(Lpec::kMethodError);
+        iResponse.Write(' ');
+        Bws<Ascii::kMaxUintStringBytes> code;
+        (void)Ascii::AppendDec(code, aCode);
+        iResponse.Write(code);
+        iResponse.Write(' ');
+        iResponse.Write(Lpec::kArgumentDelimiter);
+        iResponse.Write(aDescription);
+        iResponse.Write(Lpec::kArgumentDelimiter);
+    }
+    iResponseStarted = true;
+}
+
+void DviSessionLpec::ActionInvocation::Invoke()
 {
     Brn actionName = iParser.Next(' ');
     iTargetService->InvokeDirect(*this, actionName);
 }
 
-TUint DviSessionLpec::Version() const
+TUint DviSessionLpec::ActionInvocation::Version() const
 {
     return iVersion;
 }
 
-const TIpAddress& DviSessionLpec::Adapter() const
+const TIpAddress& DviSessionLpec::ActionInvocation::Adapter() const
 {
-    return iAdapter;
+    return iSession.iAdapter;
 }
 
-const char* DviSessionLpec::ResourceUriPrefix() const
+const char* DviSessionLpec::ActionInvocation::ResourceUriPrefix() const
 {
     // FIXME - duplicated from DviProtocolUpnp and DviServerUpnp
     iResourceUriPrefix.SetBytes(0);
     iResourceUriPrefix.Append("http://");
-    Endpoint ep(iPort, iAdapter);
+    Endpoint ep(iSession.iPort, iSession.iAdapter);
     ep.AppendEndpoint(iResourceUriPrefix);
     iResourceUriPrefix.Append("/");
     iResourceUriPrefix.Append(iTargetDevice->Udn());
@@ -712,23 +932,22 @@ const char* DviSessionLpec::ResourceUriPrefix() const
     return (const char*)iResourceUriPrefix.Ptr();
 }
 
-Endpoint DviSessionLpec::ClientEndpoint() const
+Endpoint DviSessionLpec::ActionInvocation::ClientEndpoint() const
 {
-    Endpoint ep(SocketTcpSession::ClientEndpoint());
-    return ep;
+    return iSession.SocketTcpSession::ClientEndpoint();
 }
 
-const Brx& DviSessionLpec::ClientUserAgent() const
+const Brx& DviSessionLpec::ActionInvocation::ClientUserAgent() const
 {
     return Brx::Empty();
 }
 
-void DviSessionLpec::InvocationReadStart()
+void DviSessionLpec::ActionInvocation::InvocationReadStart()
 {
     // nothing to do here
 }
 
-TBool DviSessionLpec::InvocationReadBool(const TChar* /*aName*/)
+TBool DviSessionLpec::ActionInvocation::InvocationReadBool(const TChar* /*aName*/)
 {
     (void)iParser.Next(Lpec::kArgumentDelimiter);
     Brn val = iParser.Next(Lpec::kArgumentDelimiter);
@@ -744,7 +963,7 @@ TBool DviSessionLpec::InvocationReadBool(const TChar* /*aName*/)
     return false; // never reached
 }
 
-void DviSessionLpec::InvocationReadString(const TChar* /*aName*/, Brhz& aString)
+void DviSessionLpec::ActionInvocation::InvocationReadString(const TChar* /*aName*/, Brhz& aString)
 {
     (void)iParser.Next(Lpec::kArgumentDelimiter);
     Brn val = iParser.NextNoTrim(Lpec::kArgumentDelimiter);
@@ -757,7 +976,7 @@ void DviSessionLpec::InvocationReadString(const TChar* /*aName*/, Brhz& aString)
     writable.TransferTo(aString);
 }
 
-TInt DviSessionLpec::InvocationReadInt(const TChar* /*aName*/)
+TInt DviSessionLpec::ActionInvocation::InvocationReadInt(const TChar* /*aName*/)
 {
     (void)iParser.Next(Lpec::kArgumentDelimiter);
     try {
@@ -770,7 +989,7 @@ TInt DviSessionLpec::InvocationReadInt(const TChar* /*aName*/)
     return 0; // never reached
 }
 
-TUint DviSessionLpec::InvocationReadUint(const TChar* /*aName*/)
+TUint DviSessionLpec::ActionInvocation::InvocationReadUint(const TChar* /*aName*/)
 {
     (void)iParser.Next(Lpec::kArgumentDelimiter);
     try {
@@ -783,7 +1002,7 @@ TUint DviSessionLpec::InvocationReadUint(const TChar* /*aName*/)
     return 0; // never reached
 }
 
-void DviSessionLpec::InvocationReadBinary(const TChar* /*aName*/, Brh& aData)
+void DviSessionLpec::ActionInvocation::InvocationReadBinary(const TChar* /*aName*/, Brh& aData)
 {
     (void)iParser.Next(Lpec::kArgumentDelimiter);
     Brn val = iParser.NextNoTrim(Lpec::kArgumentDelimiter);
@@ -795,109 +1014,103 @@ void DviSessionLpec::InvocationReadBinary(const TChar* /*aName*/, Brh& aData)
     }
 }
 
-void DviSessionLpec::InvocationReadEnd()
+void DviSessionLpec::ActionInvocation::InvocationReadEnd()
 {
     // nothing to do here
 }
 
-void DviSessionLpec::InvocationReportError(TUint aCode, const Brx& aDescription)
+void DviSessionLpec::ActionInvocation::InvocationReportError(TUint aCode, const Brx& aDescription)
 {
     ReportErrorNoThrow(aCode, aDescription);
     THROW(InvocationError);
 }
 
-void DviSessionLpec::InvocationWriteStart()
+void DviSessionLpec::ActionInvocation::InvocationWriteStart()
 {
-    iWriteLock.Wait();
-    iWriteBuffer->Write(Lpec::kMethodResponse);
+    iResponse.Write(Lpec::kMethodResponse);
     iResponseStarted = true;
 }
 
-void DviSessionLpec::InvocationWriteBool(const TChar* /*aName*/, TBool aValue)
+void DviSessionLpec::ActionInvocation::InvocationWriteBool(const TChar* /*aName*/, TBool aValue)
 {
-    iWriteBuffer->Write(' ');
-    iWriteBuffer->Write(Lpec::kArgumentDelimiter);
-    iWriteBuffer->Write(aValue? Lpec::kBoolTrue : Lpec::kBoolFalse);
-    iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iResponse.Write(' ');
+    iResponse.Write(Lpec::kArgumentDelimiter);
+    iResponse.Write(aValue? Lpec::kBoolTrue : Lpec::kBoolFalse);
+    iResponse.Write(Lpec::kArgumentDelimiter);
 }
 
-void DviSessionLpec::InvocationWriteInt(const TChar* /*aName*/, TInt aValue)
+void DviSessionLpec::ActionInvocation::InvocationWriteInt(const TChar* /*aName*/, TInt aValue)
 {
-    iWriteBuffer->Write(' ');
-    iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iResponse.Write(' ');
+    iResponse.Write(Lpec::kArgumentDelimiter);
     Bws<Ascii::kMaxIntStringBytes> val;
     (void)Ascii::AppendDec(val, aValue);
-    iWriteBuffer->Write(val);
-    iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iResponse.Write(val);
+    iResponse.Write(Lpec::kArgumentDelimiter);
 }
 
-void DviSessionLpec::InvocationWriteUint(const TChar* /*aName*/, TUint aValue)
+void DviSessionLpec::ActionInvocation::InvocationWriteUint(const TChar* /*aName*/, TUint aValue)
 {
-    iWriteBuffer->Write(' ');
-    iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iResponse.Write(' ');
+    iResponse.Write(Lpec::kArgumentDelimiter);
     Bws<Ascii::kMaxUintStringBytes> val;
     (void)Ascii::AppendDec(val, aValue);
-    iWriteBuffer->Write(val);
-    iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iResponse.Write(val);
+    iResponse.Write(Lpec::kArgumentDelimiter);
 }
 
-void DviSessionLpec::InvocationWriteBinaryStart(const TChar* /*aName*/)
+void DviSessionLpec::ActionInvocation::InvocationWriteBinaryStart(const TChar* /*aName*/)
 {
-    iWriteBuffer->Write(' ');
-    iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iResponse.Write(' ');
+    iResponse.Write(Lpec::kArgumentDelimiter);
 }
 
-void DviSessionLpec::InvocationWriteBinary(TByte aValue)
+void DviSessionLpec::ActionInvocation::InvocationWriteBinary(TByte aValue)
 {
-    iWriteBuffer->Write(aValue);
+    iResponse.Write(aValue);
 }
 
-void DviSessionLpec::InvocationWriteBinary(const Brx& aValue)
+void DviSessionLpec::ActionInvocation::InvocationWriteBinary(const Brx& aValue)
 {
-    Converter::ToBase64(*iWriteBuffer, aValue);
+    Converter::ToBase64(iResponse, aValue);
 }
 
-void DviSessionLpec::InvocationWriteBinaryEnd(const TChar* /*aName*/)
+void DviSessionLpec::ActionInvocation::InvocationWriteBinaryEnd(const TChar* /*aName*/)
 {
-    iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iResponse.Write(Lpec::kArgumentDelimiter);
 }
 
-void DviSessionLpec::InvocationWriteStringStart(const TChar* /*aName*/)
+void DviSessionLpec::ActionInvocation::InvocationWriteStringStart(const TChar* /*aName*/)
 {
-    iWriteBuffer->Write(' ');
-    iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iResponse.Write(' ');
+    iResponse.Write(Lpec::kArgumentDelimiter);
 }
 
-void DviSessionLpec::InvocationWriteString(TByte aValue)
+void DviSessionLpec::ActionInvocation::InvocationWriteString(TByte aValue)
 {
     Brn buf(&aValue, 1);
     InvocationWriteString(buf);
 }
 
-void DviSessionLpec::InvocationWriteString(const Brx& aValue)
+void DviSessionLpec::ActionInvocation::InvocationWriteString(const Brx& aValue)
 {
-    Converter::ToXmlEscaped(*iWriteBuffer, aValue);
+    Converter::ToXmlEscaped(iResponse, aValue);
 }
 
-void DviSessionLpec::InvocationWriteStringEnd(const TChar* /*aName*/)
+void DviSessionLpec::ActionInvocation::InvocationWriteStringEnd(const TChar* /*aName*/)
 {
-    iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iResponse.Write(Lpec::kArgumentDelimiter);
 }
 
-void DviSessionLpec::InvocationWriteEnd()
+void DviSessionLpec::ActionInvocation::InvocationWriteEnd()
 {
     ASSERT(iResponseStarted);
     iResponseEnded = true;
-    try {
-        iWriteBuffer->Write(Lpec::kMsgTerminator);
-        iWriteBuffer->WriteFlush();
-    }
-    catch (WriterError&) {
-    }
-    iWriteLock.Signal();
+    iResponse.Write(Lpec::kMsgTerminator);
 }
 
 
+
 // DviSessionLpec::SubscriptionData
 
 DviSessionLpec::SubscriptionData::SubscriptionData(DviDevice& aDevice, DviService& aService, DviSubscription& aSubscription, TUint aLpecSubscriptionId)
@@ -934,12 +1147,48 @@ TUint DviSessionLpec::SubscriptionData::LpecSid() const
 DviServerLpec::DviServerLpec(DvStack& aDvStack, TUint aPort)
     : DviServer(aDvStack)
     , iPort(aPort)
+    , iLocalServer(NULL)
 {
+    InitialisationParams* initParams = aDvStack.Env().InitParams();
+    TUint maxThreads, idleTimeoutMs;
+    initParams->GetWorkerPoolLimits(InitialisationParams::eWorkerPoolDvLpec, maxThreads, idleTimeoutMs);
+    iActionPool = new LpecActionPool(aDvStack.Env(), initParams->DvLpecMaxConcurrentActions(), maxThreads, idleTimeoutMs);
 }
 
 void DviServerLpec::Start()
 {
     Initialise();
+    const Brx& localPath = iDvStack.Env().InitParams()->LpecLocalSocket();
+    if (localPath.Bytes() > 0) {
+        StartLocalServer(localPath);
+    }
+}
+
+void DviServerLpec::StartLocalServer(const Brx& aPath)
+{
+    try {
+        iLocalServer = new SocketTcpServer(iDvStack.Env(), "LpecLocalServer", aPath);
+    }
+    catch (NetworkError&) {
+        Log::Print("WARNING: unable to listen for LPEC connections on ");
+        Log::Print(aPath);
+        Log::Print("\n");
+        return;
+    }
+    /* Clients of the local server are necessarily on this host so are told about
+       resources using the loopback address */
+    TIpAddress loopback;
+    loopback.iFamily = kFamilyV4;
+    loopback.iV4 = MakeIpAddress(127, 0, 0, 1);
+    const TUint numThreads = iDvStack.Env().InitParams()->DvNumLpecThreads();
+    for (TUint i=0; i<numThreads; i++) {
+        Bws<Thread::kMaxNameBytes+1> thName;
+        thName.AppendPrintf("LpecLocal %d", i);
+        thName.PtrZ();
+        DviSessionLpec* session = new DviSessionLpec(iDvStack, *iActionPool, loopback, iPort);
+        iLocalServer->Add((const TChar*)thName.Ptr(), session);
+        iLocalSessions.push_back(session);
+    }
 }
 
 void DviServerLpec::SendAnnouncement()
@@ -950,6 +1199,9 @@ void DviServerLpec::SendAnnouncement()
             ad->iSessions[j]->SendAnnouncement();
         }
     }
+    for (TUint i=0; i<iLocalSessions.size(); i++) {
+        iLocalSessions[i]->SendAnnouncement();
+    }
 }
 
 void DviServerLpec::NotifyDeviceDisabled(const Brx& aName, const Brx& aUdn)
@@ -960,6 +1212,9 @@ void DviServerLpec::NotifyDeviceDisabled(const Brx& aName, const Brx& aUdn)
             ad->iSessions[j]->NotifyDeviceDisabled(aName, aUdn);
         }
     }
+    for (TUint i=0; i<iLocalSessions.size(); i++) {
+        iLocalSessions[i]->NotifyDeviceDisabled(aName, aUdn);
+    }
 }
 
 TUint DviServerLpec::Port() const
@@ -977,7 +1232,7 @@ SocketTcpServer* DviServerLpec::CreateServer(const NetworkAdapter& aNif)
         Bws<Thread::kMaxNameBytes+1> thName;
         thName.AppendPrintf("LpecSession %d", i);
         thName.PtrZ();
-        DviSessionLpec* session = new DviSessionLpec(iDvStack, aNif.Address(), iPort);
+        DviSessionLpec* session = new DviSessionLpec(iDvStack, *iActionPool, aNif.Address(), iPort);
         server->Add((const TChar*)thName.Ptr(), session);
         ad->iSessions.push_back(session);
     }
@@ -986,7 +1241,10 @@ SocketTcpServer* DviServerLpec::CreateServer(const NetworkAdapter& aNif)
 
 DviServerLpec::~DviServerLpec()
 {
+    iLocalSessions.clear();
+    delete iLocalServer; // deletes iLocalSessions
     Deinitialise();
+    delete iActionPool;
 }
 
 void DviServerLpec::NotifyServerDeleted(const TIpAddress& aInterface)
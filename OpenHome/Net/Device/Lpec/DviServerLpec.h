@@ -8,10 +8,15 @@
 #include <OpenHome/Net/Private/DviService.h>
 #include <OpenHome/Net/Private/DviServer.h>
 #include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/BufferPool.h>
 #include <OpenHome/Private/Parser.h>
 #include <OpenHome/Private/Standard.h>
+#include <OpenHome/Private/Fifo.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/WorkerPool.h>
 
 #include <vector>
+#include <list>
 #include <map>
 
 EXCEPTION(LpecParseError)
@@ -111,54 +116,125 @@ private:
     Mutex iSubscriptionMapLock;
 };
 
-class DviSessionLpec : public SocketTcpSession, private IDviInvocation
+class ILpecAction
 {
 public:
-    DviSessionLpec(DvStack& aDvStack, const TIpAddress& aAdapter, TUint aPort);
+    virtual ~ILpecAction() {}
+    virtual void Run() = 0;
+};
+
+/**
+ * Runs actions for every LPEC session on a single WorkerPool.
+ *
+ * The pool doesn't limit how many actions any one session queues; sessions do that themselves.
+ */
+class LpecActionPool : private IWorkerPoolHandler
+{
+public:
+    LpecActionPool(Environment& aEnv, TUint aMinThreads, TUint aMaxThreads, TUint aIdleTimeoutMs);
+    ~LpecActionPool();
+    void Queue(ILpecAction& aAction);
+private: // from IWorkerPoolHandler
+    void ProcessJob();
+private:
+    Mutex iLock;
+    std::list<ILpecAction*> iQueue;
+    WorkerPool* iPool;
+};
+
+/**
+ * One LPEC client connection.
+ *
+ * Requests are read on the session thread.  Actions are run on the server's shared
+ * LpecActionPool so a slow action doesn't block later requests.  At most
+ * InitialisationParams::DvLpecMaxConcurrentActions() actions from a session are queued
+ * or running at once; the session thread blocks reading further requests until one
+ * completes.  Action responses are buffered and written in the order their requests
+ * were received.  Subscribe/unsubscribe requests wait for earlier actions to complete
+ * so their responses stay in order too.
+ */
+class DviSessionLpec : public SocketTcpSession
+{
+public:
+    DviSessionLpec(DvStack& aDvStack, LpecActionPool& aActionPool, const TIpAddress& aAdapter, TUint aPort);
     ~DviSessionLpec();
     void SendAnnouncement();
     void NotifyDeviceDisabled(const Brx& aName, const Brx& aUdn);
 private: // from SocketTcpSession
     void Run();
 private:
+    class ActionInvocation;
     void Announce();
-    void Action();
+    void DispatchAction(const Brx& aRequest);
+    void ActionComplete(ActionInvocation& aAction);
+    void WaitForActions();
     void Subscribe();
     void Unsubscribe();
     void ParseDeviceAndService();
+    const LpecError* FindDeviceAndService(Parser& aParser, DviDevice*& aDevice, DviService*& aService); // call with iDeviceLock held
     void DoUnsubscribe(TUint aIndex, TBool aRespond = true);
     void ReportError(const LpecError& aError);
     void ReportErrorNoThrow(const LpecError& aError);
     void ReportErrorNoThrow(TUint aCode, const Brx& aDescription);
-private: // from IDviInvocation
-    void Invoke();
-    TUint Version() const;
-    const TIpAddress& Adapter() const;
-    const char* ResourceUriPrefix() const;
-    Endpoint ClientEndpoint() const;
-    const Brx& ClientUserAgent() const;
-    void InvocationReadStart();
-    TBool InvocationReadBool(const TChar* aName);
-    void InvocationReadString(const TChar* aName, Brhz& aString);
-    TInt InvocationReadInt(const TChar* aName);
-    TUint InvocationReadUint(const TChar* aName);
-    void InvocationReadBinary(const TChar* aName, Brh& aData);
-    void InvocationReadEnd();
-    void InvocationReportError(TUint aCode, const Brx& aDescription);
-    void InvocationWriteStart();
-    void InvocationWriteBool(const TChar* aName, TBool aValue);
-    void InvocationWriteInt(const TChar* aName, TInt aValue);
-    void InvocationWriteUint(const TChar* aName, TUint aValue);
-    void InvocationWriteBinaryStart(const TChar* aName);
-    void InvocationWriteBinary(TByte aValue);
-    void InvocationWriteBinary(const Brx& aValue);
-    void InvocationWriteBinaryEnd(const TChar* aName);
-    void InvocationWriteStringStart(const TChar* aName);
-    void InvocationWriteString(TByte aValue);
-    void InvocationWriteString(const Brx& aValue);
-    void InvocationWriteStringEnd(const TChar* aName);
-    void InvocationWriteEnd();
-private: // from IEventWriter
+    void WriteResponseEnd();
+private:
+    class ActionInvocation : public ILpecAction, private IDviInvocation, private INonCopyable
+    {
+    public:
+        ActionInvocation(DviSessionLpec& aSession);
+        void Set(const Brx& aRequest);
+        TBool Complete() const;
+        void SetComplete();
+        const Brx& Response() const;
+    private: // from ILpecAction
+        void Run();
+    private:
+        void Execute();
+        void ReportError(const LpecError& aError);
+        void ReportErrorNoThrow(const LpecError& aError);
+        void ReportErrorNoThrow(TUint aCode, const Brx& aDescription);
+    private: // from IDviInvocation
+        void Invoke();
+        TUint Version() const;
+        const TIpAddress& Adapter() const;
+        const char* ResourceUriPrefix() const;
+        Endpoint ClientEndpoint() const;
+        const Brx& ClientUserAgent() const;
+        void InvocationReadStart();
+        TBool InvocationReadBool(const TChar* aName);
+        void InvocationReadString(const TChar* aName, Brhz& aString);
+        TInt InvocationReadInt(const TChar* aName);
+        TUint InvocationReadUint(const TChar* aName);
+        void InvocationReadBinary(const TChar* aName, Brh& aData);
+        void InvocationReadEnd();
+        void InvocationReportError(TUint aCode, const Brx& aDescription);
+        void InvocationWriteStart();
+        void InvocationWriteBool(const TChar* aName, TBool aValue);
+        void InvocationWriteInt(const TChar* aName, TInt aValue);
+        void InvocationWriteUint(const TChar* aName, TUint aValue);
+        void InvocationWriteBinaryStart(const TChar* aName);
+        void InvocationWriteBinary(TByte aValue);
+        void InvocationWriteBinary(const Brx& aValue);
+        void InvocationWriteBinaryEnd(const TChar* aName);
+        void InvocationWriteStringStart(const TChar* aName);
+        void InvocationWriteString(TByte aValue);
+        void InvocationWriteString(const Brx& aValue);
+        void InvocationWriteStringEnd(const TChar* aName);
+        void InvocationWriteEnd();
+    private:
+        static const TUint kResponseGranularity = 1024;
+        DviSessionLpec& iSession;
+        Bwh iRequest;
+        Parser iParser;
+        WriterBwh iResponse;
+        TBool iResponseStarted;
+        TBool iResponseEnded;
+        TBool iComplete; // protected by DviSessionLpec::iActionLock
+        DviDevice* iTargetDevice;
+        DviService* iTargetService;
+        TUint iVersion;
+        mutable Bws<128> iResourceUriPrefix;
+    };
     class SubscriptionData
     {
     public:
@@ -203,7 +279,7 @@ private:
     Mutex iDeviceLock;
     Srx* iReadBuffer;
     ReaderUntil* iReaderUntil;
-    Sws<kWriteBufferBytes>* iWriteBuffer;
+    Swp* iWriteBuffer;
     EventWriterAdapter* iEventWriterAdapter;
     PropertyWriterFactoryLpec* iPropertyWriterFactory;
     std::map<Brn,DviDevice*,BufferCmp> iDeviceMap;
@@ -214,9 +290,15 @@ private:
     TBool iActive;
     DviDevice* iTargetDevice;
     DviService* iTargetService;
-    TUint iVersion;
-    mutable Bws<128> iResourceUriPrefix;
     std::vector<SubscriptionData> iSubscriptions;
+    LpecActionPool& iActionPool;
+    const TUint iMaxConcurrentActions;
+    std::vector<ActionInvocation*> iActions;
+    Fifo<ActionInvocation*> iFreeActions;       // readers block when iMaxConcurrentActions are in progress
+    Mutex iActionLock;
+    // iActionsInOrder and iWritingResponses are protected by iActionLock
+    std::list<ActionInvocation*> iActionsInOrder; // dispatched actions, in request order
+    TBool iWritingResponses;
 };
 
 class DvStack;
@@ -243,9 +325,14 @@ private:
         TIpAddress iInterface;
         std::vector<DviSessionLpec*> iSessions;
     };
+private:
+    void StartLocalServer(const Brx& aPath);
 private:
     TUint iPort;
+    LpecActionPool* iActionPool;
     std::vector<AdapterData*> iAdapterData;
+    SocketTcpServer* iLocalServer; // optional listener on a local (unix domain) socket
+    std::vector<DviSessionLpec*> iLocalSessions;
 };
 
 } // namespace Net
@@ -55,6 +55,14 @@ ProviderTestBasic::ProviderTestBasic(DvDevice& aDevice)
     EnableActionShutdown();
 }
 
+void ProviderTestBasic::PropertyStorm(TUint aCount)
+{
+    for (TUint i=1; i<=aCount; i++) {
+        (void)SetPropertyVarUint(i);
+        (void)SetPropertyVarInt((TInt)i);
+    }
+}
+
 void ProviderTestBasic::Increment(IDvInvocation& aInvocation, TUint aValue, IDvInvocationResponseUint& aResult)
 {
     aInvocation.StartResponse();
@@ -279,3 +287,8 @@ DvDevice& DeviceBasic::Device()
 {
     return *iDevice;
 }
+
+ProviderTestBasic& DeviceBasic::Provider()
+{
+    return *iTestBasic;
+}
@@ -14,6 +14,7 @@ class ProviderTestBasic : public DvProviderOpenhomeOrgTestBasic1
 {
 public:
     ProviderTestBasic(DvDevice& aDevice);
+    void PropertyStorm(TUint aCount); // sets VarUint then VarInt to 1..aCount without grouping the changes
 private:
     void Increment(IDvInvocation& aInvocation, TUint aValue, IDvInvocationResponseUint& aResult);
     void EchoAllowedRangeUint(IDvInvocation& aInvocation, TUint aValue, IDvInvocationResponseUint& aResult);
@@ -46,6 +47,7 @@ public:
     ~DeviceBasic();
     const Brx& Udn() const;
     DvDevice& Device();
+    ProviderTestBasic& Provider();
 private:
     DvDeviceStandard* iDevice;
     ProviderTestBasic* iTestBasic;
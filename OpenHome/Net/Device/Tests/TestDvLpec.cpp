@@ -38,19 +38,30 @@ private:
 class TestLpec
 {
     static const TUint kTestIterations = 10;
+    static const TUint kPipelinedInvocations = 200;
 public:
     TestLpec(CpStack& aCpStack, Endpoint aLocation, const Brx& aLpecName, Semaphore& aSem);
+    TestLpec(CpStack& aCpStack, const Brx& aLocalPath, const Brx& aLpecName, Semaphore& aSem);
     ~TestLpec();
     void TestActions();
+    void TestPipelinedActions();
     void TestSubscriptions();
 private:
     void DeviceReady();
+    void IncrementComplete(IAsync& aAsync);
+    void EchoStringComplete(IAsync& aAsync);
     void UpdatesComplete();
 private:
     Semaphore& iSem;
     Semaphore iUpdatesComplete;
     CpDevice* iCpDevice;
     CpiDeviceLpec* iCpDeviceLpec;
+    CpProxyOpenhomeOrgTestBasic1* iProxy;
+    Mutex iLock;
+    Semaphore iPipelinedComplete;
+    std::vector<TUint> iPipelinedResults;
+    std::vector<TUint> iPipelinedEchoLengths;
+    TUint iPipelinedErrors;
 };
 
 } // namespace TestDvLpec
@@ -98,10 +109,26 @@ TestLpec::TestLpec(CpStack& aCpStack, Endpoint aLocation, const Brx& aLpecName,
     : iSem(aSem)
     , iUpdatesComplete("SEM2", 0)
     , iCpDevice(NULL)
+    , iProxy(NULL)
+    , iLock("TLPL")
+    , iPipelinedComplete("TLPC", 0)
+    , iPipelinedErrors(0)
 {
     iCpDeviceLpec = new CpiDeviceLpec(aCpStack, aLocation, aLpecName, MakeFunctor(*this, &TestLpec::DeviceReady));
 }
 
+TestLpec::TestLpec(CpStack& aCpStack, const Brx& aLocalPath, const Brx& aLpecName, Semaphore& aSem)
+    : iSem(aSem)
+    , iUpdatesComplete("SEM2", 0)
+    , iCpDevice(NULL)
+    , iProxy(NULL)
+    , iLock("TLPL")
+    , iPipelinedComplete("TLPC", 0)
+    , iPipelinedErrors(0)
+{
+    iCpDeviceLpec = new CpiDeviceLpec(aCpStack, aLocalPath, aLpecName, MakeFunctor(*this, &TestLpec::DeviceReady));
+}
+
 TestLpec::~TestLpec()
 {
     iCpDeviceLpec->Destroy();
@@ -168,6 +195,90 @@ void TestLpec::TestActions()
     delete proxy;
 }
 
+void TestLpec::TestPipelinedActions()
+{
+    /* Begin many invocations at once; they're written to the single LPEC connection
+       without waiting for earlier responses and may execute concurrently on the device.
+       Each must receive its own result.  Mixing actions with different output types and
+       sizes means a response delivered out of order would be detected. */
+    Print("  Pipelined actions...\n");
+    iProxy = new CpProxyOpenhomeOrgTestBasic1(*iCpDevice);
+    iPipelinedResults.clear();
+    iPipelinedEchoLengths.clear();
+    iPipelinedErrors = 0;
+    FunctorAsync incrementCallback = MakeFunctorAsync(*this, &TestLpec::IncrementComplete);
+    FunctorAsync echoCallback = MakeFunctorAsync(*this, &TestLpec::EchoStringComplete);
+    Bwh echo(kPipelinedInvocations);
+    for (TUint i=0; i<kPipelinedInvocations; i++) {
+        iProxy->BeginIncrement(i, incrementCallback);
+        echo.Append((TChar)('a' + (i % 26)));
+        iProxy->BeginEchoString(echo, echoCallback);
+    }
+    for (TUint i=0; i<2*kPipelinedInvocations; i++) {
+        iPipelinedComplete.Wait();
+    }
+    ASSERT(iPipelinedErrors == 0);
+    ASSERT(iPipelinedResults.size() == kPipelinedInvocations);
+    ASSERT(iPipelinedEchoLengths.size() == kPipelinedInvocations);
+    std::vector<TBool> seen(kPipelinedInvocations, false);
+    for (TUint i=0; i<kPipelinedInvocations; i++) {
+        const TUint result = iPipelinedResults[i];
+        ASSERT(result >= 1 && result <= kPipelinedInvocations);
+        ASSERT(!seen[result-1]);
+        seen[result-1] = true;
+    }
+    seen.assign(kPipelinedInvocations, false);
+    for (TUint i=0; i<kPipelinedInvocations; i++) {
+        const TUint len = iPipelinedEchoLengths[i];
+        ASSERT(len >= 1 && len <= kPipelinedInvocations);
+        ASSERT(!seen[len-1]);
+        seen[len-1] = true;
+    }
+    delete iProxy;
+    iProxy = NULL;
+}
+
+void TestLpec::IncrementComplete(IAsync& aAsync)
+{
+    TUint result = 0;
+    try {
+        iProxy->EndIncrement(aAsync, result);
+        AutoMutex a(iLock);
+        iPipelinedResults.push_back(result);
+    }
+    catch (ProxyError&) {
+        AutoMutex a(iLock);
+        iPipelinedErrors++;
+    }
+    iPipelinedComplete.Signal();
+}
+
+void TestLpec::EchoStringComplete(IAsync& aAsync)
+{
+    Brh result;
+    try {
+        iProxy->EndEchoString(aAsync, result);
+        TBool ok = true;
+        for (TUint i=0; i<result.Bytes(); i++) {
+            if (result[i] != 'a' + (i % 26)) {
+                ok = false;
+            }
+        }
+        AutoMutex a(iLock);
+        if (ok) {
+            iPipelinedEchoLengths.push_back(result.Bytes());
+        }
+        else {
+            iPipelinedErrors++;
+        }
+    }
+    catch (ProxyError&) {
+        AutoMutex a(iLock);
+        iPipelinedErrors++;
+    }
+    iPipelinedComplete.Signal();
+}
+
 void TestLpec::TestSubscriptions()
 {
     static const TUint kTimeoutMs = 5 * 1000;
@@ -303,8 +414,21 @@ void TestDvLpec(CpStack& aCpStack, DvStack& aDvStack)
     sem->Wait(5*1000); // allow up to 5 seconds to connect to LPEC server and receive initial ALIVE message
     delete sem;
     cpDevice->TestActions();
+    cpDevice->TestPipelinedActions();
     //cpDevice->TestSubscriptions();
     delete cpDevice;
+
+    const Brx& localPath = aDvStack.Env().InitParams()->LpecLocalSocket();
+    if (localPath.Bytes() > 0) {
+        Print("TestDvLpec - repeating tests over local socket\n");
+        sem = new Semaphore("SEM1", 0);
+        cpDevice = new TestLpec(aCpStack, localPath, device->LpecDeviceName(), *sem);
+        sem->Wait(5*1000);
+        delete sem;
+        cpDevice->TestActions();
+        cpDevice->TestPipelinedActions();
+        delete cpDevice;
+    }
     delete device;
 
     Print("TestDvLpec - completed\n");
@@ -15,6 +15,9 @@ void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], N
 {
     aInitParams->SetDvNumLpecThreads(2);
     aInitParams->SetDvLpecServerPort(2324);
+#ifndef _WIN32
+    aInitParams->SetLpecLocalSocket(Brn("/tmp/ohNetTestDvLpec.sock"));
+#endif
     Library* lib = new Library(aInitParams);
     std::vector<NetworkAdapter*>* subnetList = lib->CreateSubnetList();
     TIpAddress subnet = (*subnetList)[0]->Subnet();
@@ -11,6 +11,8 @@
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Net/Private/DviStack.h>
+#include <OpenHome/Private/Metrics.h>
+#include <OpenHome/OsWrapper.h>
 
 #include <vector>
 
@@ -27,6 +29,8 @@ public:
     CpDevices(Semaphore& aAddedSem, const Brx& aTargetUdn);
     ~CpDevices();
     void Test();
+    void TestPropertyStorm(ProviderTestBasic& aProvider, Environment& aEnv);
+    void TestModeration(ProviderTestBasic& aProvider, Environment& aEnv);
     void Added(CpDevice& aDevice);
     void Removed(CpDevice& aDevice);
 private:
@@ -169,6 +173,98 @@ void CpDevices::Test()
     delete proxy; // automatically unsubscribes
 }
 
+void CpDevices::TestPropertyStorm(ProviderTestBasic& aProvider, Environment& aEnv)
+{
+    static const TUint kStormCount = 500;
+    ASSERT(iList.size() == 1);
+    CpProxyOpenhomeOrgTestBasic1* proxy = new CpProxyOpenhomeOrgTestBasic1(*(iList[0]));
+    Functor functor = MakeFunctor(*this, &CpDevices::UpdatesComplete);
+    proxy->SetPropertyChanged(functor);
+    proxy->Subscribe();
+    iUpdatesComplete.Wait(); // wait for initial event
+
+    MetricsRegistry& metrics = aEnv.Metrics();
+    MetricCounter& requests = metrics.Counter("ohnet_dv_publish_requests_total", "");
+    MetricCounter& coalesced = metrics.Counter("ohnet_dv_publish_coalesced_total", "");
+    MetricCounter& publishes = metrics.Counter("ohnet_dv_publishes_total", "");
+    const TUint64 requestsStart = requests.Value();
+    const TUint64 coalescedStart = coalesced.Value();
+    const TUint64 publishesStart = publishes.Value();
+    const TUint startMs = Os::TimeInMs(aEnv.OsCtx());
+
+    aProvider.PropertyStorm(kStormCount);
+    for (;;) {
+        TUint propUint;
+        TInt propInt;
+        proxy->PropertyVarUint(propUint);
+        proxy->PropertyVarInt(propInt);
+        if (propUint == kStormCount && propInt == (TInt)kStormCount) {
+            break;
+        }
+        iUpdatesComplete.Wait();
+    }
+    const TUint elapsedMs = Os::TimeInMs(aEnv.OsCtx()) - startMs;
+    const TUint numRequests = (TUint)(requests.Value() - requestsStart);
+    const TUint numCoalesced = (TUint)(coalesced.Value() - coalescedStart);
+    const TUint numPublishes = (TUint)(publishes.Value() - publishesStart);
+    Print("  Storm of %u property changes: %u publish requests, %u coalesced, %u publishes in %ums\n",
+          2*kStormCount, numRequests, numCoalesced, numPublishes, elapsedMs);
+    ASSERT(numRequests == 2*kStormCount);
+    // +1: a publish from before the storm may be counted after its event reached us
+    ASSERT(numPublishes <= numRequests - numCoalesced + 1);
+    ASSERT(numPublishes < kStormCount);
+
+    delete proxy;
+}
+
+void CpDevices::TestModeration(ProviderTestBasic& aProvider, Environment& aEnv)
+{
+    static const TUint kModerationMs = 2000; // much longer than the SyncSetUint() loop below takes
+    static const TUint kChangeCount = 20;
+    ASSERT(iList.size() == 1);
+    aProvider.SetPropertyModeration("VarUint", kModerationMs);
+    CpProxyOpenhomeOrgTestBasic1* proxy = new CpProxyOpenhomeOrgTestBasic1(*(iList[0]));
+    proxy->SyncSetUint(0);
+    proxy->SyncSetInt(0);
+    Functor functor = MakeFunctor(*this, &CpDevices::UpdatesComplete);
+    proxy->SetPropertyChanged(functor);
+    proxy->Subscribe();
+    iUpdatesComplete.Wait(); // wait for initial event
+
+    const TUint startMs = Os::TimeInMs(aEnv.OsCtx());
+    for (TUint i=1; i<=kChangeCount; i++) {
+        proxy->SyncSetUint(i);
+    }
+    // an unmoderated property should still be evented straight away
+    proxy->SyncSetInt(7);
+    TUint numEvents = 0;
+    TInt propInt = 0;
+    while (propInt != 7) {
+        iUpdatesComplete.Wait();
+        numEvents++;
+        proxy->PropertyVarInt(propInt);
+    }
+    TUint propUint;
+    proxy->PropertyVarUint(propUint);
+    const TUint uintAtIntEvent = propUint;
+    const TUint intMs = Os::TimeInMs(aEnv.OsCtx()) - startMs;
+    while (propUint != kChangeCount) {
+        iUpdatesComplete.Wait();
+        numEvents++;
+        proxy->PropertyVarUint(propUint);
+    }
+    const TUint elapsedMs = Os::TimeInMs(aEnv.OsCtx()) - startMs;
+    Print("  %u changes to a property moderated to %ums: %u events in %ums (unmoderated change after %ums)\n",
+          kChangeCount, kModerationMs, numEvents, elapsedMs, intMs);
+    // one event per moderation interval for VarUint plus (at most) one for VarInt
+    ASSERT(numEvents <= elapsedMs/kModerationMs + 2);
+    // the last VarUint change was still held back when VarInt was evented
+    ASSERT(uintAtIntEvent != kChangeCount);
+
+    delete proxy;
+    aProvider.SetPropertyModeration("VarUint", 0);
+}
+
 void CpDevices::Added(CpDevice& aDevice)
 {
     iLock.Wait();
@@ -214,6 +310,10 @@ void TestDvSubscription(CpStack& aCpStack, DvStack& aDvStack)
         Print(" loop #%u\n", i);
         deviceList->Test();
     }
+    Print(" property storm\n");
+    deviceList->TestPropertyStorm(device->Provider(), env);
+    Print(" property moderation\n");
+    deviceList->TestModeration(device->Provider(), env);
     delete list;
     delete deviceList;
     delete device;
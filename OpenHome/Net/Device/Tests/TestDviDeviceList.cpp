@@ -10,6 +10,10 @@
 #include <OpenHome/Net/Core/CpDevice.h>
 #include <OpenHome/Net/Core/CpDeviceUpnp.h>
 #include <OpenHome/Private/NetworkAdapterList.h>
+#include <OpenHome/Net/Private/CpiStack.h>
+#include <OpenHome/Net/Private/CpiDeviceCacheUpnp.h>
+#include <OpenHome/Private/File.h>
+#include <OpenHome/OsWrapper.h>
 
 #include <stdlib.h>
 #include <time.h>
@@ -255,6 +259,40 @@ void TestDviDeviceList(CpStack& aCpStack, DvStack& aDvStack)
     deviceList->Validate(udns);
     udns.clear();
     delete list;
+    deviceList->Clear();
+
+    CpiDeviceCacheUpnp* cache = aCpStack.DeviceCacheUpnp();
+    if (cache != NULL) {
+        Print("Check device cache\n");
+        const Brx& path = aCpStack.Env().InitParams()->CpDeviceCache();
+        Brh xml;
+        ASSERT(cache->Count() >= 3);
+        cache->Flush();
+        FileSystemAnsi fileSystem;
+        CpiDeviceCacheUpnp* reloaded = new CpiDeviceCacheUpnp(aCpStack.Env(), fileSystem, path);
+        ASSERT(reloaded->Count() == cache->Count());
+        std::vector<CpiDeviceCacheUpnp::Entry*> entries;
+        cache->CopyEntries(entries);
+        for (TUint i=0; i<(TUint)entries.size(); i++) {
+            ASSERT(reloaded->TryGetXml(entries[i]->Udn(), entries[i]->Location(), xml));
+            ASSERT(xml == entries[i]->Xml());
+            ASSERT(!reloaded->TryGetXml(entries[i]->Udn(), Brn("http://127.0.0.1:1/nowhere"), xml));
+            delete entries[i];
+        }
+        delete reloaded;
+
+        Print("Warm start from device cache\n");
+        serviceType.Set("service1");
+        const TUint64 start = Os::TimeInUs(aCpStack.Env().OsCtx());
+        list = new CpDeviceListUpnpServiceType(aCpStack, domainName, serviceType, ver, added, removed);
+        udns.push_back((const char*)gNameDevice1.Ptr());
+        udns.push_back((const char*)gNameDevice2.Ptr());
+        deviceList->Validate(udns);
+        const TUint64 elapsedUs = Os::TimeInUs(aCpStack.Env().OsCtx()) - start;
+        Print("    devices reported after %llu us\n", elapsedUs);
+        udns.clear();
+        delete list;
+    }
 
     delete deviceList;
     delete devices;
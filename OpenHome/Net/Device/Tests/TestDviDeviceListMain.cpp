@@ -5,6 +5,7 @@
 #include <OpenHome/Net/Private/DviStack.h>
 
 #include <vector>
+#include <stdio.h>
 
 using namespace OpenHome;
 using namespace OpenHome::Net;
@@ -23,6 +24,9 @@ void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::Init
         aInitParams->SetUseLoopbackNetworkAdapter();
     }
     aInitParams->SetDvUpnpServerPort(0);
+    const TChar* kCachePath = "/tmp/ohNetTestDviDeviceList.cache";
+    (void)remove(kCachePath); // udns are randomised so entries from earlier runs would never be reported
+    aInitParams->SetCpDeviceCache(Brn(kCachePath));
     Library* lib = new Library(aInitParams);
     std::vector<NetworkAdapter*>* subnetList = lib->CreateSubnetList();
     TIpAddress subnet = (*subnetList)[0]->Subnet();
@@ -7,6 +7,7 @@
 #include <OpenHome/Net/Private/DviService.h>
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Net/Private/DviStack.h>
+#include <OpenHome/Net/Private/DviSsdpNotifier.h>
 #include <OpenHome/Private/NetworkAdapterList.h>
 #include <OpenHome/Private/Standard.h>
 
@@ -52,6 +53,7 @@ public:
     TUint DeviceCount() const { return iDevice; }
     TUint ServiceCount() const { return iService; }
     TUint Udns() const; // bitmask for SuiteMsearch::kNameDevice1 etc
+    TUint Device1Messages() const { return iDevice1; }
     const TChar* Dev1Type() const { return iDev1Type; }
     const TChar* Dev2Type() const { return iDev2Type; }
     const TChar* Dev21Type() const { return iDev21Type; }
@@ -77,6 +79,7 @@ private:
     TUint iDevice;
     TUint iService;
     TUint iUdnsReceived;
+    TUint iDevice1;
 
     TChar* iDev1Type;
     TChar* iDev2Type;
@@ -117,6 +120,8 @@ private:
     void TestMsearchUuid();
     void TestMsearchDeviceType();
     void TestMsearchServiceType();
+    void TestMsearchRepeated();
+    void TestMsearchStop();
 private:
     DvStack& iDvStack;
     DviDevice* iDevices[2];
@@ -254,6 +259,14 @@ void SuiteAlive::Test()
     SsdpListenerMulticast* listenerMulticast = new SsdpListenerMulticast(env, nif->Address());
     nif->RemoveRef(kAdapterCookie);
     TInt listenerId = listenerMulticast->AddNotifyHandler(listener);
+    CpListenerBasic* listenerUuid = new CpListenerBasic;
+    TInt listenerUuidId = listenerMulticast->AddNotifyHandler(listenerUuid, SsdpNotifyFilter(eSsdpUuid, gNameDevice1));
+    CpListenerBasic* listenerDevice = new CpListenerBasic;
+    TInt listenerDeviceId = listenerMulticast->AddNotifyHandler(listenerDevice, SsdpNotifyFilter(eSsdpDeviceType, Brn("a.b.c"), Brn("type1")));
+    CpListenerBasic* listenerService = new CpListenerBasic;
+    TInt listenerServiceId = listenerMulticast->AddNotifyHandler(listenerService, SsdpNotifyFilter(eSsdpServiceType, Brn("a.b.c"), Brn("service2")));
+    CpListenerBasic* listenerOther = new CpListenerBasic;
+    TInt listenerOtherId = listenerMulticast->AddNotifyHandler(listenerOther, SsdpNotifyFilter(eSsdpServiceType, Brn("a.b.c"), Brn("service3")));
     listenerMulticast->Start();
     DviDevice* device = new DviDeviceStandard(iDvStack, gNameDevice1);
     device->SetAttribute("Upnp.Domain", "a.b.c");
@@ -298,8 +311,27 @@ void SuiteAlive::Test()
     TEST(listener->TotalAlives() % 5 == 0);
 
     device->Destroy();
+    blocker->Wait(1);
+    // filtered handlers only see notifications matching their filter (1 of every 5 for a device or service type)
+    TEST(listenerUuid->TotalAlives() == listener->TotalAlives());
+    TEST(listenerUuid->TotalByeByes() == listener->TotalByeByes());
+    TEST(listenerDevice->TotalAlives() * 5 == listener->TotalAlives());
+    TEST(listenerDevice->TotalByeByes() * 5 == listener->TotalByeByes());
+    TEST(listenerService->TotalAlives() * 5 == listener->TotalAlives());
+    TEST(listenerService->TotalByeByes() * 5 == listener->TotalByeByes());
+    TEST(listenerOther->TotalAlives() == 0);
+    TEST(listenerOther->TotalByeByes() == 0);
+
+    listenerMulticast->RemoveNotifyHandler(listenerOtherId);
+    listenerMulticast->RemoveNotifyHandler(listenerServiceId);
+    listenerMulticast->RemoveNotifyHandler(listenerDeviceId);
+    listenerMulticast->RemoveNotifyHandler(listenerUuidId);
     listenerMulticast->RemoveNotifyHandler(listenerId);
     delete listenerMulticast;
+    delete listenerOther;
+    delete listenerService;
+    delete listenerDevice;
+    delete listenerUuid;
     delete listener;
     delete blocker;
 }
@@ -339,6 +371,7 @@ void CpListenerMsearch::Reset()
     iDevice = 0;
     iService = 0;
     iUdnsReceived = 0;
+    iDevice1 = 0;
     
     free(iDev1Type);
     iDev1Type = NULL;
@@ -384,6 +417,7 @@ TBool CpListenerMsearch::LogUdn(const Brx& aUuid, const Brx& aLocation)
 
     if (aUuid == SuiteMsearch::gNameDevice1){
         iUdnsReceived |= 1;
+        iDevice1++;
     }
     else if (aUuid == SuiteMsearch::gNameDevice2){
         iUdnsReceived |= 2;
@@ -570,6 +604,8 @@ void SuiteMsearch::Test()
     TestMsearchUuid();
     TestMsearchDeviceType();
     TestMsearchServiceType();
+    TestMsearchRepeated();
+    TestMsearchStop(); // last - also stops device 1's announcements
 }
 
 void SuiteMsearch::Wait()
@@ -739,6 +775,49 @@ void SuiteMsearch::TestMsearchServiceType()
     TEST(0 == strcmp(iListener->Services()[0], "openhome.org:service5:1"));
 }
 
+void SuiteMsearch::TestMsearchRepeated()
+{
+    // a search repeated within MX of the first gets a single set of responses
+    iListener->Reset();
+    iListenerUnicast->MsearchAll();
+    iListenerUnicast->MsearchAll();
+    Wait();
+    if (iListener->TotalMessages() != 16) {
+        Print("MsearchRepeated: received %u responses (expected 16)\n", iListener->TotalMessages());
+    }
+    TEST(iListener->TotalMessages() == 16);
+    TEST(iListener->Udns() == 7);
+
+    // ...but a search repeated after the first has been answered gets another
+    iListener->Reset();
+    iListenerUnicast->MsearchRoot();
+    Wait();
+    TEST(iListener->TotalMessages() == 2);
+}
+
+void SuiteMsearch::TestMsearchStop()
+{
+    // device 1 sends 6 responses to ssdp:all, each at a random time within MX
+    static const TUint kDevice1Responses = 6;
+    iListener->Reset();
+    iListenerUnicast->MsearchAll();
+    // wait for the first response so that we know the search has been scheduled
+    const TUint timeoutMs = (iDvStack.Env().InitParams()->MsearchTimeSecs() + 1) * 1000;
+    TUint waitedMs = 0;
+    while (iListener->TotalMessages() == 0 && waitedMs < timeoutMs) {
+        Thread::Sleep(10);
+        waitedMs += 10;
+    }
+    TEST(iListener->TotalMessages() > 0);
+    iDvStack.SsdpNotifierManager().Stop(gNameDevice1);
+    const TUint device1AtStop = iListener->Device1Messages();
+    Wait();
+    Print("MsearchStop: %u of %u responses from device 1 sent before Stop(), %u after\n",
+          device1AtStop, kDevice1Responses, iListener->Device1Messages() - device1AtStop);
+    TEST(iListener->Device1Messages() < kDevice1Responses);
+    TEST(iListener->TotalMessages() - iListener->Device1Messages() == 10); // device 2's responses are unaffected
+}
+
 
 void TestDviDiscovery(DvStack& aDvStack)
 {
@@ -0,0 +1,140 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Net/Private/DviPropertyUpdateCollection.h>
+#include <OpenHome/Net/Private/DviServerWebSocket.h>
+#include <OpenHome/Net/Private/Service.h>
+#include <OpenHome/Net/Private/XmlParser.h>
+#include <OpenHome/Private/Stream.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::Net;
+using namespace OpenHome::TestFramework;
+
+class SuitePropertyValueLog : public Suite, private IPropertyUpdateMerger
+{
+public:
+    SuitePropertyValueLog() : Suite("Shared property values for long-poll and WebSocket clients") {}
+    void Test();
+private:
+    PropertyUpdate* Publish(PropertyValueLog& aLog, const Brx& aSid, TUint aSeqNum, Property& aProperty);
+private: // from IPropertyUpdateMerger
+    PropertyUpdate* MergeUpdate(PropertyUpdate* aUpdate);
+    void ReleaseLog(PropertyValueLog& aLog);
+private:
+    PropertyUpdate* iMerged;
+};
+
+PropertyUpdate* SuitePropertyValueLog::Publish(PropertyValueLog& aLog, const Brx& aSid, TUint aSeqNum, Property& aProperty)
+{
+    PropertyWriter2* writer = new PropertyWriter2(*this, aLog, aSid, aSeqNum);
+    IPropertyWriter& propertyWriter = *writer;
+    aProperty.Write(propertyWriter);
+    propertyWriter.PropertyWriteEnd();
+    delete writer;
+    PropertyUpdate* update = iMerged;
+    iMerged = NULL;
+    return update;
+}
+
+PropertyUpdate* SuitePropertyValueLog::MergeUpdate(PropertyUpdate* aUpdate)
+{
+    iMerged = aUpdate;
+    return NULL;
+}
+
+void SuitePropertyValueLog::ReleaseLog(PropertyValueLog& /*aLog*/)
+{
+}
+
+void SuitePropertyValueLog::Test()
+{
+    iMerged = NULL;
+    PropertyString* propA = new PropertyString(new ParameterString("A"));
+    PropertyUint* propB = new PropertyUint(new ParameterUint("B"));
+    (void)propA->SetValue(Brn("1<2"));
+    (void)propB->SetValue(7);
+    std::vector<Property*> properties;
+    properties.push_back(propA);
+    properties.push_back(propB);
+    PropertyValueLog* log = new PropertyValueLog(properties);
+
+    // nothing is held until a subscription publishes a value
+    TUint seqNum;
+    TEST(log->Find(Brn("A"), seqNum) == NULL);
+    TEST(seqNum == propA->SequenceNumber());
+
+    // the first subscription to publish a value serialises it...
+    PropertyUpdate* update1 = Publish(*log, Brn("uuid:sid1"), 1, *propA);
+    PropertyValue* a1 = log->Find(Brn("A"), seqNum);
+    TEST(a1 != NULL);
+    TEST(a1->Name() == Brn("A"));
+    TEST(a1->Value() == Brn("1&lt;2"));
+    TEST(a1->Element() == Brn("<e:property><A>1&lt;2</A></e:property>"));
+
+    // ...and other subscriptions share it without encoding it again
+    PropertyValue* a1Again = log->Intern(Brn("A"), seqNum, Brn("not re-encoded"));
+    TEST(a1Again == a1);
+    a1Again->RemoveRef();
+    PropertyUpdate* update2 = Publish(*log, Brn("uuid:sid2"), 1, *propA);
+    a1Again = log->Find(Brn("A"), seqNum);
+    TEST(a1Again == a1);
+    a1Again->RemoveRef();
+
+    // a change to the property evicts the old value; holders of the old value keep a valid copy
+    (void)propA->SetValue(Brn("3"));
+    TEST(log->Find(Brn("A"), seqNum) == NULL);
+    TEST(seqNum == propA->SequenceNumber());
+    PropertyUpdate* update3 = Publish(*log, Brn("uuid:sid1"), 2, *propA);
+    PropertyValue* a3 = log->Find(Brn("A"), seqNum);
+    TEST(a3 != a1);
+    TEST(a3->Value() == Brn("3"));
+    TEST(a1->Value() == Brn("1&lt;2"));
+    a1->RemoveRef();
+    WriterBwh writer(1024);
+    update2->Write(writer);
+    TEST(XmlParserBasic::Find("A", writer.Buffer()) == Brn("1&lt;2"));
+    delete update2;
+
+    // a merged update reports the latest sequence number and the latest value of each property
+    PropertyUpdate* update4 = Publish(*log, Brn("uuid:sid1"), 3, *propB);
+    update1->Merge(*update3);
+    update1->Merge(*update4);
+    delete update3;
+    delete update4;
+    TEST(update1->SeqNum() == 3);
+    writer.Reset();
+    update1->Write(writer);
+    delete update1;
+    const Brx& xml = writer.Buffer();
+    TEST(XmlParserBasic::Find(WebSocket::kTagSid, xml) == Brn("uuid:sid1"));
+    TEST(XmlParserBasic::Find(WebSocket::kTagSeq, xml) == Brn("3"));
+    TEST(XmlParserBasic::Find("A", xml) == Brn("3"));
+    TEST(XmlParserBasic::Find("B", xml) == Brn("7"));
+    Brn remaining, superseded;
+    (void)XmlParserBasic::Find("A", xml, remaining);
+    TEST(!XmlParserBasic::TryFind("A", remaining, superseded)); // the superseded value isn't also sent
+    a3->RemoveRef();
+
+    // values of unknown properties are serialised each time and not held
+    TEST(log->Find(Brn("C"), seqNum) == NULL);
+    TEST(seqNum == 0);
+    PropertyValue* c1 = log->Intern(Brn("C"), seqNum, Brn("x"));
+    PropertyValue* c2 = log->Intern(Brn("C"), seqNum, Brn("x"));
+    TEST(c1 != c2);
+    TEST(c1->Element() == c2->Element());
+    c1->RemoveRef();
+    c2->RemoveRef();
+
+    delete log;
+    delete propB;
+    delete propA;
+}
+
+
+void TestDviPropertyUpdates()
+{
+    Runner runner("Property updates for long-poll and WebSocket clients\n");
+    runner.Add(new SuitePropertyValueLog());
+    runner.Run();
+}
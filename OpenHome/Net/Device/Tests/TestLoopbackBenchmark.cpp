@@ -0,0 +1,575 @@
+#include <OpenHome/Private/TestFramework.h>
+#include "TestBasicDv.h"
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Net/Core/DvDevice.h>
+#include <OpenHome/Net/Core/CpOpenhomeOrgTestBasic1.h>
+#include <OpenHome/Net/Core/OhNet.h>
+#include <OpenHome/Net/Core/CpDevice.h>
+#include <OpenHome/Net/Core/CpDeviceUpnp.h>
+#include <OpenHome/Net/Core/FunctorAsync.h>
+#include <OpenHome/Net/Private/DviStack.h>
+#include <OpenHome/Net/Private/CpiStack.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/File.h>
+#include <OpenHome/OsWrapper.h>
+
+#include <vector>
+#include <algorithm>
+
+using namespace OpenHome;
+using namespace OpenHome::Net;
+using namespace OpenHome::TestFramework;
+
+/*
+ * End-to-end benchmark over the loopback adapter.
+ *
+ * DeviceBasic (DvProviderOpenhomeOrgTestBasic1) is published by the device stack and driven
+ * via UPnP by CpProxyOpenhomeOrgTestBasic1 from the control point stack in the same process.
+ * Each scenario reports throughput plus p50/p99/p999 latency; results are written as a
+ * single JSON document so runs can be compared between releases.
+ *
+ * Each 'control point' is a separate proxy on its own thread.  All share one CpStack so
+ * concurrency is also bounded by InitialisationParams::NumActionInvokerThreads().
+ */
+
+namespace OpenHome {
+namespace TestLoopbackBenchmark {
+
+class Samples
+{
+public:
+    Samples();
+    void Add(TUint aUs);
+    void Append(const Samples& aSamples);
+    TUint Count() const;
+    TUint Percentile(TUint aPerMille); // sorts samples
+private:
+    std::vector<TUint> iUs;
+    TBool iSorted;
+};
+
+class Results : private INonCopyable
+{
+public:
+    Results(TUint aDurationMs);
+    void Add(const TChar* aScenario, TUint aControlPoints, TUint aSubscribers, TUint aArgBytes,
+             TUint aElapsedMs, TUint aErrors, Samples& aSamples);
+    void WriteJson(IWriter& aWriter);
+private:
+    void WriteUint(const TChar* aKey, TUint aValue);
+private:
+    WriterBwh iWriter;
+    TUint iDurationMs;
+    TUint iCount;
+};
+
+class ActionClient : private INonCopyable
+{
+public:
+    enum EAction
+    {
+        eIncrement
+       ,eEchoString
+       ,eEchoBinary
+    };
+public:
+    ActionClient(Environment& aEnv, CpDevice& aDevice, EAction aAction, const Brx& aArg, Semaphore& aDone);
+    ~ActionClient();
+    void Start(TUint64 aStopTimeUs);
+    Samples& Latencies();
+    TUint Errors() const;
+private:
+    void Run();
+private:
+    Environment& iEnv;
+    CpProxyOpenhomeOrgTestBasic1* iProxy;
+    EAction iAction;
+    Brn iArg;
+    Semaphore& iDone;
+    ThreadFunctor* iThread;
+    TUint64 iStopTimeUs;
+    Samples iSamples;
+    TUint iErrors;
+};
+
+class EventRound : private INonCopyable
+{
+public:
+    EventRound(Environment& aEnv);
+    void Begin(TUint aTarget);
+    void Observe(TUint aValue, TUint& aLastSeen);
+    void SetLastSeen(TUint aValue, TUint& aLastSeen);
+    void Wait(TUint aTimeoutMs);
+    Samples& Latencies();
+private:
+    Environment& iEnv;
+    Mutex iLock;
+    Semaphore iComplete;
+    TUint iTarget;
+    TUint64 iStartUs;
+    Samples iSamples;
+};
+
+class Subscriber : private INonCopyable
+{
+public:
+    Subscriber(CpDevice& aDevice, EventRound& aRound);
+    ~Subscriber();
+private:
+    void Initial();
+    void VarUintChanged();
+private:
+    CpProxyOpenhomeOrgTestBasic1* iProxy;
+    EventRound& iRound;
+    Semaphore iInitial;
+    TUint iLastSeen;
+};
+
+class Benchmark : private INonCopyable
+{
+    static const TUint kDeviceFoundTimeoutMs = 30 * 1000;
+    static const TUint kEventTimeoutMs = 5 * 1000;
+public:
+    Benchmark(CpStack& aCpStack, DvStack& aDvStack, TUint aDurationMs, TUint aMaxControlPoints, TUint aMaxSubscribers);
+    ~Benchmark();
+    TBool Run(); // returns false if the device under test wasn't found
+    void WriteJson(IWriter& aWriter);
+private:
+    void Added(CpDevice& aDevice);
+    void Removed(CpDevice& aDevice);
+    void RunActions(const TChar* aScenario, ActionClient::EAction aAction, TUint aControlPoints, TUint aArgBytes);
+    void RunEvents(TUint aSubscribers);
+private:
+    CpStack& iCpStack;
+    Environment& iEnv;
+    DeviceBasic* iDvDevice;
+    CpDevice* iCpDevice;
+    Mutex iLock;
+    Semaphore iAdded;
+    TUint iDurationMs;
+    TUint iMaxControlPoints;
+    TUint iMaxSubscribers;
+    Results iResults;
+};
+
+} // namespace TestLoopbackBenchmark
+} // namespace OpenHome
+
+using namespace OpenHome::TestLoopbackBenchmark;
+
+
+// Samples
+
+Samples::Samples()
+    : iSorted(true)
+{
+}
+
+void Samples::Add(TUint aUs)
+{
+    iUs.push_back(aUs);
+    iSorted = false;
+}
+
+void Samples::Append(const Samples& aSamples)
+{
+    iUs.insert(iUs.end(), aSamples.iUs.begin(), aSamples.iUs.end());
+    iSorted = false;
+}
+
+TUint Samples::Count() const
+{
+    return (TUint)iUs.size();
+}
+
+TUint Samples::Percentile(TUint aPerMille)
+{
+    if (iUs.size() == 0) {
+        return 0;
+    }
+    if (!iSorted) {
+        std::sort(iUs.begin(), iUs.end());
+        iSorted = true;
+    }
+    // nearest-rank
+    TUint64 rank = ((TUint64)aPerMille * iUs.size() + 999) / 1000;
+    if (rank == 0) {
+        rank = 1;
+    }
+    return iUs[(size_t)(rank - 1)];
+}
+
+
+// Results
+
+Results::Results(TUint aDurationMs)
+    : iWriter(1024)
+    , iDurationMs(aDurationMs)
+    , iCount(0)
+{
+}
+
+void Results::Add(const TChar* aScenario, TUint aControlPoints, TUint aSubscribers, TUint aArgBytes,
+                  TUint aElapsedMs, TUint aErrors, Samples& aSamples)
+{
+    const TUint count = aSamples.Count();
+    const TUint opsPerSec = (aElapsedMs == 0? 0 : (TUint)(((TUint64)count * 1000) / aElapsedMs));
+    Print("  %-12s cps=%-2u subs=%-2u bytes=%-5u: %7u ops/s  p50=%uus p99=%uus p999=%uus\n",
+          aScenario, aControlPoints, aSubscribers, aArgBytes, opsPerSec,
+          aSamples.Percentile(500), aSamples.Percentile(990), aSamples.Percentile(999));
+
+    iWriter.Write((iCount++ == 0)? "\n    {" : ",\n    {");
+    iWriter.Write("\"scenario\": \"");
+    iWriter.Write(aScenario);
+    iWriter.Write("\"");
+    WriteUint("controlPoints", aControlPoints);
+    WriteUint("subscribers", aSubscribers);
+    WriteUint("argBytes", aArgBytes);
+    WriteUint("count", count);
+    WriteUint("errors", aErrors);
+    WriteUint("elapsedMs", aElapsedMs);
+    WriteUint("opsPerSec", opsPerSec);
+    WriteUint("p50Us", aSamples.Percentile(500));
+    WriteUint("p99Us", aSamples.Percentile(990));
+    WriteUint("p999Us", aSamples.Percentile(999));
+    iWriter.Write("}");
+}
+
+void Results::WriteUint(const TChar* aKey, TUint aValue)
+{
+    iWriter.Write(", \"");
+    iWriter.Write(aKey);
+    iWriter.Write("\": ");
+    Ascii::StreamWriteUint(iWriter, aValue);
+}
+
+void Results::WriteJson(IWriter& aWriter)
+{
+    aWriter.Write(Brn("{\n  \"benchmark\": \"TestLoopbackBenchmark\",\n  \"durationMs\": "));
+    Ascii::StreamWriteUint(aWriter, iDurationMs);
+    aWriter.Write(Brn(",\n  \"results\": ["));
+    aWriter.Write(iWriter.Buffer());
+    aWriter.Write(Brn("\n  ]\n}\n"));
+}
+
+
+// ActionClient
+
+ActionClient::ActionClient(Environment& aEnv, CpDevice& aDevice, EAction aAction, const Brx& aArg, Semaphore& aDone)
+    : iEnv(aEnv)
+    , iAction(aAction)
+    , iArg(aArg)
+    , iDone(aDone)
+    , iStopTimeUs(0)
+    , iErrors(0)
+{
+    iProxy = new CpProxyOpenhomeOrgTestBasic1(aDevice);
+    iThread = new ThreadFunctor("BenchClient", MakeFunctor(*this, &ActionClient::Run));
+}
+
+ActionClient::~ActionClient()
+{
+    delete iThread;
+    delete iProxy;
+}
+
+void ActionClient::Start(TUint64 aStopTimeUs)
+{
+    iStopTimeUs = aStopTimeUs;
+    iThread->Start();
+}
+
+Samples& ActionClient::Latencies()
+{
+    return iSamples;
+}
+
+TUint ActionClient::Errors() const
+{
+    return iErrors;
+}
+
+void ActionClient::Run()
+{
+    TUint valUint = 0;
+    Brh result;
+    for (;;) {
+        const TUint64 start = Os::TimeInUs(iEnv.OsCtx());
+        if (start >= iStopTimeUs) {
+            break;
+        }
+        try {
+            switch (iAction)
+            {
+            case eIncrement:
+                iProxy->SyncIncrement(valUint, valUint);
+                break;
+            case eEchoString:
+                iProxy->SyncEchoString(iArg, result);
+                break;
+            case eEchoBinary:
+                iProxy->SyncEchoBinary(iArg, result);
+                break;
+            }
+            iSamples.Add((TUint)(Os::TimeInUs(iEnv.OsCtx()) - start));
+        }
+        catch (ProxyError&) {
+            iErrors++;
+        }
+    }
+    iDone.Signal();
+}
+
+
+// EventRound
+
+EventRound::EventRound(Environment& aEnv)
+    : iEnv(aEnv)
+    , iLock("BNER")
+    , iComplete("BNEC", 0)
+    , iTarget(0)
+    , iStartUs(0)
+{
+}
+
+void EventRound::Begin(TUint aTarget)
+{
+    AutoMutex _(iLock);
+    (void)iComplete.Clear();
+    iTarget = aTarget;
+    iStartUs = Os::TimeInUs(iEnv.OsCtx());
+}
+
+void EventRound::Observe(TUint aValue, TUint& aLastSeen)
+{
+    AutoMutex _(iLock);
+    if (aValue == iTarget && aLastSeen != iTarget) {
+        aLastSeen = aValue;
+        iSamples.Add((TUint)(Os::TimeInUs(iEnv.OsCtx()) - iStartUs));
+        iComplete.Signal();
+    }
+}
+
+void EventRound::SetLastSeen(TUint aValue, TUint& aLastSeen)
+{
+    AutoMutex _(iLock);
+    aLastSeen = aValue;
+}
+
+void EventRound::Wait(TUint aTimeoutMs)
+{
+    iComplete.Wait(aTimeoutMs);
+}
+
+Samples& EventRound::Latencies()
+{
+    return iSamples;
+}
+
+
+// Subscriber
+
+Subscriber::Subscriber(CpDevice& aDevice, EventRound& aRound)
+    : iRound(aRound)
+    , iInitial("BNSI", 0)
+    , iLastSeen(0)
+{
+    iProxy = new CpProxyOpenhomeOrgTestBasic1(aDevice);
+    Functor initial = MakeFunctor(*this, &Subscriber::Initial);
+    iProxy->SetPropertyInitialEvent(initial);
+    Functor changed = MakeFunctor(*this, &Subscriber::VarUintChanged);
+    iProxy->SetPropertyVarUintChanged(changed);
+    iProxy->Subscribe();
+    iInitial.Wait();
+}
+
+Subscriber::~Subscriber()
+{
+    delete iProxy;
+}
+
+void Subscriber::Initial()
+{
+    TUint val;
+    iProxy->PropertyVarUint(val);
+    iRound.SetLastSeen(val, iLastSeen);
+    iInitial.Signal();
+}
+
+void Subscriber::VarUintChanged()
+{
+    TUint val;
+    iProxy->PropertyVarUint(val);
+    iRound.Observe(val, iLastSeen);
+}
+
+
+// Benchmark
+
+Benchmark::Benchmark(CpStack& aCpStack, DvStack& aDvStack, TUint aDurationMs, TUint aMaxControlPoints, TUint aMaxSubscribers)
+    : iCpStack(aCpStack)
+    , iEnv(aCpStack.Env())
+    , iCpDevice(NULL)
+    , iLock("BNCH")
+    , iAdded("BNAD", 0)
+    , iDurationMs(aDurationMs)
+    , iMaxControlPoints(aMaxControlPoints)
+    , iMaxSubscribers(aMaxSubscribers)
+    , iResults(aDurationMs)
+{
+    iDvDevice = new DeviceBasic(aDvStack);
+}
+
+Benchmark::~Benchmark()
+{
+    if (iCpDevice != NULL) {
+        iCpDevice->RemoveRef();
+    }
+    delete iDvDevice;
+}
+
+void Benchmark::Added(CpDevice& aDevice)
+{
+    AutoMutex _(iLock);
+    if (iCpDevice == NULL && aDevice.Udn() == iDvDevice->Udn()) {
+        iCpDevice = &aDevice;
+        iCpDevice->AddRef();
+        iAdded.Signal();
+    }
+}
+
+void Benchmark::Removed(CpDevice& /*aDevice*/)
+{
+}
+
+TBool Benchmark::Run()
+{
+    FunctorCpDevice added = MakeFunctorCpDevice(*this, &Benchmark::Added);
+    FunctorCpDevice removed = MakeFunctorCpDevice(*this, &Benchmark::Removed);
+    CpDeviceListUpnpServiceType* list =
+        new CpDeviceListUpnpServiceType(iCpStack, Brn("openhome.org"), Brn("TestBasic"), 1, added, removed);
+    try {
+        iAdded.Wait(kDeviceFoundTimeoutMs);
+    }
+    catch (Timeout&) {
+        Print("ERROR: TestBasic device not found within %us\n", kDeviceFoundTimeoutMs / 1000);
+        delete list;
+        return false;
+    }
+
+    for (TUint cps=1; cps<=iMaxControlPoints; cps*=2) {
+        RunActions("increment", ActionClient::eIncrement, cps, 0);
+    }
+    const TUint kArgBytes[] = { 16, 1024, 16 * 1024 };
+    for (TUint i=0; i<sizeof(kArgBytes)/sizeof(kArgBytes[0]); i++) {
+        RunActions("echoString", ActionClient::eEchoString, iMaxControlPoints, kArgBytes[i]);
+        RunActions("echoBinary", ActionClient::eEchoBinary, iMaxControlPoints, kArgBytes[i]);
+    }
+    for (TUint subs=1; subs<=iMaxSubscribers; subs*=2) {
+        RunEvents(subs);
+    }
+
+    delete list;
+    return true;
+}
+
+void Benchmark::WriteJson(IWriter& aWriter)
+{
+    iResults.WriteJson(aWriter);
+}
+
+void Benchmark::RunActions(const TChar* aScenario, ActionClient::EAction aAction, TUint aControlPoints, TUint aArgBytes)
+{
+    Bwh arg(aArgBytes);
+    for (TUint i=0; i<aArgBytes; i++) {
+        arg.Append((TByte)(aAction == ActionClient::eEchoBinary? i : 'a' + (i % 26)));
+    }
+    Semaphore done("BNDN", 0);
+    std::vector<ActionClient*> clients;
+    for (TUint i=0; i<aControlPoints; i++) {
+        clients.push_back(new ActionClient(iEnv, *iCpDevice, aAction, arg, done));
+    }
+    const TUint64 startUs = Os::TimeInUs(iEnv.OsCtx());
+    const TUint64 stopUs = startUs + (TUint64)iDurationMs * 1000;
+    for (TUint i=0; i<aControlPoints; i++) {
+        clients[i]->Start(stopUs);
+    }
+    for (TUint i=0; i<aControlPoints; i++) {
+        done.Wait();
+    }
+    const TUint elapsedMs = (TUint)((Os::TimeInUs(iEnv.OsCtx()) - startUs) / 1000);
+    Samples all;
+    TUint errors = 0;
+    for (TUint i=0; i<aControlPoints; i++) {
+        all.Append(clients[i]->Latencies());
+        errors += clients[i]->Errors();
+        delete clients[i];
+    }
+    iResults.Add(aScenario, aControlPoints, 0, aArgBytes, elapsedMs, errors, all);
+}
+
+void Benchmark::RunEvents(TUint aSubscribers)
+{
+    EventRound round(iEnv);
+    std::vector<Subscriber*> subscribers;
+    for (TUint i=0; i<aSubscribers; i++) {
+        subscribers.push_back(new Subscriber(*iCpDevice, round));
+    }
+    CpProxyOpenhomeOrgTestBasic1* setter = new CpProxyOpenhomeOrgTestBasic1(*iCpDevice);
+    TUint value;
+    setter->SyncGetUint(value);
+
+    TUint errors = 0;
+    const TUint64 startUs = Os::TimeInUs(iEnv.OsCtx());
+    const TUint64 stopUs = startUs + (TUint64)iDurationMs * 1000;
+    while (Os::TimeInUs(iEnv.OsCtx()) < stopUs) {
+        round.Begin(++value);
+        setter->SyncSetUint(value);
+        for (TUint i=0; i<aSubscribers; i++) {
+            try {
+                round.Wait(kEventTimeoutMs);
+            }
+            catch (Timeout&) {
+                errors++;
+            }
+        }
+    }
+    const TUint elapsedMs = (TUint)((Os::TimeInUs(iEnv.OsCtx()) - startUs) / 1000);
+
+    delete setter;
+    for (TUint i=0; i<aSubscribers; i++) {
+        delete subscribers[i];
+    }
+    iResults.Add("events", 1, aSubscribers, 0, elapsedMs, errors, round.Latencies());
+}
+
+
+void TestLoopbackBenchmark(CpStack& aCpStack, DvStack& aDvStack, TUint aDurationMs,
+                           TUint aMaxControlPoints, TUint aMaxSubscribers, const Brx& aOutputFile)
+{
+    Print("TestLoopbackBenchmark - starting\n");
+    Benchmark* benchmark = new Benchmark(aCpStack, aDvStack, aDurationMs, aMaxControlPoints, aMaxSubscribers);
+    if (!benchmark->Run()) {
+        delete benchmark;
+        Print("TestLoopbackBenchmark - FAILED\n");
+        ASSERTS();
+    }
+    WriterBwh json(1024);
+    benchmark->WriteJson(json);
+    if (aOutputFile.Bytes() == 0) {
+        Print(json.Buffer());
+    }
+    else {
+        Brhz path(aOutputFile);
+        FileStream file;
+        file.OpenFile(path.CString(), eFileWriteOnly);
+        file.Write(json.Buffer());
+        file.CloseFile();
+        Print("Results written to %s\n", path.CString());
+    }
+    delete benchmark;
+    Print("TestLoopbackBenchmark - completed\n");
+}
@@ -0,0 +1,49 @@
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/OptionParser.h>
+#include <OpenHome/Net/Core/OhNet.h>
+#include <OpenHome/Net/Private/DviStack.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::Net;
+
+extern void TestLoopbackBenchmark(CpStack& aCpStack, DvStack& aDvStack, TUint aDurationMs,
+                                  TUint aMaxControlPoints, TUint aMaxSubscribers, const Brx& aOutputFile);
+
+void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::InitialisationParams* aInitParams)
+{
+    OptionParser parser;
+    OptionUint duration("-d", "--duration", 2, "Seconds to run each scenario for");
+    parser.AddOption(&duration);
+    OptionUint controlPoints("-c", "--control-points", 4, "Maximum number of concurrent control points");
+    parser.AddOption(&controlPoints);
+    OptionUint subscribers("-s", "--subscribers", 8, "Maximum number of subscribers for event scenarios");
+    parser.AddOption(&subscribers);
+    OptionString output("-o", "--output", Brx::Empty(), "File to write JSON results to (default is stdout)");
+    parser.AddOption(&output);
+    if (!parser.Parse(aArgc, aArgv) || parser.HelpDisplayed()) {
+        return;
+    }
+    // results are only comparable between runs if they don't depend on the network
+    aInitParams->SetUseLoopbackNetworkAdapter();
+    aInitParams->SetDvUpnpServerPort(0);
+    if (aInitParams->NumActionInvokerThreads() < controlPoints.Value()) {
+        aInitParams->SetNumActionInvokerThreads(controlPoints.Value());
+    }
+    Library* lib = new Library(aInitParams);
+    std::vector<NetworkAdapter*>* subnetList = lib->CreateSubnetList();
+    TIpAddress subnet = (*subnetList)[0]->Subnet();
+    Library::DestroySubnetList(subnetList);
+    CpStack* cpStack = NULL;
+    DvStack* dvStack = NULL;
+    lib->StartCombined(subnet, cpStack, dvStack);
+    dvStack->Start();
+
+    TestLoopbackBenchmark(*cpStack, *dvStack, duration.Value() * 1000,
+                          controlPoints.Value(), subscribers.Value(), output.Value());
+
+    delete lib;
+}
@@ -0,0 +1,449 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Net/Private/DviServerWebSocket.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Net/Private/Globals.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Private/Debug.h>
+
+#include <string.h>
+
+using namespace OpenHome;
+using namespace OpenHome::Net;
+using namespace OpenHome::TestFramework;
+
+static const TByte kOpContinuation = 0x0;
+static const TByte kOpText         = 0x1;
+static const TByte kOpBinary       = 0x2;
+static const TByte kOpClose        = 0x8;
+static const TByte kOpPing         = 0x9;
+static const TByte kOpPong         = 0xA;
+
+// deterministic so that any failure can be reproduced
+class Prng
+{
+public:
+    Prng(TUint32 aSeed) : iState(aSeed) {}
+    TUint32 Next()
+    {
+        iState ^= iState << 13;
+        iState ^= iState >> 17;
+        iState ^= iState << 5;
+        return iState;
+    }
+    TUint Next(TUint aMin, TUint aMax) { return aMin + (Next() % (aMax - aMin + 1)); }
+private:
+    TUint32 iState;
+};
+
+// returns data in (pseudo-)random sized chunks, as a socket might
+class ReaderChunked : public IReader
+{
+public:
+    ReaderChunked(Prng& aPrng, TUint aMaxChunkBytes)
+        : iPrng(aPrng), iMaxChunkBytes(aMaxChunkBytes), iOffset(0) {}
+    void Set(const Brx& aData) { iData.Set(aData); iOffset = 0; }
+    TBool Done() const { return iOffset == iData.Bytes(); }
+private: // from IReader
+    Brn Read(TUint aBytes)
+    {
+        TUint bytes = iPrng.Next(1, iMaxChunkBytes);
+        if (bytes > aBytes) {
+            bytes = aBytes;
+        }
+        if (bytes > iData.Bytes() - iOffset) {
+            bytes = iData.Bytes() - iOffset;
+        }
+        Brn buf(iData.Ptr() + iOffset, bytes);
+        iOffset += bytes;
+        return buf;
+    }
+    void ReadFlush() {}
+    void ReadInterrupt() {}
+private:
+    Prng& iPrng;
+    TUint iMaxChunkBytes;
+    Brn iData;
+    TUint iOffset;
+};
+
+static void AppendFrame(Bwh& aStream, TByte aOpcode, TBool aFinal, const Brx& aPayload, const TByte* aMask)
+{
+    const TUint bytes = aPayload.Bytes();
+    aStream.Grow(aStream.Bytes() + bytes + 14);
+    aStream.Append((TByte)((aFinal? 0x80 : 0) | aOpcode));
+    if (bytes < 126) {
+        aStream.Append((TByte)(0x80 | bytes));
+    }
+    else if (bytes < (1<<16)) {
+        aStream.Append((TByte)(0x80 | 126));
+        aStream.Append((TByte)(bytes >> 8));
+        aStream.Append((TByte)bytes);
+    }
+    else {
+        aStream.Append((TByte)(0x80 | 127));
+        for (TInt i=7; i>=0; i--) {
+            aStream.Append((TByte)(i >= 4? 0 : (bytes >> (8*i))));
+        }
+    }
+    aStream.Append(aMask, 4);
+    for (TUint i=0; i<bytes; i++) {
+        aStream.Append((TByte)(aPayload[i] ^ aMask[i%4]));
+    }
+}
+
+static void AppendFrame(Bwh& aStream, TByte aOpcode, TBool aFinal, const Brx& aPayload)
+{
+    static const TByte kMask[4] = { 0x37, 0xfa, 0x21, 0x3d };
+    AppendFrame(aStream, aOpcode, aFinal, aPayload, kMask);
+}
+
+static void FillPayload(Bwh& aBuf, TUint aBytes, Prng& aPrng)
+{
+    aBuf.Grow(aBytes);
+    aBuf.SetBytes(0);
+    for (TUint i=0; i<aBytes; i++) {
+        aBuf.Append((TChar)aPrng.Next('a', 'z'));
+    }
+}
+
+
+class SuiteWsUnmask : public Suite
+{
+public:
+    SuiteWsUnmask() : Suite("WebSocket unmasking") {}
+    void Test();
+};
+
+void SuiteWsUnmask::Test()
+{
+    static const TByte kMask[4] = { 0x01, 0x80, 0x5a, 0xff };
+    Prng prng(1);
+    TByte data[300];
+    TByte expected[300];
+    TBool ok = true;
+    for (TUint offset=0; offset<8; offset++) { // check unaligned starts
+        for (TUint bytes=0; bytes+offset<=sizeof(data); bytes+=7) {
+            for (TUint i=0; i<sizeof(data); i++) {
+                data[i] = (TByte)prng.Next();
+                expected[i] = data[i];
+            }
+            for (TUint i=0; i<bytes; i++) {
+                expected[offset+i] ^= kMask[i%4];
+            }
+            WsFrameReader::Unmask(&data[offset], bytes, kMask);
+            if (memcmp(data, expected, sizeof(data)) != 0) {
+                ok = false;
+            }
+        }
+    }
+    TEST(ok);
+}
+
+
+class SuiteWsFrameReader : public Suite
+{
+public:
+    SuiteWsFrameReader();
+    void Test();
+private:
+    WsFrameReader::EFrame ReadOne(const Brx& aStream, Brn& aData, TUint16& aCloseCode);
+    void TestInvalid(const Brx& aStream, TUint16 aExpectedCode);
+private:
+    static const TUint kMaxMessageBytes = 256 * 1024;
+    Prng iPrng;
+    ReaderChunked iSource;
+    ReaderUntilS<4096> iReader;
+    Bwh iData;
+};
+
+SuiteWsFrameReader::SuiteWsFrameReader()
+    : Suite("WebSocket frame decoding")
+    , iPrng(2)
+    , iSource(iPrng, 1500)
+    , iReader(iSource)
+{
+}
+
+WsFrameReader::EFrame SuiteWsFrameReader::ReadOne(const Brx& aStream, Brn& aData, TUint16& aCloseCode)
+{
+    iSource.Set(aStream);
+    iReader.ReadFlush();
+    WsFrameReader frameReader(iReader, kMaxMessageBytes);
+    WsFrameReader::EFrame frame = frameReader.Read(aData, aCloseCode);
+    // aData refers to frameReader's buffer so needs to be copied before frameReader is destroyed
+    iData.Grow(aData.Bytes());
+    iData.Replace(aData);
+    aData.Set(iData);
+    return frame;
+}
+
+void SuiteWsFrameReader::TestInvalid(const Brx& aStream, TUint16 aExpectedCode)
+{
+    Brn data;
+    TUint16 code;
+    TEST(ReadOne(aStream, data, code) == WsFrameReader::eInvalid);
+    TEST(code == aExpectedCode);
+}
+
+void SuiteWsFrameReader::Test()
+{
+    Brn data;
+    TUint16 code;
+    Bwh stream;
+    Bwh payload;
+
+    // single frame messages using each length encoding
+    const TUint sizes[] = { 0, 1, 125, 126, 1000, 65535, 65536, 200000 };
+    for (TUint i=0; i<sizeof(sizes)/sizeof(sizes[0]); i++) {
+        FillPayload(payload, sizes[i], iPrng);
+        stream.SetBytes(0);
+        AppendFrame(stream, kOpText, true, payload);
+        TEST(ReadOne(stream, data, code) == WsFrameReader::eMessage);
+        TEST(data == payload);
+        TEST(iSource.Done());
+    }
+
+    // fragmented message with control frames between fragments
+    FillPayload(payload, 70000, iPrng);
+    stream.SetBytes(0);
+    AppendFrame(stream, kOpText, false, Brn(payload.Ptr(), 10));
+    AppendFrame(stream, kOpPing, true, Brn("ping"));
+    AppendFrame(stream, kOpContinuation, false, Brn(payload.Ptr() + 10, 30000));
+    AppendFrame(stream, kOpPong, true, Brn(""));
+    AppendFrame(stream, kOpContinuation, true, Brn(payload.Ptr() + 30010, payload.Bytes() - 30010));
+    AppendFrame(stream, kOpClose, true, Brn("\x03\xe8"));
+    iSource.Set(stream);
+    iReader.ReadFlush();
+    {
+        WsFrameReader frameReader(iReader, kMaxMessageBytes);
+        TEST(frameReader.Read(data, code) == WsFrameReader::ePing);
+        TEST(data == Brn("ping"));
+        TEST(frameReader.Read(data, code) == WsFrameReader::ePong);
+        TEST(data.Bytes() == 0);
+        TEST(frameReader.Read(data, code) == WsFrameReader::eMessage);
+        TEST(data == payload);
+        TEST(frameReader.Read(data, code) == WsFrameReader::eClose);
+        TEST(data.Bytes() == 2);
+        TEST(iSource.Done());
+        TEST_THROWS(frameReader.Read(data, code), ReaderError);
+    }
+
+    // protocol errors
+    stream.SetBytes(0);
+    AppendFrame(stream, kOpBinary, true, Brn("binary"));
+    TestInvalid(stream, WsFrameReader::kCloseUnsupportedData);
+    stream.SetBytes(0);
+    AppendFrame(stream, kOpContinuation, true, Brn("orphan"));
+    TestInvalid(stream, WsFrameReader::kCloseProtocolError);
+    stream.SetBytes(0);
+    AppendFrame(stream, kOpText, false, Brn("first"));
+    AppendFrame(stream, kOpText, true, Brn("second"));
+    TestInvalid(stream, WsFrameReader::kCloseProtocolError);
+    stream.SetBytes(0);
+    AppendFrame(stream, kOpPing, false, Brn("fragmented ping"));
+    TestInvalid(stream, WsFrameReader::kCloseProtocolError);
+    FillPayload(payload, WsFrameReader::kMaxControlBytes + 1, iPrng);
+    stream.SetBytes(0);
+    AppendFrame(stream, kOpPing, true, payload);
+    TestInvalid(stream, WsFrameReader::kCloseProtocolError);
+    stream.SetBytes(0);
+    AppendFrame(stream, 0x3, true, Brn("reserved"));
+    TestInvalid(stream, WsFrameReader::kCloseProtocolError);
+    stream.SetBytes(0);
+    AppendFrame(stream, kOpText, true, Brn("rsv"));
+    stream[0] |= 0x40;
+    TestInvalid(stream, WsFrameReader::kCloseProtocolError);
+    stream.SetBytes(0);
+    AppendFrame(stream, kOpText, true, Brn("unmasked"));
+    stream[1] &= 0x7f;
+    TestInvalid(stream, WsFrameReader::kCloseProtocolError);
+
+    // messages over the size limit, whether sent whole or fragmented
+    FillPayload(payload, kMaxMessageBytes + 1, iPrng);
+    stream.SetBytes(0);
+    AppendFrame(stream, kOpText, true, payload);
+    TestInvalid(stream, WsFrameReader::kCloseMsgTooBig);
+    stream.SetBytes(0);
+    AppendFrame(stream, kOpText, false, Brn(payload.Ptr(), kMaxMessageBytes));
+    AppendFrame(stream, kOpContinuation, true, Brn("x"));
+    TestInvalid(stream, WsFrameReader::kCloseMsgTooBig);
+    // ...and a 64-bit length which would overflow if truncated to 32 bits
+    stream.SetBytes(0);
+    stream.Append((TByte)0x81);
+    stream.Append((TByte)0xff);
+    stream.Append(Brn((const TByte*)"\x00\x00\x00\x01\x00\x00\x00\x05" "abcd", 12));
+    TestInvalid(stream, WsFrameReader::kCloseMsgTooBig);
+}
+
+
+class SuiteWsFuzz : public Suite
+{
+public:
+    SuiteWsFuzz() : Suite("WebSocket decoder fuzzing") {}
+    void Test();
+private:
+    void BuildStream(Prng& aPrng, Bwh& aStream, std::vector<Bwh*>& aMessages);
+};
+
+void SuiteWsFuzz::BuildStream(Prng& aPrng, Bwh& aStream, std::vector<Bwh*>& aMessages)
+{
+    aStream.SetBytes(0);
+    const TUint numMessages = aPrng.Next(1, 8);
+    for (TUint i=0; i<numMessages; i++) {
+        Bwh* msg = new Bwh();
+        FillPayload(*msg, aPrng.Next(0, aPrng.Next(0, 1) == 0? 200 : 100000), aPrng);
+        aMessages.push_back(msg);
+        const TUint numFragments = aPrng.Next(1, 5);
+        TUint offset = 0;
+        for (TUint j=0; j<numFragments; j++) {
+            const TBool last = (j == numFragments-1);
+            const TUint bytes = (last? msg->Bytes() - offset : aPrng.Next(0, msg->Bytes() - offset));
+            TByte mask[4];
+            for (TUint k=0; k<4; k++) {
+                mask[k] = (TByte)aPrng.Next();
+            }
+            AppendFrame(aStream, (j == 0? kOpText : kOpContinuation), last, Brn(msg->Ptr() + offset, bytes), mask);
+            offset += bytes;
+            if (aPrng.Next(0, 3) == 0) {
+                AppendFrame(aStream, kOpPing, true, Brn("fuzz"), mask);
+            }
+        }
+    }
+}
+
+void SuiteWsFuzz::Test()
+{
+    static const TUint kIterations = 2000;
+    static const TUint kMaxMessageBytes = 128 * 1024;
+    Prng prng(3);
+    ReaderChunked source(prng, 3000);
+    ReaderUntilS<4096> reader(source);
+    Bwh stream;
+    std::vector<Bwh*> messages;
+    TBool validOk = true;
+    TUint corruptInvalid = 0;
+    TUint corruptTruncated = 0;
+    for (TUint i=0; i<kIterations; i++) {
+        BuildStream(prng, stream, messages);
+        const TBool corrupt = (i % 2 == 1);
+        if (corrupt) {
+            const TUint numFlips = prng.Next(1, 4);
+            for (TUint j=0; j<numFlips; j++) {
+                stream[prng.Next(0, stream.Bytes()-1)] ^= (TByte)(1 << prng.Next(0, 7));
+            }
+        }
+        source.Set(stream);
+        reader.ReadFlush();
+        WsFrameReader frameReader(reader, kMaxMessageBytes);
+        TUint msgIndex = 0;
+        try {
+            while (!source.Done() || msgIndex < messages.size()) {
+                Brn data;
+                TUint16 code;
+                WsFrameReader::EFrame frame = frameReader.Read(data, code);
+                if (frame == WsFrameReader::eInvalid) {
+                    if (!corrupt) {
+                        validOk = false;
+                    }
+                    corruptInvalid++;
+                    break;
+                }
+                if (frame == WsFrameReader::eMessage) {
+                    if (!corrupt && (msgIndex >= messages.size() || data != *messages[msgIndex])) {
+                        validOk = false;
+                    }
+                    msgIndex++;
+                }
+            }
+        }
+        catch (ReaderError&) {
+            // corrupted lengths may claim more data than the stream holds
+            if (!corrupt) {
+                validOk = false;
+            }
+            corruptTruncated++;
+        }
+        for (TUint j=0; j<messages.size(); j++) {
+            delete messages[j];
+        }
+        messages.clear();
+    }
+    TEST(validOk);
+    Print("    %u corrupted streams rejected, %u truncated\n", corruptInvalid, corruptTruncated);
+}
+
+
+class SuiteWsThroughput : public Suite
+{
+public:
+    SuiteWsThroughput() : Suite("WebSocket decoder throughput") {}
+    void Test();
+};
+
+void SuiteWsThroughput::Test()
+{
+    static const TUint kMessageBytes = 1024 * 1024;
+    static const TUint kNumMessages = 64;
+    static const TByte kMask[4] = { 0x12, 0x34, 0x56, 0x78 };
+    Prng prng(4);
+    Bwh payload;
+    FillPayload(payload, kMessageBytes, prng);
+    Bwh stream;
+    // each message in 16 fragments, with the reader returning up to 64k at a time
+    for (TUint i=0; i<16; i++) {
+        const TUint bytes = kMessageBytes / 16;
+        AppendFrame(stream, (i == 0? kOpText : kOpContinuation), (i == 15), Brn(payload.Ptr() + i*bytes, bytes), kMask);
+    }
+    ReaderChunked source(prng, 64 * 1024);
+    ReaderUntilS<4096> reader(source);
+    TBool ok = true;
+    TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+    {
+        WsFrameReader frameReader(reader, kMessageBytes);
+        for (TUint i=0; i<kNumMessages; i++) {
+            source.Set(stream);
+            Brn data;
+            TUint16 code;
+            if (frameReader.Read(data, code) != WsFrameReader::eMessage || data.Bytes() != kMessageBytes) {
+                ok = false;
+            }
+        }
+    }
+    TUint64 elapsedUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+    TEST(ok);
+    Print("    decoded %u MB in %llu ms", kNumMessages, elapsedUs / 1000);
+    if (elapsedUs > 0) {
+        Print(" (%llu MB/s)", ((TUint64)kNumMessages * 1000000) / elapsedUs);
+    }
+    Print("\n");
+
+    // unmasking alone, compared with the byte-at-a-time loop this replaced
+    TByte* buf = const_cast<TByte*>(payload.Ptr());
+    start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kNumMessages; i++) {
+        WsFrameReader::Unmask(buf, kMessageBytes, kMask);
+    }
+    const TUint64 wordUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+    start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kNumMessages; i++) {
+        for (TUint j=0; j<kMessageBytes; j++) {
+            buf[j] ^= kMask[j%4];
+        }
+    }
+    const TUint64 byteUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+    Print("    unmask %u MB: word-wide %llu us, byte-wise %llu us\n", kNumMessages, wordUs, byteUs);
+}
+
+
+void TestWebSocket()
+{
+    Debug::SetLevel(Debug::kNone);
+
+    Runner runner("WebSocket framing tests\n");
+    runner.Add(new SuiteWsUnmask());
+    runner.Add(new SuiteWsFrameReader());
+    runner.Add(new SuiteWsFuzz());
+    runner.Add(new SuiteWsThroughput());
+    runner.Run();
+}
@@ -599,8 +599,9 @@ DviSessionUpnp::DviSessionUpnp(DvStack& aDvStack, const NetworkAdapter& aNif, TU
     iReaderRequest = new ReaderHttpRequest(aDvStack.Env(), *iReaderUntil);
     iReaderEntity = new ReaderHttpEntity(*iReaderUntil);
     iWriterChunked = new WriterHttpChunked(*this);
-    iWriterBuffer = new Sws<kMaxResponseBytes>(*iWriterChunked);
+    iWriterBuffer = new Swp(aDvStack.Env().Buffers(), kMaxResponseBytes, *iWriterChunked);
     iWriterResponse = new WriterHttpResponse(*iWriterBuffer);
+    iSoapRequest = new WriterBufferChain(aDvStack.Env().Buffers(), kRequestChunkBytes, kMaxRequestBytes);
 
     iReaderRequest->AddMethod(Http::kMethodGet);
     iReaderRequest->AddMethod(Http::kMethodPost);
@@ -626,6 +627,7 @@ DviSessionUpnp::~DviSessionUpnp()
 {
     Interrupt(true);
     iShutdownSem.Wait();
+    delete iSoapRequest;
     delete iWriterResponse;
     delete iWriterBuffer;
     delete iWriterChunked;
@@ -644,7 +646,7 @@ void DviSessionUpnp::Run()
     iWriterChunked->SetChunked(false);
     iInvocationService = NULL;
     iResourceWriterHeadersOnly = false;
-    iSoapRequest.SetBytes(0);
+    iSoapArgs.Set(Brx::Empty());
     iReaderEntity->ReadFlush();
     iResponseStarted = false;
     iResponseEnded = false;
@@ -724,6 +726,8 @@ void DviSessionUpnp::Run()
            Log::Print("WriterError(2) handling %.*s for %.*s\n", PBUF(method), PBUF(reqUri));
         }
     }
+    iSoapArgs.Set(Brx::Empty());
+    iSoapRequest->Reset();
     iShutdownSem.Signal();
 }
 
@@ -785,8 +789,7 @@ void DviSessionUpnp::Post()
             iErrorStatus = &HttpStatus::kLengthRequired;
             iReaderEntity->Set(iHeaderContentLength, iHeaderTransferEncoding, ReaderHttpEntity::Server);
             iErrorStatus = &HttpStatus::kRequestEntityTooLarge;
-            WriterBuffer writer(iSoapRequest);
-            iReaderEntity->ReadAll(writer);
+            iReaderEntity->ReadAll(*iSoapRequest);
             iErrorStatus = &HttpStatus::kOk;
 
             Invoke();
@@ -1132,10 +1135,9 @@ const Brx& DviSessionUpnp::ClientUserAgent() const
 void DviSessionUpnp::InvocationReadStart()
 {
     try {
-        Brn envelope = XmlParserBasic::Find("Envelope", iSoapRequest);
+        Brn envelope = XmlParserBasic::Find("Envelope", iSoapRequest->Buffer());
         Brn body = XmlParserBasic::Find("Body", envelope);
-        Brn args = XmlParserBasic::Find(iHeaderSoapAction.Action(), body);
-        iSoapRequest.Replace(args);
+        iSoapArgs.Set(XmlParserBasic::Find(iHeaderSoapAction.Action(), body));
     }
     catch (XmlError&) {
         InvocationReportError(501, Brn("Invalid XML"));
@@ -1145,7 +1147,7 @@ void DviSessionUpnp::InvocationReadStart()
 TBool DviSessionUpnp::InvocationReadBool(const TChar* aName)
 {
     try {
-        Brn value = XmlParserBasic::Find(aName, iSoapRequest);
+        Brn value = XmlParserBasic::Find(aName, iSoapArgs);
         try {
             TUint num = Ascii::Uint(value);
             return (num != 0);
@@ -1169,7 +1171,7 @@ TBool DviSessionUpnp::InvocationReadBool(const TChar* aName)
 void DviSessionUpnp::InvocationReadString(const TChar* aName, Brhz& aString)
 {
     try {
-        Brn value = XmlParserBasic::Find(aName, iSoapRequest);
+        Brn value = XmlParserBasic::Find(aName, iSoapArgs);
         Bwh writable(value.Bytes()+1);
         if (value.Bytes()) {
             writable.Append(value);
@@ -1186,7 +1188,7 @@ void DviSessionUpnp::InvocationReadString(const TChar* aName, Brhz& aString)
 TInt DviSessionUpnp::InvocationReadInt(const TChar* aName)
 {
     try {
-        Brn value = XmlParserBasic::Find(aName, iSoapRequest);
+        Brn value = XmlParserBasic::Find(aName, iSoapArgs);
         TInt num = Ascii::Int(value);
         return num;
     }
@@ -1202,7 +1204,7 @@ TInt DviSessionUpnp::InvocationReadInt(const TChar* aName)
 TUint DviSessionUpnp::InvocationReadUint(const TChar* aName)
 {
     try {
-        Brn value = XmlParserBasic::Find(aName, iSoapRequest);
+        Brn value = XmlParserBasic::Find(aName, iSoapArgs);
         TUint num = Ascii::Uint(value);
         return num;
     }
@@ -1218,7 +1220,7 @@ TUint DviSessionUpnp::InvocationReadUint(const TChar* aName)
 void DviSessionUpnp::InvocationReadBinary(const TChar* aName, Brh& aData)
 {
     try {
-        Brn value = XmlParserBasic::Find(aName, iSoapRequest);
+        Brn value = XmlParserBasic::Find(aName, iSoapArgs);
         if (value.Bytes()) {
             Bwh writable(value.Bytes()+1);
             writable.Append(value);
@@ -1233,7 +1235,7 @@ void DviSessionUpnp::InvocationReadBinary(const TChar* aName, Brh& aData)
 
 void DviSessionUpnp::InvocationReadEnd()
 {
-    iSoapRequest.Replace(Brx::Empty());
+    iSoapArgs.Set(Brx::Empty());
 }
 
 void DviSessionUpnp::InvocationReportErrorNoThrow(TUint aCode, const Brx& aDescription)
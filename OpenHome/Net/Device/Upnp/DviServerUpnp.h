@@ -7,6 +7,7 @@
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Net/Private/DviDevice.h>
 #include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/BufferPool.h>
 #include <OpenHome/Net/Private/DviService.h>
 #include <OpenHome/Net/Private/Subscription.h>
 #include <OpenHome/Net/Private/Service.h>
@@ -222,7 +223,8 @@ private: // IDviInvocation
     void InvocationWriteStringEnd(const TChar* aName);
     void InvocationWriteEnd();
 private:
-    static const TUint kMaxRequestBytes = 64*1024;
+    static const TUint kMaxRequestBytes = 1024*1024;
+    static const TUint kRequestChunkBytes = 4*1024;
     static const TUint kMaxResponseBytes = 4*1024;
     static const TUint kReadTimeoutMs = 5 * 1000;
     static const TUint kMaxRequestPathBytes = 256;
@@ -239,7 +241,7 @@ private:
     ReaderHttpRequest* iReaderRequest;
     ReaderHttpEntity* iReaderEntity;
     WriterHttpChunked* iWriterChunked;
-    Sws<kMaxResponseBytes>* iWriterBuffer;
+    Swp* iWriterBuffer;
     WriterHttpResponse* iWriterResponse;
     HttpHeaderHost iHeaderHost;
     HttpHeaderContentLength iHeaderContentLength;
@@ -256,7 +258,8 @@ private:
     const HttpStatus* iErrorStatus;
     TBool iResponseStarted;
     TBool iResponseEnded;
-    Bws<kMaxRequestBytes> iSoapRequest;
+    WriterBufferChain* iSoapRequest; // only holds buffers while a request is being processed
+    Brn iSoapArgs;
     Bws<kMaxRequestPathBytes> iMappedRequestUri;
     DviDevice* iInvocationDevice;
     DviService* iInvocationService;
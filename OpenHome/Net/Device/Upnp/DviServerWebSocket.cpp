@@ -17,6 +17,7 @@
 #include <OpenHome/Private/Parser.h>
 
 #include <stdlib.h>
+#include <string.h>
 
 using namespace OpenHome;
 using namespace OpenHome::Net;
@@ -224,11 +225,57 @@ void WsHeaderVersion::Process(const Brx& aValue)
 }
 
 
+// WsPropertyUpdate
+
+WsPropertyUpdate::WsPropertyUpdate(Brh& aMsg, EFraming aFraming, const Brx& aSid, const Brx& aProperties)
+    : iSid(aSid)
+    , iProperties(aProperties)
+{
+    aMsg.TransferTo(iMsg);
+    ASSERT(iMsg.Bytes() >= kMaxHeaderBytes + kTrailerBytes);
+    const TUint payloadBytes = iMsg.Bytes() - kMaxHeaderBytes - kTrailerBytes;
+    if (aFraming == eHixie76) {
+        iFrame.Set(WsProtocol76::FrameInPlace(iMsg, kMaxHeaderBytes, payloadBytes));
+    }
+    else {
+        iFrame.Set(WsProtocol80::FrameInPlace(iMsg, kMaxHeaderBytes, payloadBytes));
+    }
+}
+
+const Brn& WsPropertyUpdate::Frame() const
+{
+    return iFrame;
+}
+
+TBool WsPropertyUpdate::Supersedes(const WsPropertyUpdate& aOlder) const
+{
+    if (iSid != aOlder.iSid) {
+        return false;
+    }
+    Parser older(aOlder.iProperties);
+    for (Brn name = older.Next(); name.Bytes() > 0; name = older.Next()) {
+        TBool found = false;
+        Parser newer(iProperties);
+        for (Brn n = newer.Next(); n.Bytes() > 0; n = newer.Next()) {
+            if (n == name) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
 // PropertyWriterWs
 
-PropertyWriterWs* PropertyWriterWs::Create(DviSessionWebSocket& aSession, const Brx& aSid, TUint aSequenceNumber)
+PropertyWriterWs* PropertyWriterWs::Create(DviSessionWebSocket& aSession, WsPropertyUpdate::EFraming aFraming,
+                                           const Brx& aSid, TUint aSequenceNumber)
 { // static
-    PropertyWriterWs* self = new PropertyWriterWs(aSession);
+    PropertyWriterWs* self = new PropertyWriterWs(aSession, aFraming, aSid);
     try {
         self->WriteHeaders(aSid, aSequenceNumber);
     }
@@ -239,9 +286,12 @@ PropertyWriterWs* PropertyWriterWs::Create(DviSessionWebSocket& aSession, const
     return self;
 }
 
-PropertyWriterWs::PropertyWriterWs(DviSessionWebSocket& aSession)
+PropertyWriterWs::PropertyWriterWs(DviSessionWebSocket& aSession, WsPropertyUpdate::EFraming aFraming, const Brx& aSid)
     : iSession(aSession)
+    , iFraming(aFraming)
+    , iSid(aSid)
     , iWriter(kWriteBufGranularity)
+    , iProperties(kPropertiesGranularity)
 {
     SetWriter(iWriter);
 }
@@ -252,6 +302,9 @@ PropertyWriterWs::~PropertyWriterWs()
 
 void PropertyWriterWs::WriteHeaders(const Brx& aSid, TUint aSequenceNumber)
 {
+    // leave space for the frame header, written by WsPropertyUpdate once the payload length is known
+    static const TByte kHeaderSpace[WsPropertyUpdate::kMaxHeaderBytes] = { 0 };
+    iWriter.Write(Brn(kHeaderSpace, sizeof(kHeaderSpace)));
     iWriter.Write(Brn("<?xml version=\"1.0\"?>"));
     iWriter.Write(Brn("<root>"));
     iWriter.Write('<');
@@ -267,6 +320,38 @@ void PropertyWriterWs::WriteHeaders(const Brx& aSid, TUint aSequenceNumber)
     iWriter.Write(Brn("<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">"));
 }
 
+void PropertyWriterWs::AddProperty(const Brx& aName)
+{
+    if (iProperties.Buffer().Bytes() > 0) {
+        iProperties.Write(' ');
+    }
+    iProperties.Write(aName);
+}
+
+void PropertyWriterWs::PropertyWriteString(const Brx& aName, const Brx& aValue)
+{
+    AddProperty(aName);
+    PropertyWriter::PropertyWriteString(aName, aValue);
+}
+
+void PropertyWriterWs::PropertyWriteInt(const Brx& aName, TInt aValue)
+{
+    AddProperty(aName);
+    PropertyWriter::PropertyWriteInt(aName, aValue);
+}
+
+void PropertyWriterWs::PropertyWriteUint(const Brx& aName, TUint aValue)
+{
+    AddProperty(aName);
+    PropertyWriter::PropertyWriteUint(aName, aValue);
+}
+
+void PropertyWriterWs::PropertyWriteBinary(const Brx& aName, const Brx& aValue)
+{
+    AddProperty(aName);
+    PropertyWriter::PropertyWriteBinary(aName, aValue);
+}
+
 void PropertyWriterWs::PropertyWriteEnd()
 {
     iWriter.Write(Brn("</e:propertyset>"));
@@ -275,9 +360,10 @@ void PropertyWriterWs::PropertyWriteEnd()
     iWriter.Write(WebSocket::kTagSubscription);
     iWriter.Write('>');
     iWriter.Write(Brn("</root>"));
-    Brh* buf = new Brh;
-    iWriter.TransferTo(*buf);
-    iSession.QueuePropertyUpdate(buf);
+    iWriter.Write((TByte)0); // space for a frame trailer
+    Brh msg;
+    iWriter.TransferTo(msg);
+    iSession.QueuePropertyUpdate(new WsPropertyUpdate(msg, iFraming, iSid, iProperties.Buffer()));
 }
 
 
@@ -324,6 +410,18 @@ void WsProtocol76::Read(Brn& aData, TBool& aClosed)
     aData.Set(data.Split(1, data.Bytes()-1));
 }
 
+Brn WsProtocol76::FrameInPlace(const Brx& aBuf, TUint aPayloadOffset, TUint aPayloadBytes)
+{ // static
+    ASSERT(aPayloadOffset >= 1);
+    ASSERT(aPayloadOffset + aPayloadBytes < aBuf.Bytes());
+    const TByte* start = aBuf.Ptr() + aPayloadOffset - 1;
+    Bwn frame(start, aPayloadBytes + 2);
+    frame.Append(kFrameMsgStart);
+    frame.SetBytes(aPayloadBytes + 1);
+    frame.Append(kMsgEnd);
+    return Brn(frame);
+}
+
 void WsProtocol76::Write(const Brx& aData)
 {
     iWriteBuffer.Write(kFrameMsgStart);
@@ -343,130 +441,207 @@ void WsProtocol76::Close()
 }
 
 
-// WsProtocol80
+// WsFrameReader
 
-WsProtocol80::WsProtocol80(ReaderUntil& aReaderUntil, Swx& aWriteBuffer)
-    : WsProtocol(aReaderUntil, aWriteBuffer)
-    , iReaderProtocol(aReaderUntil)
+WsFrameReader::WsFrameReader(ReaderUntil& aReader, TUint aMaxMessageBytes)
+    : iReader(aReader)
+    , iMaxMessageBytes(aMaxMessageBytes)
+    , iMessage(kInitialMessageBytes)
+    , iFragmented(false)
 {
 }
 
-void WsProtocol80::Read(Brn& aData, TBool& aClosed)
+WsFrameReader::EFrame WsFrameReader::Read(Brn& aData, TUint16& aCloseCode)
 {
-    aData.Set(NULL, 0);
-    aClosed = false;
-
     static const TByte kBitMaskFinalFragment = 1<<7;
     static const TByte kBitMaskRsv123        = 0x70;
     static const TByte kBitMaskOpcode        = 0xf;
     static const TByte kBitMaskPayloadMask   = 1<<7;
     static const TByte kBitMaskPayloadLen    = 0x7f;
+    static const TByte kOpcodeContinuation   = 0x0;
+    static const TByte kOpcodeText           = 0x1;
+    static const TByte kOpcodeBinary         = 0x2;
+    static const TByte kOpcodeClose          = 0x8;
+    static const TByte kOpcodePing           = 0x9;
+    static const TByte kOpcodePong           = 0xA;
 
-    // validate framing
-    Bws<2> ctrl;
-    ctrl.Append(iReaderProtocol.Read(2));
-    const TByte& byte0 = ctrl.At(0);
-    const TByte& byte1 = ctrl.At(1);
-    const TBool fragment = ((byte0 & kBitMaskFinalFragment) == 0);
-    if (byte0 & kBitMaskRsv123) {
-        LOG_ERROR(kDvWebSocket, "WS: RSV bit(s) set - %u - but no extension negotiated\n", (byte0 & kBitMaskRsv123) >> 4);
-        Close(kCloseProtocolError);
-        aClosed = true;
-        return;
-    }
-    if ((byte1 & kBitMaskPayloadMask) == 0) {
-        LOG_ERROR(kDvWebSocket, "WS: mask bit not set\n");
-        Close(kCloseProtocolError);
-        aClosed = true;
-        return;
-    }
-    WsOpcode opcode = (WsOpcode)(byte0 & kBitMaskOpcode);
-    switch (opcode)
-    {
-    case eContinuation:
-        // test for already having stored some data from a previous text (non-final) message??
-        break;
-    case eText:
-        break;
-    case eClose:
-        aClosed = true;
-        return;
-    case ePing:
-    case ePong:
-        if (fragment) {
-            Close(kCloseProtocolError);
-            aClosed = true;
-            return;
+    aData.Set(NULL, 0);
+    aCloseCode = 0;
+    for (;;) {
+        Brn ctrl = iReader.ReadProtocol(2);
+        const TByte byte0 = ctrl[0];
+        const TByte byte1 = ctrl[1];
+        const TBool finalFragment = ((byte0 & kBitMaskFinalFragment) != 0);
+        const TByte opcode = byte0 & kBitMaskOpcode;
+        if (byte0 & kBitMaskRsv123) {
+            LOG_ERROR(kDvWebSocket, "WS: RSV bit(s) set - %u - but no extension negotiated\n", (byte0 & kBitMaskRsv123) >> 4);
+            return Invalid(kCloseProtocolError, aCloseCode);
+        }
+        if ((byte1 & kBitMaskPayloadMask) == 0) {
+            LOG_ERROR(kDvWebSocket, "WS: mask bit not set\n");
+            return Invalid(kCloseProtocolError, aCloseCode);
+        }
+
+        // calculate payload length
+        TUint64 payloadLen = byte1 & kBitMaskPayloadLen;
+        if (payloadLen == 0x7e) {
+            Brn len = iReader.ReadProtocol(2);
+            payloadLen = ((TUint)len[0] << 8) | len[1];
+        }
+        else if (payloadLen == 0x7f) {
+            Brn len = iReader.ReadProtocol(8);
+            payloadLen = 0;
+            for (TUint i=0; i<8; i++) {
+                payloadLen = (payloadLen << 8) | len[i];
+            }
+        }
+        TByte mask[4];
+        (void)memcpy(mask, iReader.ReadProtocol(4).Ptr(), sizeof(mask));
+
+        if (opcode & 0x8) {
+            // control frames can't be fragmented but may arrive between fragments of a message
+            if (!finalFragment || payloadLen > kMaxControlBytes) {
+                return Invalid(kCloseProtocolError, aCloseCode);
+            }
+            iControl.SetBytes(0);
+            ReadPayload(iControl, (TUint)payloadLen);
+            Unmask(const_cast<TByte*>(iControl.Ptr()), iControl.Bytes(), mask);
+            aData.Set(iControl);
+            switch (opcode)
+            {
+            case kOpcodeClose:
+                return eClose;
+            case kOpcodePing:
+                return ePing;
+            case kOpcodePong:
+                return ePong;
+            default:
+                LOG_ERROR(kDvWebSocket, "WS: Unexpected reserved opcode %u received\n", opcode);
+                return Invalid(kCloseProtocolError, aCloseCode);
+            }
+        }
+
+        switch (opcode)
+        {
+        case kOpcodeText:
+            if (iFragmented) {
+                LOG_ERROR(kDvWebSocket, "WS: new message before previous one completed\n");
+                return Invalid(kCloseProtocolError, aCloseCode);
+            }
+            iMessage.SetBytes(0);
+            break;
+        case kOpcodeContinuation:
+            if (!iFragmented) {
+                LOG_ERROR(kDvWebSocket, "WS: continuation frame without a message\n");
+                return Invalid(kCloseProtocolError, aCloseCode);
+            }
+            break;
+        case kOpcodeBinary:
+            LOG_ERROR(kDvWebSocket, "WS: received unexpected binary data\n");
+            return Invalid(kCloseUnsupportedData, aCloseCode);
+        default:
+            LOG_ERROR(kDvWebSocket, "WS: Unexpected reserved opcode %u received\n", opcode);
+            return Invalid(kCloseProtocolError, aCloseCode);
+        }
+        if (payloadLen > iMaxMessageBytes - iMessage.Bytes()) {
+            LOG_ERROR(kDvWebSocket, "WS: message exceeds %u bytes\n", iMaxMessageBytes);
+            return Invalid(kCloseMsgTooBig, aCloseCode);
+        }
+        const TUint offset = iMessage.Bytes();
+        const TUint required = offset + (TUint)payloadLen;
+        if (required > iMessage.MaxBytes()) {
+            // grow geometrically so a message split into many small fragments isn't copied once per fragment
+            TUint bytes = iMessage.MaxBytes();
+            while (bytes < required) {
+                bytes = (bytes > iMaxMessageBytes / 2? iMaxMessageBytes : bytes * 2);
+            }
+            iMessage.Grow(bytes);
+        }
+        ReadPayload(iMessage, (TUint)payloadLen);
+        Unmask(const_cast<TByte*>(iMessage.Ptr()) + offset, (TUint)payloadLen, mask);
+        iFragmented = !finalFragment;
+        if (finalFragment) {
+            aData.Set(iMessage);
+            return eMessage;
         }
-        break;
-    case eBinary:
-        LOG_ERROR(kDvWebSocket, "WS: received unexpected binary data\n");
-        Close(kCloseUnsupportedData);
-        aClosed = true;
-        return;
-    default:
-        LOG_ERROR(kDvWebSocket, "WS: Unexpected reserved opcode %u received\n", opcode);
-        Close(kCloseProtocolError);
-        aClosed = true;
-        return;
     }
+}
 
-    // calculate payload length
-    TUint32 payloadLen = byte1 & kBitMaskPayloadLen;
-    if (payloadLen == 0x7f) {
-        ReaderBinary rb(iReaderUntil);
-        payloadLen = (TUint32)rb.ReadUint64Be(8);
+void WsFrameReader::Unmask(TByte* aPtr, TUint aBytes, const TByte* aMask)
+{ // static
+    TByte mask8[8];
+    for (TUint i=0; i<8; i++) {
+        mask8[i] = aMask[i & 3];
     }
-    else if (payloadLen == 0x7e) {
-        ReaderBinary rb(iReaderUntil);
-        payloadLen = rb.ReadUintBe(2);
+    TUint64 mask64;
+    (void)memcpy(&mask64, mask8, sizeof(mask64));
+    TUint i = 0;
+    // memcpy avoids alignment and aliasing problems; compilers reduce it to plain (often vectorised) loads and stores
+    for (; i+8<=aBytes; i+=8) {
+        TUint64 word;
+        (void)memcpy(&word, aPtr + i, sizeof(word));
+        word ^= mask64;
+        (void)memcpy(aPtr + i, &word, sizeof(word));
     }
-    if (payloadLen > DviSessionWebSocket::kMaxRequestBytes) {
-        // larger message than we expect to handle - close the socket
-        Close(kCloseMsgTooLong);
-        aClosed = true;
-        return;
+    for (; i<aBytes; i++) {
+        aPtr[i] ^= aMask[i & 3];
     }
+}
+
+WsFrameReader::EFrame WsFrameReader::Invalid(TUint16 aCode, TUint16& aCloseCode)
+{
+    iFragmented = false;
+    iMessage.SetBytes(0);
+    aCloseCode = aCode;
+    return eInvalid;
+}
 
-    // read/decode payload
-    // decoding is in-place since we'll have no future use for the original data after decoding it
-    Bws<4> mask;
-    mask.Append(iReaderProtocol.Read(4));
-    Brn maskedData = iReaderProtocol.Read(payloadLen);
-    Bwn data(maskedData.Ptr(), maskedData.Bytes());
-    for (TUint i=0; i<maskedData.Bytes(); i++) {
-        data.Append((TByte)(maskedData[i] ^ mask[i%4]));
+void WsFrameReader::ReadPayload(Bwx& aBuf, TUint aBytes)
+{
+    while (aBytes > 0) {
+        Brn buf = iReader.Read(aBytes);
+        if (buf.Bytes() == 0) {
+            THROW(ReaderError);
+        }
+        aBuf.Append(buf);
+        aBytes -= buf.Bytes();
     }
+}
+
 
-    // now, finally, process the message
-    switch (opcode)
+// WsProtocol80
+
+WsProtocol80::WsProtocol80(ReaderUntil& aReaderUntil, Swx& aWriteBuffer, SocketTcp& aSocket, TUint aMaxMessageBytes)
+    : WsProtocol(aReaderUntil, aWriteBuffer)
+    , iSocket(aSocket)
+    , iFrameReader(aReaderUntil, aMaxMessageBytes)
+{
+    iFrame.reserve(2);
+}
+
+void WsProtocol80::Read(Brn& aData, TBool& aClosed)
+{
+    aData.Set(NULL, 0);
+    aClosed = false;
+    Brn data;
+    TUint16 closeCode;
+    switch (iFrameReader.Read(data, closeCode))
     {
-    case eText:
-        iMessage.SetBytes(0);
-        // fallthrough
-    case eContinuation:
-        if (iMessage.Bytes() > 0 || fragment) {
-            iMessage.Grow(iMessage.Bytes() + data.Bytes());
-            iMessage.Append(data);
-        }
-        if (!fragment) {
-            if (iMessage.Bytes() > 0) {
-                aData.Set(iMessage);
-            }
-            else {
-                aData.Set(data);
-            }
-        }
+    case WsFrameReader::eMessage:
+        aData.Set(data);
         break;
-    case ePing:
+    case WsFrameReader::ePing:
         Write(ePong, data);
         break;
-    case ePong:
+    case WsFrameReader::ePong:
         LOG(kDvWebSocket, "WS: Pong - %.*s\n", PBUF(data));
         break;
-    default:
-        // should have filtered out all other cases in the earlier switch
-        ASSERTS();
+    case WsFrameReader::eClose:
+        aClosed = true;
+        break;
+    case WsFrameReader::eInvalid:
+        Close(closeCode);
+        aClosed = true;
         break;
     }
 }
@@ -481,34 +656,48 @@ void WsProtocol80::Close()
     Close(kCloseNormal);
 }
 
-void WsProtocol80::Write(WsOpcode aOpcode, const Brx& aData)
-{
-    TByte b = 0x80 | (TByte)aOpcode;
-    iWriteBuffer.Write(b);
-    const TUint dataLen = aData.Bytes();
-    if (dataLen < 126) {
-        iWriteBuffer.Write((TByte)dataLen);
+Brn WsProtocol80::FrameInPlace(const Brx& aBuf, TUint aPayloadOffset, TUint aPayloadBytes)
+{ // static
+    Bws<kMaxHeaderBytes> header;
+    WriteHeader(header, eText, aPayloadBytes);
+    ASSERT(aPayloadOffset >= header.Bytes());
+    ASSERT(aPayloadOffset + aPayloadBytes <= aBuf.Bytes());
+    const TByte* start = aBuf.Ptr() + aPayloadOffset - header.Bytes();
+    Bwn frame(start, header.Bytes() + aPayloadBytes);
+    frame.Append(header);
+    frame.SetBytes(header.Bytes() + aPayloadBytes);
+    return Brn(frame);
+}
+
+void WsProtocol80::WriteHeader(Bwx& aHeader, WsOpcode aOpcode, TUint aDataLen)
+{ // static
+    aHeader.Append((TByte)(0x80 | (TByte)aOpcode));
+    if (aDataLen < 126) {
+        aHeader.Append((TByte)aDataLen);
     }
-    else if (dataLen < (1<<16)) {
-        iWriteBuffer.Write((TByte)0x7e);
-        TUint16 len = (TUint16)dataLen;
+    else if (aDataLen < (1<<16)) {
+        aHeader.Append((TByte)0x7e);
+        TUint16 len = (TUint16)aDataLen;
         len = Arch::BigEndian2(len);
-        Bws<2> lenBuf;
-        (void)memcpy((TByte*)lenBuf.Ptr(), &len, 2);
-        lenBuf.SetBytes(2);
-        iWriteBuffer.Write(lenBuf);
+        aHeader.Append((const TByte*)&len, 2);
     }
     else {
-        iWriteBuffer.Write((TByte)0x7f);
-        TUint64 len = dataLen;
+        aHeader.Append((TByte)0x7f);
+        TUint64 len = aDataLen;
         len = Arch::BigEndian8(len);
-        Bws<8> lenBuf;
-        (void)memcpy((TByte*)lenBuf.Ptr(), &len, 8);
-        lenBuf.SetBytes(8);
-        iWriteBuffer.Write(lenBuf);
+        aHeader.Append((const TByte*)&len, 8);
     }
-    iWriteBuffer.Write(aData);
-    iWriteBuffer.WriteFlush();
+}
+
+void WsProtocol80::Write(WsOpcode aOpcode, const Brx& aData)
+{
+    Bws<kMaxHeaderBytes> header;
+    WriteHeader(header, aOpcode, aData.Bytes());
+    iWriteBuffer.WriteFlush(); // in case anything (e.g. the handshake) is still buffered
+    iFrame.clear();
+    iFrame.push_back(Brn(header));
+    iFrame.push_back(Brn(aData));
+    iSocket.WriteV(iFrame);
 }
 
 void WsProtocol80::Close(TUint16 aCode)
@@ -527,15 +716,21 @@ void WsProtocol80::Close(TUint16 aCode)
 DviSessionWebSocket::DviSessionWebSocket(DvStack& aDvStack, TIpAddress aInterface, TUint aPort)
     : iDvStack(aDvStack)
     , iEndpoint(aPort, aInterface)
+    , iProtocol(NULL)
+    , iFraming(WsPropertyUpdate::eRfc6455)
     , iExit(false)
     , iInterruptLock("WSIM")
     , iShutdownSem("WSIS", 1)
-    , iPropertyUpdates(kMaxPropertyUpdates)
+    , iAcceptPropertyUpdates(false)
+    , iWritingPropertyUpdates(false)
+    , iPropertyUpdateWaiters(0)
+    , iPropertyUpdateSpace("WSUS", 0)
 {
-    iReadBuffer = new Srs<1024>(*this);
+    iFrames.reserve(kMaxPropertyUpdates);
+    iReadBuffer = new Srs<kReadBufferBytes>(*this);
     iReaderUntil = new ReaderUntilS<kMaxRequestBytes>(*iReadBuffer);
     iReaderRequest = new ReaderHttpRequest(iDvStack.Env(), *iReaderUntil);
-    iWriterBuffer = new Sws<kMaxWriteBytes>(*this);
+    iWriterBuffer = new Swp(aDvStack.Env().Buffers(), kMaxWriteBytes, *this);
     iWriterResponse = new WriterHttpResponse(*iWriterBuffer);
 
     iReaderRequest->AddMethod(Http::kMethodGet);
@@ -564,11 +759,29 @@ DviSessionWebSocket::~DviSessionWebSocket()
     delete iReadBuffer;
 }
 
-void DviSessionWebSocket::QueuePropertyUpdate(Brh* aUpdate)
+void DviSessionWebSocket::QueuePropertyUpdate(WsPropertyUpdate* aUpdate)
 {
     iInterruptLock.Wait();
-    iPropertyUpdates.Write(aUpdate);
-    Interrupt(true);
+    for (;;) {
+        if (!iAcceptPropertyUpdates) {
+            iInterruptLock.Signal();
+            delete aUpdate;
+            return;
+        }
+        RemoveSupersededUpdates(*aUpdate);
+        if (iPropertyUpdates.size() < kMaxPropertyUpdates) {
+            break;
+        }
+        // queue is full of updates we can't discard; wait for Run() to write some
+        iPropertyUpdateWaiters++;
+        iInterruptLock.Signal();
+        iPropertyUpdateSpace.Wait();
+        iInterruptLock.Wait();
+    }
+    iPropertyUpdates.push_back(aUpdate);
+    if (!iWritingPropertyUpdates) { // WritePropertyUpdates will pick this up before returning
+        Interrupt(true);
+    }
     iInterruptLock.Signal();
 }
 
@@ -578,6 +791,9 @@ void DviSessionWebSocket::Run()
     iErrorStatus = &HttpStatus::kOk;
     iReaderRequest->Flush();
     iExit = false;
+    iInterruptLock.Wait();
+    iAcceptPropertyUpdates = true;
+    iInterruptLock.Signal();
     try {
         try {
             iReaderRequest->Read(kReadTimeoutMs);
@@ -618,7 +834,7 @@ void DviSessionWebSocket::Run()
                 DoRead();
             }
             catch (ReaderError&) {
-                if (iPropertyUpdates.SlotsUsed() == 0) {
+                if (!PropertyUpdatesPending()) {
                     LOG_ERROR(kDvWebSocket, "WS: Exception - ReaderError\n");
                     iProtocol->Close();
                     iExit = true;
@@ -641,9 +857,6 @@ void DviSessionWebSocket::Run()
         }
         delete iProtocol;
         iProtocol = NULL;
-        while (iPropertyUpdates.SlotsUsed() > 0) {
-            delete iPropertyUpdates.Read();
-        }
         Map::iterator it = iMap.begin();
         while (it != iMap.end()) {
             delete it->second;
@@ -651,6 +864,7 @@ void DviSessionWebSocket::Run()
         }
         iMap.clear();
     }
+    DiscardPropertyUpdates();
     iShutdownSem.Signal();
 }
 
@@ -663,9 +877,11 @@ void DviSessionWebSocket::Error(const HttpStatus& aStatus)
 void DviSessionWebSocket::Handshake()
 {
     if (iHeaderKey1.Received()) {
+        iFraming = WsPropertyUpdate::eHixie76;
         iProtocol = Handshake76();
     }
     else if (iHeadverKeyV8.Received()) {
+        iFraming = WsPropertyUpdate::eRfc6455;
         iProtocol = Handshake80();
     }
     else {
@@ -787,7 +1003,7 @@ WsProtocol* DviSessionWebSocket::Handshake80()
     stream.WriteFlush();
     iWriterResponse->WriteFlush();
 
-    return new WsProtocol80(*iReaderUntil, *iWriterBuffer);
+    return new WsProtocol80(*iReaderUntil, *iWriterBuffer, *this, kMaxMessageBytes);
 }
 
 void DviSessionWebSocket::DoRead()
@@ -943,20 +1159,91 @@ void DviSessionWebSocket::WriteSubscriptionRenewed(const Brx& aSid, TUint aSecon
 }
 
 void DviSessionWebSocket::WritePropertyUpdates()
+{
+    /* Updates are written outside iInterruptLock so that a slow client can't block
+       QueuePropertyUpdate.  The socket mustn't be interrupted while we're writing so
+       updates queued in the meantime are collected by looping rather than via Interrupt(). */
+    std::list<WsPropertyUpdate*> updates;
+    for (;;) {
+        iInterruptLock.Wait();
+        Interrupt(false);
+        updates.swap(iPropertyUpdates);
+        while (iPropertyUpdateWaiters > 0) {
+            iPropertyUpdateWaiters--;
+            iPropertyUpdateSpace.Signal();
+        }
+        iWritingPropertyUpdates = (updates.size() > 0);
+        iInterruptLock.Signal();
+        if (updates.size() == 0) {
+            return;
+        }
+        LOG(kDvWebSocket, "WS: Write %u property update(s)\n", (TUint)updates.size());
+        // all updates are pre-framed so can be sent in a single gather write
+        iFrames.clear();
+        std::list<WsPropertyUpdate*>::iterator it;
+        for (it = updates.begin(); it != updates.end(); ++it) {
+            iFrames.push_back((*it)->Frame());
+        }
+        TBool failed = false;
+        try {
+            WriteV(iFrames);
+        }
+        catch (WriterError&) {
+            failed = true;
+        }
+        iFrames.clear();
+        for (it = updates.begin(); it != updates.end(); ++it) {
+            delete *it;
+        }
+        updates.clear();
+        if (failed) {
+            iInterruptLock.Wait();
+            iWritingPropertyUpdates = false;
+            iInterruptLock.Signal();
+            THROW(WriterError);
+        }
+    }
+}
+
+TBool DviSessionWebSocket::PropertyUpdatesPending()
 {
     AutoMutex a(iInterruptLock);
-    Interrupt(false);
-    while (iPropertyUpdates.SlotsUsed() > 0) {
-        LOG(kDvWebSocket, "WS: Write property update\n");
-        Brh* msg = iPropertyUpdates.Read();
-        iProtocol->Write(*msg);
-        delete msg;
+    return (iPropertyUpdates.size() > 0);
+}
+
+void DviSessionWebSocket::RemoveSupersededUpdates(const WsPropertyUpdate& aUpdate)
+{ // called with iInterruptLock held
+    std::list<WsPropertyUpdate*>::iterator it = iPropertyUpdates.begin();
+    while (it != iPropertyUpdates.end()) {
+        if (aUpdate.Supersedes(**it)) {
+            LOG(kDvWebSocket, "WS: Discard superseded property update\n");
+            delete *it;
+            it = iPropertyUpdates.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void DviSessionWebSocket::DiscardPropertyUpdates()
+{
+    AutoMutex a(iInterruptLock);
+    iAcceptPropertyUpdates = false;
+    std::list<WsPropertyUpdate*>::iterator it;
+    for (it = iPropertyUpdates.begin(); it != iPropertyUpdates.end(); ++it) {
+        delete *it;
+    }
+    iPropertyUpdates.clear();
+    while (iPropertyUpdateWaiters > 0) {
+        iPropertyUpdateWaiters--;
+        iPropertyUpdateSpace.Signal();
     }
 }
 
 IPropertyWriter* DviSessionWebSocket::ClaimWriter(const IDviSubscriptionUserData* /*aUserData*/, const Brx& aSid, TUint aSequenceNumber)
 {
-    return PropertyWriterWs::Create(*this, aSid, aSequenceNumber);
+    return PropertyWriterWs::Create(*this, iFraming, aSid, aSequenceNumber);
 }
 
 void DviSessionWebSocket::ReleaseWriter(IPropertyWriter* aWriter)
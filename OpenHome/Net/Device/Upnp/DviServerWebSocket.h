@@ -8,12 +8,15 @@
 #include <OpenHome/Net/Private/Service.h>
 #include <OpenHome/Net/Core/OhNet.h>
 #include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/BufferPool.h>
 #include <OpenHome/Private/Http.h>
 #include <OpenHome/Exception.h>
 #include <OpenHome/Private/Fifo.h>
 #include <OpenHome/Net/Private/DviSubscription.h>
 
 #include <map>
+#include <list>
+#include <vector>
 
 EXCEPTION(WebSocketError)
 
@@ -136,20 +139,62 @@ private:
 
 class DviSessionWebSocket;
 
+/**
+ * Property update for a single subscription, framed once by the publisher thread.
+ *
+ * The payload is written after kMaxHeaderBytes of reserved space (and followed by
+ * kTrailerBytes) so framing never needs a second allocation or copy; the session
+ * passes Frame() straight to the socket.
+ */
+class WsPropertyUpdate : private INonCopyable
+{
+public:
+    static const TUint kMaxHeaderBytes = 10;
+    static const TUint kTrailerBytes = 1;
+    enum EFraming
+    {
+        eHixie76
+       ,eRfc6455
+    };
+public:
+    WsPropertyUpdate(Brh& aMsg, EFraming aFraming, const Brx& aSid, const Brx& aProperties); // takes ownership of aMsg
+    const Brn& Frame() const;
+    /**
+     * Returns true if this update carries newer values for every property in aOlder,
+     * for the same subscription, leaving aOlder with nothing left to tell a client.
+     */
+    TBool Supersedes(const WsPropertyUpdate& aOlder) const;
+private:
+    Brh iMsg;
+    Brn iFrame;
+    Brh iSid;
+    Brh iProperties; // space separated names
+};
+
 class PropertyWriterWs : public PropertyWriter
 {
 public:
-    static PropertyWriterWs* Create(DviSessionWebSocket& aSession, const Brx& aSid, TUint aSequenceNumber);
+    static PropertyWriterWs* Create(DviSessionWebSocket& aSession, WsPropertyUpdate::EFraming aFraming,
+                                    const Brx& aSid, TUint aSequenceNumber);
 private:
-    PropertyWriterWs(DviSessionWebSocket& aSession);
+    PropertyWriterWs(DviSessionWebSocket& aSession, WsPropertyUpdate::EFraming aFraming, const Brx& aSid);
     void WriteHeaders(const Brx& aSid, TUint aSequenceNumber);
+    void AddProperty(const Brx& aName);
 private: // IPropertyWriter
     ~PropertyWriterWs();
+    void PropertyWriteString(const Brx& aName, const Brx& aValue);
+    void PropertyWriteInt(const Brx& aName, TInt aValue);
+    void PropertyWriteUint(const Brx& aName, TUint aValue); // PropertyWriteBool is routed here too
+    void PropertyWriteBinary(const Brx& aName, const Brx& aValue);
     void PropertyWriteEnd();
 private:
     static const TUint kWriteBufGranularity = 1024;
+    static const TUint kPropertiesGranularity = 64;
     DviSessionWebSocket& iSession;
+    const WsPropertyUpdate::EFraming iFraming;
+    Brh iSid;
     WriterBwh iWriter;
+    WriterBwh iProperties;
 };
 
 class WsProtocol : private INonCopyable
@@ -170,6 +215,11 @@ class WsProtocol76 : public WsProtocol
 {
 public:
     WsProtocol76(ReaderUntil& aReaderUntil, Swx& aWriteBuffer);
+    /**
+     * Frame aPayloadBytes of text starting at aPayloadOffset of aBuf, using the (at least)
+     * 1 byte before and after the payload.  Returns the complete frame.
+     */
+    static Brn FrameInPlace(const Brx& aBuf, TUint aPayloadOffset, TUint aPayloadBytes);
 private:
     void Read(Brn& aData, TBool& aClosed);
     void Write(const Brx& aData);
@@ -181,11 +231,58 @@ private:
     static const TByte kMsgCloseEnd = (TByte)'\0';
 };
 
+/**
+ * Streaming decoder for RFC 6455 frames sent by a client.
+ *
+ * Payloads are read straight from the stream, so frames needn't fit in the reader's
+ * buffer.  Fragmented messages are reassembled into a growable buffer (of at most
+ * aMaxMessageBytes).  Control frames may arrive between fragments; they are returned
+ * as soon as they're read and any partially assembled message is kept.
+ */
+class WsFrameReader : private INonCopyable
+{
+public:
+    enum EFrame
+    {
+        eMessage
+       ,ePing
+       ,ePong
+       ,eClose
+       ,eInvalid
+    };
+    static const TUint16 kCloseProtocolError   = 1002;
+    static const TUint16 kCloseUnsupportedData = 1003;
+    static const TUint16 kCloseMsgTooBig       = 1009;
+    static const TUint kMaxControlBytes = 125;
+public:
+    WsFrameReader(ReaderUntil& aReader, TUint aMaxMessageBytes);
+    /**
+     * Block until a complete (text) message or a control frame is read.
+     * aData is valid until the next call.  eInvalid means the client broke the protocol
+     * and the connection should be closed with status aCloseCode.
+     * Throws ReaderError if the stream fails.
+     */
+    EFrame Read(Brn& aData, TUint16& aCloseCode);
+    /**
+     * XOR aBytes of aPtr with the 4 byte aMask, a 64-bit word at a time.
+     */
+    static void Unmask(TByte* aPtr, TUint aBytes, const TByte* aMask);
+private:
+    EFrame Invalid(TUint16 aCode, TUint16& aCloseCode);
+    void ReadPayload(Bwx& aBuf, TUint aBytes);
+private:
+    static const TUint kInitialMessageBytes = 1024;
+    ReaderUntil& iReader;
+    const TUint iMaxMessageBytes;
+    Bwh iMessage;
+    TBool iFragmented; // part of a message has been read; waiting for continuation frames
+    Bws<kMaxControlBytes> iControl;
+};
+
 class WsProtocol80 : public WsProtocol
 {
-    static const TUint kMaxRequestBytes = 4*1024;
 public:
-    WsProtocol80(ReaderUntil& aReaderUntil, Swx& aWriteBuffer);
+    WsProtocol80(ReaderUntil& aReaderUntil, Swx& aWriteBuffer, SocketTcp& aSocket, TUint aMaxMessageBytes);
 private:
     void Read(Brn& aData, TBool& aClosed);
     void Write(const Brx& aData);
@@ -200,16 +297,22 @@ private:
        ,ePing = 0x9
        ,ePong = 0xA
     };
-    static const TUint16 kCloseNormal          = 1000;
-    static const TUint16 kCloseProtocolError   = 1002;
-    static const TUint16 kCloseUnsupportedData = 1003;
-    static const TUint16 kCloseMsgTooLong      = 1004;
+    static const TUint16 kCloseNormal = 1000;
+    static const TUint kMaxHeaderBytes = 10;
+public:
+    /**
+     * Frame aPayloadBytes of text starting at aPayloadOffset of aBuf, writing the
+     * header into the (up to kMaxHeaderBytes) bytes before it.  Returns the complete frame.
+     */
+    static Brn FrameInPlace(const Brx& aBuf, TUint aPayloadOffset, TUint aPayloadBytes);
 private:
+    static void WriteHeader(Bwx& aHeader, WsOpcode aOpcode, TUint aDataLen);
     void Write(WsOpcode aOpcode, const Brx& aData);
     void Close(TUint16 aCode);
 private:
-    Bwh iMessage;
-    ReaderProtocolS<kMaxRequestBytes> iReaderProtocol;
+    SocketTcp& iSocket;
+    WsFrameReader iFrameReader;
+    std::vector<Brn> iFrame; // header, payload; written using a single gather write
 };
 
 class DviService;
@@ -219,7 +322,7 @@ class DviSessionWebSocket : public SocketTcpSession, private IPropertyWriterFact
 public:
     DviSessionWebSocket(DvStack& aDvStack, TIpAddress aInterface, TUint aPort);
     ~DviSessionWebSocket();
-    void QueuePropertyUpdate(Brh* aUpdate);
+    void QueuePropertyUpdate(WsPropertyUpdate* aUpdate);
 private:
     enum WsOpcode
     {
@@ -243,6 +346,9 @@ private:
     void WriteSubscriptionSid(const Brx& aDevice, const Brx& aService, const Brx& aSid, TUint aSeconds);
     void WriteSubscriptionRenewed(const Brx& aSid, TUint aSeconds);
     void WritePropertyUpdates();
+    TBool PropertyUpdatesPending();
+    void RemoveSupersededUpdates(const WsPropertyUpdate& aUpdate);
+    void DiscardPropertyUpdates();
 private: // IPropertyWriterFactory
     IPropertyWriter* ClaimWriter(const IDviSubscriptionUserData* aUserData,
                                  const Brx& aSid, TUint aSequenceNumber);
@@ -266,6 +372,8 @@ private:
     };
 public:
     static const TUint kMaxRequestBytes = 4*1024;
+    static const TUint kMaxMessageBytes = 4*1024*1024; // limits the size of a (reassembled) message from a client
+    static const TUint kReadBufferBytes = 8*1024;
     static const TUint kMaxWriteBytes = 4*1024;
     static const TUint kMaxPropertyUpdates = 20;
     static const TUint kReadTimeoutMs = 5 * 1000;
@@ -275,7 +383,7 @@ private:
     Srx* iReadBuffer;
     ReaderUntil* iReaderUntil;
     ReaderHttpRequest* iReaderRequest;
-    Sws<kMaxWriteBytes>* iWriterBuffer;
+    Swp* iWriterBuffer;
     WriterHttpResponse* iWriterResponse;
     HttpHeaderHost iHeaderHost;
     HttpHeaderConnection iHeaderConnection;
@@ -289,12 +397,19 @@ private:
     HttpHeaderContentLength iHeaderContentLength;
     const HttpStatus* iErrorStatus;
     WsProtocol* iProtocol;
+    WsPropertyUpdate::EFraming iFraming;
     TBool iExit;
     typedef std::map<Brn,SubscriptionWrapper*,BufferCmp> Map;
     Map iMap;
     Mutex iInterruptLock;
     Semaphore iShutdownSem;
-    Fifo<Brh*> iPropertyUpdates; // used for web sockets
+    // iPropertyUpdates, iAcceptPropertyUpdates, iWritingPropertyUpdates and iPropertyUpdateWaiters are protected by iInterruptLock
+    std::list<WsPropertyUpdate*> iPropertyUpdates;
+    TBool iAcceptPropertyUpdates;
+    TBool iWritingPropertyUpdates;
+    TUint iPropertyUpdateWaiters;
+    Semaphore iPropertyUpdateSpace;
+    std::vector<Brn> iFrames;
 };
 
 class DviServerWebSocket : public DviServer
@@ -8,6 +8,7 @@
 #include <OpenHome/Net/Private/Ssdp.h>
 #include <OpenHome/Private/Debug.h>
 #include <OpenHome/Private/Printer.h>
+#include <OpenHome/Private/Ascii.h>
 #include <OpenHome/OsWrapper.h>
 
 #include <climits>
@@ -120,117 +121,375 @@ void SsdpNotifierScheduler::LogNotifierStart(const TChar* aType, TIpAddress addr
 }
 
 
-// MsearchResponse
+// MsearchResponder
 
 #define NEXT_MSG_ROOT         (0)
 #define NEXT_MSG_UUID         (1)
 #define NEXT_MSG_DEVICE_TYPE  (2)
 #define NEXT_MSG_SERVICE_TYPE (3)
-const TUint MsearchResponse::kServiceVersionOverrideDisabled = 0;
+const TUint MsearchResponder::kServiceVersionOverrideDisabled = 0;
+const TUint MsearchResponder::kMaxPendingMsgs = 4096;
+const TUint MsearchResponder::kMaxPendingMsgsPerRequester = 512;
 
-MsearchResponse::MsearchResponse(DvStack& aDvStack, ISsdpNotifyListener& aListener)
-    : SsdpNotifierScheduler(aDvStack, aListener, "MSearchResponse")
-    , iAnnouncementData(NULL)
-    , iServiceVersionOverride(kServiceVersionOverrideDisabled)
+MsearchResponder::MsearchResponder(DvStack& aDvStack)
+    : iDvStack(aDvStack)
+    , iLock("DVMR")
+    , iResponder(aDvStack)
 {
-    iNotifier = new SsdpMsearchResponder(aDvStack);
+    Functor functor = MakeFunctor(*this, &MsearchResponder::TimerExpired);
+    iTimer = new Timer(iDvStack.Env(), functor, "MsearchResponder");
 }
 
-MsearchResponse::~MsearchResponse()
+MsearchResponder::~MsearchResponder()
 {
-    delete iNotifier;
+    delete iTimer;
+    iMsgs.clear();
+    for (std::list<Request*>::iterator it = iRequests.begin(); it != iRequests.end(); ++it) {
+        delete *it;
+    }
 }
 
-void MsearchResponse::StartAll(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
+void MsearchResponder::StartAll(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
 {
-    LogNotifierStart("StartAll", aRemote.Address());
-    TUint nextMsgIndex = NEXT_MSG_ROOT;
+    TUint firstMsgIndex = NEXT_MSG_ROOT;
     TUint msgCount = 3 + aAnnouncementData.ServiceCount();
     if (!aAnnouncementData.IsRoot()) {
         msgCount--;
-        nextMsgIndex = NEXT_MSG_UUID;
+        firstMsgIndex = NEXT_MSG_UUID;
     }
-    Start(aAnnouncementData, msgCount, nextMsgIndex, aRemote, aMx, aUri, aConfigId, aAdapter);
+    Start(eSearchAll, Brx::Empty(), aAnnouncementData, firstMsgIndex, msgCount, aRemote, aMx, aUri, aConfigId, aAdapter, kServiceVersionOverrideDisabled);
 }
 
-void MsearchResponse::StartRoot(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
+void MsearchResponder::StartRoot(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
 {
-    LogNotifierStart("StartRoot", aRemote.Address());
-    Start(aAnnouncementData, 1, NEXT_MSG_ROOT, aRemote, aMx, aUri, aConfigId, aAdapter);
+    Start(eSearchRoot, Brx::Empty(), aAnnouncementData, NEXT_MSG_ROOT, 1, aRemote, aMx, aUri, aConfigId, aAdapter, kServiceVersionOverrideDisabled);
 }
 
-void MsearchResponse::StartUuid(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
+void MsearchResponder::StartUuid(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
 {
-    LogNotifierStart("StartUuid", aRemote.Address());
-    Start(aAnnouncementData, 1, NEXT_MSG_UUID, aRemote, aMx, aUri, aConfigId, aAdapter);
+    Start(eSearchUuid, aAnnouncementData.Udn(), aAnnouncementData, NEXT_MSG_UUID, 1, aRemote, aMx, aUri, aConfigId, aAdapter, kServiceVersionOverrideDisabled);
 }
 
-void MsearchResponse::StartDeviceType(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
+void MsearchResponder::StartDeviceType(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
 {
-    LogNotifierStart("StartDeviceType", aRemote.Address());
-    Start(aAnnouncementData, 1, NEXT_MSG_DEVICE_TYPE, aRemote, aMx, aUri, aConfigId, aAdapter);
+    // responses always report the device's own version so searches for any version of a type are equivalent
+    Bws<Request::kMaxTargetBytes> target;
+    target.Append(aAnnouncementData.Domain());
+    target.Append(':');
+    target.Append(aAnnouncementData.Type());
+    Start(eSearchDeviceType, target, aAnnouncementData, NEXT_MSG_DEVICE_TYPE, 1, aRemote, aMx, aUri, aConfigId, aAdapter, kServiceVersionOverrideDisabled);
 }
 
-void MsearchResponse::StartServiceType(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const OpenHome::Net::ServiceType& aServiceType, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter, TUint aServiceVersionOverride)
+void MsearchResponder::StartServiceType(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const OpenHome::Net::ServiceType& aServiceType, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter, TUint aServiceVersionOverride)
 {
-    LogNotifierStart("StartServiceType", aRemote.Address());
     TUint index = 0;
     for (;;) {
         const OpenHome::Net::ServiceType& st = aAnnouncementData.Service(index).ServiceType();
         if (st.Domain() == aServiceType.Domain() && st.Name() == aServiceType.Name()) {
             if (aServiceVersionOverride != kServiceVersionOverrideDisabled) {
                 ASSERT(aServiceVersionOverride <= st.Version()); // can report a lower service version but must not claim support for a more recent version
-                iServiceVersionOverride = aServiceVersionOverride;
             }
             break;
         }
         index++;
     }
-    Start(aAnnouncementData, 1, NEXT_MSG_SERVICE_TYPE + index, aRemote, aMx, aUri, aConfigId, aAdapter);
+    Bws<Request::kMaxTargetBytes> target;
+    target.Append(aServiceType.Domain());
+    target.Append(':');
+    target.Append(aServiceType.Name());
+    target.Append(':');
+    Ascii::AppendDec(target, aServiceVersionOverride);
+    Start(eSearchServiceType, target, aAnnouncementData, NEXT_MSG_SERVICE_TYPE + index, 1, aRemote, aMx, aUri, aConfigId, aAdapter, aServiceVersionOverride);
 }
 
-Endpoint MsearchResponse::Remote() const
+void MsearchResponder::Stop(const Brx& aUdn)
 {
-    return iRemote;
+    AutoMutex a(iLock);
+    MsgSchedule::iterator it = iMsgs.begin();
+    while (it != iMsgs.end()) {
+        Response& response = it->second.Resp();
+        if (response.AnnouncementData().Udn() != aUdn) {
+            ++it;
+        }
+        else {
+            it = iMsgs.erase(it);
+            if (response.RemoveMsg()) {
+                Release(response);
+            }
+        }
+    }
 }
 
-void MsearchResponse::Start(IUpnpAnnouncementData& aAnnouncementData, TUint aTotalMsgs, TUint aNextMsgIndex, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
+void MsearchResponder::Start(ESearchType aType, const Brx& aTarget, IUpnpAnnouncementData& aAnnouncementData, TUint aFirstMsgIndex, TUint aMsgCount,
+                             const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter, TUint aServiceVersionOverride)
 {
-    iAnnouncementData = &aAnnouncementData;
-    iNextMsgIndex = aNextMsgIndex;
-    iRemainingMsgs = aTotalMsgs;
-    static_cast<SsdpMsearchResponder*>(iNotifier)->SetRemote(aRemote, aConfigId, aAdapter);
-    iRemote = aRemote;
-    iUri.Replace(aUri);
-    SsdpNotifierScheduler::Start(aMx * 1000, iRemainingMsgs);
+    AutoMutex a(iLock);
+    Endpoint::EndpointBuf epBuf;
+    Request* request = NULL;
+    for (std::list<Request*>::iterator it = iRequests.begin(); it != iRequests.end(); ++it) {
+        if ((*it)->Matches(aType, aRemote, aTarget)) {
+            request = *it;
+            break;
+        }
+    }
+    if (request != NULL && request->Contains(aAnnouncementData)) {
+        aRemote.AppendEndpoint(epBuf);
+        LOG(kDvSsdpNotifier, "MsearchResponder ignoring repeated msearch from %.*s for %.*s\n", PBUF(epBuf), PBUF(aAnnouncementData.Udn()));
+        return;
+    }
+    if (iMsgs.size() + aMsgCount > kMaxPendingMsgs) {
+        aRemote.AppendEndpoint(epBuf);
+        LOG(kDvSsdpNotifier, "MsearchResponder ignoring excess msearch from %.*s\n", PBUF(epBuf));
+        THROW(MsearchResponseLimit);
+    }
+    if (PendingMsgsForRequester(aRemote) + aMsgCount > kMaxPendingMsgsPerRequester) {
+        aRemote.AppendEndpoint(epBuf);
+        LOG(kDvSsdpNotifier, "MsearchResponder ignoring excess msearch from %.*s (requester limit)\n", PBUF(epBuf));
+        THROW(MsearchResponseLimit);
+    }
+    if (request == NULL) {
+        request = new Request(aType, aRemote, aTarget);
+        iRequests.push_back(request);
+    }
+    Response& response = request->AddResponse(aAnnouncementData, aUri, aConfigId, aAdapter, aServiceVersionOverride);
+    Environment& env = iDvStack.Env();
+    const TUint timeNow = Os::TimeInMs(env.OsCtx());
+    const TUint maxDelay = aMx * 1000;
+    for (TUint i=0; i<aMsgCount; i++) {
+        const TUint delay = (maxDelay == 0? 0 : env.Random(maxDelay));
+        (void)iMsgs.insert(MsgSchedule::value_type(timeNow + delay, Msg(response, aFirstMsgIndex + i)));
+        response.AddMsg();
+    }
+    ScheduleTimer(timeNow);
 }
 
-TUint MsearchResponse::NextMsg()
+TUint MsearchResponder::PendingMsgsForRequester(const Endpoint& aRemote) const
 {
-    switch (iNextMsgIndex)
+    // requesters are identified by address only; a control point may search from several ports
+    const TIpAddress address = aRemote.Address();
+    TUint pending = 0;
+    for (std::list<Request*>::const_iterator it = iRequests.begin(); it != iRequests.end(); ++it) {
+        if (TIpAddressUtils::Equals((*it)->Remote().Address(), address)) {
+            pending += (*it)->PendingMsgs();
+        }
+    }
+    return pending;
+}
+
+void MsearchResponder::Send(const Msg& aMsg)
+{
+    Response& response = aMsg.Resp();
+    IUpnpAnnouncementData& data = response.AnnouncementData();
+    iResponder.SetRemote(response.Req().Remote(), response.ConfigId(), response.Adapter());
+    const TUint index = aMsg.Index();
+    switch (index)
     {
-    case 0:
-        iNotifier->SsdpNotifyRoot(iAnnouncementData->Udn(), iUri);
+    case NEXT_MSG_ROOT:
+        iResponder.SsdpNotifyRoot(data.Udn(), response.Uri());
         break;
-    case 1:
-        iNotifier->SsdpNotifyUuid(iAnnouncementData->Udn(), iUri);
+    case NEXT_MSG_UUID:
+        iResponder.SsdpNotifyUuid(data.Udn(), response.Uri());
         break;
-    case 2:
-        iNotifier->SsdpNotifyDeviceType(iAnnouncementData->Domain(), iAnnouncementData->Type(), iAnnouncementData->Version(), iAnnouncementData->Udn(), iUri);
+    case NEXT_MSG_DEVICE_TYPE:
+        iResponder.SsdpNotifyDeviceType(data.Domain(), data.Type(), data.Version(), data.Udn(), response.Uri());
         break;
     default:
-        DviService& service = iAnnouncementData->Service(iNextMsgIndex - 3);
-        const OpenHome::Net::ServiceType& serviceType = service.ServiceType();
+        const OpenHome::Net::ServiceType& serviceType = data.Service(index - NEXT_MSG_SERVICE_TYPE).ServiceType();
         TUint version = serviceType.Version();
-        if (iServiceVersionOverride != kServiceVersionOverrideDisabled) {
-            version = iServiceVersionOverride;
-            iServiceVersionOverride = kServiceVersionOverrideDisabled;
+        if (response.ServiceVersionOverride() != kServiceVersionOverrideDisabled) {
+            version = response.ServiceVersionOverride();
         }
-        iNotifier->SsdpNotifyServiceType(serviceType.Domain(), serviceType.Name(), version, iAnnouncementData->Udn(), iUri);
+        iResponder.SsdpNotifyServiceType(serviceType.Domain(), serviceType.Name(), version, data.Udn(), response.Uri());
         break;
     }
-    iNextMsgIndex++;
-    return --iRemainingMsgs;
+}
+
+void MsearchResponder::Release(Response& aResponse)
+{
+    Request& request = aResponse.Req();
+    if (request.RemoveResponse(aResponse)) {
+        iRequests.remove(&request);
+        delete &request;
+    }
+}
+
+void MsearchResponder::ScheduleTimer(TUint aTimeNow)
+{
+    if (iMsgs.size() == 0) {
+        return;
+    }
+    TInt delay = (TInt)(iMsgs.begin()->first - aTimeNow);
+    if (delay < 0) {
+        delay = 0;
+    }
+    iTimer->FireIn((TUint)delay);
+}
+
+void MsearchResponder::TimerExpired()
+{
+    AutoMutex a(iLock);
+    const TUint timeNow = Os::TimeInMs(iDvStack.Env().OsCtx());
+    /* If the clock wraps while responses are pending, any due before the wrap
+       are sent with those due soon after it; this is at worst MX secs late.
+       TimerManager runs timers due up to now+1 so send those too; re-arming for
+       now+1 would run this callback again in the same pass. */
+    MsgSchedule::iterator it = iMsgs.begin();
+    while (it != iMsgs.end() && (TInt)(it->first - timeNow) <= 1) {
+        Response& response = it->second.Resp();
+        try {
+            Send(it->second);
+        }
+        catch (WriterError&) {
+            LOG_ERROR(kDvDevice, "WriterError from MsearchResponder::TimerExpired()\n");
+        }
+        catch (NetworkError&) {
+            LOG_ERROR(kDvDevice, "NetworkError from MsearchResponder::TimerExpired()\n");
+        }
+        it = iMsgs.erase(it);
+        if (response.RemoveMsg()) {
+            Release(response);
+        }
+    }
+    ScheduleTimer(timeNow);
+}
+
+
+// MsearchResponder::Response
+
+MsearchResponder::Response::Response(Request& aRequest, IUpnpAnnouncementData& aAnnouncementData, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter, TUint aServiceVersionOverride)
+    : iRequest(aRequest)
+    , iAnnouncementData(aAnnouncementData)
+    , iUri(aUri)
+    , iConfigId(aConfigId)
+    , iAdapter(aAdapter)
+    , iServiceVersionOverride(aServiceVersionOverride)
+    , iPendingMsgs(0)
+{
+}
+
+MsearchResponder::Request& MsearchResponder::Response::Req()
+{
+    return iRequest;
+}
+
+IUpnpAnnouncementData& MsearchResponder::Response::AnnouncementData()
+{
+    return iAnnouncementData;
+}
+
+const Brx& MsearchResponder::Response::Uri() const
+{
+    return iUri;
+}
+
+TUint MsearchResponder::Response::ConfigId() const
+{
+    return iConfigId;
+}
+
+TIpAddress MsearchResponder::Response::Adapter() const
+{
+    return iAdapter;
+}
+
+TUint MsearchResponder::Response::ServiceVersionOverride() const
+{
+    return iServiceVersionOverride;
+}
+
+void MsearchResponder::Response::AddMsg()
+{
+    iPendingMsgs++;
+}
+
+TBool MsearchResponder::Response::RemoveMsg()
+{
+    ASSERT(iPendingMsgs > 0);
+    return (--iPendingMsgs == 0);
+}
+
+TUint MsearchResponder::Response::PendingMsgs() const
+{
+    return iPendingMsgs;
+}
+
+
+// MsearchResponder::Request
+
+MsearchResponder::Request::Request(ESearchType aType, const Endpoint& aRemote, const Brx& aTarget)
+    : iType(aType)
+    , iRemote(aRemote)
+    , iTarget(aTarget)
+{
+}
+
+MsearchResponder::Request::~Request()
+{
+    for (std::list<Response*>::iterator it = iResponses.begin(); it != iResponses.end(); ++it) {
+        delete *it;
+    }
+}
+
+TBool MsearchResponder::Request::Matches(ESearchType aType, const Endpoint& aRemote, const Brx& aTarget) const
+{
+    return (iType == aType && iRemote == aRemote && iTarget == aTarget);
+}
+
+TBool MsearchResponder::Request::Contains(const IUpnpAnnouncementData& aAnnouncementData) const
+{
+    for (std::list<Response*>::const_iterator it = iResponses.begin(); it != iResponses.end(); ++it) {
+        if (&(*it)->AnnouncementData() == &aAnnouncementData) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const Endpoint& MsearchResponder::Request::Remote() const
+{
+    return iRemote;
+}
+
+MsearchResponder::Response& MsearchResponder::Request::AddResponse(IUpnpAnnouncementData& aAnnouncementData, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter, TUint aServiceVersionOverride)
+{
+    Response* response = new Response(*this, aAnnouncementData, aUri, aConfigId, aAdapter, aServiceVersionOverride);
+    iResponses.push_back(response);
+    return *response;
+}
+
+TBool MsearchResponder::Request::RemoveResponse(Response& aResponse)
+{
+    iResponses.remove(&aResponse);
+    delete &aResponse;
+    return (iResponses.size() == 0);
+}
+
+TUint MsearchResponder::Request::PendingMsgs() const
+{
+    TUint pending = 0;
+    for (std::list<Response*>::const_iterator it = iResponses.begin(); it != iResponses.end(); ++it) {
+        pending += (*it)->PendingMsgs();
+    }
+    return pending;
+}
+
+
+// MsearchResponder::Msg
+
+MsearchResponder::Msg::Msg(Response& aResponse, TUint aIndex)
+    : iResponse(&aResponse)
+    , iIndex(aIndex)
+{
+}
+
+MsearchResponder::Response& MsearchResponder::Msg::Resp() const
+{
+    return *iResponse;
+}
+
+TUint MsearchResponder::Msg::Index() const
+{
+    return iIndex;
 }
 
 
@@ -314,12 +573,11 @@ void DeviceAnnouncement::NotifyComplete(TBool aCancelled)
 
 // DviSsdpNotifierManager
 
-const TUint DviSsdpNotifierManager::kMaxMsearchResponses = 2;
-
 DviSsdpNotifierManager::DviSsdpNotifierManager(DvStack& aDvStack)
     : iDvStack(aDvStack)
     , iLock("DVDM")
     , iShutdownSem("DVDM", 1)
+    , iMsearchResponder(aDvStack)
 {
     iDvStack.Env().InitParams()->GetDvAnnouncementIntervals(iAnnounceIntervalByeBye, iAnnounceIntervalAlive);
 }
@@ -332,9 +590,7 @@ DviSsdpNotifierManager::~DviSsdpNotifierManager()
     iLock.Wait();
     iLock.Signal();
 
-    ASSERT(iActiveResponders.size() == 0);
     ASSERT(iActiveAnnouncers.size() == 0);
-    Delete(iFreeResponders);
     Delete(iFreeAnnouncers);
 }
 
@@ -386,9 +642,7 @@ void DviSsdpNotifierManager::AnnouncementUpdate(IUpnpAnnouncementData& aAnnounce
 void DviSsdpNotifierManager::MsearchResponseAll(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
 {
     try {
-        AutoMutex a(iLock);
-        Responder* responder = GetResponder(aAnnouncementData, aRemote);
-        responder->Response().StartAll(aAnnouncementData, aRemote, aMx, aUri, aConfigId, aAdapter);
+        iMsearchResponder.StartAll(aAnnouncementData, aRemote, aMx, aUri, aConfigId, aAdapter);
     }
     catch (MsearchResponseLimit&) {}
 }
@@ -396,9 +650,7 @@ void DviSsdpNotifierManager::MsearchResponseAll(IUpnpAnnouncementData& aAnnounce
 void DviSsdpNotifierManager::MsearchResponseRoot(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
 {
     try {
-        AutoMutex a(iLock);
-        Responder* responder = GetResponder(aAnnouncementData, aRemote);
-        responder->Response().StartRoot(aAnnouncementData, aRemote, aMx, aUri, aConfigId, aAdapter);
+        iMsearchResponder.StartRoot(aAnnouncementData, aRemote, aMx, aUri, aConfigId, aAdapter);
     }
     catch (MsearchResponseLimit&) {}
 }
@@ -406,9 +658,7 @@ void DviSsdpNotifierManager::MsearchResponseRoot(IUpnpAnnouncementData& aAnnounc
 void DviSsdpNotifierManager::MsearchResponseUuid(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
 {
     try {
-        AutoMutex a(iLock);
-        Responder* responder = GetResponder(aAnnouncementData, aRemote);
-        responder->Response().StartUuid(aAnnouncementData, aRemote, aMx, aUri, aConfigId, aAdapter);
+        iMsearchResponder.StartUuid(aAnnouncementData, aRemote, aMx, aUri, aConfigId, aAdapter);
     }
     catch (MsearchResponseLimit&) {}
 }
@@ -416,9 +666,7 @@ void DviSsdpNotifierManager::MsearchResponseUuid(IUpnpAnnouncementData& aAnnounc
 void DviSsdpNotifierManager::MsearchResponseDeviceType(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter)
 {
     try {
-        AutoMutex a(iLock);
-        Responder* responder = GetResponder(aAnnouncementData, aRemote);
-        responder->Response().StartDeviceType(aAnnouncementData, aRemote, aMx, aUri, aConfigId, aAdapter);
+        iMsearchResponder.StartDeviceType(aAnnouncementData, aRemote, aMx, aUri, aConfigId, aAdapter);
     }
     catch (MsearchResponseLimit&) {}
 }
@@ -426,9 +674,7 @@ void DviSsdpNotifierManager::MsearchResponseDeviceType(IUpnpAnnouncementData& aA
 void DviSsdpNotifierManager::MsearchResponseServiceType(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const OpenHome::Net::ServiceType& aServiceType, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter, TUint aServiceVersionOverride)
 {
     try {
-        AutoMutex a(iLock);
-        Responder* responder = GetResponder(aAnnouncementData, aRemote);
-        responder->Response().StartServiceType(aAnnouncementData, aRemote, aMx, aServiceType, aUri, aConfigId, aAdapter, aServiceVersionOverride);
+        iMsearchResponder.StartServiceType(aAnnouncementData, aRemote, aMx, aServiceType, aUri, aConfigId, aAdapter, aServiceVersionOverride);
     }
     catch (MsearchResponseLimit&) {}
 }
@@ -436,8 +682,8 @@ void DviSsdpNotifierManager::MsearchResponseServiceType(IUpnpAnnouncementData& a
 void DviSsdpNotifierManager::Stop(const Brx& aUdn)
 {
     LOG(kDvSsdpNotifier, "DviSsdpNotifierManager::Stop(%.*s)\n", PBUF(aUdn));
+    iMsearchResponder.Stop(aUdn);
     iLock.Wait();
-    Stop(iActiveResponders, aUdn);
     Stop(iActiveAnnouncers, aUdn);
     iLock.Signal();
 }
@@ -462,38 +708,6 @@ void DviSsdpNotifierManager::Delete(std::list<Notifier*>& aList)
     }
 }
 
-DviSsdpNotifierManager::Responder* DviSsdpNotifierManager::GetResponder(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote)
-{
-    TUint responsesCount = 0; // Active responses for the device described by "aAnnouncementData" to endpoint "aRemote".
-    for (std::list<Notifier*>::iterator it = iActiveResponders.begin(); it != iActiveResponders.end(); ++it) {
-        Responder& responder = static_cast<Responder&>(**it);
-        Endpoint remote = responder.Response().Remote();
-        const TBool udnMatches = responder.MatchesDevice(aAnnouncementData.Udn());
-        if (remote == aRemote && udnMatches) {
-            if (++responsesCount > kMaxMsearchResponses) {
-                Endpoint::EndpointBuf epBuf;
-                remote.AppendEndpoint(epBuf);
-                LOG(kDvSsdpNotifier, "DviSsdpNotifierManager ignoring excess msearch from %.*s\n", PBUF(epBuf));
-                THROW(MsearchResponseLimit);
-            }
-        }
-    }
-
-    DviSsdpNotifierManager::Responder* responder;
-    if (iFreeResponders.size() == 0) {
-        MsearchResponse* msr = new MsearchResponse(iDvStack, *this);
-        responder = new Responder(msr);
-        iActiveResponders.push_back(responder);
-    }
-    else {
-        responder = static_cast<DviSsdpNotifierManager::Responder*>(iFreeResponders.front());
-        iActiveResponders.splice(iActiveResponders.end(), iFreeResponders, iFreeResponders.begin());
-    }
-    (void)iShutdownSem.Clear();
-    responder->SetActive(aAnnouncementData.Udn());
-    return responder;
-}
-
 DviSsdpNotifierManager::Announcer* DviSsdpNotifierManager::GetAnnouncer(IUpnpAnnouncementData& aAnnouncementData)
 {
     DviSsdpNotifierManager::Announcer* announcer;
@@ -519,13 +733,11 @@ DviSsdpNotifierManager::Announcer* DviSsdpNotifierManager::GetAnnouncer(IUpnpAnn
 void DviSsdpNotifierManager::NotifySchedulerComplete(SsdpNotifierScheduler* aScheduler)
 {
     iLock.Wait();
-    if (!TryMove(aScheduler, iActiveResponders, iFreeResponders)) {
-        const TBool matched = TryMove(aScheduler, iActiveAnnouncers, iFreeAnnouncers);
-        if (!matched) {
-            ASSERTS(); // MSVC will warn about const conditional expr if we ASSERT(TryMove(...
-        }
+    const TBool matched = TryMove(aScheduler, iActiveAnnouncers, iFreeAnnouncers);
+    if (!matched) {
+        ASSERTS(); // MSVC will warn about const conditional expr if we ASSERT(TryMove(...
     }
-    if (iActiveResponders.size() == 0 && iActiveAnnouncers.size() == 0) {
+    if (iActiveAnnouncers.size() == 0) {
         iShutdownSem.Signal();
     }
     iLock.Signal();
@@ -580,19 +792,6 @@ DviSsdpNotifierManager::Notifier::Notifier(SsdpNotifierScheduler* aScheduler)
 }
 
 
-// DviSsdpNotifierManager::Responder
-
-DviSsdpNotifierManager::Responder::Responder(MsearchResponse* aResponder)
-    : DviSsdpNotifierManager::Notifier(aResponder)
-{
-}
-
-MsearchResponse& DviSsdpNotifierManager::Responder::Response()
-{
-    return *static_cast<MsearchResponse*>(iScheduler);
-}
-
-
 // DviSsdpNotifierManager::Announcer
 
 DviSsdpNotifierManager::Announcer::Announcer(DeviceAnnouncement* aAnnouncer)
@@ -9,6 +9,8 @@
 #include <OpenHome/Net/Private/Ssdp.h>
 
 #include <vector>
+#include <list>
+#include <map>
 
 EXCEPTION(MsearchResponseLimit)
 
@@ -52,32 +54,108 @@ private:
 };
 
 
-class MsearchResponse : public SsdpNotifierScheduler
+/**
+ * Sends m-search responses for all devices from a single timer.
+ *
+ * Pending responses are grouped by requester (remote endpoint) and search target, across
+ * all devices.  A search repeated by the same requester while responses to it are still
+ * pending (i.e. within its MX window) is ignored.  Each message is sent at a random time
+ * within the MX window.  The total number of pending messages is capped, as is the number
+ * pending for any one requester (IP address) so that a single noisy control point can't
+ * use up the whole budget.
+ */
+class MsearchResponder : private INonCopyable
 {
 public:
     static const TUint kServiceVersionOverrideDisabled;
+    static const TUint kMaxPendingMsgs;
+    static const TUint kMaxPendingMsgsPerRequester;
 public:
-    MsearchResponse(DvStack& aDvStack, ISsdpNotifyListener& aListener);
-    ~MsearchResponse();
+    MsearchResponder(DvStack& aDvStack);
+    ~MsearchResponder();
     void StartAll(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter);
     void StartRoot(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter);
     void StartUuid(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter);
     void StartDeviceType(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter);
     void StartServiceType(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const OpenHome::Net::ServiceType& aServiceType, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter, TUint aServiceVersionOverride = kServiceVersionOverrideDisabled);
-    Endpoint Remote() const;
+    void Stop(const Brx& aUdn);
 private:
-    void Start(IUpnpAnnouncementData& aAnnouncementData, TUint aTotalMsgs, TUint aNextMsgIndex, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter);
-private: // from DviMsg
-    TUint NextMsg();
+    enum ESearchType
+    {
+        eSearchAll
+       ,eSearchRoot
+       ,eSearchUuid
+       ,eSearchDeviceType
+       ,eSearchServiceType
+    };
+    class Request;
+    class Response : private INonCopyable
+    {
+    public:
+        Response(Request& aRequest, IUpnpAnnouncementData& aAnnouncementData, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter, TUint aServiceVersionOverride);
+        Request& Req();
+        IUpnpAnnouncementData& AnnouncementData();
+        const Brx& Uri() const;
+        TUint ConfigId() const;
+        TIpAddress Adapter() const;
+        TUint ServiceVersionOverride() const;
+        void AddMsg();
+        TBool RemoveMsg(); // returns true if this was the last pending msg
+        TUint PendingMsgs() const;
+    private:
+        static const TUint kMaxUriBytes = 256;
+        Request& iRequest;
+        IUpnpAnnouncementData& iAnnouncementData;
+        Bws<kMaxUriBytes> iUri;
+        TUint iConfigId;
+        TIpAddress iAdapter;
+        TUint iServiceVersionOverride;
+        TUint iPendingMsgs;
+    };
+    class Request : private INonCopyable
+    {
+    public:
+        static const TUint kMaxTargetBytes = 256;
+    public:
+        Request(ESearchType aType, const Endpoint& aRemote, const Brx& aTarget);
+        ~Request();
+        TBool Matches(ESearchType aType, const Endpoint& aRemote, const Brx& aTarget) const;
+        TBool Contains(const IUpnpAnnouncementData& aAnnouncementData) const;
+        const Endpoint& Remote() const;
+        Response& AddResponse(IUpnpAnnouncementData& aAnnouncementData, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter, TUint aServiceVersionOverride);
+        TBool RemoveResponse(Response& aResponse); // returns true if no responses remain
+        TUint PendingMsgs() const;
+    private:
+        ESearchType iType;
+        Endpoint iRemote;
+        Bws<kMaxTargetBytes> iTarget;
+        std::list<Response*> iResponses;
+    };
+    class Msg
+    {
+    public:
+        Msg(Response& aResponse, TUint aIndex);
+        Response& Resp() const;
+        TUint Index() const;
+    private:
+        Response* iResponse;
+        TUint iIndex;
+    };
+    typedef std::multimap<TUint, Msg> MsgSchedule; // keyed by time (in ms) each Msg is due
 private:
-    static const TUint kMaxUriBytes = 256;
-    IUpnpAnnouncementData* iAnnouncementData;
-    ISsdpNotify* iNotifier;
-    Endpoint iRemote;
-    Bws<kMaxUriBytes> iUri;
-    TUint iRemainingMsgs;
-    TUint iNextMsgIndex;
-    TUint iServiceVersionOverride;
+    void Start(ESearchType aType, const Brx& aTarget, IUpnpAnnouncementData& aAnnouncementData, TUint aFirstMsgIndex, TUint aMsgCount, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter, TUint aServiceVersionOverride);
+    TUint PendingMsgsForRequester(const Endpoint& aRemote) const;
+    void Send(const Msg& aMsg);
+    void Release(Response& aResponse);
+    void ScheduleTimer(TUint aTimeNow);
+    void TimerExpired();
+private:
+    DvStack& iDvStack;
+    Mutex iLock;
+    Timer* iTimer;
+    SsdpMsearchResponder iResponder;
+    std::list<Request*> iRequests;
+    MsgSchedule iMsgs;
 };
 
 class DeviceAnnouncement : public SsdpNotifierScheduler
@@ -111,7 +189,6 @@ private:
 
 class DviSsdpNotifierManager : private ISsdpNotifyListener
 {
-    static const TUint kMaxMsearchResponses; // Maximum number of pending m-search responses per device per endpoint.
 public:
     DviSsdpNotifierManager(DvStack& aDvStack);
     ~DviSsdpNotifierManager();
@@ -122,7 +199,7 @@ public:
     void MsearchResponseRoot(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter);
     void MsearchResponseUuid(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter);
     void MsearchResponseDeviceType(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter);
-    void MsearchResponseServiceType(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const OpenHome::Net::ServiceType& aServiceType, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter, TUint aServiceVersionOverride = MsearchResponse::kServiceVersionOverrideDisabled);
+    void MsearchResponseServiceType(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const OpenHome::Net::ServiceType& aServiceType, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter, TUint aServiceVersionOverride = MsearchResponder::kServiceVersionOverrideDisabled);
     void Stop(const Brx& aUdn);
 private:
     class Notifier
@@ -140,12 +217,6 @@ private:
     private:
         Brn iUdn;
     };
-    class Responder : public Notifier
-    {
-    public:
-        Responder(MsearchResponse* aResponder);
-        MsearchResponse& Response();
-    };
     class Announcer : public Notifier
     {
     public:
@@ -155,7 +226,6 @@ private:
 private:
     void Stop(std::list<Notifier*>& aList, const Brx& aUdn);
     void Delete(std::list<Notifier*>& aList);
-    Responder* GetResponder(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote);
     Announcer* GetAnnouncer(IUpnpAnnouncementData& aAnnouncementData);
     TBool TryMove(SsdpNotifierScheduler* aScheduler, std::list<Notifier*>& aFrom, std::list<Notifier*>& aTo);
 private: // from ISsdpNotifyListener
@@ -164,8 +234,7 @@ private:
     DvStack& iDvStack;
     Mutex iLock;
     Semaphore iShutdownSem;
-    std::list<Notifier*> iFreeResponders;
-    std::list<Notifier*> iActiveResponders;
+    MsearchResponder iMsearchResponder;
     std::list<Notifier*> iFreeAnnouncers;
     std::list<Notifier*> iActiveAnnouncers;
     TUint iAnnounceIntervalAlive;
@@ -4,10 +4,72 @@
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Net/Core/OhNet.h>
 #include <OpenHome/Private/DnsChangeNotifier.h>
+#include <OpenHome/Private/Metrics.h>
+
+#include <algorithm>
 
 using namespace OpenHome;
 using namespace OpenHome::Net;
 
+// SsdpNotifyFilter
+
+SsdpNotifyFilter::SsdpNotifyFilter(ESsdpTarget aTarget, const Brx& aUuidOrDomain, const Brx& aType)
+    : iTarget(aTarget)
+{
+    ASSERT(aTarget != eSsdpUnknown);
+    if (iTarget != eSsdpAll) {
+        Bwh key(aUuidOrDomain.Bytes() + aType.Bytes() + 3);
+        AppendKey(key, iTarget, aUuidOrDomain, aType);
+        iKey.Set(key);
+    }
+}
+
+SsdpNotifyFilter::SsdpNotifyFilter(const SsdpNotifyFilter& aFilter)
+    : iTarget(aFilter.iTarget)
+    , iKey(static_cast<const Brx&>(aFilter.iKey))
+{
+}
+
+ESsdpTarget SsdpNotifyFilter::Target() const
+{
+    return iTarget;
+}
+
+const Brx& SsdpNotifyFilter::Key() const
+{
+    return iKey;
+}
+
+void SsdpNotifyFilter::AppendKey(Bwx& aKey, ESsdpTarget aTarget, const Brx& aUuidOrDomain, const Brx& aType)
+{
+    switch (aTarget)
+    {
+    case eSsdpRoot:
+        aKey.AppendThrow("r");
+        break;
+    case eSsdpUuid:
+        aKey.AppendThrow("u:");
+        aKey.AppendThrow(aUuidOrDomain);
+        break;
+    case eSsdpDeviceType:
+        aKey.AppendThrow("d:");
+        aKey.AppendThrow(aUuidOrDomain);
+        aKey.AppendThrow(":");
+        aKey.AppendThrow(aType);
+        break;
+    case eSsdpServiceType:
+        aKey.AppendThrow("s:");
+        aKey.AppendThrow(aUuidOrDomain);
+        aKey.AppendThrow(":");
+        aKey.AppendThrow(aType);
+        break;
+    default:
+        ASSERTS();
+        break;
+    }
+}
+
+
 // SsdpSocketReader
 
 SsdpSocketReader::SsdpSocketReader(Environment& aEnv, const TIpAddress& aInterface, const Endpoint& aMulticast)
@@ -57,6 +119,7 @@ SsdpListener::SsdpListener(const TChar* aName)
 SsdpListenerMulticast::SsdpListenerMulticast(Environment& aEnv, const TIpAddress& aInterface)
     : SsdpListener("SsdpListenerM")
     , iEnv(aEnv)
+    , iNotifyHandlersDisabled(0)
     , iLock("LMCM")
     , iNextHandlerId(0)
     , iInterface(aInterface)
@@ -67,6 +130,9 @@ SsdpListenerMulticast::SsdpListenerMulticast(Environment& aEnv, const TIpAddress
     , iDnsChangeListenerId(DnsChangeNotifier::kIdInvalid)
     , iExiting(false)
     , iRecreateSocket(false)
+    , iMetricNotifies(aEnv.Metrics().Counter("ohnet_ssdp_rx_notify_total", "SSDP NOTIFY messages received by multicast listeners"))
+    , iMetricMsearches(aEnv.Metrics().Counter("ohnet_ssdp_rx_msearch_total", "SSDP M-SEARCH requests received by multicast listeners"))
+    , iMetricErrors(aEnv.Metrics().Counter("ohnet_ssdp_rx_errors_total", "Malformed SSDP messages received by multicast listeners"))
 {
     try
     {
@@ -105,20 +171,17 @@ void SsdpListenerMulticast::Run()
                     const Brx& method = iReaderRequest.Method();
                     if (method == Ssdp::kMethodNotify) {
                         LOG(kSsdpMulticast, "SSDP Multicast      Notify\n");
-                        iLock.Wait();
-                        EraseDisabled(iNotifyHandlers);
+                        iMetricNotifies.Inc();
                         VectorNotifyHandler callbacks;
-                        TUint count = (TUint)iNotifyHandlers.size();
-                        for (TUint i=0; i<count; i++) {
-                            callbacks.push_back(iNotifyHandlers[i]);
-                        }
-                        iLock.Signal();
+                        GetNotifyHandlers(callbacks);
+                        const TUint count = (TUint)callbacks.size();
                         for (TUint i = 0; i<count; i++) {
                             Notify(*(callbacks[i]));
                         }
                     }
                     else if (method == Ssdp::kMethodMsearch) {
                         LOG(kSsdpMulticast, "SSDP Multicast      Msearch\n");
+                        iMetricMsearches.Inc();
                         iLock.Wait();
                         EraseDisabled(iMsearchHandlers);
                         VectorMsearchHandler callbacks;
@@ -135,6 +198,7 @@ void SsdpListenerMulticast::Run()
             }
         }
         catch (HttpError& ex) {
+            iMetricErrors.Inc();
             Endpoint::EndpointBuf epb;
             iSocket.Sender().AppendEndpoint(epb);
             epb.PtrZ();
@@ -216,6 +280,50 @@ void SsdpListenerMulticast::Msearch(ISsdpMsearchHandler& aMsearchHandler)
     }
 }
 
+void SsdpListenerMulticast::GetNotifyHandlers(VectorNotifyHandler& aHandlers)
+{
+    // Only handlers whose filter matches the message's NT (or USN uuid) are passed it
+    AutoMutex a(iLock);
+    if (iNotifyHandlersDisabled > 0) {
+        EraseDisabledNotifyHandlers();
+    }
+    aHandlers = iNotifyHandlersAll;
+    if (iNotifyHandlerIndex.size() == 0) {
+        return;
+    }
+    if (iHeaderUsn.Received()) {
+        AppendNotifyHandlers(aHandlers, eSsdpUuid, iHeaderUsn.Uuid(), Brx::Empty());
+    }
+    if (iHeaderNt.Received()) {
+        switch (iHeaderNt.Target()) {
+        case eSsdpRoot:
+            AppendNotifyHandlers(aHandlers, eSsdpRoot, Brx::Empty(), Brx::Empty());
+            break;
+        case eSsdpDeviceType:
+        case eSsdpServiceType:
+            AppendNotifyHandlers(aHandlers, iHeaderNt.Target(), iHeaderNt.Domain(), iHeaderNt.Type());
+            break;
+        default: // uuid notifications were matched using the USN above
+            break;
+        }
+    }
+}
+
+void SsdpListenerMulticast::AppendNotifyHandlers(VectorNotifyHandler& aHandlers, ESsdpTarget aTarget, const Brx& aUuidOrDomain, const Brx& aType)
+{
+    Bws<SsdpNotifyFilter::kMaxKeyBytes> key;
+    try {
+        SsdpNotifyFilter::AppendKey(key, aTarget, aUuidOrDomain, aType);
+    }
+    catch (BufferOverflow&) {
+        return; // no filter can have a key this long
+    }
+    std::pair<NotifyHandlerIndex::iterator, NotifyHandlerIndex::iterator> range = iNotifyHandlerIndex.equal_range(Brn(key));
+    for (NotifyHandlerIndex::iterator it = range.first; it != range.second; ++it) {
+        aHandlers.push_back(it->second);
+    }
+}
+
 void SsdpListenerMulticast::Notify(NotifyHandler& aHandler)
 {
     AutoMutex a(aHandler.Mutex());
@@ -345,19 +453,31 @@ SsdpListenerMulticast::~SsdpListenerMulticast()
     iExiting = true;
     iReaderRequest.Interrupt();
     Join();
-    EraseDisabled(iNotifyHandlers);
+    EraseDisabledNotifyHandlers();
     ASSERT(iNotifyHandlers.size() == 0);
     EraseDisabled(iMsearchHandlers);
     ASSERT(iMsearchHandlers.size() == 0);
 }
 
 TInt SsdpListenerMulticast::AddNotifyHandler(ISsdpNotifyHandler* aNotifyHandler)
+{
+    return AddNotifyHandler(aNotifyHandler, SsdpNotifyFilter(eSsdpAll));
+}
+
+TInt SsdpListenerMulticast::AddNotifyHandler(ISsdpNotifyHandler* aNotifyHandler, const SsdpNotifyFilter& aFilter)
 {
     ASSERT(aNotifyHandler != NULL);
     iLock.Wait();
     TInt id = iNextHandlerId;
-    NotifyHandler* handler = new NotifyHandler(aNotifyHandler, iNextHandlerId);
+    NotifyHandler* handler = new NotifyHandler(aNotifyHandler, iNextHandlerId, aFilter);
     iNotifyHandlers.push_back(handler);
+    if (aFilter.Target() == eSsdpAll) {
+        iNotifyHandlersAll.push_back(handler);
+    }
+    else {
+        Brn key(handler->Filter().Key());
+        iNotifyHandlerIndex.insert(std::pair<Brn, NotifyHandler*>(key, handler));
+    }
     iNextHandlerId++;
     iLock.Signal();
     return id;
@@ -385,6 +505,7 @@ void SsdpListenerMulticast::RemoveNotifyHandler(TInt aHandlerId)
             nh->Lock();
             nh->Disable();
             nh->Unlock();
+            iNotifyHandlersDisabled++;
             break;
         }
     }
@@ -412,22 +533,38 @@ const TIpAddress& SsdpListenerMulticast::Interface() const
     return iInterface;
 }
 
-void SsdpListenerMulticast::EraseDisabled(VectorNotifyHandler& aVector)
+void SsdpListenerMulticast::EraseDisabledNotifyHandlers()
 {
-    VectorNotifyHandler::iterator it = aVector.begin();
-    while (it != aVector.end()) {
-        NotifyHandler* handler = reinterpret_cast<NotifyHandler*>(*it);
+    VectorNotifyHandler::iterator it = iNotifyHandlers.begin();
+    while (it != iNotifyHandlers.end()) {
+        NotifyHandler* handler = *it;
         handler->Lock();
         if (handler->IsDisabled()) {
             handler->Unlock();
+            if (handler->Filter().Target() == eSsdpAll) {
+                VectorNotifyHandler::iterator itAll = std::find(iNotifyHandlersAll.begin(), iNotifyHandlersAll.end(), handler);
+                ASSERT(itAll != iNotifyHandlersAll.end());
+                iNotifyHandlersAll.erase(itAll);
+            }
+            else {
+                Brn key(handler->Filter().Key());
+                std::pair<NotifyHandlerIndex::iterator, NotifyHandlerIndex::iterator> range = iNotifyHandlerIndex.equal_range(key);
+                NotifyHandlerIndex::iterator itIndex = range.first;
+                while (itIndex != range.second && itIndex->second != handler) {
+                    ++itIndex;
+                }
+                ASSERT(itIndex != range.second);
+                iNotifyHandlerIndex.erase(itIndex);
+            }
             delete handler;
-            it = aVector.erase(it);
+            it = iNotifyHandlers.erase(it);
         }
         else {
             handler->Unlock();
             it++;
         }
     }
+    iNotifyHandlersDisabled = 0;
 }
 
 void SsdpListenerMulticast::EraseDisabled(VectorMsearchHandler& aVector)
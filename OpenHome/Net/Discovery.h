@@ -9,9 +9,11 @@
 #include <OpenHome/Private/Network.h>
 
 #include <vector>
+#include <map>
 
 namespace OpenHome {
 class Environment;
+class MetricCounter;
 namespace Net {
 
 
@@ -42,6 +44,29 @@ public:
     virtual ~ISsdpMsearchHandler() {}
 };
 
+// SsdpNotifyFilter - selects the notifications SsdpListenerMulticast passes to an ISsdpNotifyHandler
+//                  - eSsdpAll:         all notifications
+//                  - eSsdpRoot:        root device notifications
+//                  - eSsdpUuid:        any notification from device aUuidOrDomain
+//                  - eSsdpDeviceType:  notifications for device type aUuidOrDomain:aType (any version)
+//                  - eSsdpServiceType: notifications for service type aUuidOrDomain:aType (any version)
+class SsdpNotifyFilter
+{
+public:
+    static const TUint kMaxKeyBytes = 256;
+public:
+    SsdpNotifyFilter(ESsdpTarget aTarget, const Brx& aUuidOrDomain = Brx::Empty(), const Brx& aType = Brx::Empty());
+    SsdpNotifyFilter(const SsdpNotifyFilter& aFilter);
+    ESsdpTarget Target() const;
+    const Brx& Key() const; // empty for eSsdpAll
+    static void AppendKey(Bwx& aKey, ESsdpTarget aTarget, const Brx& aUuidOrDomain, const Brx& aType); // throws BufferOverflow
+private:
+    void operator=(const SsdpNotifyFilter&);
+private:
+    ESsdpTarget iTarget;
+    Brh iKey;
+};
+
 class SsdpSocketReader : public SocketUdpMulticast, public IReaderSource
 {
 public:
@@ -96,10 +121,12 @@ class SsdpListenerMulticast : public SsdpListener, private IResumeObserver
     class NotifyHandler : public Handler
     {
     public:
-        NotifyHandler(ISsdpNotifyHandler* aHandler, TInt aId) : SsdpListenerMulticast::Handler(aId), iHandler(aHandler) {}
+        NotifyHandler(ISsdpNotifyHandler* aHandler, TInt aId, const SsdpNotifyFilter& aFilter) : SsdpListenerMulticast::Handler(aId), iHandler(aHandler), iFilter(aFilter) {}
         ISsdpNotifyHandler* Handler() { return iHandler; }
+        const SsdpNotifyFilter& Filter() const { return iFilter; }
     private:
         ISsdpNotifyHandler* iHandler;
+        SsdpNotifyFilter iFilter;
     };
     class MsearchHandler : public Handler
     {
@@ -111,10 +138,12 @@ class SsdpListenerMulticast : public SsdpListener, private IResumeObserver
     };
     typedef std::vector<NotifyHandler*> VectorNotifyHandler;
     typedef std::vector<MsearchHandler*> VectorMsearchHandler;
+    typedef std::multimap<Brn, NotifyHandler*, BufferCmp> NotifyHandlerIndex;
 public:
     SsdpListenerMulticast(Environment& aEnv, const TIpAddress& aInterface);
     virtual ~SsdpListenerMulticast();
-    TInt AddNotifyHandler(ISsdpNotifyHandler* aNotifyHandler);
+    TInt AddNotifyHandler(ISsdpNotifyHandler* aNotifyHandler); // passed all notifications
+    TInt AddNotifyHandler(ISsdpNotifyHandler* aNotifyHandler, const SsdpNotifyFilter& aFilter);
     TInt AddMsearchHandler(ISsdpMsearchHandler* aMsearchHandler);
     void RemoveNotifyHandler(TInt aHandlerId);
     void RemoveMsearchHandler(TInt aHandlerId);
@@ -122,11 +151,13 @@ public:
 private:
     void Run();
     void Terminated();
+    void GetNotifyHandlers(VectorNotifyHandler& aHandlers);
+    void AppendNotifyHandlers(VectorNotifyHandler& aHandlers, ESsdpTarget aTarget, const Brx& aUuidOrDomain, const Brx& aType);
     void Notify(NotifyHandler& aHandler);
     void Notify(ISsdpNotifyHandler& aNotifyHandler);
     void Msearch(MsearchHandler& aHandler);
     void Msearch(ISsdpMsearchHandler& aMsearchHandler);
-    void EraseDisabled(VectorNotifyHandler& aVector);
+    void EraseDisabledNotifyHandlers();
     void EraseDisabled(VectorMsearchHandler& aVector);
     void DnsChanged();
 private: // from IResumeObserver
@@ -134,6 +165,9 @@ private: // from IResumeObserver
 private:
     Environment& iEnv;
     VectorNotifyHandler iNotifyHandlers;
+    VectorNotifyHandler iNotifyHandlersAll;  // handlers passed all notifications
+    NotifyHandlerIndex iNotifyHandlerIndex;  // handlers passed notifications matching their filter's key
+    TUint iNotifyHandlersDisabled;
     VectorMsearchHandler iMsearchHandlers;
     OpenHome::Mutex iLock;
     TInt iNextHandlerId;
@@ -150,6 +184,9 @@ private:
     TUint iDnsChangeListenerId;
     TBool iExiting;
     TBool iRecreateSocket;
+    MetricCounter& iMetricNotifies;
+    MetricCounter& iMetricMsearches;
+    MetricCounter& iMetricErrors;
 };
 
 // SsdpListenerUnicast - sends out an msearch request and listens to the unicast responses
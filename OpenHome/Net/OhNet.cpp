@@ -323,6 +323,13 @@ void InitialisationParams::SetNumSubscriberThreads(uint32_t aNumThreads)
     iNumSubscriberThreads = aNumThreads;
 }
 
+void InitialisationParams::SetWorkerPoolLimits(EWorkerPool aPool, uint32_t aMaxThreads, uint32_t aIdleTimeoutMs)
+{
+    ASSERT((uint32_t)aPool < kNumWorkerPools);
+    iWorkerPoolMaxThreads[aPool] = aMaxThreads;
+    iWorkerPoolIdleTimeoutMs[aPool] = aIdleTimeoutMs;
+}
+
 void InitialisationParams::SetInvocationTimeout(uint32_t aMs)
 {
     ASSERT(aMs > 0);
@@ -400,6 +407,16 @@ void InitialisationParams::SetCpUpnpEventServerPort(TUint aPort)
     iCpUpnpEventServerPort = aPort;
 }
 
+void InitialisationParams::SetCpDeviceCache(const Brx& aPath)
+{
+    iCpDeviceCache.Set(aPath);
+}
+
+void InitialisationParams::SetCpDeviceDvInvokeOnCallerThread(TBool aEnable)
+{
+    iCpDeviceDvInvokeOnCallerThread = aEnable;
+}
+
 void InitialisationParams::SetDvUpnpServerPort(TUint aPort)
 {
     iDvUpnpWebServerPort = aPort;
@@ -422,11 +439,22 @@ void InitialisationParams::SetDvNumLpecThreads(uint32_t aNumThreads)
     iDvNumLpecThreads = aNumThreads;
 }
 
+void InitialisationParams::SetDvLpecMaxConcurrentActions(uint32_t aNumActions)
+{
+    ASSERT(aNumActions > 0);
+    iDvLpecMaxConcurrentActions = aNumActions;
+}
+
 void InitialisationParams::SetDvLpecServerPort(uint32_t aPort)
 {
     iDvLpecServerPort = aPort;
 }
 
+void InitialisationParams::SetLpecLocalSocket(const Brx& aPath)
+{
+    iLpecLocalSocket.Set(aPath);
+}
+
 void InitialisationParams::SetDvAnnouncementIntervals(uint32_t aByeByeMs, uint32_t aAliveMs)
 {
     ASSERT(aByeByeMs != 0);
@@ -459,6 +487,26 @@ void InitialisationParams::SetEnableShell(TUint aPort, TUint aSessionPriority)
     iShellSessionPriority = aSessionPriority;
 }
 
+void InitialisationParams::SetEnableMetricsServer(TUint aPort)
+{
+    TIpAddress loopback;
+    loopback.iFamily = kFamilyV4;
+    loopback.iV4 = MakeIpAddress(127, 0, 0, 1);
+    SetEnableMetricsServer(aPort, loopback);
+}
+
+void InitialisationParams::SetEnableMetricsServer(TUint aPort, const TIpAddress& aInterface)
+{
+    iEnableMetricsServer = true;
+    iMetricsServerPort = aPort;
+    iMetricsServerInterface = aInterface;
+}
+
+void InitialisationParams::SetEnableMutexProfiling()
+{
+    iEnableMutexProfiling = true;
+}
+
 void InitialisationParams::SetSchedulingPolicy(Environment::EThreadScheduling aPolicy)
 {
     iSchedulingPolicy = aPolicy;
@@ -559,6 +607,13 @@ uint32_t InitialisationParams::NumSubscriberThreads() const
     return iNumSubscriberThreads;
 }
 
+void InitialisationParams::GetWorkerPoolLimits(EWorkerPool aPool, uint32_t& aMaxThreads, uint32_t& aIdleTimeoutMs) const
+{
+    ASSERT((uint32_t)aPool < kNumWorkerPools);
+    aMaxThreads = iWorkerPoolMaxThreads[aPool];
+    aIdleTimeoutMs = iWorkerPoolIdleTimeoutMs[aPool];
+}
+
 uint32_t InitialisationParams::InvocationTimeoutMs() const
 {
     return iInvocationTimeoutMs;
@@ -624,6 +679,16 @@ uint32_t InitialisationParams::CpUpnpEventServerPort() const
     return iCpUpnpEventServerPort;
 }
 
+const Brx& InitialisationParams::CpDeviceCache() const
+{
+    return iCpDeviceCache;
+}
+
+bool InitialisationParams::CpDeviceDvInvokeOnCallerThread() const
+{
+    return iCpDeviceDvInvokeOnCallerThread;
+}
+
 uint32_t InitialisationParams::DvUpnpServerPort() const
 {
     // Disable conflation of use of Bonjour with MDNS hostname setting for UPnP devices
@@ -650,11 +715,21 @@ uint32_t InitialisationParams::DvNumLpecThreads()
     return iDvNumLpecThreads;
 }
 
+uint32_t InitialisationParams::DvLpecMaxConcurrentActions()
+{
+    return iDvLpecMaxConcurrentActions;
+}
+
 uint32_t InitialisationParams::DvLpecServerPort()
 {
     return iDvLpecServerPort;
 }
 
+const Brx& InitialisationParams::LpecLocalSocket() const
+{
+    return iLpecLocalSocket;
+}
+
 void InitialisationParams::GetDvAnnouncementIntervals(uint32_t& aByeByeMs, uint32_t& aAliveMs)
 {
     aByeByeMs = iDvAnnouncementIntervalByeByeMs;
@@ -683,6 +758,18 @@ TBool InitialisationParams::IsShellEnabled(TUint& aPort, TUint& aSessionPriority
     return iEnableShell;
 }
 
+TBool InitialisationParams::IsMetricsServerEnabled(TUint& aPort, TIpAddress& aInterface) const
+{
+    aPort = iMetricsServerPort;
+    aInterface = iMetricsServerInterface;
+    return iEnableMetricsServer;
+}
+
+TBool InitialisationParams::IsMutexProfilingEnabled() const
+{
+    return iEnableMutexProfiling;
+}
+
 Environment::EThreadScheduling InitialisationParams::SchedulingPolicy() const
 {
     return iSchedulingPolicy;
@@ -723,6 +810,7 @@ InitialisationParams::InitialisationParams()
     , iDvPublisherThreadPriority(kPriorityNormal)
     , iDvNumWebSocketThreads(0)
     , iCpUpnpEventServerPort(0)
+    , iCpDeviceDvInvokeOnCallerThread(false)
     , iDvUpnpWebServerPort(0)
     , iDvWebSocketPort(0)
     , iHostUdpLowQuality(HOST_UDP_LOW_QUALITY_DEFAULT)
@@ -730,6 +818,7 @@ InitialisationParams::InitialisationParams()
     , iRequiresMdnsCache(false)
     , iIPv6Supported(false)
     , iDvNumLpecThreads(0)
+    , iDvLpecMaxConcurrentActions(4)
     , iDvLpecServerPort(0)
     , iDvAnnouncementIntervalByeByeMs(10)
     , iDvAnnouncementIntervalAliveMs(40)
@@ -737,9 +826,17 @@ InitialisationParams::InitialisationParams()
     , iEnableShell(false)
     , iShellPort(0)
     , iShellSessionPriority(kPriorityNormal)
+    , iEnableMetricsServer(false)
+    , iMetricsServerPort(0)
+    , iMetricsServerInterface(kIpAddressV4AllAdapters)
+    , iEnableMutexProfiling(false)
     , iSchedulingPolicy(Environment::EScheduleDefault)
     , iDnsChangeTestHostName("wiki.openhome.org")
 {
+    for (TUint i=0; i<kNumWorkerPools; i++) {
+        iWorkerPoolMaxThreads[i] = kWorkerPoolMaxThreadsDefault;
+        iWorkerPoolIdleTimeoutMs[i] = kWorkerPoolIdleTimeoutMsDefault;
+    }
     iDefaultLogger = new DefaultLogger;
     FunctorMsg functor = MakeFunctorMsg(*iDefaultLogger, &OpenHome::Net::DefaultLogger::Log);
     SetLogOutput(functor);
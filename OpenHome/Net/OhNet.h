@@ -187,6 +187,20 @@ class DefaultLogger;
  */
 class DllExportClass InitialisationParams
 {
+public:
+    /**
+     * Pools of threads which may grow beyond their initial size under load.
+     * See SetWorkerPoolLimits().
+     */
+    enum EWorkerPool
+    {
+        eWorkerPoolXmlFetcher
+       ,eWorkerPoolActionInvoker
+       ,eWorkerPoolSubscriber
+       ,eWorkerPoolDvPublisher
+       ,eWorkerPoolDvLpec
+    };
+    static const uint32_t kNumWorkerPools = 5;
 public:
     /**
      * Create a new InitialisationParams instance.
@@ -248,8 +262,10 @@ public:
     void SetNumActionInvokerThreads(uint32_t aNumThreads);
     /**
      * Set the number of invocations (actions) which should be pre-allocated.
-     * If more that this number are pending, the additional attempted invocations
-     * will block until a pre-allocated slot becomes clear.
+     * If more that this number are pending, further invocations are allocated on demand
+     * (keeping the same ratio to the maximum number of action invoker threads as
+     * aNumInvocations has to SetNumActionInvokerThreads()).  Attempted invocations
+     * beyond that limit block until a slot becomes clear.
      * A higher number of invocations will decrease the likelihood and duration of
      * any UI-level delays but will also increase the peaks in RAM requirements.
      * Must be greater than zero.
@@ -262,6 +278,18 @@ public:
      * but will also require more system resources.
      */
     void SetNumSubscriberThreads(uint32_t aNumThreads);
+    /**
+     * Set the limits for one of the elastic thread pools.
+     * The thread counts set by SetNumXmlFetcherThreads(), SetNumActionInvokerThreads(),
+     * SetNumSubscriberThreads(), SetDvNumPublisherThreads() and SetDvLpecMaxConcurrentActions()
+     * are the number of threads created when each pool starts.  A pool grows, up to
+     * aMaxThreads, when work is queued with none of its threads free and shrinks back once
+     * the extra threads have been idle for aIdleTimeoutMs (0 means they never exit).  Setting aMaxThreads no higher than
+     * the initial thread count gives a fixed size pool.
+     * The current size and peak usage of each pool are reported by the shell's
+     * 'info workerpools' command.
+     */
+    void SetWorkerPoolLimits(EWorkerPool aPool, uint32_t aMaxThreads, uint32_t aIdleTimeoutMs);
     /**
      * Set the maximum time to wait for a (remote) device to begin responding
      * to an invoked action.
@@ -321,6 +349,8 @@ public:
     /**
      * Set a delay between publishing events from a single thread.
      * A value of 0 implies no delay.
+     * Each of the SetDvNumPublisherThreads() publishing slots waits this long after a
+     * publish completes before starting another.  No thread is blocked for the delay.
      * Can be used in systems capable of priority-based scheduling to to allow
      * eventing to run at a very high priority without risking it blocking out
      * other high priority tasks.
@@ -342,6 +372,22 @@ public:
      * requirements) running on a device.
      */ 
     void SetCpUpnpEventServerPort(TUint aPort);
+    /**
+     * Set the path of a file used to remember UPnP devices between runs.
+     * When set, control point device lists report devices seen by a previous run
+     * as soon as they start, checking each is still contactable rather than
+     * waiting for msearch responses and re-fetching device xml.
+     * Unset (no cache) by default.
+     */
+    void SetCpDeviceCache(const Brx& aPath);
+    /**
+     * Run actions invoked on a CpDeviceDv (a control point's view of a device in the same
+     * process) on the calling thread rather than passing them to an action invoker thread.
+     * Async completion callbacks will then run before the Begin...() call that started the
+     * invocation returns, so callers must not hold locks their callback needs.
+     * Disabled by default.
+     */
+    void SetCpDeviceDvInvokeOnCallerThread(TBool aEnable);
     /**
      * Set the tcp port number the device stack's UPnP web server will run on.
      * The default value is 0 (OS-assigned).
@@ -368,6 +414,12 @@ public:
      * resources.
      */
     void SetDvNumLpecThreads(uint32_t aNumThreads);
+    /**
+     * Set the maximum number of actions each LPEC connection may run concurrently.
+     * Responses are always returned in the order requests were received.
+     * Set to 1 to run each client's actions strictly one after another.
+     */
+    void SetDvLpecMaxConcurrentActions(uint32_t aNumActions);
     /**
      * Set the tcp port number the device stack's LPEC servers will run on.
      * The default value is 0 (meaning that the OS will assign a port).
@@ -375,6 +427,15 @@ public:
      * requirements) running on a device.
      */
     void SetDvLpecServerPort(uint32_t aPort);
+    /**
+     * Set the path of a local (unix domain) socket for LPEC connections between
+     * control points and devices on the same host.
+     * When set, the device stack's LPEC server additionally listens on this path.
+     * Control points connect to it rather than to a loopback tcp address whose port
+     * matches SetDvLpecServerPort(); other loopback ports continue to use tcp.
+     * Ignored on platforms which don't support local sockets.  Unset by default.
+     */
+    void SetLpecLocalSocket(const Brx& aPath);
     /**
      * Set the minimum gap (per device) between multicast announcement messages.
      */
@@ -398,6 +459,28 @@ public:
      * Enable use of debug shell
      */
     void SetEnableShell(TUint aPort = Shell::kServerPortDefault, TUint aSessionPriority = kPriorityNormal);
+    /**
+     * Enable a http server which publishes stack metrics in Prometheus text format
+     * Metrics are also available via the shell's 'info metrics' command, whether or not this is enabled.
+     *
+     * The server listens on loopback only unless an interface is specified.
+     *
+     * @param[in] aPort       Port to listen on.  0 means an ephemeral port will be chosen.
+     */
+    void SetEnableMetricsServer(TUint aPort);
+    /**
+     * Enable the metrics http server on a specific interface
+     *
+     * @param[in] aPort       Port to listen on.  0 means an ephemeral port will be chosen.
+     * @param[in] aInterface  Address to bind to.  kIpAddressV4AllAdapters exposes metrics on every interface.
+     */
+    void SetEnableMetricsServer(TUint aPort, const TIpAddress& aInterface);
+    /**
+     * Record wait/hold times and contention for every Mutex, grouped by name.
+     * Results are available via the 'mutexes' shell command.  Adds a small cost
+     * to every lock so should only be enabled while diagnosing performance problems.
+     */
+    void SetEnableMutexProfiling();
     /**
      * Set thread scheduling policy
      * EScheduleDefault is suitable for most OSes.
@@ -428,6 +511,7 @@ public:
     uint32_t NumActionInvokerThreads() const;
     uint32_t NumInvocations() const;
     uint32_t NumSubscriberThreads() const;
+    void GetWorkerPoolLimits(EWorkerPool aPool, uint32_t& aMaxThreads, uint32_t& aIdleTimeoutMs) const;
     uint32_t InvocationTimeoutMs() const;
     uint32_t SubscriptionDurationSecs() const;
     uint32_t PendingSubscriptionTimeoutMs() const;
@@ -441,18 +525,27 @@ public:
     uint32_t DvPublisherModerationTimeMs() const;
     uint32_t DvNumWebSocketThreads() const;
     uint32_t CpUpnpEventServerPort() const;
+    const Brx& CpDeviceCache() const;
+    bool CpDeviceDvInvokeOnCallerThread() const;
     uint32_t DvUpnpServerPort() const;
     uint32_t DvWebSocketPort() const;
     bool DvIsBonjourEnabled(const TChar*& aHostName, TBool& aRequiresMdnsCache) const;
     uint32_t DvNumLpecThreads();
+    uint32_t DvLpecMaxConcurrentActions();
     uint32_t DvLpecServerPort();
+    const Brx& LpecLocalSocket() const;
     void GetDvAnnouncementIntervals(uint32_t& aByeByeMs, uint32_t& aAliveMs);
     bool IsHostUdpLowQuality();
     uint32_t TimerManagerPriority() const;
     const Brx& HttpUserAgent() const;
     TBool IsShellEnabled(TUint& aPort, TUint& aSessionPriority) const;
+    TBool IsMetricsServerEnabled(TUint& aPort, TIpAddress& aInterface) const;
+    TBool IsMutexProfilingEnabled() const;
     Environment::EThreadScheduling SchedulingPolicy() const;
     const TChar* DnsChangeTestHostName() const;
+private:
+    static const uint32_t kWorkerPoolMaxThreadsDefault = 16;
+    static const uint32_t kWorkerPoolIdleTimeoutMsDefault = 30 * 1000;
 private:
     InitialisationParams();
     void FatalErrorHandlerDefault(const char* aMsg);
@@ -477,6 +570,8 @@ private:
     uint32_t iNumActionInvokerThreads;
     uint32_t iNumInvocations;
     uint32_t iNumSubscriberThreads;
+    uint32_t iWorkerPoolMaxThreads[kNumWorkerPools];
+    uint32_t iWorkerPoolIdleTimeoutMs[kNumWorkerPools];
     uint32_t iInvocationTimeoutMs;
     uint32_t iSubscriptionDurationSecs;
     uint32_t iPendingSubscriptionTimeoutMs;
@@ -489,6 +584,8 @@ private:
     uint32_t iDvPublisherThreadPriority;
     uint32_t iDvNumWebSocketThreads;
     uint32_t iCpUpnpEventServerPort;
+    Brh iCpDeviceCache;
+    bool iCpDeviceDvInvokeOnCallerThread;
     uint32_t iDvUpnpWebServerPort;
     uint32_t iDvWebSocketPort;
     bool iHostUdpLowQuality;
@@ -497,7 +594,9 @@ private:
     bool iIPv6Supported;
     Brhz iDvBonjourHostName;
     uint32_t iDvNumLpecThreads;
+    uint32_t iDvLpecMaxConcurrentActions;
     uint32_t iDvLpecServerPort;
+    Brh iLpecLocalSocket;
     uint32_t iDvAnnouncementIntervalByeByeMs;
     uint32_t iDvAnnouncementIntervalAliveMs;
     uint32_t iTimerManagerThreadPriority;
@@ -505,6 +604,10 @@ private:
     TBool iEnableShell;
     TUint iShellPort;
     TUint iShellSessionPriority;
+    TBool iEnableMetricsServer;
+    TUint iMetricsServerPort;
+    TIpAddress iMetricsServerInterface;
+    TBool iEnableMutexProfiling;
     Environment::EThreadScheduling iSchedulingPolicy;
     const TChar* iDnsChangeTestHostName;
 };
@@ -317,12 +317,23 @@ TBool Property::ReportChanged()
     return false;
 }
 
+void Property::SetModerationMs(TUint aMinIntervalMs)
+{
+    iModerationMs = aMinIntervalMs;
+}
+
+TUint Property::ModerationMs() const
+{
+    return iModerationMs;
+}
+
 Property::Property(OpenHome::Net::Parameter* aParameter, Functor& aFunctor)
     : iLock("PROP")
     , iParameter(aParameter)
     , iFunctor(aFunctor)
     , iChanged(false)
     , iSequenceNumber(0)
+    , iModerationMs(0)
 {
     ASSERT(iParameter != NULL);
     ASSERT(iParameter->Type() != OpenHome::Net::Parameter::eTypeRelated);
@@ -333,6 +344,7 @@ Property::Property(OpenHome::Net::Parameter* aParameter)
     , iParameter(aParameter)
     , iChanged(false)
     , iSequenceNumber(0)
+    , iModerationMs(0)
 {
     ASSERT(iParameter != NULL);
     ASSERT(iParameter->Type() != OpenHome::Net::Parameter::eTypeRelated);
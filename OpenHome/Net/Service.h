@@ -211,6 +211,15 @@ public:
     TUint SequenceNumber() const;
     void ResetSequenceNumber();
     TBool ReportChanged();
+    /**
+     * Limit how often changes to this property are evented to each subscriber.
+     *
+     * Changes made within aMinIntervalMs of the last update sent to a subscriber are held back
+     * and merged, so only the latest value is sent once the interval has passed.  Other
+     * properties of the service are unaffected.  0 (the default) publishes every change.
+     */
+    void SetModerationMs(TUint aMinIntervalMs);
+    TUint ModerationMs() const;
     virtual void Process(IOutputProcessor& aProcessor, const Brx& aBuffer) = 0;
     virtual void Write(IPropertyWriter& aWriter) = 0;
 protected:
@@ -225,6 +234,7 @@ protected:
     Functor iFunctor;
     TBool iChanged;
     TUint iSequenceNumber;
+    TUint iModerationMs;
 };
 
 /**
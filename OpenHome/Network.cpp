@@ -7,6 +7,7 @@
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/TIpAddressUtils.h>
+#include <OpenHome/Private/Metrics.h>
 
 #include <errno.h>
 
@@ -326,6 +327,16 @@ void Socket::Create(Environment& aEnv, ESocketType aSocketType, ESocketFamily aS
     iLock.Signal();
 }
 
+void Socket::CreateLocal(Environment& aEnv)
+{
+    iSocketFamily = eSocketFamilyV4; // not used by local sockets
+    THandle handle = OpenHome::Os::NetworkCreateLocal(aEnv.OsCtx());
+    LOG_TRACE(kNetwork, "Socket::CreateLocal  Socket H = %d\n", handle);
+    iLock.Wait();
+    iHandle = handle;
+    iLock.Signal();
+}
+
 void Socket::Send(const Brx& aBuffer)
 {
     LOG_TRACE(kNetwork, "Socket::Send  H = %d, BC = %d\n", iHandle, aBuffer.Bytes());
@@ -341,6 +352,35 @@ void Socket::Send(const Brx& aBuffer)
     }
 }
 
+void Socket::SendV(const std::vector<Brn>& aBuffers)
+{
+    static const TUint kMaxBuffersPerSend = 16;
+    OsNetworkBuffer buffers[kMaxBuffersPerSend];
+    const TUint count = (TUint)aBuffers.size();
+    TUint index = 0;
+    while (index < count) {
+        TUint n = 0;
+        TUint bytes = 0;
+        for (; n<kMaxBuffersPerSend && index+n<count; n++) {
+            const Brn& buf = aBuffers[index+n];
+            buffers[n].iPtr = buf.Ptr();
+            buffers[n].iBytes = buf.Bytes();
+            bytes += buf.Bytes();
+        }
+        LOG_TRACE(kNetwork, "Socket::SendV  H = %d, NB = %u, BC = %u\n", iHandle, n, bytes);
+        TInt sent = OpenHome::Os::NetworkSendV(iHandle, buffers, n);
+        if (sent < 0) {
+            LOG_ERROR(kNetwork, "Socket::SendV H = %d, RETURN VALUE = %d\n", iHandle, sent);
+            THROW(NetworkError);
+        }
+        if ((TUint)sent != bytes) {
+            LOG_ERROR(kNetwork, "Socket::SendV H = %d, RETURN VALUE = %d, INCOMPLETE\n", iHandle, sent);
+            THROW(NetworkError);
+        }
+        index += n;
+    }
+}
+
 void Socket::SendTo(const Brx& aBuffer, const Endpoint& aEndpoint)
 {
     LOG_TRACE(kNetwork, "Socket::SendTo  H = %d, BC = %d, E = %x:%d\n", iHandle, aBuffer.Bytes(), aEndpoint.Address(), aEndpoint.Port());
@@ -428,6 +468,16 @@ void Socket::Bind(const Endpoint& aEndpoint)
     }
 }
 
+void Socket::BindLocal(const Brx& aPath)
+{
+    LOG_TRACE(kNetwork, "Socket::BindLocal H = %d\n", iHandle);
+    TInt err = OpenHome::Os::NetworkBindLocal(iHandle, aPath);
+    if (err != 0) {
+        LOG_ERROR(kNetwork, "Socket::BindLocal H = %d, RETURN VALUE = %d\n", iHandle, err);
+        THROW(NetworkError);
+    }
+}
+
 void Socket::GetPort(TUint& aPort)
 {
     LOG_TRACE(kNetwork, "Socket::GetPort H = %d\n", iHandle);
@@ -571,6 +621,17 @@ void SocketTcp::Write(const Brx& aBuffer)
     }
 }
 
+void SocketTcp::WriteV(const std::vector<Brn>& aBuffers)
+{
+    LOG_TRACE(kNetwork, "SocketTcp::WriteV\n");
+    try {
+        SendV(aBuffers);
+    }
+    catch(NetworkError&) {
+        THROW(WriterError);
+    }
+}
+
 void SocketTcp::WriteFlush()
 {
     // all writes go directly to the socket so nothing to flush
@@ -648,6 +709,19 @@ void SocketTcpClient::Connect(const Endpoint& aEndpoint, TUint aTimeout)
     OpenHome::Os::NetworkConnect(iHandle, ep, aTimeout);
 }
 
+void SocketTcpClient::OpenLocal(Environment& aEnv)
+{
+    ASSERT(iHandle == kHandleNull);
+    LOG_TRACE(kNetwork, "SocketTcpClient::OpenLocal\n");
+    CreateLocal(aEnv);
+}
+
+void SocketTcpClient::ConnectLocal(const Brx& aPath, TUint aTimeoutMs)
+{
+    LOG_TRACE(kNetwork, "SocketTcpClient::ConnectLocal\n");
+    OpenHome::Os::NetworkConnectLocal(iHandle, aPath, aTimeoutMs);
+}
+
 // Tcp Server
 
 SocketTcpServer::SocketTcpServer(Environment& aEnv, const TChar* aName, TUint aPort, const TIpAddress& aInterface,
@@ -656,6 +730,8 @@ SocketTcpServer::SocketTcpServer(Environment& aEnv, const TChar* aName, TUint aP
     , iSessionPriority(aSessionPriority)
     , iSessionStackBytes(aSessionStackBytes)
     , iTerminating(false)
+    , iMetricConnections(aEnv.Metrics().Counter("ohnet_tcp_connections_total", "Connections accepted by all tcp servers"))
+    , iMetricSessionsBusy(aEnv.Metrics().Gauge("ohnet_tcp_sessions_busy", "Tcp server sessions currently serving a connection"))
 {
     LOG_TRACE(kNetwork, "SocketTcpServer::SocketTcpServer\n");
     iSocketFamily = aInterface.iFamily == kFamilyV6 ? eSocketFamilyV6 : eSocketFamilyV4;
@@ -668,6 +744,33 @@ SocketTcpServer::SocketTcpServer(Environment& aEnv, const TChar* aName, TUint aP
     Listen(aSlots);
 }
 
+SocketTcpServer::SocketTcpServer(Environment& aEnv, const TChar* aName, const Brx& aLocalPath,
+                                 TUint aSessionPriority, TUint aSessionStackBytes, TUint aSlots)
+    : iMutex(aName)
+    , iSessionPriority(aSessionPriority)
+    , iSessionStackBytes(aSessionStackBytes)
+    , iTerminating(false)
+    , iPort(0)
+    , iInterface(kIpAddressV4AllAdapters)
+    , iMetricConnections(aEnv.Metrics().Counter("ohnet_tcp_connections_total", "Connections accepted by all tcp servers"))
+    , iMetricSessionsBusy(aEnv.Metrics().Gauge("ohnet_tcp_sessions_busy", "Tcp server sessions currently serving a connection"))
+{
+    LOG_TRACE(kNetwork, "SocketTcpServer::SocketTcpServer (local)\n");
+    CreateLocal(aEnv);
+    try {
+        BindLocal(aLocalPath);
+        iLocalPath.Set(aLocalPath);
+        Listen(aSlots);
+    }
+    catch (NetworkError&) {
+        if (iLocalPath.Bytes() > 0) {
+            OpenHome::Os::NetworkUnlinkLocal(iLocalPath);
+        }
+        Close();
+        throw;
+    }
+}
+
 void SocketTcpServer::Add(const TChar* aName, SocketTcpSession* aSession, TInt aPriorityOffset)
 {
     LOG_TRACE(kNetwork, "SocketTcpServer::Add\n");
@@ -713,6 +816,9 @@ SocketTcpServer::~SocketTcpServer()
     }
 
     Close();
+    if (iLocalPath.Bytes() > 0) {
+        OpenHome::Os::NetworkUnlinkLocal(iLocalPath);
+    }
     LOG_TRACE(kNetwork, "<SocketTcpServer::~SocketTcpServer\n");
 }
 
@@ -743,6 +849,8 @@ void SocketTcpSession::Start()
             LOG_ERROR(kNetwork, "-SocketTcpSession::Start() Network Accept Exception\n");
             break;
         }
+        iServer->iMetricConnections.Inc();
+        iServer->iMetricSessionsBusy.Inc();
         try {
             LOG_TRACE(kNetwork, "-SocketTcpSession::Start() Run session\n");
             Run();                              // execute specific session behaviour
@@ -755,6 +863,7 @@ void SocketTcpSession::Start()
         } catch (NetworkError&) {
             LOG_ERROR(kNetwork, "-SocketTcpSession::Start() Network Close Exception\n");
         }
+        iServer->iMetricSessionsBusy.Dec();
     }
     LOG_TRACE(kNetwork, "<SocketTcpSession::Start()\n");
 }
@@ -99,12 +99,15 @@ protected:
     Socket();
     virtual ~Socket() {}
     void Create(Environment& aEnv, ESocketType aSocketType, ESocketFamily aSocketFamily);
+    void CreateLocal(Environment& aEnv);
     void Send(const Brx& aBuffer);
+    void SendV(const std::vector<Brn>& aBuffers);
     void SendTo(const Brx& aBuffer, const Endpoint& aEndpoint);
     void Receive(Bwx& aBuffer);
     void Receive(Bwx& aBuffer, TUint aBytes);
     void ReceiveFrom(Bwx& aBuffer, Endpoint& aEndpoint);
     void Bind(const Endpoint& aEndpoint);
+    void BindLocal(const Brx& aPath);
     void GetPort(TUint& aPort);
     void Listen(TUint aSlots);
     THandle Accept(Endpoint& aClientEndpoint);
@@ -175,6 +178,13 @@ public:
     void Write(const Brx& aBuffer);
     void WriteFlush();
 
+    /**
+     * Send several buffers, in order, using a single gather write where the platform allows
+     * Block until all bytes are sent
+     * Throw WriterError on network error
+     */
+    void WriteV(const std::vector<Brn>& aBuffers);
+
     // IReaderSource
     /**
      * Receive between [0, aBuffer.MaxBytes()] bytes, replace buffer
@@ -190,6 +200,8 @@ protected:
 };
 
 class Environment;
+class MetricCounter;
+class MetricGauge;
 
 /// Tcp client
 
@@ -198,6 +210,13 @@ class SocketTcpClient : public SocketTcp
 public:
     void Open(Environment& aEnv);
     void Connect(const Endpoint& aEndpoint, TUint aTimeoutMs);
+    /**
+     * Alternatives to Open()/Connect() for a server on the same host which is listening
+     * on a local (unix domain) socket.  Throw NetworkError if the platform doesn't support
+     * local sockets or nothing is listening on aPath.
+     */
+    void OpenLocal(Environment& aEnv);
+    void ConnectLocal(const Brx& aPath, TUint aTimeoutMs);
 };
 
 /// Tcp Session
@@ -235,6 +254,15 @@ public:
     SocketTcpServer(Environment& aEnv, const TChar* aName, TUint aPort, const TIpAddress& aInterface,
                     TUint aSessionPriority = kPriorityHigh, TUint aSessionStackBytes = Thread::kDefaultStackBytes,
                     TUint aSlots = 128);
+    /**
+     * Listen on a local (unix domain) socket at aLocalPath rather than a tcp port.
+     * aLocalPath is removed when the server is destroyed.  Port() returns 0 and
+     * sessions see a loopback ClientEndpoint().
+     * Throws NetworkError if the platform doesn't support local sockets.
+     */
+    SocketTcpServer(Environment& aEnv, const TChar* aName, const Brx& aLocalPath,
+                    TUint aSessionPriority = kPriorityHigh, TUint aSessionStackBytes = Thread::kDefaultStackBytes,
+                    TUint aSlots = 128);
     // Add is not thread safe, but why would you want that?
     void Add(const TChar* aName, SocketTcpSession* aSession, TInt aPriorityOffset = 0);
     TUint Port() const { return iPort; }
@@ -251,6 +279,9 @@ private:
     std::vector<SocketTcpSession*> iSessions;
     TUint iPort;
     TIpAddress iInterface;
+    Brh iLocalPath;
+    MetricCounter& iMetricConnections;
+    MetricGauge& iMetricSessionsBusy;
 };
 
 // general udp socket;
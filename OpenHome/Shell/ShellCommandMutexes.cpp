@@ -0,0 +1,42 @@
+#include <OpenHome/Private/ShellCommandMutexes.h>
+#include <OpenHome/Private/MutexProfiler.h>
+#include <OpenHome/Private/Stream.h>
+
+using namespace OpenHome;
+
+// ShellCommandMutexes
+
+static const TChar kShellCommandMutexes[] = "mutexes";
+
+ShellCommandMutexes::ShellCommandMutexes(Shell& aShell, MutexProfiler& aProfiler)
+    : iShell(aShell)
+    , iProfiler(aProfiler)
+{
+    iShell.AddCommandHandler(kShellCommandMutexes, *this);
+}
+
+ShellCommandMutexes::~ShellCommandMutexes()
+{
+    iShell.RemoveCommandHandler(kShellCommandMutexes);
+}
+
+void ShellCommandMutexes::HandleShellCommand(Brn /*aCommand*/, const std::vector<Brn>& aArgs, IWriter& aResponse)
+{
+    if (aArgs.size() == 0 || (aArgs.size() == 1 && aArgs[0] == Brn("show"))) {
+        iProfiler.WriteTable(aResponse);
+    }
+    else if (aArgs.size() == 1 && aArgs[0] == Brn("reset")) {
+        iProfiler.Reset();
+    }
+    else {
+        aResponse.Write(Brn("Unexpected arguments for \'mutexes\' command\n"));
+    }
+}
+
+void ShellCommandMutexes::DisplayHelp(IWriter& aResponse)
+{
+    aResponse.Write(Brn("mutexes [show|reset]\n"));
+    aResponse.Write(Brn("  show: list lock contention statistics, aggregated by mutex name\n"));
+    aResponse.Write(Brn("  reset: zero all statistics\n"));
+    aResponse.Write(Brn("  Requires InitialisationParams::SetEnableMutexProfiling()\n"));
+}
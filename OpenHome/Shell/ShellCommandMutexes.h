@@ -0,0 +1,29 @@
+#ifndef HEADER_SHELL_COMMAND_MUTEXES
+#define HEADER_SHELL_COMMAND_MUTEXES
+
+#include <OpenHome/Private/Shell.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+
+#include <vector>
+
+namespace OpenHome {
+class IWriter;
+class MutexProfiler;
+
+class ShellCommandMutexes : private IShellCommandHandler
+{
+public:
+    ShellCommandMutexes(Shell& aShell, MutexProfiler& aProfiler);
+    ~ShellCommandMutexes();
+private: // from IShellCommandHandler
+    void HandleShellCommand(Brn aCommand, const std::vector<Brn>& aArgs, IWriter& aResponse);
+    void DisplayHelp(IWriter& aResponse);
+private:
+    Shell& iShell;
+    MutexProfiler& iProfiler;
+};
+
+} // namespace OpenHome
+
+#endif // HEADER_SHELL_COMMAND_MUTEXES
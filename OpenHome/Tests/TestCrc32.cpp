@@ -0,0 +1,204 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/Crc32.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Debug.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Net/Private/Globals.h>
+#include <OpenHome/OsWrapper.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+
+// bit-at-a-time reference implementation
+static TUint32 ReferenceUpdate(TUint32 aCrc, const TByte* aPtr, TUint aBytes)
+{
+    for (TUint i=0; i<aBytes; i++) {
+        aCrc ^= aPtr[i];
+        for (TUint j=0; j<8; j++) {
+            aCrc = (aCrc >> 1) ^ (Crc32::kDefaultPolynomial & (0 - (aCrc & 1)));
+        }
+    }
+    return aCrc;
+}
+
+static void FillRandom(Bwx& aBuf, TUint aBytes, TUint32& aState)
+{
+    aBuf.SetBytes(0);
+    for (TUint i=0; i<aBytes; i++) {
+        aState = aState * 1103515245 + 12345;
+        aBuf.Append((TByte)(aState >> 16));
+    }
+}
+
+class SuiteCrc32Vectors : public Suite
+{
+public:
+    SuiteCrc32Vectors() : Suite("Crc32 known values") {}
+    void Test();
+};
+
+void SuiteCrc32Vectors::Test()
+{
+    TEST(Crc32::Compute(Brn("123456789")) == 0xcbf43926);
+    TEST(Crc32::Compute(Brx::Empty()) == 0);
+    TEST(Crc32::Compute(Brn("The quick brown fox jumps over the lazy dog")) == 0x414fa339);
+    TEST(Crc32::Compute(Brn("123456789")) == ~Crc32::Update(Crc32::kDefaultSeed, Brn("123456789")));
+    TEST(Crc32::UpdateSoftware(Crc32::kDefaultSeed, Brn("123456789")) == ~0xcbf43926u);
+    Print("Hardware accelerated: %s\n", Crc32::HardwareAccelerated()? "yes" : "no");
+}
+
+class SuiteCrc32Random : public Suite
+{
+public:
+    SuiteCrc32Random() : Suite("Crc32 random lengths and alignments") {}
+    void Test();
+};
+
+void SuiteCrc32Random::Test()
+{
+    Bwh buf(4096 + 16);
+    TUint32 state = 1;
+    FillRandom(buf, buf.MaxBytes(), state);
+    TBool ok = true;
+    for (TUint i=0; i<2000 && ok; i++) {
+        state = state * 1103515245 + 12345;
+        const TUint offset = (state >> 8) % 16;
+        state = state * 1103515245 + 12345;
+        const TUint bytes = (i < 300? i : (state >> 8) % 4096);
+        Brn data(buf.Ptr() + offset, bytes);
+        const TUint32 seed = (i & 1)? Crc32::kDefaultSeed : state;
+        const TUint32 expected = ReferenceUpdate(seed, data.Ptr(), data.Bytes());
+        ok = (Crc32::Update(seed, data) == expected &&
+              Crc32::UpdateSoftware(seed, data) == expected &&
+              Crc32::Compute(data, seed) == ~expected);
+    }
+    TEST(ok);
+}
+
+class SuiteCrc32Combine : public Suite
+{
+public:
+    SuiteCrc32Combine() : Suite("Crc32::Combine") {}
+    void Test();
+};
+
+void SuiteCrc32Combine::Test()
+{
+    Bwh buf(10000);
+    TUint32 state = 7;
+    FillRandom(buf, buf.MaxBytes(), state);
+    const TUint32 whole = Crc32::Compute(buf);
+    static const TUint kSplits[] = { 0, 1, 3, 64, 1000, 4999, 9999, 10000 };
+    for (TUint i=0; i<sizeof(kSplits)/sizeof(kSplits[0]); i++) {
+        Brn a(buf.Ptr(), kSplits[i]);
+        Brn b(buf.Ptr() + kSplits[i], buf.Bytes() - kSplits[i]);
+        TEST(Crc32::Combine(Crc32::Compute(a), Crc32::Compute(b), b.Bytes()) == whole);
+    }
+    // combining with an empty B leaves A unchanged
+    TEST(Crc32::Combine(0x12345678, 0, 0) == 0x12345678);
+}
+
+class SuiteCrc32Generator : public Suite
+{
+public:
+    SuiteCrc32Generator() : Suite("Crc32Generator and IReader") {}
+    void Test();
+};
+
+void SuiteCrc32Generator::Test()
+{
+    Bwh buf(5000);
+    TUint32 state = 3;
+    FillRandom(buf, buf.MaxBytes(), state);
+    const TUint32 expected = Crc32::Compute(buf);
+
+    Crc32Generator gen;
+    gen.Append(Brn(buf.Ptr(), 17));
+    gen.Append(Brn(buf.Ptr() + 17, 2000));
+    gen.Append(Brn(buf.Ptr() + 2017, buf.Bytes() - 2017));
+    TEST(gen.Result() == expected);
+    TEST_THROWS(gen.Append(buf), CrcGenerationFinished);
+
+    Crc32Generator gen2(buf);
+    TEST(gen2.Result() == expected);
+
+    ReaderBuffer reader(buf);
+    TEST(Crc32::Compute(reader) == expected);
+}
+
+class SuiteCrc32Throughput : public Suite
+{
+public:
+    SuiteCrc32Throughput() : Suite("Crc32 throughput") {}
+    void Test();
+private:
+    void Report(const TChar* aName, TUint64 aStartUs, TUint aBytes, TUint aIterations);
+};
+
+void SuiteCrc32Throughput::Report(const TChar* aName, TUint64 aStartUs, TUint aBytes, TUint aIterations)
+{
+    TUint64 us = Os::TimeInUs(gEnv->OsCtx()) - aStartUs;
+    if (us == 0) {
+        us = 1;
+    }
+    const TUint64 mbPerSec = ((TUint64)aBytes * aIterations) / us;
+    Print("    %-12s %6llu MB/s\n", aName, mbPerSec);
+}
+
+void SuiteCrc32Throughput::Test()
+{
+    static const TUint kBytes = 1024 * 1024;
+    Bwh buf(kBytes);
+    TUint32 state = 11;
+    FillRandom(buf, kBytes, state);
+    TUint32 sink = 0;
+
+    TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+    sink ^= ReferenceUpdate(Crc32::kDefaultSeed, buf.Ptr(), buf.Bytes());
+    Report("bitwise", start, kBytes, 1);
+
+    static const TUint kIterations = 64;
+    start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kIterations; i++) {
+        sink ^= Crc32::UpdateSoftware(Crc32::kDefaultSeed, buf);
+    }
+    Report("slice16", start, kBytes, kIterations);
+
+    start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kIterations; i++) {
+        sink ^= Crc32::Update(Crc32::kDefaultSeed, buf);
+    }
+    Report("default", start, kBytes, kIterations);
+
+    // checksum in 4 independent chunks then combine, as a multi-threaded caller would
+    static const TUint kChunks = 4;
+    const TUint chunkBytes = kBytes / kChunks;
+    start = Os::TimeInUs(gEnv->OsCtx());
+    TUint32 combined = 0;
+    for (TUint i=0; i<kIterations; i++) {
+        combined = Crc32::Compute(Brn(buf.Ptr(), chunkBytes));
+        for (TUint j=1; j<kChunks; j++) {
+            const TUint32 crc = Crc32::Compute(Brn(buf.Ptr() + j*chunkBytes, chunkBytes));
+            combined = Crc32::Combine(combined, crc, chunkBytes);
+        }
+    }
+    Report("chunked", start, kBytes, kIterations);
+    TEST(combined == Crc32::Compute(buf));
+    Print("    (checksum %08x)\n", sink); // keep the loops above from being optimised away
+}
+
+
+void TestCrc32()
+{
+    Debug::SetLevel(Debug::kNone);
+
+    Runner runner("Crc32 testing\n");
+    runner.Add(new SuiteCrc32Vectors());
+    runner.Add(new SuiteCrc32Random());
+    runner.Add(new SuiteCrc32Combine());
+    runner.Add(new SuiteCrc32Generator());
+    runner.Add(new SuiteCrc32Throughput());
+    runner.Run();
+}
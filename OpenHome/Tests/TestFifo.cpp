@@ -1,6 +1,11 @@
 #include <OpenHome/Private/TestFramework.h>
 #include <OpenHome/Private/Fifo.h>
 #include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Net/Private/Globals.h>
+#include <OpenHome/OsWrapper.h>
+
+#include <vector>
 
 using namespace OpenHome;
 using namespace OpenHome::TestFramework;
@@ -327,6 +332,143 @@ void SuiteFifoInterrupt::RunWriter()
     }
 }
 
+class SuiteFifoStress : public Suite
+{
+public:
+    SuiteFifoStress();
+    void Test();
+private:
+    void Run(TUint aProducers, TUint aConsumers, TUint aSlots);
+    void Produce();
+    void Consume();
+private:
+    static const TUint kEntriesPerProducer = 100000;
+    static const TUint kProducerShift = 24;
+    static const TUint kSeqMask = (1<<kProducerShift) - 1;
+    static const TUint kMaxProducers = 8;
+    static const TUint kStop = 0xffffffff;
+    Fifo<TUint>* iFifo;
+    Mutex iLock;
+    TUint iNextProducer;
+    TUint iNumProducers;
+    TUint iReceived;
+    TUint iOrderErrors;
+    TUint iOverfull;
+};
+
+SuiteFifoStress::SuiteFifoStress()
+    : Suite("Fifo multiple writers, multiple readers stress")
+    , iFifo(NULL)
+    , iLock("SFSL")
+{
+}
+
+void SuiteFifoStress::Test()
+{
+    // capacities which aren't a power of 2 check that Slots() rather than the ring size bounds the fifo
+    Run(1, 1, 1);
+    Run(1, 1, 64);
+    Run(2, 2, 3);
+    Run(4, 4, 7);
+    Run(4, 1, 100);
+    Run(1, 4, 100);
+    Run(8, 8, 32);
+}
+
+void SuiteFifoStress::Run(TUint aProducers, TUint aConsumers, TUint aSlots)
+{
+    iFifo = new Fifo<TUint>(aSlots);
+    iNextProducer = 0;
+    iNumProducers = aProducers;
+    iReceived = 0;
+    iOrderErrors = 0;
+    iOverfull = 0;
+    std::vector<ThreadFunctor*> producers;
+    std::vector<ThreadFunctor*> consumers;
+    for (TUint i=0; i<aConsumers; i++) {
+        consumers.push_back(new ThreadFunctor("SFSC", MakeFunctor(*this, &SuiteFifoStress::Consume)));
+    }
+    for (TUint i=0; i<aProducers; i++) {
+        producers.push_back(new ThreadFunctor("SFSP", MakeFunctor(*this, &SuiteFifoStress::Produce)));
+    }
+
+    const TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<aConsumers; i++) {
+        consumers[i]->Start();
+    }
+    for (TUint i=0; i<aProducers; i++) {
+        producers[i]->Start();
+    }
+    for (TUint i=0; i<aProducers; i++) {
+        delete producers[i]; // waits for the thread to exit
+    }
+    for (TUint i=0; i<aConsumers; i++) {
+        iFifo->Write(kStop);
+    }
+    for (TUint i=0; i<aConsumers; i++) {
+        delete consumers[i];
+    }
+    const TUint64 elapsedUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+
+    const TUint expected = aProducers * kEntriesPerProducer;
+    TEST(iReceived == expected);
+    TEST(iOrderErrors == 0);
+    TEST(iOverfull == 0);
+    TEST(iFifo->SlotsUsed() == 0);
+    const TUint perSec = (elapsedUs == 0? 0 : (TUint)((TUint64)expected * 1000000 / elapsedUs));
+    Print("    %u writer(s), %u reader(s), %3u slots: %u entries in %llums (%u/s)\n",
+          aProducers, aConsumers, aSlots, expected, elapsedUs/1000, perSec);
+    delete iFifo;
+    iFifo = NULL;
+}
+
+void SuiteFifoStress::Produce()
+{
+    iLock.Wait();
+    const TUint id = iNextProducer++;
+    iLock.Signal();
+    for (TUint i=0; i<kEntriesPerProducer; i++) {
+        iFifo->Write((id << kProducerShift) | i);
+        if (iFifo->SlotsUsed() > iFifo->Slots()) {
+            iLock.Wait();
+            iOverfull++;
+            iLock.Signal();
+        }
+    }
+}
+
+void SuiteFifoStress::Consume()
+{
+    // entries from any one writer must be read in the order they were written
+    TUint lastSeq[kMaxProducers];
+    TBool seen[kMaxProducers];
+    for (TUint i=0; i<kMaxProducers; i++) {
+        seen[i] = false;
+    }
+    TUint received = 0;
+    TUint orderErrors = 0;
+    for (;;) {
+        const TUint entry = iFifo->Read();
+        if (entry == kStop) {
+            break;
+        }
+        const TUint producer = entry >> kProducerShift;
+        const TUint seq = entry & kSeqMask;
+        if (producer >= iNumProducers || (seen[producer] && seq <= lastSeq[producer])) {
+            orderErrors++;
+        }
+        else {
+            seen[producer] = true;
+            lastSeq[producer] = seq;
+        }
+        received++;
+    }
+    iLock.Wait();
+    iReceived += received;
+    iOrderErrors += orderErrors;
+    iLock.Signal();
+}
+
 class SuiteFifoLiteBasic : public Suite
 {
 public:
@@ -410,6 +552,7 @@ void TestFifo()
     runner.Add(new SuiteFifoBasic());
     runner.Add(new SuiteFifoThreadSafety());
     runner.Add(new SuiteFifoInterrupt());
+    runner.Add(new SuiteFifoStress());
     runner.Add(new SuiteFifoLiteBasic());
     runner.Run();
 }
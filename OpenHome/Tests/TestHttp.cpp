@@ -0,0 +1,232 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/Http.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Env.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+
+class SuiteReaderHttpHeader : public Suite, private IHttpHeaderObserver
+{
+public:
+    SuiteReaderHttpHeader(Environment& aEnv);
+
+public: // Suite
+    void Test();
+
+private:
+    class CountingHeader : public HttpHeader
+    {
+    public:
+        CountingHeader(const TChar* aField);
+        TUint RecogniseCount() const { return iRecogniseCount; }
+        const Brx& Value() const { return iValue; }
+    private: // from HttpHeader
+        TBool Recognise(const Brx& aHeader);
+        void Process(const Brx& aValue);
+    private:
+        Brn iField;
+        TUint iRecogniseCount;
+        Bws<32> iValue;
+    };
+private:
+    void Read(ReaderHttpRequest& aReader, const Brx& aRequest);
+    void TestDispatch();
+    void TestUnknownFields();
+    void TestLongFields();
+    void TestObserver();
+private: // from IHttpHeaderObserver
+    void NotifyHeader(const Brx& aField, const Brx& aValue);
+private:
+    Environment& iEnv;
+    ReaderBuffer iReaderBuffer;
+    ReaderUntilS<1024> iReaderUntil;
+    std::vector<Bwh*> iObserved;
+};
+
+
+// SuiteReaderHttpHeader
+SuiteReaderHttpHeader::CountingHeader::CountingHeader(const TChar* aField)
+    : iField(aField)
+    , iRecogniseCount(0)
+{ }
+
+TBool SuiteReaderHttpHeader::CountingHeader::Recognise(const Brx& aHeader)
+{
+    iRecogniseCount++;
+    return Ascii::CaseInsensitiveEquals(aHeader, iField);
+}
+
+void SuiteReaderHttpHeader::CountingHeader::Process(const Brx& aValue)
+{
+    SetReceived();
+    iValue.Replace(aValue);
+}
+
+SuiteReaderHttpHeader::SuiteReaderHttpHeader(Environment& aEnv)
+    : Suite("SuiteReaderHttpHeader")
+    , iEnv(aEnv)
+    , iReaderUntil(iReaderBuffer)
+{ }
+
+void SuiteReaderHttpHeader::Test()
+{
+    TestDispatch();
+    TestUnknownFields();
+    TestLongFields();
+    TestObserver();
+}
+
+void SuiteReaderHttpHeader::Read(ReaderHttpRequest& aReader, const Brx& aRequest)
+{
+    iReaderBuffer.Set(aRequest);
+    aReader.Flush();
+    aReader.Read();
+}
+
+void SuiteReaderHttpHeader::TestDispatch()
+{
+    ReaderHttpRequest reader(iEnv, iReaderUntil);
+    reader.AddMethod(Http::kMethodGet);
+    CountingHeader headerA("X-A");
+    CountingHeader headerB("X-B");
+    reader.AddHeader(headerA);
+    reader.AddHeader(headerB);
+
+    Read(reader, Brn("GET / HTTP/1.1\r\nX-B: 1\r\n\r\n"));
+    TEST(headerB.Received());
+    TEST(headerB.Value() == Brn("1"));
+    TEST(headerA.RecogniseCount() == 1);
+    TEST(headerB.RecogniseCount() == 1);
+
+    // a field recognised before goes straight to its header, whatever its case
+    Read(reader, Brn("GET / HTTP/1.1\r\nx-b: 2\r\nX-A: 3\r\n\r\n"));
+    TEST(headerB.Value() == Brn("2"));
+    TEST(headerA.Value() == Brn("3"));
+    TEST(headerA.RecogniseCount() == 2);
+    TEST(headerB.RecogniseCount() == 1);
+
+    Read(reader, Brn("GET / HTTP/1.1\r\nX-A: 4\r\nX-B: 5\r\n\r\n"));
+    TEST(headerA.Value() == Brn("4"));
+    TEST(headerB.Value() == Brn("5"));
+    TEST(headerA.RecogniseCount() == 2);
+    TEST(headerB.RecogniseCount() == 1);
+
+    // adding a header forgets what was recorded
+    CountingHeader headerC("X-C");
+    reader.AddHeader(headerC);
+    Read(reader, Brn("GET / HTTP/1.1\r\nX-B: 6\r\nX-C: 7\r\n\r\n"));
+    TEST(headerB.Value() == Brn("6"));
+    TEST(headerC.Value() == Brn("7"));
+    TEST(headerA.RecogniseCount() == 4);
+    TEST(headerB.RecogniseCount() == 3);
+    TEST(headerC.RecogniseCount() == 1);
+}
+
+void SuiteReaderHttpHeader::TestUnknownFields()
+{
+    ReaderHttpRequest reader(iEnv, iReaderUntil);
+    reader.AddMethod(Http::kMethodGet);
+    CountingHeader headerA("X-A");
+    CountingHeader headerB("X-B");
+    reader.AddHeader(headerA);
+    reader.AddHeader(headerB);
+
+    // an unknown field is only offered to the headers the first time it's seen
+    Read(reader, Brn("GET / HTTP/1.1\r\nUnknown: 1\r\n\r\n"));
+    TEST(headerA.RecogniseCount() == 1);
+    TEST(headerB.RecogniseCount() == 1);
+    Read(reader, Brn("GET / HTTP/1.1\r\nUNKNOWN: 2\r\nUnknown: 3\r\n\r\n"));
+    TEST(headerA.RecogniseCount() == 1);
+    TEST(headerB.RecogniseCount() == 1);
+    TEST(!headerA.Received());
+    TEST(!headerB.Received());
+
+    // many distinct unknown fields shouldn't prevent later fields being recorded
+    Bwh request(4096);
+    request.Append("GET / HTTP/1.1\r\n");
+    const TUint kUnknownFields = 40;
+    for (TUint i=0; i<kUnknownFields; i++) {
+        request.Append("Junk");
+        Ascii::AppendDec(request, i);
+        request.Append(": x\r\n");
+    }
+    request.Append("X-B: 1\r\n\r\n");
+    Read(reader, request);
+    TEST(headerB.Value() == Brn("1"));
+    TEST(headerA.RecogniseCount() == kUnknownFields + 2);
+    TEST(headerB.RecogniseCount() == kUnknownFields + 2);
+
+    Read(reader, Brn("GET / HTTP/1.1\r\nX-B: 2\r\n\r\n"));
+    TEST(headerB.Value() == Brn("2"));
+    TEST(headerA.RecogniseCount() == kUnknownFields + 2);
+    TEST(headerB.RecogniseCount() == kUnknownFields + 2);
+
+    // unknown fields that weren't recorded are still dispatched correctly
+    Read(reader, Brn("GET / HTTP/1.1\r\nJunk39: y\r\nX-A: 3\r\n\r\n"));
+    TEST(headerA.Value() == Brn("3"));
+    TEST(headerA.RecogniseCount() == kUnknownFields + 4);
+    TEST(headerB.RecogniseCount() == kUnknownFields + 3);
+}
+
+void SuiteReaderHttpHeader::TestLongFields()
+{
+    ReaderHttpRequest reader(iEnv, iReaderUntil);
+    reader.AddMethod(Http::kMethodGet);
+    CountingHeader headerLong("X-A-Field-Name-Too-Long-To-Record-In-Dispatch");
+    reader.AddHeader(headerLong);
+
+    // fields too long to record are recognised every time they're seen
+    Read(reader, Brn("GET / HTTP/1.1\r\nX-A-Field-Name-Too-Long-To-Record-In-Dispatch: 1\r\n\r\n"));
+    TEST(headerLong.Value() == Brn("1"));
+    TEST(headerLong.RecogniseCount() == 1);
+    Read(reader, Brn("GET / HTTP/1.1\r\nX-A-Field-Name-Too-Long-To-Record-In-Dispatch: 2\r\n\r\n"));
+    TEST(headerLong.Value() == Brn("2"));
+    TEST(headerLong.RecogniseCount() == 2);
+}
+
+void SuiteReaderHttpHeader::TestObserver()
+{
+    ReaderHttpRequest reader(iEnv, iReaderUntil);
+    reader.AddMethod(Http::kMethodGet);
+    CountingHeader headerA("X-A");
+    reader.AddHeader(headerA);
+    reader.SetHeaderObserver(this);
+
+    Read(reader, Brn("GET / HTTP/1.1\r\nX-A: 1\r\nUnknown: two\r\n\r\n"));
+    TEST(headerA.Value() == Brn("1"));
+    TEST(iObserved.size() == 4);
+    if (iObserved.size() == 4) {
+        TEST(*iObserved[0] == Brn("X-A"));
+        TEST(*iObserved[1] == Brn("1"));
+        TEST(*iObserved[2] == Brn("Unknown"));
+        TEST(*iObserved[3] == Brn("two"));
+    }
+
+    reader.SetHeaderObserver(NULL);
+    Read(reader, Brn("GET / HTTP/1.1\r\nX-A: 2\r\n\r\n"));
+    TEST(headerA.Value() == Brn("2"));
+    TEST(iObserved.size() == 4);
+
+    for (TUint i=0; i<iObserved.size(); i++) {
+        delete iObserved[i];
+    }
+    iObserved.clear();
+}
+
+void SuiteReaderHttpHeader::NotifyHeader(const Brx& aField, const Brx& aValue)
+{
+    iObserved.push_back(new Bwh(aField));
+    iObserved.push_back(new Bwh(aValue));
+}
+
+
+void TestHttp(Environment& aEnv)
+{
+    Runner runner("Http testing.");
+    runner.Add(new SuiteReaderHttpHeader(aEnv));
+    runner.Run();
+}
@@ -0,0 +1,159 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/Metrics.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/InfoProvider.h>
+#include <OpenHome/Buffer.h>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+
+class SuiteMetricsRegistry : public Suite
+{
+public:
+    SuiteMetricsRegistry() : Suite("MetricsRegistry text exposition") {}
+    void Test();
+};
+
+// Registers a metric whenever it's written to, so only works if WriteText doesn't hold the registry lock
+class WriterRegistering : public IWriter
+{
+public:
+    WriterRegistering(MetricsRegistry& aRegistry) : iRegistry(aRegistry), iWrites(0) {}
+    TUint Writes() const { return iWrites; }
+private: // from IWriter
+    void Write(TByte /*aValue*/) { Register(); }
+    void Write(const Brx& /*aBuffer*/) { Register(); }
+    void WriteFlush() {}
+private:
+    void Register() { (void)iRegistry.Counter("test_registered_total", "Registered while writing"); iWrites++; }
+private:
+    MetricsRegistry& iRegistry;
+    TUint iWrites;
+};
+
+void SuiteMetricsRegistry::Test()
+{
+    MetricsRegistry registry;
+    MetricCounter& requests = registry.Counter("test_requests_total", "Requests received");
+    MetricGauge& sessions = registry.Gauge("test_sessions", "Open sessions");
+
+    // looking up an existing name returns the same metric
+    TEST(&registry.Counter("test_requests_total", "ignored") == &requests);
+    TEST(&registry.Gauge("test_sessions", "ignored") == &sessions);
+
+    WriterBwh writer(1024);
+    registry.WriteText(writer);
+    TEST(writer.Buffer() == Brn("# HELP test_requests_total Requests received\n"
+                                "# TYPE test_requests_total counter\n"
+                                "test_requests_total 0\n"
+                                "# HELP test_sessions Open sessions\n"
+                                "# TYPE test_sessions gauge\n"
+                                "test_sessions 0\n"));
+
+    requests.Inc();
+    requests.Add(41);
+    sessions.Inc();
+    sessions.Inc();
+    sessions.Dec();
+    TEST(requests.Value() == 42);
+    TEST(sessions.Value() == 1);
+    writer.Reset();
+    registry.WriteText(writer);
+    TEST(writer.Buffer() == Brn("# HELP test_requests_total Requests received\n"
+                                "# TYPE test_requests_total counter\n"
+                                "test_requests_total 42\n"
+                                "# HELP test_sessions Open sessions\n"
+                                "# TYPE test_sessions gauge\n"
+                                "test_sessions 1\n"));
+
+    // gauges are signed
+    sessions.Set(-3);
+    writer.Reset();
+    IInfoProvider& info = registry;
+    info.QueryInfo(MetricsRegistry::kQueryMetrics, writer);
+    TEST(writer.Buffer() == Brn("# HELP test_requests_total Requests received\n"
+                                "# TYPE test_requests_total counter\n"
+                                "test_requests_total 42\n"
+                                "# HELP test_sessions Open sessions\n"
+                                "# TYPE test_sessions gauge\n"
+                                "test_sessions -3\n"));
+
+    // unrelated info queries write nothing
+    writer.Reset();
+    info.QueryInfo(Brn("threads"), writer);
+    TEST(writer.Buffer().Bytes() == 0);
+
+    // the output is written after the registry lock is released
+    WriterRegistering registering(registry);
+    registry.WriteText(registering);
+    TEST(registering.Writes() == 1);
+    writer.Reset();
+    registry.WriteText(writer);
+    TEST(Brn(writer.Buffer().Split(writer.Buffer().Bytes() - 24)) == Brn("test_registered_total 0\n"));
+}
+
+class SuiteMetricsServer : public Suite
+{
+    static const TUint kTimeoutMs = 1000;
+public:
+    SuiteMetricsServer(Environment& aEnv) : Suite("MetricsServer"), iEnv(aEnv) {}
+    void Test();
+private:
+    void Get(TUint aPort, const Brx& aUri, Bwx& aResponse);
+private:
+    Environment& iEnv;
+    TIpAddress iLoopback;
+};
+
+void SuiteMetricsServer::Test()
+{
+    iLoopback.iFamily = kFamilyV4;
+    iLoopback.iV4 = MakeIpAddress(127, 0, 0, 1);
+    MetricsRegistry registry;
+    registry.Counter("test_hits_total", "Hits").Add(7);
+    MetricsServer server(iEnv, registry, 0, iLoopback);
+
+    Bws<1024> response;
+    Get(server.Port(), MetricsSession::kUriMetrics, response);
+    TEST(response.BeginsWith(Brn("HTTP/1.1 200")));
+    TEST(response.Split(response.Bytes() - 18) == Brn("test_hits_total 7\n"));
+
+    Get(server.Port(), Brn("/"), response);
+    TEST(response.BeginsWith(Brn("HTTP/1.1 404")));
+    TEST(response.Split(response.Bytes() - 18) != Brn("test_hits_total 7\n"));
+
+    Get(server.Port(), Brn("/metrics/extra"), response);
+    TEST(response.BeginsWith(Brn("HTTP/1.1 404")));
+}
+
+void SuiteMetricsServer::Get(TUint aPort, const Brx& aUri, Bwx& aResponse)
+{
+    aResponse.SetBytes(0);
+    SocketTcpClient client;
+    client.Open(iEnv);
+    client.Connect(Endpoint(aPort, iLoopback), kTimeoutMs);
+    client.Write(Brn("GET "));
+    client.Write(aUri);
+    client.Write(Brn(" HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n"));
+    Bws<256> buf;
+    for (;;) {
+        try {
+            client.Read(buf);
+        }
+        catch (ReaderError&) {
+            break;
+        }
+        aResponse.Append(buf);
+    }
+    client.Close();
+}
+
+void TestMetrics(Environment& aEnv)
+{
+    Runner runner("Metrics tests\n");
+    runner.Add(new SuiteMetricsRegistry());
+    runner.Add(new SuiteMetricsServer(aEnv));
+    runner.Run();
+}
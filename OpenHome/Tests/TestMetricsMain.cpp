@@ -0,0 +1,13 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Net/Core/OhNet.h>
+
+using namespace OpenHome;
+
+extern void TestMetrics(Environment& aEnv);
+
+void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
+{
+    Net::Library* lib = new Net::Library(aInitParams);
+    TestMetrics(lib->Env());
+    delete lib;
+}
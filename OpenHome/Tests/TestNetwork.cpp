@@ -133,6 +133,20 @@ void SuiteTcpClient::Test()
     TEST(session->TestDone() == true);
     TEST(session->Buffer() == Brn("abcdefghijklmnopabcdefghijklmnop"));
 
+    // Test 1 - gather write of many (including empty) buffers arrives as a single stream
+    session->StartTest(1,32);
+    TEST(session->TestDone() == false);
+    const Brn gathered("abcdefghijklmnopabcdefghijklmnop");
+    std::vector<Brn> buffers;
+    buffers.push_back(Brx::Empty());
+    for (TUint i=0; i<gathered.Bytes(); i++) {
+        buffers.push_back(gathered.Split(i, 1));
+    }
+    client.WriteV(buffers);
+    sem.Wait();
+    TEST(session->TestDone() == true);
+    TEST(session->Buffer() == gathered);
+
     // Test 2 - test Receive(Bwx& , TUint ) interface behaviour when
     // remote end closes socket before aBytes are received
     session->StartTest(2,32);
@@ -1,5 +1,6 @@
 #include <OpenHome/Private/TestFramework.h>
 #include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/BufferPool.h>
 #include <cstdarg>
 
 using namespace OpenHome;
@@ -305,11 +306,126 @@ void SuiteWriterRingBuffer::Test()
     }
 }
 
+class SuiteBufferPool : public Suite
+{
+public:
+    SuiteBufferPool() : Suite("BufferPool") {}
+    void Test();
+};
+
+void SuiteBufferPool::Test()
+{
+    BufferPool pool(1);
+    Bwh* buf = pool.Acquire(100);
+    TEST(buf->Bytes() == 0);
+    TEST(buf->MaxBytes() == 256);
+    TEST(pool.BytesInUse() == 256);
+    buf->Append(Brn("abc"));
+    pool.Release(buf);
+    TEST(pool.BytesInUse() == 0);
+    TEST(pool.BytesFree() == 256);
+
+    // released buffers are reused (and emptied)
+    Bwh* buf2 = pool.Acquire(256);
+    TEST(buf2 == buf);
+    TEST(buf2->Bytes() == 0);
+    TEST(pool.BytesFree() == 0);
+
+    // only aMaxFreePerClass buffers of each size are kept
+    Bwh* buf3 = pool.Acquire(200);
+    pool.Release(buf2);
+    pool.Release(buf3);
+    TEST(pool.BytesFree() == 256);
+
+    // requests larger than the biggest class aren't pooled
+    Bwh* large = pool.Acquire(BufferPool::kMaxPooledBytes + 1);
+    TEST(large->MaxBytes() == BufferPool::kMaxPooledBytes + 1);
+    pool.Release(large);
+    TEST(pool.BytesInUse() == 0);
+    TEST(pool.BytesFree() == 256);
+}
+
+class SuiteSwp : public Suite
+{
+public:
+    SuiteSwp() : Suite("Swp") {}
+    void Test();
+};
+
+void SuiteSwp::Test()
+{
+    BufferPool pool;
+    WriterBwh sink(64);
+    Swp writer(pool, 1024, sink);
+    TEST(pool.BytesInUse() == 0);
+    writer.Write(Brn("abc"));
+    writer.Write('d');
+    TEST(pool.BytesInUse() == 1024);
+    TEST(sink.Buffer().Bytes() == 0);
+    writer.WriteFlush();
+    TEST(pool.BytesInUse() == 0);
+    TEST(sink.Buffer() == Brn("abcd"));
+
+    // writes larger than the buffer are passed straight through
+    Bwh big(3000);
+    big.SetBytes(big.MaxBytes());
+    writer.Write(Brn("e"));
+    writer.Write(big);
+    writer.WriteFlush();
+    TEST(sink.Buffer().Bytes() == 4 + 1 + 3000);
+    TEST(pool.BytesInUse() == 0);
+}
+
+class SuiteWriterBufferChain : public Suite
+{
+public:
+    SuiteWriterBufferChain() : Suite("WriterBufferChain") {}
+    void Test();
+};
+
+void SuiteWriterBufferChain::Test()
+{
+    BufferPool pool;
+    WriterBufferChain chain(pool, 256, 100*1024);
+    TEST(chain.Buffer().Bytes() == 0);
+    chain.Write(Brn("abc"));
+    TEST(chain.Buffer() == Brn("abc"));
+    TEST(pool.BytesInUse() == 256);
+
+    // grows past the first chunk and is merged into a single contiguous buffer on request
+    Bws<100> block;
+    for (TUint i=0; i<block.MaxBytes(); i++) {
+        block.Append((TByte)i);
+    }
+    for (TUint i=0; i<800; i++) {
+        chain.Write(block);
+    }
+    TEST(chain.Bytes() == 3 + 800*100);
+    const Brx& buf = chain.Buffer();
+    TEST(buf.Bytes() == chain.Bytes());
+    TEST(Brn(buf.Ptr(), 3) == Brn("abc"));
+    TEST(Brn(buf.Ptr() + 3 + 799*100, 100) == block);
+    TEST(Brn(buf.Ptr() + 3 + 456*100, 100) == block);
+
+    chain.Reset();
+    TEST(chain.Bytes() == 0);
+    TEST(pool.BytesInUse() == 0);
+
+    // writes beyond aMaxBytes fail
+    WriterBufferChain small(pool, 256, 150);
+    small.Write(block);
+    TEST_THROWS(small.Write(block), WriterError);
+    TEST(small.Bytes() == 100);
+}
+
 void TestStream()
 {
     Runner runner("Stream Testing\n");
     runner.Add(new SuiteReaderBinary());
     runner.Add(new SuiteWriterBinary());
     runner.Add(new SuiteWriterRingBuffer());
+    runner.Add(new SuiteBufferPool());
+    runner.Add(new SuiteSwp());
+    runner.Add(new SuiteWriterBufferChain());
     runner.Run();
 }
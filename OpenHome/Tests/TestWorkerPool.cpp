@@ -0,0 +1,278 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/WorkerPool.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Parser.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Debug.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Net/Private/Globals.h>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+
+class JobCounter : public IWorkerPoolHandler, private INonCopyable
+{
+public:
+    JobCounter(TBool aGated);
+    void Release(TUint aCount);
+    void ReleaseRunningAfterDelay();
+    TBool WaitStarted(TUint aTimeoutMs);
+    TBool WaitDone(TUint aTimeoutMs);
+    TUint Done() const;
+private: // from IWorkerPoolHandler
+    void ProcessJob();
+private:
+    const TBool iGated;
+    mutable Mutex iLock;
+    Semaphore iGate;
+    Semaphore iStarted;
+    Semaphore iDone;
+    TUint iNumBlocked;
+    TUint iNumDone;
+};
+
+JobCounter::JobCounter(TBool aGated)
+    : iGated(aGated)
+    , iLock("TWPC")
+    , iGate("TWPG", 0)
+    , iStarted("TWPS", 0)
+    , iDone("TWPD", 0)
+    , iNumBlocked(0)
+    , iNumDone(0)
+{
+}
+
+void JobCounter::Release(TUint aCount)
+{
+    for (TUint i=0; i<aCount; i++) {
+        iGate.Signal();
+    }
+}
+
+void JobCounter::ReleaseRunningAfterDelay()
+{
+    Thread::Sleep(100);
+    iLock.Wait();
+    const TUint count = iNumBlocked;
+    iLock.Signal();
+    Release(count);
+}
+
+TBool JobCounter::WaitStarted(TUint aTimeoutMs)
+{
+    try {
+        iStarted.Wait(aTimeoutMs);
+    }
+    catch (Timeout&) {
+        return false;
+    }
+    return true;
+}
+
+TBool JobCounter::WaitDone(TUint aTimeoutMs)
+{
+    try {
+        iDone.Wait(aTimeoutMs);
+    }
+    catch (Timeout&) {
+        return false;
+    }
+    return true;
+}
+
+TUint JobCounter::Done() const
+{
+    AutoMutex _(iLock);
+    return iNumDone;
+}
+
+void JobCounter::ProcessJob()
+{
+    if (iGated) {
+        iLock.Wait();
+        iNumBlocked++;
+        iLock.Signal();
+        iStarted.Signal();
+        iGate.Wait();
+    }
+    else {
+        iStarted.Signal();
+    }
+    iLock.Wait();
+    if (iGated) {
+        iNumBlocked--;
+    }
+    iNumDone++;
+    iLock.Signal();
+    iDone.Signal();
+}
+
+static TBool WaitForThreads(WorkerPool& aPool, TUint aNumThreads, TUint aTimeoutMs)
+{
+    for (TUint elapsed=0; elapsed<aTimeoutMs; elapsed+=10) {
+        if (aPool.NumThreads() == aNumThreads) {
+            return true;
+        }
+        Thread::Sleep(10);
+    }
+    return (aPool.NumThreads() == aNumThreads);
+}
+
+
+class SuiteWorkerPoolBasic : public Suite
+{
+public:
+    SuiteWorkerPoolBasic() : Suite("WorkerPool processes every job") {}
+    void Test();
+};
+
+void SuiteWorkerPoolBasic::Test()
+{
+    JobCounter counter(false);
+    WorkerPool pool(*gEnv, "TestPool", counter, 2, 4, 0);
+    TEST(pool.NumThreads() == 2);
+    static const TUint kNumJobs = 1000;
+    for (TUint i=0; i<kNumJobs; i++) {
+        pool.JobAdded();
+    }
+    TBool ok = true;
+    for (TUint i=0; i<kNumJobs && ok; i++) {
+        ok = counter.WaitDone(5000);
+    }
+    TEST(ok);
+    TEST(counter.Done() == kNumJobs);
+    TEST(pool.NumThreads() <= 4);
+}
+
+class SuiteWorkerPoolGrow : public Suite
+{
+public:
+    SuiteWorkerPoolGrow() : Suite("WorkerPool grows to its maximum then shrinks") {}
+    void Test();
+};
+
+void SuiteWorkerPoolGrow::Test()
+{
+    JobCounter counter(true);
+    WorkerPool pool(*gEnv, "TestPool", counter, 2, 4, 50);
+    static const TUint kNumJobs = 6;
+    for (TUint i=0; i<kNumJobs; i++) {
+        pool.JobAdded();
+    }
+    // all 4 threads should be blocked in jobs; the other 2 jobs wait for a free thread
+    for (TUint i=0; i<4; i++) {
+        TEST(counter.WaitStarted(5000));
+    }
+    TEST(pool.NumThreads() == 4);
+    TEST(pool.NumBusy() == 4);
+    TEST(!counter.WaitStarted(100));
+
+    counter.Release(kNumJobs);
+    for (TUint i=0; i<kNumJobs; i++) {
+        TEST(counter.WaitDone(5000));
+    }
+    TEST(counter.Done() == kNumJobs);
+
+    // threads above the minimum exit once idle for 50ms
+    TEST(WaitForThreads(pool, 2, 5000));
+    // ...and the pool grows again on demand
+    counter.Release(3);
+    for (TUint i=0; i<3; i++) {
+        pool.JobAdded();
+    }
+    for (TUint i=0; i<3; i++) {
+        TEST(counter.WaitDone(5000));
+    }
+    TEST(pool.NumThreads() >= 2 && pool.NumThreads() <= 4);
+}
+
+class SuiteWorkerPoolFixed : public Suite
+{
+public:
+    SuiteWorkerPoolFixed() : Suite("WorkerPool with max no higher than min doesn't grow") {}
+    void Test();
+};
+
+void SuiteWorkerPoolFixed::Test()
+{
+    JobCounter counter(true);
+    WorkerPool pool(*gEnv, "TestPool", counter, 3, 1, 50);
+    for (TUint i=0; i<5; i++) {
+        pool.JobAdded();
+    }
+    for (TUint i=0; i<3; i++) {
+        TEST(counter.WaitStarted(5000));
+    }
+    TEST(!counter.WaitStarted(100));
+    TEST(pool.NumThreads() == 3);
+    counter.Release(5);
+    for (TUint i=0; i<5; i++) {
+        TEST(counter.WaitDone(5000));
+    }
+    Thread::Sleep(150);
+    TEST(pool.NumThreads() == 3);
+}
+
+class SuiteWorkerPoolShutdown : public Suite
+{
+public:
+    SuiteWorkerPoolShutdown() : Suite("WorkerPool deleted with jobs pending") {}
+    void Test();
+};
+
+void SuiteWorkerPoolShutdown::Test()
+{
+    JobCounter counter(true);
+    WorkerPool* pool = new WorkerPool(*gEnv, "TestPool", counter, 1, 2, 0);
+    for (TUint i=0; i<10; i++) {
+        pool->JobAdded();
+    }
+    TEST(counter.WaitStarted(5000));
+    TEST(counter.WaitStarted(5000));
+    // let the two running jobs complete once the pool is being deleted; the rest are never started
+    ThreadFunctor* releaser = new ThreadFunctor("TWPR", MakeFunctor(counter, &JobCounter::ReleaseRunningAfterDelay));
+    releaser->Start();
+    delete pool;
+    TEST(counter.Done() == 2);
+    delete releaser;
+}
+
+class SuiteWorkerPoolRegistry : public Suite
+{
+public:
+    SuiteWorkerPoolRegistry() : Suite("WorkerPoolRegistry reports live pools") {}
+    void Test();
+};
+
+void SuiteWorkerPoolRegistry::Test()
+{
+    JobCounter counter(false);
+    WorkerPool* pool = new WorkerPool(*gEnv, "RegistryPool", counter, 1, 2, 0);
+    pool->JobAdded();
+    TEST(counter.WaitDone(5000));
+    WriterBwh writer(1024);
+    gEnv->WorkerPools().WriteTable(writer);
+    Parser parser(writer.Buffer());
+    (void)parser.Next('\n'); // header
+    Brn row = parser.Next('\n');
+    TEST(Ascii::Contains(row, Brn("RegistryPool")));
+    delete pool;
+    WriterBwh writer2(1024);
+    gEnv->WorkerPools().WriteTable(writer2);
+    TEST(!Ascii::Contains(writer2.Buffer(), Brn("RegistryPool")));
+}
+
+
+void TestWorkerPool()
+{
+    Debug::SetLevel(Debug::kNone);
+
+    Runner runner("WorkerPool testing\n");
+    runner.Add(new SuiteWorkerPoolBasic());
+    runner.Add(new SuiteWorkerPoolGrow());
+    runner.Add(new SuiteWorkerPoolFixed());
+    runner.Add(new SuiteWorkerPoolShutdown());
+    runner.Add(new SuiteWorkerPoolRegistry());
+    runner.Run();
+}
@@ -4,6 +4,8 @@
 #include <exception>
 #include <OpenHome/Net/Private/Globals.h> // FIXME - use of globals should be discouraged
 #include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/Atomic.h>
+#include <OpenHome/Private/MutexProfiler.h>
 
 #include <algorithm>
 
@@ -61,6 +63,9 @@ const TChar* Mutex::kErrorStringDeadlock = "Recursive lock attempted on mutex";
 const TChar* Mutex::kErrorStringUninitialised = "Lock attempted on uninitialised mutex";
 
 Mutex::Mutex(const TChar* aName)
+    : iStats(NULL)
+    , iHeld(0)
+    , iAcquiredUs(0)
 {
     iHandle = OpenHome::Os::MutexCreate(OpenHome::gEnv->OsCtx(), aName);
     if (iHandle == kHandleNull) {
@@ -68,17 +73,38 @@ Mutex::Mutex(const TChar* aName)
     }
     (void)strncpy(iName, aName, 4);
     iName[4] = 0;
+    MutexProfiler* profiler = OpenHome::gEnv->MutexProfiler();
+    if (profiler != NULL) {
+        iStats = profiler->Register(*this, iName);
+    }
 }
 
 Mutex::~Mutex()
 {
+    if (iStats != NULL) {
+        // iStats is cleared if the profiler is destroyed first
+        OpenHome::gEnv->MutexProfiler()->Deregister(*this);
+    }
     OpenHome::Os::MutexDestroy(iHandle);
 }
 
 void Mutex::Wait()
 {
+    MutexStats* stats = iStats;
+    TUint64 startUs = 0;
+    TBool contended = false;
+    if (stats != NULL) {
+        // iHeld is only a hint - a racing Signal() may make an uncontended acquisition look contended
+        contended = (Atomic::Load(iHeld) != 0);
+        startUs = Os::TimeInUs(OpenHome::gEnv->OsCtx());
+    }
     TInt err = OpenHome::Os::MutexLock(iHandle);
     if (err == 0) {
+        if (stats != NULL) {
+            iAcquiredUs = Os::TimeInUs(OpenHome::gEnv->OsCtx());
+            Atomic::Store(iHeld, 1);
+            stats->RecordWait(iAcquiredUs - startUs, contended);
+        }
         return;
     }
 
@@ -89,6 +115,11 @@ void Mutex::Wait()
 
 void Mutex::Signal()
 {
+    MutexStats* stats = iStats;
+    if (stats != NULL) {
+        Atomic::Store(iHeld, 0);
+        stats->RecordHold(Os::TimeInUs(OpenHome::gEnv->OsCtx()) - iAcquiredUs);
+    }
     OpenHome::Os::MutexUnlock(iHandle);
 }
 
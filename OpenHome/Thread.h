@@ -65,8 +65,12 @@ public:
     DllExport virtual const TChar* Name() const = 0;
 };
 
+class MutexStats;
+class MutexProfiler;
+
 class DllExportClass Mutex : public INonCopyable
 {
+    friend class MutexProfiler;
 private:
     static const TChar* kErrorStringDeadlock;
     static const TChar* kErrorStringUninitialised;
@@ -79,6 +83,10 @@ public:
 protected:
     THandle iHandle;
     TChar iName[5];
+private:
+    MutexStats* iStats; // non-NULL iff mutex profiling is enabled and the profiler still exists
+    volatile TUint iHeld;
+    TUint64 iAcquiredUs;
 };
 
 class DllExportClass MutexFactory
@@ -0,0 +1,233 @@
+#include <OpenHome/Private/WorkerPool.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/Debug.h>
+
+#include <algorithm>
+
+using namespace OpenHome;
+
+// WorkerPool::Worker
+
+WorkerPool::Worker::Worker(WorkerPool& aPool, const TChar* aName, TUint aPriority)
+    : Thread(aName, aPriority)
+    , iPool(aPool)
+{
+}
+
+WorkerPool::Worker::~Worker()
+{
+    Kill();
+    Join();
+}
+
+void WorkerPool::Worker::Run()
+{
+    iPool.Run(*this);
+}
+
+
+// WorkerPool
+
+WorkerPool::WorkerPool(Environment& aEnv, const TChar* aName, IWorkerPoolHandler& aHandler,
+                       TUint aMinThreads, TUint aMaxThreads, TUint aIdleTimeoutMs, TUint aPriority)
+    : iEnv(aEnv)
+    , iName(aName)
+    , iHandler(aHandler)
+    , iMinThreads(aMinThreads)
+    , iMaxThreads(std::max(aMinThreads, aMaxThreads))
+    , iIdleTimeoutMs(aIdleTimeoutMs)
+    , iPriority(aPriority)
+    , iLock("WKPL")
+    , iJobs("WKPJ", 0)
+    , iActive(true)
+    , iNextId(0)
+    , iPending(0)
+    , iBusy(0)
+    , iPeakThreads(0)
+    , iPeakPending(0)
+    , iJobsProcessed(0)
+    , iThreadsCreated(0)
+    , iThreadsRetired(0)
+{
+    ASSERT(iMinThreads > 0);
+    iLock.Wait();
+    for (TUint i=0; i<iMinThreads; i++) {
+        AddWorkerLocked();
+    }
+    iLock.Signal();
+    iEnv.WorkerPools().Add(*this);
+}
+
+WorkerPool::~WorkerPool()
+{
+    iEnv.WorkerPools().Remove(*this);
+    iLock.Wait();
+    iActive = false; // iWorkers won't change after this
+    iLock.Signal();
+    std::list<Worker*>::iterator it;
+    for (it=iWorkers.begin(); it!=iWorkers.end(); ++it) {
+        (*it)->Kill();
+        iJobs.Signal();
+    }
+    for (it=iWorkers.begin(); it!=iWorkers.end(); ++it) {
+        delete *it;
+    }
+    iWorkers.clear();
+    ReapRetired();
+}
+
+void WorkerPool::JobAdded()
+{
+    ReapRetired();
+    iLock.Wait();
+    iPending++;
+    if (iPending > iPeakPending) {
+        iPeakPending = iPending;
+    }
+    const TUint numThreads = (TUint)iWorkers.size();
+    if (iActive && iPending > numThreads - iBusy && numThreads < iMaxThreads) {
+        LOG(kThread, "WorkerPool %.*s: %u jobs pending, growing to %u threads\n", PBUF(iName), iPending, numThreads+1);
+        AddWorkerLocked();
+    }
+    iLock.Signal();
+    iJobs.Signal();
+}
+
+const Brx& WorkerPool::Name() const
+{
+    return iName;
+}
+
+TUint WorkerPool::NumThreads() const
+{
+    AutoMutex _(iLock);
+    return (TUint)iWorkers.size();
+}
+
+TUint WorkerPool::NumBusy() const
+{
+    AutoMutex _(iLock);
+    return iBusy;
+}
+
+void WorkerPool::WriteStats(IWriter& aWriter) const
+{
+    Bws<160> row;
+    iLock.Wait();
+    row.AppendPrintf("%-18.*s %7u %4u %7u %4u %4u %7u %8u %8u %7u %7u %10llu\n",
+                     PBUF(iName), (TUint)iWorkers.size(), iBusy, iPending, iMinThreads, iMaxThreads, iIdleTimeoutMs,
+                     iPeakThreads, iPeakPending, iThreadsCreated, iThreadsRetired, iJobsProcessed);
+    iLock.Signal();
+    aWriter.Write(row);
+}
+
+void WorkerPool::AddWorkerLocked()
+{
+    Bws<Thread::kMaxNameBytes+1> thName;
+    thName.AppendPrintf("%.*s %u", PBUF(iName), iNextId++);
+    Worker* worker = new Worker(*this, (const TChar*)thName.PtrZ(), iPriority);
+    iWorkers.push_back(worker);
+    iThreadsCreated++;
+    if (iWorkers.size() > iPeakThreads) {
+        iPeakThreads = (TUint)iWorkers.size();
+    }
+    worker->Start();
+}
+
+void WorkerPool::Run(Worker& aWorker)
+{
+    for (;;) {
+        iLock.Wait();
+        // threads above the minimum wait with a timeout so that they can exit once demand drops
+        const TUint timeoutMs = (iWorkers.size() > iMinThreads? iIdleTimeoutMs : Semaphore::kWaitForever);
+        iLock.Signal();
+        try {
+            iJobs.Wait(timeoutMs);
+        }
+        catch (Timeout&) {
+            AutoMutex _(iLock);
+            if (iActive && iPending == 0 && iWorkers.size() > iMinThreads) {
+                LOG(kThread, "WorkerPool %.*s: idle, shrinking to %u threads\n", PBUF(iName), (TUint)iWorkers.size()-1);
+                iWorkers.remove(&aWorker);
+                iRetired.push_back(&aWorker); // deleted by the next call to JobAdded() or ~WorkerPool()
+                iThreadsRetired++;
+                return;
+            }
+            continue;
+        }
+        iLock.Wait();
+        if (!iActive) {
+            iLock.Signal();
+            return;
+        }
+        iPending--;
+        iBusy++;
+        iLock.Signal();
+        try {
+            iHandler.ProcessJob();
+        }
+        catch (ThreadKill&) {
+            iLock.Wait();
+            iBusy--;
+            iLock.Signal();
+            throw;
+        }
+        iLock.Wait();
+        iBusy--;
+        iJobsProcessed++;
+        iLock.Signal();
+    }
+}
+
+void WorkerPool::ReapRetired()
+{
+    std::vector<Worker*> retired;
+    iLock.Wait();
+    retired.swap(iRetired);
+    iLock.Signal();
+    for (TUint i=0; i<(TUint)retired.size(); i++) {
+        delete retired[i];
+    }
+}
+
+
+// WorkerPoolRegistry
+
+const Brn WorkerPoolRegistry::kQueryWorkerPools("workerpools");
+
+WorkerPoolRegistry::WorkerPoolRegistry()
+    : iLock("WKPR")
+{
+}
+
+void WorkerPoolRegistry::Add(WorkerPool& aPool)
+{
+    AutoMutex _(iLock);
+    iPools.push_back(&aPool);
+}
+
+void WorkerPoolRegistry::Remove(WorkerPool& aPool)
+{
+    AutoMutex _(iLock);
+    iPools.remove(&aPool);
+}
+
+void WorkerPoolRegistry::WriteTable(IWriter& aWriter)
+{
+    aWriter.Write(Brn("pool               threads busy pending  min  max idle_ms peak_thr peak_pnd created retired       jobs\n"));
+    AutoMutex _(iLock);
+    for (std::list<WorkerPool*>::iterator it=iPools.begin(); it!=iPools.end(); ++it) {
+        (*it)->WriteStats(aWriter);
+    }
+}
+
+void WorkerPoolRegistry::QueryInfo(const Brx& aQuery, IWriter& aWriter)
+{
+    if (aQuery == kQueryWorkerPools) {
+        WriteTable(aWriter);
+    }
+}
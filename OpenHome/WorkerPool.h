@@ -0,0 +1,115 @@
+#ifndef HEADER_WORKER_POOL
+#define HEADER_WORKER_POOL
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Standard.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/InfoProvider.h>
+
+#include <list>
+#include <vector>
+
+namespace OpenHome {
+
+class Environment;
+
+class IWorkerPoolHandler
+{
+public:
+    virtual ~IWorkerPoolHandler() {}
+    /**
+     * Called from a pool thread once for each call to WorkerPool::JobAdded().
+     * Implementations should remove the oldest job from their own queue and process it.
+     */
+    virtual void ProcessJob() = 0;
+};
+
+/**
+ * Pool of threads whose size follows demand.
+ *
+ * aMinThreads threads are started on construction.  Another is created, up to a limit of
+ * aMaxThreads, whenever a job is added while no thread is free to run it.  Threads above
+ * aMinThreads exit after aIdleTimeoutMs without work (0 means they never exit).
+ *
+ * The pool doesn't hold jobs itself.  Clients queue work in whatever structure suits them
+ * then call JobAdded(); the pool calls IWorkerPoolHandler::ProcessJob() once per job.
+ */
+class WorkerPool : private INonCopyable
+{
+public:
+    WorkerPool(Environment& aEnv, const TChar* aName, IWorkerPoolHandler& aHandler,
+               TUint aMinThreads, TUint aMaxThreads, TUint aIdleTimeoutMs,
+               TUint aPriority = kPriorityNormal);
+    /**
+     * Kills and joins all threads.  Jobs which haven't been started by this point are
+     * never passed to the handler; the client is responsible for cleaning them up.
+     */
+    ~WorkerPool();
+    void JobAdded();
+    const Brx& Name() const;
+    TUint NumThreads() const;
+    TUint NumBusy() const;
+    void WriteStats(IWriter& aWriter) const;
+private:
+    class Worker : public Thread
+    {
+    public:
+        Worker(WorkerPool& aPool, const TChar* aName, TUint aPriority);
+        ~Worker();
+    private: // from Thread
+        void Run();
+    private:
+        WorkerPool& iPool;
+    };
+private:
+    void AddWorkerLocked();
+    void Run(Worker& aWorker);
+    void ReapRetired();
+private:
+    Environment& iEnv;
+    Bws<Thread::kMaxNameBytes> iName;
+    IWorkerPoolHandler& iHandler;
+    const TUint iMinThreads;
+    const TUint iMaxThreads;
+    const TUint iIdleTimeoutMs;
+    const TUint iPriority;
+    mutable Mutex iLock;
+    Semaphore iJobs;
+    std::list<Worker*> iWorkers;
+    std::vector<Worker*> iRetired;
+    TBool iActive;
+    TUint iNextId;
+    TUint iPending;
+    TUint iBusy;
+    TUint iPeakThreads;
+    TUint iPeakPending;
+    TUint64 iJobsProcessed;
+    TUint iThreadsCreated;
+    TUint iThreadsRetired;
+};
+
+/**
+ * Owned by Environment.  Every WorkerPool registers itself for the lifetime of the pool
+ * so that its utilisation can be reported via the InfoAggregator.
+ */
+class WorkerPoolRegistry : public IInfoProvider, private INonCopyable
+{
+public:
+    static const Brn kQueryWorkerPools;
+public:
+    WorkerPoolRegistry();
+    void Add(WorkerPool& aPool);
+    void Remove(WorkerPool& aPool);
+    void WriteTable(IWriter& aWriter);
+private: // from IInfoProvider
+    void QueryInfo(const Brx& aQuery, IWriter& aWriter);
+private:
+    Mutex iLock;
+    std::list<WorkerPool*> iPools;
+};
+
+} // namespace OpenHome
+
+#endif // HEADER_WORKER_POOL
@@ -413,6 +413,55 @@ typedef enum
  */
 THandle OsNetworkCreate(OsContext* aContext, OsNetworkSocketType aSocketType, OsNetworkSocketFamily aSocketFamily);
 
+/**
+ * Create a stream socket in the local (unix domain) address family.
+ *
+ * Local sockets are named by a filesystem path rather than an address and port and
+ * are only reachable from the same host.  Once bound/connected they support the same
+ * OsNetworkListen(), OsNetworkAccept(), OsNetworkSend(), OsNetworkReceive(),
+ * OsNetworkInterrupt() and OsNetworkClose() calls as a stream socket created by
+ * OsNetworkCreate().
+ *
+ * @param[in] aContext          Returned from OsCreate().
+ *
+ * @return  a valid handle on success; kHandleNull if creation failed or the platform
+ *          doesn't support local sockets.
+ */
+THandle OsNetworkCreateLocal(OsContext* aContext);
+
+/**
+ * Assign a filesystem path to a local socket.
+ *
+ * A socket already at aPath is removed first if nothing is listening on it.  Binding
+ * fails if another process is listening on aPath or aPath exists but isn't a socket.
+ *
+ * @param[in] aHandle      Socket handle returned from OsNetworkCreateLocal()
+ * @param[in] aPath        Nul-terminated path
+ *
+ * @return  0 on success; -2 if aPath is already in use; -1 on any other failure
+ */
+int32_t OsNetworkBindLocal(THandle aHandle, const char* aPath);
+
+/**
+ * Connect a local socket to a listening socket bound to aPath.
+ *
+ * @param[in] aHandle      Socket handle returned from OsNetworkCreateLocal()
+ * @param[in] aPath        Nul-terminated path
+ * @param[in] aTimeoutMs   Number of milliseconds to wait for the listener to accept the connection
+ *
+ * @return  0 on success; -2 if nothing is listening on aPath; -1 on any other failure
+ */
+int32_t OsNetworkConnectLocal(THandle aHandle, const char* aPath, uint32_t aTimeoutMs);
+
+/**
+ * Remove the filesystem entry created by OsNetworkBindLocal().
+ *
+ * @param[in] aPath        Nul-terminated path
+ *
+ * @return  0 on success; -1 on failure
+ */
+int32_t OsNetworkUnlinkLocal(const char* aPath);
+
 /**
  * Assign a name to a socket.
  *
@@ -478,6 +527,31 @@ int32_t OsNetworkConnect(THandle aHandle, TIpAddress aAddress, uint16_t aPort, u
  */
 int32_t OsNetworkSend(THandle aHandle, const uint8_t* aBuffer, uint32_t aBytes);
 
+/**
+ * One element of the array of buffers passed to OsNetworkSendV()
+ */
+typedef struct OsNetworkBuffer
+{
+    const uint8_t* iPtr;  /**< Start of data to send */
+    uint32_t       iBytes;/**< Number of bytes of iPtr to send */
+} OsNetworkBuffer;
+
+/**
+ * Send data gathered from several buffers
+ *
+ * This is equivalent to the BSD sendmsg() (or writev()) function.  Blocks until all
+ * bytes from all buffers have been sent.  Platforms without a gather write may
+ * implement this as a series of calls to OsNetworkSend().
+ *
+ * @param[in] aHandle      Socket handle returned from OsNetworkCreate()
+ * @param[in] aBuffers     Array of buffers to send, in order
+ * @param[in] aCount       Number of elements in aBuffers
+ *
+ * @return  total number of bytes sent.  This is 0 if aBuffers contain no data and is less
+ *          than the total requested if the socket failed part way through.  -1 on failure.
+ */
+int32_t OsNetworkSendV(THandle aHandle, const OsNetworkBuffer* aBuffers, uint32_t aCount);
+
 /**
  * Send data to the specified endpoint
  *
@@ -106,6 +106,37 @@ void OpenHome::Os::NetworkConnect(THandle aHandle, const Endpoint& aEndpoint, TU
     }
 }
 
+THandle Os::NetworkCreateLocal(OsContext* aContext)
+{
+    THandle handle = OsNetworkCreateLocal(aContext);
+    if (handle == kHandleNull) {
+        THROW(NetworkError);
+    }
+    return handle;
+}
+
+TInt Os::NetworkBindLocal(THandle aHandle, const Brx& aPath)
+{
+    Brhz path(aPath);
+    return OsNetworkBindLocal(aHandle, path.CString());
+}
+
+void Os::NetworkConnectLocal(THandle aHandle, const Brx& aPath, TUint aTimeoutMs)
+{
+    Brhz path(aPath);
+    int32_t err = OsNetworkConnectLocal(aHandle, path.CString(), aTimeoutMs);
+    if (err != 0) {
+        LOG_ERROR(kNetwork, "Os::NetworkConnectLocal H = %d, RETURN VALUE = %d\n", aHandle, err);
+        THROW(NetworkError);
+    }
+}
+
+void Os::NetworkUnlinkLocal(const Brx& aPath)
+{
+    Brhz path(aPath);
+    (void)OsNetworkUnlinkLocal(path.CString());
+}
+
 TInt OpenHome::Os::NetworkReceiveFrom(THandle aHandle, Bwx& aBuffer, Endpoint& aEndpoint)
 {
     TIpAddress address;
@@ -54,7 +54,12 @@ public:
     static TInt NetworkBindMulticast(THandle aHandle, TIpAddress aAdapter, const Endpoint& aMulticast);
     static TInt NetworkPort(THandle aHandle, TUint& aPort);
     static void NetworkConnect(THandle aHandle, const Endpoint& aEndpoint, TUint aTimeoutMs);
+    static THandle NetworkCreateLocal(OsContext* aContext);
+    static TInt NetworkBindLocal(THandle aHandle, const Brx& aPath);
+    static void NetworkConnectLocal(THandle aHandle, const Brx& aPath, TUint aTimeoutMs);
+    static void NetworkUnlinkLocal(const Brx& aPath);
     inline static TInt NetworkSend(THandle aHandle, const Brx& aBuffer);
+    inline static TInt NetworkSendV(THandle aHandle, const OsNetworkBuffer* aBuffers, TUint aCount);
     inline static TInt NetworkSendTo(THandle aHandle, const Brx& aBuffer, const Endpoint& aEndpoint);
     inline static TInt NetworkReceive(THandle aHandle, Bwx& aBuffer);
     static TInt NetworkReceiveFrom(THandle aHandle, Bwx& aBuffer, Endpoint& aEndpoint);
@@ -76,6 +76,8 @@ inline TBool Os::ThreadSupportsPriorities(OsContext* aContext)
 
 inline TInt Os::NetworkSend(THandle aHandle, const Brx& aBuffer)
 { return OsNetworkSend(aHandle, aBuffer.Ptr(), aBuffer.Bytes()); }
+inline TInt Os::NetworkSendV(THandle aHandle, const OsNetworkBuffer* aBuffers, TUint aCount)
+{ return OsNetworkSendV(aHandle, aBuffers, aCount); }
 inline TInt Os::NetworkSendTo(THandle aHandle, const Brx& aBuffer, const Endpoint& aEndpoint)
 { return OsNetworkSendTo(aHandle, aBuffer.Ptr(), aBuffer.Bytes(), aEndpoint.Address(), aEndpoint.Port()); }
 inline TInt Os::NetworkReceive(THandle aHandle, Bwx& aBuffer)
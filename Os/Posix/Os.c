@@ -13,6 +13,9 @@
 #include <sys/types.h>
 #include <sys/select.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <sys/stat.h>
 #include <sys/ioctl.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -1284,6 +1287,154 @@ THandle OsNetworkCreate(OsContext* aContext, OsNetworkSocketType aSocketType, Os
     return (THandle)handle;
 }
 
+THandle OsNetworkCreateLocal(OsContext* aContext)
+{
+    int32_t socketH = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socketH == -1) {
+        return kHandleNull;
+    }
+    OsNetworkHandle* handle = CreateHandle(aContext, socketH);
+    if (handle == kHandleNull) {
+        close(socketH);
+    }
+    return (THandle)handle;
+}
+
+static int32_t sockaddrFromPath(struct sockaddr_un* aAddr, const char* aPath)
+{
+    size_t len = strlen(aPath);
+    if (len == 0 || len >= sizeof(aAddr->sun_path)) {
+        return -1;
+    }
+    memset(aAddr, 0, sizeof(*aAddr));
+    aAddr->sun_family = AF_UNIX;
+    memcpy(aAddr->sun_path, aPath, len + 1);
+    return 0;
+}
+
+/* Returns 1 if aPath is a socket nothing is listening on, 0 otherwise */
+static int32_t localSocketIsStale(const struct sockaddr_un* aAddr, const char* aPath)
+{
+    struct stat st;
+    int32_t probe;
+    int32_t stale;
+    if (lstat(aPath, &st) != 0 || !S_ISSOCK(st.st_mode)) {
+        return 0;
+    }
+    probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe == -1) {
+        return 0;
+    }
+    stale = (connect(probe, (const struct sockaddr*)aAddr, sizeof(*aAddr)) != 0 && errno == ECONNREFUSED);
+    close(probe);
+    return stale;
+}
+
+int32_t OsNetworkBindLocal(THandle aHandle, const char* aPath)
+{
+    OsNetworkHandle* handle = (OsNetworkHandle*)aHandle;
+    struct sockaddr_un addr;
+    if (sockaddrFromPath(&addr, aPath) != 0) {
+        return -1;
+    }
+    if (localSocketIsStale(&addr, aPath)) {
+        (void)unlink(aPath);
+    }
+    /* anything else at aPath (a live server, or a file that isn't a socket) causes bind to fail */
+    if (bind(handle->iSocket, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        return (errno == EADDRINUSE)? -2 : -1;
+    }
+    return 0;
+}
+
+#define kLocalConnectRetryMs 10
+
+int32_t OsNetworkConnectLocal(THandle aHandle, const char* aPath, uint32_t aTimeoutMs)
+{
+    OsNetworkHandle* handle = (OsNetworkHandle*)aHandle;
+    if (SocketInterrupted(handle)) {
+        return -1;
+    }
+    struct sockaddr_un addr;
+    if (sockaddrFromPath(&addr, aPath) != 0) {
+        return -1;
+    }
+    int32_t err = -1;
+    uint32_t remainingMs = aTimeoutMs;
+
+    /* A blocking connect waits indefinitely if the listener's backlog is full.  Connect
+       non-blocking instead, waiting for at most aTimeoutMs as OsNetworkConnect does.
+       Linux fails with EAGAIN (rather than EINPROGRESS) while the backlog is full so
+       retry periodically in that case. */
+    SetFdNonBlocking(handle->iSocket);
+    for (;;) {
+        if (connect(handle->iSocket, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+            err = 0;
+            break;
+        }
+        const int connectErr = errno;
+        if (connectErr == ENOENT || connectErr == ECONNREFUSED) {
+            err = -2;
+            break;
+        }
+        if (connectErr != EAGAIN && connectErr != EINPROGRESS && connectErr != EINTR) {
+            break;
+        }
+        if (SocketInterrupted(handle)) {
+            break;
+        }
+
+        fd_set read;
+        fd_set write;
+        fd_set error;
+        int32_t selectErr;
+        /* an interrupted connect continues asynchronously, as if it had failed with EINPROGRESS */
+        const int inProgress = (connectErr != EAGAIN);
+        uint32_t waitMs = remainingMs;
+        if (!inProgress && waitMs > kLocalConnectRetryMs) {
+            waitMs = kLocalConnectRetryMs;
+        }
+        struct timeval tv;
+        tv.tv_sec = waitMs / 1000;
+        tv.tv_usec = (waitMs % 1000) * 1000;
+
+        do {
+            FD_ZERO(&read);
+            FD_SET(handle->iPipe[0], &read);
+            FD_ZERO(&write);
+            FD_ZERO(&error);
+            if (inProgress) {
+                FD_SET(handle->iSocket, &write);
+                FD_SET(handle->iSocket, &error);
+            }
+            selectErr = (long int) select(nfds(handle), &read, &write, &error, &tv);
+        } while(selectErr == -1L && errno == EINTR && !SocketInterrupted(handle));
+        if (inProgress) {
+            if (selectErr > 0 && FD_ISSET(handle->iSocket, &write)) {
+                // Need to check socket status using getsockopt. See man page for connect, EINPROGRESS
+                int sock_error;
+                socklen_t err_len = sizeof(sock_error);
+                if (getsockopt(handle->iSocket, SOL_SOCKET, SO_ERROR, &sock_error, &err_len) == 0) {
+                    err = ((err_len == sizeof(sock_error)) && (sock_error == 0)) ? 0 : -2;
+                }
+            }
+            break;
+        }
+        if (selectErr != 0 || remainingMs <= waitMs) {
+            /* interrupted, select failed or timed out */
+            break;
+        }
+        remainingMs -= waitMs;
+    }
+    SetFdBlocking(handle->iSocket);
+    return err;
+}
+
+int32_t OsNetworkUnlinkLocal(const char* aPath)
+{
+    return unlink(aPath);
+}
+
 int32_t OsNetworkBind(THandle aHandle, TIpAddress aAddress, uint32_t aPort)
 {
     int32_t err;
@@ -1403,6 +1554,62 @@ int32_t OsNetworkSend(THandle aHandle, const uint8_t* aBuffer, uint32_t aBytes)
     return sent;
 }
 
+#define kMaxSendVBuffers 16
+
+int32_t OsNetworkSendV(THandle aHandle, const OsNetworkBuffer* aBuffers, uint32_t aCount)
+{
+    OsNetworkHandle* handle = (OsNetworkHandle*)aHandle;
+    struct iovec iov[kMaxSendVBuffers];
+    struct msghdr msg;
+    uint32_t index = 0;
+    uint32_t offset = 0; /* bytes from aBuffers[index] which have already been sent */
+    int32_t sent = 0;
+    long int bytes;
+    uint32_t count;
+    uint32_t i;
+
+    if (SocketInterrupted(handle)) {
+        return -1;
+    }
+
+    for (;;) {
+        while (index < aCount && offset == aBuffers[index].iBytes) {
+            index++;
+            offset = 0;
+        }
+        if (index == aCount) {
+            break;
+        }
+        count = 0;
+        for (i=index; i<aCount && count<kMaxSendVBuffers; i++) {
+            iov[count].iov_base = (void*)(aBuffers[i].iPtr + (i==index? offset : 0));
+            iov[count].iov_len = aBuffers[i].iBytes - (i==index? offset : 0);
+            count++;
+        }
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        bytes = TEMP_FAILURE_RETRY_2(sendmsg(handle->iSocket, &msg, MSG_NOSIGNAL), handle);
+        if (bytes == -1) {
+            break;
+        }
+        sent += (int32_t)bytes;
+        while (bytes > 0) {
+            const uint32_t remaining = aBuffers[index].iBytes - offset;
+            if ((uint32_t)bytes < remaining) {
+                offset += (uint32_t)bytes;
+                bytes = 0;
+            }
+            else {
+                bytes -= remaining;
+                index++;
+                offset = 0;
+            }
+        }
+    }
+    return sent;
+}
+
 int32_t OsNetworkSendTo(THandle aHandle, const uint8_t* aBuffer, uint32_t aBytes, TIpAddress aAddress, uint16_t aPort)
 {
     OsNetworkHandle* handle = (OsNetworkHandle*)aHandle;
@@ -1642,6 +1849,12 @@ THandle OsNetworkAccept(THandle aHandle, TIpAddress* aClientAddress, uint32_t* a
         return kHandleNull;
     }
 
+    if (addr.sa_family == AF_UNIX) {
+        // local socket clients have no address; report them as loopback
+        aClientAddress->iFamily = kFamilyV4;
+        aClientAddress->iV4 = htonl(INADDR_LOOPBACK);
+        return (THandle)newHandle;
+    }
     // Helper functions determine protocol family (IPv4/v6)
     *aClientAddress = TIpAddressFromSockAddr(&addr);
     *aClientPort = PortFromSockAddr(&addr);
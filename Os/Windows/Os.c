@@ -586,6 +586,34 @@ THandle OsNetworkCreate(OsContext* aContext, OsNetworkSocketType aSocketType, Os
     return (THandle)handle;
 }
 
+THandle OsNetworkCreateLocal(OsContext* aContext)
+{
+    /* AF_UNIX is only available on recent Windows 10 builds; not supported for now */
+    UNUSED(aContext);
+    return kHandleNull;
+}
+
+int32_t OsNetworkBindLocal(THandle aHandle, const char* aPath)
+{
+    UNUSED(aHandle);
+    UNUSED(aPath);
+    return -1;
+}
+
+int32_t OsNetworkConnectLocal(THandle aHandle, const char* aPath, uint32_t aTimeoutMs)
+{
+    UNUSED(aHandle);
+    UNUSED(aPath);
+    UNUSED(aTimeoutMs);
+    return -1;
+}
+
+int32_t OsNetworkUnlinkLocal(const char* aPath)
+{
+    UNUSED(aPath);
+    return -1;
+}
+
 int32_t OsNetworkBind(THandle aHandle, TIpAddress aAddress, uint32_t aPort)
 {
     int32_t err;
@@ -696,6 +724,26 @@ int32_t OsNetworkSend(THandle aHandle, const uint8_t* aBuffer, uint32_t aBytes)
     return (int32_t)aBytes - remaining;
 }
 
+int32_t OsNetworkSendV(THandle aHandle, const OsNetworkBuffer* aBuffers, uint32_t aCount)
+{
+    /* WSASend() supports gather writes but needs its own WSAEWOULDBLOCK handling;
+       for now, send each buffer in turn */
+    int32_t sent = 0;
+    int32_t bytes;
+    uint32_t i;
+    for (i=0; i<aCount; i++) {
+        bytes = OsNetworkSend(aHandle, aBuffers[i].iPtr, aBuffers[i].iBytes);
+        if (bytes == -1) {
+            return (sent == 0? -1 : sent);
+        }
+        sent += bytes;
+        if ((uint32_t)bytes != aBuffers[i].iBytes) {
+            break;
+        }
+    }
+    return sent;
+}
+
 int32_t OsNetworkSendTo(THandle aHandle, const uint8_t* aBuffer, uint32_t aBytes, TIpAddress aAddress, uint16_t aPort)
 {
     int32_t sent = 0;